@@ -0,0 +1,123 @@
+#include <cstring>
+
+#include <nn/nn_Abort.h>
+#include <nn/fs.h>
+
+#include "AudioBank.h"
+
+AudioBank::AudioBank() NN_NOEXCEPT
+    : m_pBank(nullptr)
+    , m_Size(0)
+    , m_pPool(nullptr)
+{
+}
+
+void AudioBank::Load(const char* filename, AudioDsp::WavePool* pPool) NN_NOEXCEPT
+{
+    NN_ABORT_UNLESS_NOT_NULL(pPool);
+    NN_ABORT_UNLESS(m_pBank == nullptr);
+
+    nn::fs::FileHandle handle;
+    nn::Result result = nn::fs::OpenFile(&handle, filename, nn::fs::OpenMode_Read);
+    NN_ABORT_UNLESS_RESULT_SUCCESS(result);
+
+    int64_t size;
+    result = nn::fs::GetFileSize(&size, handle);
+    NN_ABORT_UNLESS_RESULT_SUCCESS(result);
+
+    m_Size = static_cast<std::size_t>(size);
+    m_pBank = pPool->AllocateLongLived(m_Size);
+    NN_ABORT_UNLESS(m_pBank != nullptr, "No room for bank %s (%lld bytes)", filename, static_cast<long long>(size));
+    m_pPool = pPool;
+
+    result = nn::fs::ReadFile(handle, 0, m_pBank, m_Size);
+    NN_ABORT_UNLESS_RESULT_SUCCESS(result);
+    nn::fs::CloseFile(handle);
+
+    const AudioDsp::BankResult bankResult = AudioDsp::ValidateBank(m_pBank, m_Size);
+    NN_ABORT_UNLESS(bankResult == AudioDsp::BankResult_Success, "Failed to load bank %s (%s)", filename, AudioDsp::GetBankResultString(bankResult));
+    NN_ABORT_UNLESS(AudioDsp::GetBankHeader(m_pBank)->alignment >= nn::audio::BufferAlignSize);
+}
+
+void AudioBank::Unload() NN_NOEXCEPT
+{
+    if (m_pBank != nullptr)
+    {
+        m_pPool->FreeLongLived(m_pBank, m_Size);
+        m_pBank = nullptr;
+        m_Size = 0;
+        m_pPool = nullptr;
+    }
+}
+
+int AudioBank::GetSoundCount() const NN_NOEXCEPT
+{
+    NN_ABORT_UNLESS_NOT_NULL(m_pBank);
+    return AudioDsp::GetBankEntryCount(m_pBank);
+}
+
+int AudioBank::FindSound(const char* name) const NN_NOEXCEPT
+{
+    NN_ABORT_UNLESS_NOT_NULL(m_pBank);
+    const int index = AudioDsp::FindBankEntry(m_pBank, name);
+    return index >= 0 ? index : InvalidIndex;
+}
+
+const char* AudioBank::GetName(int index) const NN_NOEXCEPT
+{
+    return GetEntry(index).name;
+}
+
+nn::audio::SampleFormat AudioBank::GetSampleFormat(int index) const NN_NOEXCEPT
+{
+    return GetEntry(index).sampleFormat == AudioDsp::BankSampleFormat_Adpcm ? nn::audio::SampleFormat_Adpcm : nn::audio::SampleFormat_PcmInt16;
+}
+
+int AudioBank::GetChannelCount(int index) const NN_NOEXCEPT
+{
+    return GetEntry(index).channelCount;
+}
+
+int AudioBank::GetSampleRate(int index) const NN_NOEXCEPT
+{
+    return GetEntry(index).info.sampleRate;
+}
+
+int AudioBank::GetSampleCount(int index) const NN_NOEXCEPT
+{
+    return GetEntry(index).info.sampleCount;
+}
+
+void AudioBank::GetAdpcmHeader(nn::audio::AdpcmHeaderInfo* pOutHeader, int index) const NN_NOEXCEPT
+{
+    NN_STATIC_ASSERT(sizeof(nn::audio::AdpcmParameter) == sizeof(AudioDsp::AdpcmParameter));
+    NN_STATIC_ASSERT(sizeof(nn::audio::AdpcmContext) == sizeof(AudioDsp::AdpcmContext));
+
+    // Copied member by member; the bank stores the portable AudioDsp layout.
+    const AudioDsp::AdpcmHeaderInfo& info = GetEntry(index).info;
+    std::memcpy(&pOutHeader->parameter, &info.parameter, sizeof(pOutHeader->parameter));
+    std::memcpy(&pOutHeader->loopContext, &info.loopContext, sizeof(pOutHeader->loopContext));
+    pOutHeader->sampleCount = info.sampleCount;
+    pOutHeader->sampleRate = info.sampleRate;
+    pOutHeader->loop = info.loop;
+    pOutHeader->loopStartSampleOffset = info.loopStartSampleOffset;
+    pOutHeader->loopEndSampleOffset = info.loopEndSampleOffset;
+}
+
+const void* AudioBank::GetData(int index) const NN_NOEXCEPT
+{
+    GetEntry(index);
+    return AudioDsp::GetBankEntryData(m_pBank, index);
+}
+
+std::size_t AudioBank::GetDataSize(int index) const NN_NOEXCEPT
+{
+    return GetEntry(index).dataSize;
+}
+
+const AudioDsp::BankEntry& AudioBank::GetEntry(int index) const NN_NOEXCEPT
+{
+    NN_ABORT_UNLESS_NOT_NULL(m_pBank);
+    NN_ABORT_UNLESS(index >= 0 && index < AudioDsp::GetBankEntryCount(m_pBank));
+    return *AudioDsp::GetBankEntry(m_pBank, index);
+}
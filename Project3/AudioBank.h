@@ -0,0 +1,64 @@
+#pragma once
+
+/**
+* @brief
+*  A sound bank loaded with a single read.
+*
+*  The bank file (see AudioDspBank.h, built with <tt>HostAudioTool bank-build</tt>) is read in one piece into the
+*  long-lived region of a wave pool over an attached memory pool. The ADPCM and PCM payloads are already aligned inside it, so every sound
+*  is played from where it lies and loading costs one allocation for the whole bank instead of several per sound.
+*/
+
+#include <nn/nn_Common.h>
+#include <nn/nn_Macro.h>
+#include <nn/audio.h>
+
+#include "AudioDspBank.h"
+#include "AudioDspWavePool.h"
+
+class AudioBank
+{
+    NN_DISALLOW_COPY(AudioBank);
+    NN_DISALLOW_MOVE(AudioBank);
+
+public:
+    static const int InvalidIndex = -1;
+
+    AudioBank() NN_NOEXCEPT;
+
+    /**
+    * @brief  Reads the bank at filename.
+    *
+    *  pPool must manage memory in an attached memory pool at nn::audio::BufferAlignSize. Aborts if the file is not a
+    *  valid bank or does not fit.
+    */
+    void Load(const char* filename, AudioDsp::WavePool* pPool) NN_NOEXCEPT;
+
+    //!<  Frees the bank. Stop every voice playing from it first.
+    void Unload() NN_NOEXCEPT;
+
+    int GetSoundCount() const NN_NOEXCEPT;
+
+    //!<  Index of the sound named name, or InvalidIndex.
+    int FindSound(const char* name) const NN_NOEXCEPT;
+
+    const char* GetName(int index) const NN_NOEXCEPT;
+    nn::audio::SampleFormat GetSampleFormat(int index) const NN_NOEXCEPT;
+    int GetChannelCount(int index) const NN_NOEXCEPT;
+    int GetSampleRate(int index) const NN_NOEXCEPT;
+    int GetSampleCount(int index) const NN_NOEXCEPT;
+
+    //!<  Fills pOutHeader from the bank. The sample count, rate, and loop are valid for every format.
+    void GetAdpcmHeader(nn::audio::AdpcmHeaderInfo* pOutHeader, int index) const NN_NOEXCEPT;
+
+    //!<  Sample data inside the bank, valid until <tt>Unload()</tt>.
+    const void* GetData(int index) const NN_NOEXCEPT;
+    std::size_t GetDataSize(int index) const NN_NOEXCEPT;
+
+private:
+    const AudioDsp::BankEntry& GetEntry(int index) const NN_NOEXCEPT;
+
+    void* m_pBank;
+    std::size_t m_Size;
+    AudioDsp::WavePool* m_pPool;
+};
@@ -0,0 +1,174 @@
+#include <nn/nn_Abort.h>
+
+#include "AudioCaptureWriter.h"
+#include "AudioDspWav.h"
+
+AudioCaptureWriter::AudioCaptureWriter() NN_NOEXCEPT
+    : m_pRingBuffer(nullptr)
+    , m_RingBufferSize(0)
+    , m_pThreadStack(nullptr)
+    , m_ThreadStackSize(0)
+    , m_FrameSampleCount(0)
+    , m_SampleRate(0)
+    , m_ChannelCount(0)
+    , m_FrameCount(0)
+    , m_WriteOffset(0)
+    , m_IsCapturing(false)
+    , m_PushingCount(0)
+    , m_IsQuitRequested(false)
+    , m_WrittenFrameCount(0)
+    , m_IsInitialized(false)
+{
+}
+
+std::size_t AudioCaptureWriter::GetRequiredWorkBufferSize(const nn::audio::AudioRendererParameter& parameter, int channelCount, int frameCount) NN_NOEXCEPT
+{
+    return AudioDsp::CaptureRing::GetRequiredWorkBufferSize(parameter.sampleCount, channelCount, frameCount);
+}
+
+void AudioCaptureWriter::Initialize(const nn::audio::AudioRendererParameter& parameter, int channelCount, int frameCount,
+                                    void* workBuffer, std::size_t workBufferSize, void* threadStack, std::size_t threadStackSize) NN_NOEXCEPT
+{
+    NN_ABORT_UNLESS(!m_IsInitialized);
+    NN_ABORT_UNLESS(channelCount > 0);
+    NN_ABORT_UNLESS(frameCount > 0 && (frameCount & (frameCount - 1)) == 0);
+    NN_ABORT_UNLESS_NOT_NULL(workBuffer);
+    NN_ABORT_UNLESS(workBufferSize >= GetRequiredWorkBufferSize(parameter, channelCount, frameCount));
+    NN_ABORT_UNLESS_NOT_NULL(threadStack);
+    NN_ABORT_UNLESS(threadStackSize >= ThreadStackSize);
+
+    m_pRingBuffer = workBuffer;
+    m_RingBufferSize = workBufferSize;
+    m_pThreadStack = threadStack;
+    m_ThreadStackSize = threadStackSize;
+    m_FrameSampleCount = parameter.sampleCount;
+    m_SampleRate = parameter.sampleRate;
+    m_ChannelCount = channelCount;
+    m_FrameCount = frameCount;
+    m_Ring.Initialize(m_pRingBuffer, m_RingBufferSize, m_FrameSampleCount, m_ChannelCount, m_FrameCount);
+    nn::os::InitializeEvent(&m_Event, false, nn::os::EventClearMode_AutoClear);
+    m_IsInitialized = true;
+}
+
+void AudioCaptureWriter::Finalize() NN_NOEXCEPT
+{
+    if (!m_IsInitialized)
+    {
+        return;
+    }
+    Stop();
+    nn::os::FinalizeEvent(&m_Event);
+    m_pRingBuffer = nullptr;
+    m_pThreadStack = nullptr;
+    m_IsInitialized = false;
+}
+
+bool AudioCaptureWriter::Start(const char* path) NN_NOEXCEPT
+{
+    NN_ABORT_UNLESS(m_IsInitialized);
+    NN_ABORT_UNLESS(!IsCapturing());
+    NN_ABORT_UNLESS_NOT_NULL(path);
+
+    // A file left by an earlier capture is replaced; DeleteFile fails harmlessly if there is none.
+    nn::fs::DeleteFile(path);
+    if (nn::fs::CreateFile(path, 0).IsFailure())
+    {
+        return false;
+    }
+    if (nn::fs::OpenFile(&m_FileHandle, path, nn::fs::OpenMode_Write | nn::fs::OpenMode_AllowAppend).IsFailure())
+    {
+        return false;
+    }
+
+    // The sizes in the header are patched by Stop().
+    uint8_t header[AudioDsp::WavHeaderSize];
+    AudioDsp::MakeWavHeader(header, m_SampleRate, m_ChannelCount, 0);
+    if (nn::fs::WriteFile(m_FileHandle, 0, header, sizeof(header), nn::fs::WriteOption::MakeValue(0)).IsFailure())
+    {
+        nn::fs::CloseFile(m_FileHandle);
+        return false;
+    }
+    m_WriteOffset = sizeof(header);
+
+    // Nothing pushes until m_IsCapturing is set, so the ring can be reset here.
+    m_Ring.Initialize(m_pRingBuffer, m_RingBufferSize, m_FrameSampleCount, m_ChannelCount, m_FrameCount);
+    m_WrittenFrameCount.store(0, std::memory_order_relaxed);
+    m_IsQuitRequested.store(false, std::memory_order_relaxed);
+
+    const nn::Result result = nn::os::CreateThread(&m_Thread, ThreadFunction, this, m_pThreadStack, m_ThreadStackSize, nn::os::DefaultThreadPriority);
+    NN_ABORT_UNLESS_RESULT_SUCCESS(result);
+    nn::os::SetThreadNamePointer(&m_Thread, "AudioCaptureWriter");
+    nn::os::StartThread(&m_Thread);
+    m_IsCapturing.store(true, std::memory_order_seq_cst);
+    return true;
+}
+
+void AudioCaptureWriter::Stop() NN_NOEXCEPT
+{
+    if (!IsCapturing())
+    {
+        return;
+    }
+
+    // A push that saw the flag still set finishes before the writer is told to drain, so its frame is not left behind.
+    m_IsCapturing.store(false, std::memory_order_seq_cst);
+    while (m_PushingCount.load(std::memory_order_seq_cst) != 0)
+    {
+        nn::os::YieldThread();
+    }
+    m_IsQuitRequested.store(true, std::memory_order_release);
+    nn::os::SignalEvent(&m_Event);
+    nn::os::WaitThread(&m_Thread);
+    nn::os::DestroyThread(&m_Thread);
+
+    uint8_t header[AudioDsp::WavHeaderSize];
+    const int64_t dataSize = m_WrittenFrameCount.load(std::memory_order_relaxed) * static_cast<int64_t>(m_Ring.GetFrameSize());
+    AudioDsp::MakeWavHeader(header, m_SampleRate, m_ChannelCount, static_cast<uint32_t>(dataSize));
+    nn::Result result = nn::fs::WriteFile(m_FileHandle, 0, header, sizeof(header), nn::fs::WriteOption::MakeValue(0));
+    NN_ABORT_UNLESS_RESULT_SUCCESS(result);
+    result = nn::fs::FlushFile(m_FileHandle);
+    NN_ABORT_UNLESS_RESULT_SUCCESS(result);
+    nn::fs::CloseFile(m_FileHandle);
+}
+
+void AudioCaptureWriter::Push(const int32_t* frame) NN_NOEXCEPT
+{
+    m_PushingCount.fetch_add(1, std::memory_order_seq_cst);
+    if (m_IsCapturing.load(std::memory_order_seq_cst))
+    {
+        m_Ring.PushPlanar(frame);
+        nn::os::SignalEvent(&m_Event);
+    }
+    m_PushingCount.fetch_sub(1, std::memory_order_release);
+}
+
+void AudioCaptureWriter::ThreadFunction(void* arg) NN_NOEXCEPT
+{
+    static_cast<AudioCaptureWriter*>(arg)->ThreadMain();
+}
+
+void AudioCaptureWriter::ThreadMain() NN_NOEXCEPT
+{
+    for (;;)
+    {
+        // The quit request is read before the ring, so every frame pushed before it is written on this pass.
+        const bool isQuitRequested = m_IsQuitRequested.load(std::memory_order_acquire);
+        const int16_t* pFrames;
+        int frameCount;
+        while ((frameCount = m_Ring.Peek(&pFrames)) > 0)
+        {
+            const std::size_t size = m_Ring.GetFrameSize() * frameCount;
+            nn::Result result = nn::fs::WriteFile(m_FileHandle, m_WriteOffset, pFrames, size, nn::fs::WriteOption::MakeValue(0));
+            NN_ABORT_UNLESS_RESULT_SUCCESS(result);
+            m_WriteOffset += size;
+            m_Ring.Pop(frameCount);
+            m_WrittenFrameCount.fetch_add(frameCount, std::memory_order_relaxed);
+        }
+        if (isQuitRequested)
+        {
+            break;
+        }
+        // The event is signaled after every push, so a frame pushed after the ring was found empty still wakes the wait.
+        nn::os::WaitEvent(&m_Event);
+    }
+}
@@ -0,0 +1,97 @@
+#pragma once
+
+/**
+* @brief
+*  Records the frames an aux tap reads to a 16-bit PCM WAV file without blocking the audio thread.
+*
+*  <tt>Push()</tt> runs on the thread that updates the engine. It only converts the frame into an
+*  <tt>AudioDsp::CaptureRing</tt> and signals an event; a writer thread appends whatever the ring holds to the file,
+*  each contiguous run of frames in one write. If the file system stalls for longer than the ring lasts, the frames
+*  that do not fit are dropped and counted, and the audio thread never waits.
+*
+*  <tt>Start()</tt> and <tt>Stop()</tt> create and finish the file, so they wait on the file system; the thread that
+*  pushes only calls them if it can afford a late frame. A capture is a debugging aid, so a file that cannot be created
+*  makes <tt>Start()</tt> fail rather than abort. <tt>Stop()</tt> waits until no push is in progress before it
+*  lets the writer drain the ring, so every frame pushed while capturing reaches the file or the dropped count.
+*/
+
+#include <atomic>
+
+#include <nn/nn_Common.h>
+#include <nn/nn_Macro.h>
+#include <nn/audio.h>
+#include <nn/fs.h>
+#include <nn/os.h>
+
+#include "AudioDspCaptureRing.h"
+
+class AudioCaptureWriter
+{
+    NN_DISALLOW_COPY(AudioCaptureWriter);
+    NN_DISALLOW_MOVE(AudioCaptureWriter);
+
+public:
+    static const std::size_t ThreadStackSize = 16 * 1024;   //!<  Stack size the writer thread needs.
+
+    AudioCaptureWriter() NN_NOEXCEPT;
+
+    //!<  Size of the ring of frameCount audio frames of channelCount channels.
+    static std::size_t GetRequiredWorkBufferSize(const nn::audio::AudioRendererParameter& parameter, int channelCount, int frameCount) NN_NOEXCEPT;
+
+    /**
+    * @brief  Prepares a writer for frames of parameter.sampleCount samples of channelCount channels.
+    *
+    *  frameCount is a power of two, the audio frames the writer may fall behind by. threadStack must be aligned to
+    *  <tt>nn::os::ThreadStackAlignment</tt>. Both buffers must stay valid until <tt>Finalize()</tt>.
+    */
+    void Initialize(const nn::audio::AudioRendererParameter& parameter, int channelCount, int frameCount,
+                    void* workBuffer, std::size_t workBufferSize, void* threadStack, std::size_t threadStackSize) NN_NOEXCEPT;
+
+    //!<  Stops a capture in progress.
+    void Finalize() NN_NOEXCEPT;
+
+    //!<  Creates the file at path, replacing any file there, and starts capturing the frames pushed from now on. Returns false, not capturing, if the file cannot be created and written.
+    bool Start(const char* path) NN_NOEXCEPT;
+
+    //!<  Writes the frames still in the ring, completes the WAV header, and closes the file. Does nothing if not capturing.
+    void Stop() NN_NOEXCEPT;
+
+    bool IsCapturing() const NN_NOEXCEPT { return m_IsCapturing.load(std::memory_order_relaxed); }
+
+    //!<  Queues a frame stored channel after channel as an aux effect sends it, if capturing. Never blocks.
+    void Push(const int32_t* frame) NN_NOEXCEPT;
+
+    // Statistics of the current or last capture. Safe from any thread.
+
+    int64_t GetWrittenFrameCount() const NN_NOEXCEPT { return m_WrittenFrameCount.load(std::memory_order_relaxed); }
+    uint32_t GetDroppedFrameCount() const NN_NOEXCEPT { return m_Ring.GetDroppedFrameCount(); }
+
+    //!<  Most frames that were waiting for the writer at once.
+    int GetPeakFrameCount() const NN_NOEXCEPT { return m_Ring.GetPeakFrameCount(); }
+
+private:
+    static void ThreadFunction(void* arg) NN_NOEXCEPT;
+
+    void ThreadMain() NN_NOEXCEPT;
+
+    void* m_pRingBuffer;
+    std::size_t m_RingBufferSize;
+    void* m_pThreadStack;
+    std::size_t m_ThreadStackSize;
+    int m_FrameSampleCount;
+    int m_SampleRate;
+    int m_ChannelCount;
+    int m_FrameCount;
+    AudioDsp::CaptureRing m_Ring;
+
+    nn::fs::FileHandle m_FileHandle;
+    int64_t m_WriteOffset;                          //!<  Owned by the writer thread while capturing.
+
+    nn::os::ThreadType m_Thread;
+    nn::os::EventType m_Event;                      //!<  Signaled after each push and to stop; the writer waits on it.
+    std::atomic<bool> m_IsCapturing;
+    std::atomic<int> m_PushingCount;                //!<  Pushes in progress, for Stop() to wait out.
+    std::atomic<bool> m_IsQuitRequested;
+    std::atomic<int64_t> m_WrittenFrameCount;
+    bool m_IsInitialized;
+};
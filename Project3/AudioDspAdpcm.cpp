@@ -0,0 +1,242 @@
+#include "AudioDspAdpcm.h"
+
+#include <cstring>
+
+#include "AudioDspSimd.h"
+
+namespace AudioDsp {
+
+namespace {
+
+uint32_t ReadU32(const uint8_t* p)
+{
+    return p[0] | (p[1] << 8) | (p[2] << 16) | (static_cast<uint32_t>(p[3]) << 24);
+}
+
+uint16_t ReadU16(const uint8_t* p)
+{
+    return static_cast<uint16_t>(p[0] | (p[1] << 8));
+}
+
+void WriteU32(uint8_t* p, uint32_t value)
+{
+    p[0] = static_cast<uint8_t>(value);
+    p[1] = static_cast<uint8_t>(value >> 8);
+    p[2] = static_cast<uint8_t>(value >> 16);
+    p[3] = static_cast<uint8_t>(value >> 24);
+}
+
+void WriteU16(uint8_t* p, uint16_t value)
+{
+    p[0] = static_cast<uint8_t>(value);
+    p[1] = static_cast<uint8_t>(value >> 8);
+}
+
+int NibbleToSample(uint32_t nibble)
+{
+    // Every frame starts with two header nibbles.
+    const uint32_t indexInFrame = nibble % 16;
+    return static_cast<int>(nibble / 16 * AdpcmFrameSampleCount + (indexInFrame < 2 ? 0 : indexInFrame - 2));
+}
+
+uint32_t SampleToNibble(int sample)
+{
+    return static_cast<uint32_t>(sample / AdpcmFrameSampleCount * 16 + 2 + sample % AdpcmFrameSampleCount);
+}
+
+int16_t ClampInt16(int32_t value)
+{
+    return static_cast<int16_t>(value < -32768 ? -32768 : (value > 32767 ? 32767 : value));
+}
+
+/**
+* @brief  Expands the 16 nibbles of one 8-byte frame to <tt>nibble * (1 << shift)</tt>.
+*
+*  pOut[0] and pOut[1] hold the header byte and are ignored; pOut[2 + i] belongs to sample i.
+*/
+void ExpandFrame(int32_t* pOut, const uint8_t* pFrame, int shift)
+{
+#if defined(AUDIODSP_SIMD_NEON)
+    const int8x8_t bytes = vreinterpret_s8_u8(vld1_u8(pFrame));
+    const int8x8_t high = vshr_n_s8(bytes, 4);
+    const int8x8_t low = vshr_n_s8(vshl_n_s8(bytes, 4), 4);
+    const int8x8x2_t nibbles = vzip_s8(high, low);
+    const int16x8_t first = vmovl_s8(nibbles.val[0]);
+    const int16x8_t second = vmovl_s8(nibbles.val[1]);
+    const int32x4_t shiftVector = vdupq_n_s32(shift);
+    vst1q_s32(pOut + 0, vshlq_s32(vmovl_s16(vget_low_s16(first)), shiftVector));
+    vst1q_s32(pOut + 4, vshlq_s32(vmovl_s16(vget_high_s16(first)), shiftVector));
+    vst1q_s32(pOut + 8, vshlq_s32(vmovl_s16(vget_low_s16(second)), shiftVector));
+    vst1q_s32(pOut + 12, vshlq_s32(vmovl_s16(vget_high_s16(second)), shiftVector));
+#elif defined(AUDIODSP_SIMD_SSE2)
+    // Duplicate each byte into a 16-bit lane so arithmetic shifts can sign-extend either nibble.
+    const __m128i bytes = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(pFrame));
+    const __m128i words = _mm_unpacklo_epi8(bytes, bytes);
+    const __m128i high = _mm_srai_epi16(words, 12);
+    const __m128i low = _mm_srai_epi16(_mm_slli_epi16(words, 12), 12);
+    const __m128i first = _mm_unpacklo_epi16(high, low);
+    const __m128i second = _mm_unpackhi_epi16(high, low);
+    const __m128i shiftCount = _mm_cvtsi32_si128(shift);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(pOut + 0), _mm_sll_epi32(_mm_srai_epi32(_mm_unpacklo_epi16(first, first), 16), shiftCount));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(pOut + 4), _mm_sll_epi32(_mm_srai_epi32(_mm_unpackhi_epi16(first, first), 16), shiftCount));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(pOut + 8), _mm_sll_epi32(_mm_srai_epi32(_mm_unpacklo_epi16(second, second), 16), shiftCount));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(pOut + 12), _mm_sll_epi32(_mm_srai_epi32(_mm_unpackhi_epi16(second, second), 16), shiftCount));
+#else
+    const int32_t scale = static_cast<int32_t>(1) << shift;
+    for (int i = 0; i < AdpcmFrameSize; ++i)
+    {
+        const int32_t high = pFrame[i] >> 4;
+        const int32_t low = pFrame[i] & 0xf;
+        pOut[i * 2] = (high >= 8 ? high - 16 : high) * scale;
+        pOut[i * 2 + 1] = (low >= 8 ? low - 16 : low) * scale;
+    }
+#endif
+}
+
+}  // namespace
+
+bool ParseAdpcmHeader(AdpcmHeaderInfo* pOutInfo, const void* header, std::size_t headerSize)
+{
+    if (headerSize < AdpcmHeaderSize)
+    {
+        return false;
+    }
+    const uint8_t* p = static_cast<const uint8_t*>(header);
+    pOutInfo->sampleCount = static_cast<int>(ReadU32(p + 0x00));
+    pOutInfo->sampleRate = static_cast<int>(ReadU32(p + 0x08));
+    pOutInfo->loop = ReadU16(p + 0x0c) != 0;
+    pOutInfo->loopStartSampleOffset = NibbleToSample(ReadU32(p + 0x10));
+    // The header stores the nibble address of the last sample in the loop.
+    pOutInfo->loopEndSampleOffset = NibbleToSample(ReadU32(p + 0x14)) + 1;
+    for (int i = 0; i < 16; ++i)
+    {
+        pOutInfo->parameter.coefficients[i] = ReadU16(p + 0x1c + i * 2);
+    }
+    pOutInfo->context.predScale = ReadU16(p + 0x3e);
+    pOutInfo->context.history[0] = static_cast<int16_t>(ReadU16(p + 0x40));
+    pOutInfo->context.history[1] = static_cast<int16_t>(ReadU16(p + 0x42));
+    pOutInfo->loopContext.predScale = ReadU16(p + 0x44);
+    pOutInfo->loopContext.history[0] = static_cast<int16_t>(ReadU16(p + 0x46));
+    pOutInfo->loopContext.history[1] = static_cast<int16_t>(ReadU16(p + 0x48));
+    return pOutInfo->sampleRate > 0 && pOutInfo->sampleCount >= 0;
+}
+
+bool WriteAdpcmHeader(void* header, std::size_t headerSize, const AdpcmHeaderInfo& info)
+{
+    if (headerSize < AdpcmHeaderSize)
+    {
+        return false;
+    }
+    uint8_t* p = static_cast<uint8_t*>(header);
+    std::memset(p, 0, AdpcmHeaderSize);
+    WriteU32(p + 0x00, static_cast<uint32_t>(info.sampleCount));
+    // Nibbles up to the end of the last sample, counting the header nibbles of every frame.
+    WriteU32(p + 0x04, info.sampleCount > 0 ? SampleToNibble(info.sampleCount - 1) + 1 : 0);
+    WriteU32(p + 0x08, static_cast<uint32_t>(info.sampleRate));
+    WriteU16(p + 0x0c, info.loop ? 1 : 0);
+    WriteU32(p + 0x10, SampleToNibble(info.loop ? info.loopStartSampleOffset : 0));
+    WriteU32(p + 0x14, SampleToNibble((info.loop ? info.loopEndSampleOffset : info.sampleCount) - 1));
+    WriteU32(p + 0x18, SampleToNibble(0));
+    for (int i = 0; i < 16; ++i)
+    {
+        WriteU16(p + 0x1c + i * 2, info.parameter.coefficients[i]);
+    }
+    WriteU16(p + 0x3e, info.context.predScale);
+    WriteU16(p + 0x40, static_cast<uint16_t>(info.context.history[0]));
+    WriteU16(p + 0x42, static_cast<uint16_t>(info.context.history[1]));
+    WriteU16(p + 0x44, info.loopContext.predScale);
+    WriteU16(p + 0x46, static_cast<uint16_t>(info.loopContext.history[0]));
+    WriteU16(p + 0x48, static_cast<uint16_t>(info.loopContext.history[1]));
+    return true;
+}
+
+void DecodeAdpcm(int16_t* pOut, const void* data, std::size_t dataSize, int32_t startSampleOffset, int sampleCount,
+                 const AdpcmParameter& parameter, AdpcmContext* pContext)
+{
+    const uint8_t* pData = static_cast<const uint8_t*>(data);
+    int32_t history0 = pContext->history[0];
+    int32_t history1 = pContext->history[1];
+    uint8_t predScale = static_cast<uint8_t>(pContext->predScale);
+
+    int32_t frame = startSampleOffset / AdpcmFrameSampleCount;
+    int indexInFrame = startSampleOffset % AdpcmFrameSampleCount;
+    int remaining = sampleCount;
+    while (remaining > 0)
+    {
+        const std::size_t frameOffset = static_cast<std::size_t>(frame) * AdpcmFrameSize;
+        const uint8_t* pFrame = pData + frameOffset;
+        uint8_t partialFrame[AdpcmFrameSize] = {};
+        if (frameOffset + AdpcmFrameSize > dataSize)
+        {
+            // Never read past the end of the caller's buffer.
+            if (frameOffset < dataSize)
+            {
+                std::memcpy(partialFrame, pFrame, dataSize - frameOffset);
+            }
+            pFrame = partialFrame;
+        }
+
+        predScale = pFrame[0];
+        const int predictor = (predScale >> 4) & 0x7;
+        const int32_t coef0 = static_cast<int16_t>(parameter.coefficients[predictor * 2]);
+        const int32_t coef1 = static_cast<int16_t>(parameter.coefficients[predictor * 2 + 1]);
+
+        int32_t expanded[16];
+        ExpandFrame(expanded, pFrame, (predScale & 0xf) + 11);
+
+        // The predictor recurrence is serial; everything per-frame above is hoisted out of it.
+        const int count = AdpcmFrameSampleCount - indexInFrame < remaining ? AdpcmFrameSampleCount - indexInFrame : remaining;
+        const int32_t* pExpanded = expanded + 2 + indexInFrame;
+        for (int i = 0; i < count; ++i)
+        {
+            const int32_t sample = ClampInt16((pExpanded[i] + 1024 + coef0 * history0 + coef1 * history1) >> 11);
+            history1 = history0;
+            history0 = sample;
+            pOut[i] = static_cast<int16_t>(sample);
+        }
+
+        pOut += count;
+        remaining -= count;
+        indexInFrame = 0;
+        ++frame;
+    }
+
+    pContext->predScale = predScale;
+    pContext->history[0] = static_cast<int16_t>(history0);
+    pContext->history[1] = static_cast<int16_t>(history1);
+}
+
+void ResetAdpcmCursor(AdpcmCursor* pCursor, const AdpcmHeaderInfo& info)
+{
+    pCursor->sampleOffset = 0;
+    pCursor->context = info.context;
+}
+
+int DecodeAdpcmWithLoop(int16_t* pOut, int sampleCount, const void* data, std::size_t dataSize,
+                        const AdpcmHeaderInfo& info, AdpcmCursor* pCursor)
+{
+    const bool isLooping = info.loop && info.loopStartSampleOffset < info.loopEndSampleOffset;
+    const int32_t endOffset = isLooping ? info.loopEndSampleOffset : info.sampleCount;
+    int written = 0;
+    while (written < sampleCount)
+    {
+        if (pCursor->sampleOffset >= endOffset)
+        {
+            if (!isLooping)
+            {
+                std::memset(pOut + written, 0, sizeof(int16_t) * (sampleCount - written));
+                break;
+            }
+            pCursor->sampleOffset = info.loopStartSampleOffset;
+            pCursor->context = info.loopContext;
+        }
+        const int32_t available = endOffset - pCursor->sampleOffset;
+        const int count = available < sampleCount - written ? static_cast<int>(available) : sampleCount - written;
+        DecodeAdpcm(pOut + written, data, dataSize, pCursor->sampleOffset, count, info.parameter, &pCursor->context);
+        pCursor->sampleOffset += count;
+        written += count;
+    }
+    return written;
+}
+
+}  // namespace AudioDsp
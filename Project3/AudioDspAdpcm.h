@@ -0,0 +1,88 @@
+#pragma once
+
+/**
+* @brief
+*  DSP-ADPCM header parsing and decoding, bit-exact with <tt>SampleFormat_Adpcm</tt> playback.
+*
+*  The types have the same layout as their <tt>nn::audio</tt> counterparts, so a header parsed here
+*  can be handed to the renderer and vice versa.
+*/
+
+#include <cstddef>
+#include <cstdint>
+
+namespace AudioDsp {
+
+const std::size_t AdpcmHeaderSize = 96;
+const int AdpcmFrameSize = 8;           //!<  Bytes per frame (1 predictor/scale byte + 7 data bytes).
+const int AdpcmFrameSampleCount = 14;   //!<  Samples per frame.
+
+struct AdpcmParameter
+{
+    uint16_t coefficients[16];          //!<  Eight predictor pairs, signed Q11 stored as uint16.
+};
+
+struct AdpcmContext
+{
+    uint16_t predScale;                 //!<  Predictor/scale byte of the frame the state belongs to.
+    int16_t  history[2];                //!<  Last two decoded samples, newest first.
+};
+
+struct AdpcmHeaderInfo
+{
+    AdpcmParameter parameter;
+    AdpcmContext   context;             //!<  Decoder state at sample 0.
+    AdpcmContext   loopContext;         //!<  Decoder state at loopStartSampleOffset.
+    int            sampleCount;
+    int            sampleRate;
+    bool           loop;
+    int            loopStartSampleOffset;
+    int            loopEndSampleOffset; //!<  Exclusive.
+};
+
+//!<  Position and decoder state for DecodeAdpcmWithLoop().
+struct AdpcmCursor
+{
+    int32_t      sampleOffset;
+    AdpcmContext context;
+};
+
+//!<  Parses the 96-byte little-endian header written by the SDK converter.
+bool ParseAdpcmHeader(AdpcmHeaderInfo* pOutInfo, const void* header, std::size_t headerSize);
+
+//!<  Writes info as the 96-byte header <tt>ParseAdpcmHeader()</tt> reads. Returns false if headerSize is too small.
+bool WriteAdpcmHeader(void* header, std::size_t headerSize, const AdpcmHeaderInfo& info);
+
+//!<  Bytes of frame data needed for sampleCount samples.
+inline std::size_t GetAdpcmDataSize(int sampleCount)
+{
+    const int frameCount = sampleCount / AdpcmFrameSampleCount;
+    const int remainder = sampleCount % AdpcmFrameSampleCount;
+    return static_cast<std::size_t>(frameCount) * AdpcmFrameSize + (remainder > 0 ? 1 + (remainder + 1) / 2 : 0);
+}
+
+/**
+* @brief  Decodes sampleCount samples starting at startSampleOffset.
+*
+*  pContext must hold the history at startSampleOffset and receives the state after the last decoded sample.
+*  Whole frames are expanded with SIMD and only the predictor recurrence runs per sample.
+*  Bytes beyond dataSize decode as zero nibbles, so a truncated last frame is safe.
+*/
+void DecodeAdpcm(int16_t* pOut, const void* data, std::size_t dataSize, int32_t startSampleOffset, int sampleCount,
+                 const AdpcmParameter& parameter, AdpcmContext* pContext);
+
+/**
+* @brief  Decodes the next sampleCount samples of a sound described by info, as the renderer plays it.
+*
+*  On reaching the loop end of a looping sound the cursor jumps to the loop start and takes the loop context.
+*  A non-looping sound is zero-filled past its end.
+*
+* @return  Number of samples decoded before the end of a non-looping sound (sampleCount while playing).
+*/
+int DecodeAdpcmWithLoop(int16_t* pOut, int sampleCount, const void* data, std::size_t dataSize,
+                        const AdpcmHeaderInfo& info, AdpcmCursor* pCursor);
+
+//!<  Resets a cursor to the start of the sound.
+void ResetAdpcmCursor(AdpcmCursor* pCursor, const AdpcmHeaderInfo& info);
+
+}  // namespace AudioDsp
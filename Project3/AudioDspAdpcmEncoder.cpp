@@ -0,0 +1,335 @@
+#include "AudioDspAdpcmEncoder.h"
+
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+namespace AudioDsp {
+
+namespace {
+
+const int PredictorCount = 8;
+const int ScaleMax = 12;
+const int ClusterIterationCountMax = 16;
+
+// Sums over the samples of a frame, with x0 the sample and x1, x2 the two before it, from which the squared error of
+// any predictor pair a follows as e00 - 2 a.c + a.C.a.
+struct FrameStatistics
+{
+    double e00;                 //!<  Sum of x0 * x0.
+    double c[2];                //!<  Sums of x0 * x1 and x0 * x2.
+    double m[3];                //!<  Sums of x1 * x1, x1 * x2, and x2 * x2.
+};
+
+struct Predictor
+{
+    double a[2];
+};
+
+void Accumulate(FrameStatistics* pSum, const FrameStatistics& statistics)
+{
+    pSum->e00 += statistics.e00;
+    pSum->c[0] += statistics.c[0];
+    pSum->c[1] += statistics.c[1];
+    pSum->m[0] += statistics.m[0];
+    pSum->m[1] += statistics.m[1];
+    pSum->m[2] += statistics.m[2];
+}
+
+double GetPredictionError(const FrameStatistics& statistics, const Predictor& predictor)
+{
+    const double a0 = predictor.a[0];
+    const double a1 = predictor.a[1];
+    return statistics.e00 - 2.0 * (a0 * statistics.c[0] + a1 * statistics.c[1])
+         + a0 * a0 * statistics.m[0] + 2.0 * a0 * a1 * statistics.m[1] + a1 * a1 * statistics.m[2];
+}
+
+// Least-squares predictor of statistics. The small ridge keeps it finite for silence and for pure tones, whose
+// normal equations are singular.
+Predictor SolvePredictor(const FrameStatistics& statistics)
+{
+    const double ridge = 1.0e-6 * (statistics.m[0] + statistics.m[2]) + 1.0e-9;
+    const double m0 = statistics.m[0] + ridge;
+    const double m2 = statistics.m[2] + ridge;
+    const double determinant = m0 * m2 - statistics.m[1] * statistics.m[1];
+    Predictor predictor;
+    predictor.a[0] = (statistics.c[0] * m2 - statistics.c[1] * statistics.m[1]) / determinant;
+    predictor.a[1] = (statistics.c[1] * m0 - statistics.c[0] * statistics.m[1]) / determinant;
+    return predictor;
+}
+
+int FindNearestPredictor(const FrameStatistics& statistics, const Predictor* predictors, int predictorCount)
+{
+    int nearest = 0;
+    double nearestError = GetPredictionError(statistics, predictors[0]);
+    for (int k = 1; k < predictorCount; ++k)
+    {
+        const double error = GetPredictionError(statistics, predictors[k]);
+        if (error < nearestError)
+        {
+            nearest = k;
+            nearestError = error;
+        }
+    }
+    return nearest;
+}
+
+// Lloyd iterations: every frame goes to the predictor with the least error on it, and every predictor becomes the
+// least-squares predictor of its frames. Neither step can raise the total error.
+void RefinePredictors(Predictor* predictors, int predictorCount, const std::vector<FrameStatistics>& frames)
+{
+    std::vector<int> assignments(frames.size(), -1);
+    for (int iteration = 0; iteration < ClusterIterationCountMax; ++iteration)
+    {
+        bool isChanged = false;
+        FrameStatistics sums[PredictorCount];
+        std::memset(sums, 0, sizeof(sums));
+        int counts[PredictorCount] = {};
+        for (std::size_t f = 0; f < frames.size(); ++f)
+        {
+            const int nearest = FindNearestPredictor(frames[f], predictors, predictorCount);
+            isChanged = isChanged || nearest != assignments[f];
+            assignments[f] = nearest;
+            Accumulate(&sums[nearest], frames[f]);
+            ++counts[nearest];
+        }
+        if (!isChanged)
+        {
+            break;
+        }
+
+        for (int k = 0; k < predictorCount; ++k)
+        {
+            if (counts[k] > 0)
+            {
+                predictors[k] = SolvePredictor(sums[k]);
+                continue;
+            }
+            // An empty cluster takes the frame the current predictors fit worst.
+            std::size_t worst = 0;
+            double worstError = -1.0;
+            for (std::size_t f = 0; f < frames.size(); ++f)
+            {
+                const double error = GetPredictionError(frames[f], predictors[assignments[f]]);
+                if (error > worstError)
+                {
+                    worst = f;
+                    worstError = error;
+                }
+            }
+            predictors[k] = SolvePredictor(frames[worst]);
+        }
+    }
+}
+
+uint16_t ToCoefficient(double a)
+{
+    // Signed Q11, as the decoder reads it.
+    const double scaled = std::floor(a * 2048.0 + 0.5);
+    const int32_t value = scaled < -32768.0 ? -32768 : (scaled > 32767.0 ? 32767 : static_cast<int32_t>(scaled));
+    return static_cast<uint16_t>(static_cast<int16_t>(value));
+}
+
+int16_t ClampInt16(int32_t value)
+{
+    return static_cast<int16_t>(value < -32768 ? -32768 : (value > 32767 ? 32767 : value));
+}
+
+// One frame encoded with one predictor and scale.
+struct FrameCandidate
+{
+    uint8_t predScale;
+    int8_t nibbles[AdpcmFrameSampleCount];
+    int16_t decoded[AdpcmFrameSampleCount];
+    int64_t error;
+};
+
+/**
+* @brief  Quantizes count samples of pInput with the decoder recurrence, starting from history0 and history1.
+*
+*  Each nibble is the one whose decoded sample is nearest the input, given the samples decoded before it.
+*/
+void EncodeFrameCandidate(FrameCandidate* pOut, const int32_t* pInput, int count, int32_t coef0, int32_t coef1, int scale,
+                          int32_t history0, int32_t history1)
+{
+    const int32_t step = static_cast<int32_t>(1) << scale;
+    pOut->error = 0;
+    for (int i = 0; i < AdpcmFrameSampleCount; ++i)
+    {
+        if (i >= count)
+        {
+            pOut->nibbles[i] = 0;
+            pOut->decoded[i] = 0;
+            continue;
+        }
+        const int32_t prediction = coef0 * history0 + coef1 * history1 + 1024;
+        // Nearest nibble to the residual after the prediction, rounded as the decoder does.
+        const int32_t residual = pInput[i] - (prediction >> 11);
+        int32_t nibble = (residual + (step >> 1)) >> scale;
+        nibble = nibble < -8 ? -8 : (nibble > 7 ? 7 : nibble);
+        const int32_t sample = ClampInt16((nibble * (static_cast<int32_t>(1) << (scale + 11)) + prediction) >> 11);
+        const int64_t difference = pInput[i] - sample;
+        pOut->error += difference * difference;
+        pOut->nibbles[i] = static_cast<int8_t>(nibble);
+        pOut->decoded[i] = static_cast<int16_t>(sample);
+        history1 = history0;
+        history0 = sample;
+    }
+}
+
+}  // namespace
+
+void DesignAdpcmParameter(AdpcmParameter* pOutParameter, const int16_t* pSamples, int sampleCount, int stride)
+{
+    // Statistics of every frame that has a signal; silent frames fit any predictor equally.
+    std::vector<FrameStatistics> frames;
+    frames.reserve(sampleCount / AdpcmFrameSampleCount + 1);
+    FrameStatistics total;
+    std::memset(&total, 0, sizeof(total));
+    for (int start = 0; start < sampleCount; start += AdpcmFrameSampleCount)
+    {
+        FrameStatistics statistics;
+        std::memset(&statistics, 0, sizeof(statistics));
+        const int end = start + AdpcmFrameSampleCount < sampleCount ? start + AdpcmFrameSampleCount : sampleCount;
+        for (int n = start; n < end; ++n)
+        {
+            const double x0 = pSamples[static_cast<std::size_t>(n) * stride];
+            const double x1 = n >= 1 ? pSamples[static_cast<std::size_t>(n - 1) * stride] : 0.0;
+            const double x2 = n >= 2 ? pSamples[static_cast<std::size_t>(n - 2) * stride] : 0.0;
+            statistics.e00 += x0 * x0;
+            statistics.c[0] += x0 * x1;
+            statistics.c[1] += x0 * x2;
+            statistics.m[0] += x1 * x1;
+            statistics.m[1] += x1 * x2;
+            statistics.m[2] += x2 * x2;
+        }
+        if (statistics.e00 > 0.0)
+        {
+            frames.push_back(statistics);
+            Accumulate(&total, statistics);
+        }
+    }
+
+    // Split every predictor in two and refine, from the one predictor of the whole sound up to eight.
+    Predictor predictors[PredictorCount];
+    predictors[0] = SolvePredictor(total);
+    int predictorCount = 1;
+    while (!frames.empty() && predictorCount < PredictorCount)
+    {
+        for (int k = 0; k < predictorCount; ++k)
+        {
+            predictors[predictorCount + k] = predictors[k];
+            predictors[predictorCount + k].a[0] += 0.01;
+            predictors[predictorCount + k].a[1] += 0.01;
+            predictors[k].a[0] -= 0.01;
+            predictors[k].a[1] -= 0.01;
+        }
+        predictorCount *= 2;
+        RefinePredictors(predictors, predictorCount, frames);
+    }
+    for (int k = predictorCount; k < PredictorCount; ++k)
+    {
+        predictors[k] = predictors[0];
+    }
+
+    for (int k = 0; k < PredictorCount; ++k)
+    {
+        pOutParameter->coefficients[k * 2] = ToCoefficient(predictors[k].a[0]);
+        pOutParameter->coefficients[k * 2 + 1] = ToCoefficient(predictors[k].a[1]);
+    }
+}
+
+bool EncodeAdpcm(void* data, std::size_t dataSize, AdpcmHeaderInfo* pInfo, const int16_t* pSamples, int stride)
+{
+    const int sampleCount = pInfo->sampleCount;
+    if (sampleCount < 0 || dataSize < GetAdpcmDataSize(sampleCount))
+    {
+        return false;
+    }
+    if (pInfo->loop && !(pInfo->loopStartSampleOffset >= 0 && pInfo->loopStartSampleOffset < pInfo->loopEndSampleOffset
+                         && pInfo->loopEndSampleOffset <= sampleCount))
+    {
+        return false;
+    }
+
+    DesignAdpcmParameter(&pInfo->parameter, pSamples, sampleCount, stride);
+    std::memset(&pInfo->context, 0, sizeof(pInfo->context));
+    std::memset(&pInfo->loopContext, 0, sizeof(pInfo->loopContext));
+
+    uint8_t* pData = static_cast<uint8_t*>(data);
+    int32_t history0 = 0;
+    int32_t history1 = 0;
+    for (int start = 0; start < sampleCount; start += AdpcmFrameSampleCount)
+    {
+        const int count = sampleCount - start < AdpcmFrameSampleCount ? sampleCount - start : AdpcmFrameSampleCount;
+        int32_t input[AdpcmFrameSampleCount];
+        for (int i = 0; i < count; ++i)
+        {
+            input[i] = pSamples[static_cast<std::size_t>(start + i) * stride];
+        }
+
+        // Try every predictor at the scale its residual needs and the ones on either side, keeping the least error.
+        FrameCandidate best;
+        best.error = -1;
+        for (int predictor = 0; predictor < PredictorCount; ++predictor)
+        {
+            const int32_t coef0 = static_cast<int16_t>(pInfo->parameter.coefficients[predictor * 2]);
+            const int32_t coef1 = static_cast<int16_t>(pInfo->parameter.coefficients[predictor * 2 + 1]);
+            int32_t residualMax = 0;
+            int32_t previous0 = history0;
+            int32_t previous1 = history1;
+            for (int i = 0; i < count; ++i)
+            {
+                const int32_t residual = input[i] - ((coef0 * previous0 + coef1 * previous1 + 1024) >> 11);
+                residualMax = residual > residualMax ? residual : (-residual > residualMax ? -residual : residualMax);
+                previous1 = previous0;
+                previous0 = input[i];
+            }
+            int scale = 0;
+            while (scale < ScaleMax && residualMax > (7 << scale))
+            {
+                ++scale;
+            }
+            for (int s = scale > 0 ? scale - 1 : 0; s <= scale + 1 && s <= ScaleMax; ++s)
+            {
+                FrameCandidate candidate;
+                EncodeFrameCandidate(&candidate, input, count, coef0, coef1, s, history0, history1);
+                if (best.error < 0 || candidate.error < best.error)
+                {
+                    best = candidate;
+                    best.predScale = static_cast<uint8_t>((predictor << 4) | s);
+                }
+            }
+        }
+
+        // The decoder state where the loop starts: the header byte of its frame and the two samples decoded before it.
+        const int loopStart = pInfo->loopStartSampleOffset;
+        if (pInfo->loop && loopStart >= start && loopStart < start + AdpcmFrameSampleCount)
+        {
+            const int index = loopStart - start;
+            pInfo->loopContext.predScale = best.predScale;
+            pInfo->loopContext.history[0] = static_cast<int16_t>(index >= 1 ? best.decoded[index - 1] : history0);
+            pInfo->loopContext.history[1] = static_cast<int16_t>(index >= 2 ? best.decoded[index - 2] : (index == 1 ? history0 : history1));
+        }
+        if (start == 0)
+        {
+            pInfo->context.predScale = best.predScale;
+        }
+
+        // Only the bytes GetAdpcmDataSize() counts for a short last frame.
+        uint8_t frame[AdpcmFrameSize];
+        frame[0] = best.predScale;
+        for (int i = 0; i < AdpcmFrameSampleCount; i += 2)
+        {
+            frame[1 + i / 2] = static_cast<uint8_t>(((best.nibbles[i] & 0xf) << 4) | (best.nibbles[i + 1] & 0xf));
+        }
+        const std::size_t frameOffset = static_cast<std::size_t>(start / AdpcmFrameSampleCount) * AdpcmFrameSize;
+        std::memcpy(pData + frameOffset, frame, GetAdpcmDataSize(start + count) - frameOffset);
+
+        history1 = count >= 2 ? best.decoded[count - 2] : history0;
+        history0 = best.decoded[count - 1];
+    }
+    return true;
+}
+
+}  // namespace AudioDsp
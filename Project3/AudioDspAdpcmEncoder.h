@@ -0,0 +1,36 @@
+#pragma once
+
+/**
+* @brief
+*  DSP-ADPCM encoder producing data that <tt>DecodeAdpcm()</tt> and <tt>SampleFormat_Adpcm</tt> voices play.
+*
+*  The eight predictor pairs are designed per sound. Each 14-sample frame gets the second-order predictor that
+*  minimizes its prediction error, and the pairs are the eight centroids of those frames under that same error, found
+*  by splitting and refining clusters (the LBG algorithm). Each frame is then encoded with every pair at the scales
+*  around the one its residual needs, running the decoder recurrence on the quantized samples, and the combination
+*  with the least squared error against the input is kept. The output is four bits per sample plus one byte per frame,
+*  3.5 times smaller than 16-bit PCM.
+*/
+
+#include <cstddef>
+#include <cstdint>
+
+#include "AudioDspAdpcm.h"
+
+namespace AudioDsp {
+
+//!<  Designs the eight predictor pairs for sampleCount samples, taken every stride samples from pSamples.
+void DesignAdpcmParameter(AdpcmParameter* pOutParameter, const int16_t* pSamples, int sampleCount, int stride);
+
+/**
+* @brief  Encodes the sound described by pInfo, taking its samples every stride samples from pSamples.
+*
+*  pInfo supplies sampleCount, sampleRate, and the loop; the parameter is designed with <tt>DesignAdpcmParameter()</tt>
+*  and the context and loop context are filled in, so pInfo can be written with <tt>WriteAdpcmHeader()</tt>.
+*  data receives <tt>GetAdpcmDataSize(sampleCount)</tt> bytes.
+*
+* @return  False if dataSize is too small or the loop lies outside the sound.
+*/
+bool EncodeAdpcm(void* data, std::size_t dataSize, AdpcmHeaderInfo* pInfo, const int16_t* pSamples, int stride);
+
+}  // namespace AudioDsp
@@ -0,0 +1,207 @@
+#include "AudioDspBank.h"
+
+#include <cstring>
+
+namespace AudioDsp {
+
+namespace {
+
+static_assert(sizeof(BankHeader) == 32, "The bank header is part of the file format");
+static_assert(sizeof(AdpcmHeaderInfo) == 64, "The entries embed AdpcmHeaderInfo in its nn::audio layout");
+static_assert(sizeof(BankEntry) == 128, "The bank entry is part of the file format");
+
+bool IsPowerOfTwo(std::size_t value)
+{
+    return value != 0 && (value & (value - 1)) == 0;
+}
+
+std::size_t AlignUp(std::size_t value, std::size_t alignment)
+{
+    return (value + alignment - 1) & ~(alignment - 1);
+}
+
+BankResult ValidateEntry(const BankEntry& entry, std::size_t tableEnd, std::size_t fileSize, std::size_t alignment)
+{
+    if (std::memchr(entry.name, '\0', sizeof(entry.name)) == nullptr || entry.nameHash != HashBankName(entry.name))
+    {
+        return BankResult_BadEntry;
+    }
+    if (entry.dataOffset % alignment != 0)
+    {
+        return BankResult_BadAlignment;
+    }
+    if (entry.dataOffset < tableEnd || static_cast<uint64_t>(entry.dataOffset) + entry.dataSize > fileSize || entry.info.sampleCount < 0)
+    {
+        return BankResult_BadEntry;
+    }
+
+    std::size_t requiredSize;
+    switch (entry.sampleFormat)
+    {
+    case BankSampleFormat_PcmInt16:
+        if (entry.channelCount == 0)
+        {
+            return BankResult_BadEntry;
+        }
+        requiredSize = static_cast<std::size_t>(entry.info.sampleCount) * entry.channelCount * sizeof(int16_t);
+        break;
+    case BankSampleFormat_Adpcm:
+        if (entry.channelCount != 1)
+        {
+            return BankResult_BadEntry;
+        }
+        requiredSize = GetAdpcmDataSize(entry.info.sampleCount);
+        break;
+    default:
+        return BankResult_BadEntry;
+    }
+    return entry.dataSize >= requiredSize ? BankResult_Success : BankResult_BadEntry;
+}
+
+}
+
+uint32_t HashBankName(const char* name)
+{
+    uint32_t hash = 2166136261u;
+    for (const char* p = name; *p != '\0'; ++p)
+    {
+        hash = (hash ^ static_cast<uint8_t>(*p)) * 16777619u;
+    }
+    return hash;
+}
+
+BankResult ValidateBank(const void* bank, std::size_t size)
+{
+    if (size < sizeof(BankHeader))
+    {
+        return BankResult_TooSmall;
+    }
+    const BankHeader* pHeader = GetBankHeader(bank);
+    if (pHeader->signature != BankSignature)
+    {
+        return BankResult_NotBank;
+    }
+    if (pHeader->version != BankVersion)
+    {
+        return BankResult_UnsupportedVersion;
+    }
+    if (!IsPowerOfTwo(pHeader->alignment) || pHeader->alignment < sizeof(uint32_t))
+    {
+        return BankResult_BadAlignment;
+    }
+    const std::size_t tableEnd = sizeof(BankHeader) + sizeof(BankEntry) * pHeader->entryCount;
+    if (pHeader->fileSize > size || tableEnd > pHeader->fileSize)
+    {
+        return BankResult_TooSmall;
+    }
+
+    for (int i = 0; i < pHeader->entryCount; ++i)
+    {
+        const BankResult result = ValidateEntry(*GetBankEntry(bank, i), tableEnd, pHeader->fileSize, pHeader->alignment);
+        if (result != BankResult_Success)
+        {
+            return result;
+        }
+    }
+    return BankResult_Success;
+}
+
+const char* GetBankResultString(BankResult result)
+{
+    switch (result)
+    {
+    case BankResult_Success:
+        return "Success";
+    case BankResult_TooSmall:
+        return "TooSmall";
+    case BankResult_NotBank:
+        return "NotBank";
+    case BankResult_UnsupportedVersion:
+        return "UnsupportedVersion";
+    case BankResult_BadAlignment:
+        return "BadAlignment";
+    case BankResult_BadEntry:
+        return "BadEntry";
+    case BankResult_BufferTooSmall:
+        return "BufferTooSmall";
+    default:
+        return "Unknown";
+    }
+}
+
+int FindBankEntry(const void* bank, const char* name)
+{
+    const uint32_t hash = HashBankName(name);
+    const int entryCount = GetBankEntryCount(bank);
+    for (int i = 0; i < entryCount; ++i)
+    {
+        const BankEntry* pEntry = GetBankEntry(bank, i);
+        if (pEntry->nameHash == hash && std::strcmp(pEntry->name, name) == 0)
+        {
+            return i;
+        }
+    }
+    return -1;
+}
+
+BankResult BuildBank(void* buffer, std::size_t bufferSize, std::size_t* pOutSize, const BankSource* sources, int sourceCount, std::size_t alignment)
+{
+    if (!IsPowerOfTwo(alignment) || alignment < sizeof(uint32_t))
+    {
+        return BankResult_BadAlignment;
+    }
+
+    std::size_t size = sizeof(BankHeader) + sizeof(BankEntry) * sourceCount;
+    for (int i = 0; i < sourceCount; ++i)
+    {
+        size = AlignUp(size, alignment) + sources[i].dataSize;
+    }
+    *pOutSize = size;
+    if (buffer == nullptr)
+    {
+        return BankResult_Success;
+    }
+    if (bufferSize < size)
+    {
+        return BankResult_BufferTooSmall;
+    }
+
+    // Zero everything first so the padding and reserved fields are deterministic.
+    uint8_t* pBank = static_cast<uint8_t*>(buffer);
+    std::memset(pBank, 0, size);
+    BankHeader* pHeader = reinterpret_cast<BankHeader*>(pBank);
+    pHeader->signature = BankSignature;
+    pHeader->version = BankVersion;
+    pHeader->entryCount = static_cast<uint16_t>(sourceCount);
+    pHeader->alignment = static_cast<uint32_t>(alignment);
+    pHeader->fileSize = static_cast<uint32_t>(size);
+
+    std::size_t offset = sizeof(BankHeader) + sizeof(BankEntry) * sourceCount;
+    for (int i = 0; i < sourceCount; ++i)
+    {
+        const BankSource& source = sources[i];
+        BankEntry* pEntry = reinterpret_cast<BankEntry*>(pBank + sizeof(BankHeader)) + i;
+        std::strncpy(pEntry->name, source.name, BankNameLengthMax);
+        pEntry->nameHash = HashBankName(pEntry->name);
+        pEntry->sampleFormat = static_cast<uint8_t>(source.sampleFormat);
+        pEntry->channelCount = static_cast<uint8_t>(source.channelCount);
+        // Member by member, so the padding inside AdpcmHeaderInfo stays zero.
+        pEntry->info.parameter = source.info.parameter;
+        pEntry->info.context = source.info.context;
+        pEntry->info.loopContext = source.info.loopContext;
+        pEntry->info.sampleCount = source.info.sampleCount;
+        pEntry->info.sampleRate = source.info.sampleRate;
+        pEntry->info.loop = source.info.loop;
+        pEntry->info.loopStartSampleOffset = source.info.loopStartSampleOffset;
+        pEntry->info.loopEndSampleOffset = source.info.loopEndSampleOffset;
+
+        offset = AlignUp(offset, alignment);
+        pEntry->dataOffset = static_cast<uint32_t>(offset);
+        pEntry->dataSize = static_cast<uint32_t>(source.dataSize);
+        std::memcpy(pBank + offset, source.data, source.dataSize);
+        offset += source.dataSize;
+    }
+    return BankResult_Success;
+}
+
+}
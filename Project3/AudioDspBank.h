@@ -0,0 +1,125 @@
+#pragma once
+
+/**
+* @brief
+*  Sound bank format shared by the console loader and the host bank builder.
+*
+*  A bank is one file holding any number of ADPCM and 16-bit PCM sounds:
+*
+*      BankHeader | BankEntry[entryCount] | padding | payload | padding | payload ...
+*
+*  Every payload starts at a multiple of <tt>BankHeader::alignment</tt> from the start of the file, so a bank read in one
+*  piece into memory aligned to <tt>nn::audio::BufferAlignSize</tt> can be played from where it lies.
+*  The entries embed a complete <tt>AdpcmHeaderInfo</tt>, which has the layout of <tt>nn::audio::AdpcmHeaderInfo</tt>,
+*  so the renderer takes its header straight from the loaded image as well. All fields are little-endian.
+*/
+
+#include <cstddef>
+#include <cstdint>
+
+#include "AudioDspAdpcm.h"
+
+namespace AudioDsp {
+
+const uint32_t BankSignature = 0x4B4E4241;     //!<  "ABNK" as stored in the file.
+const uint16_t BankVersion = 1;
+const int BankNameLengthMax = 31;
+const std::size_t BankAlignmentDefault = 64;   //!<  nn::audio::BufferAlignSize.
+
+enum BankSampleFormat
+{
+    BankSampleFormat_PcmInt16 = 1,              //!<  Interleaved.
+    BankSampleFormat_Adpcm = 2                  //!<  Mono DSP-ADPCM frames.
+};
+
+enum BankResult
+{
+    BankResult_Success,
+    BankResult_TooSmall,                        //!<  Shorter than its header or entry table.
+    BankResult_NotBank,
+    BankResult_UnsupportedVersion,
+    BankResult_BadAlignment,                    //!<  The alignment is not a power of two or a payload is misaligned.
+    BankResult_BadEntry,                        //!<  A payload lies outside the file or an entry is inconsistent.
+    BankResult_BufferTooSmall                   //!<  BuildBank() was given a smaller buffer than it needs.
+};
+
+struct BankHeader
+{
+    uint32_t signature;
+    uint16_t version;
+    uint16_t entryCount;
+    uint32_t alignment;
+    uint32_t fileSize;
+    uint32_t reserved[4];
+};
+
+struct BankEntry
+{
+    uint32_t nameHash;                          //!<  HashBankName(name).
+    char     name[BankNameLengthMax + 1];       //!<  Zero-terminated.
+    uint8_t  sampleFormat;                      //!<  BankSampleFormat.
+    uint8_t  channelCount;
+    uint16_t reserved0;
+    uint32_t dataOffset;                        //!<  From the start of the bank.
+    uint32_t dataSize;
+    AdpcmHeaderInfo info;                       //!<  sampleCount, sampleRate and loop for every format; coefficients and contexts for ADPCM.
+    uint8_t  reserved1[16];
+};
+
+//!<  One sound for BuildBank(). data is copied.
+struct BankSource
+{
+    const char* name;
+    BankSampleFormat sampleFormat;
+    int channelCount;
+    AdpcmHeaderInfo info;
+    const void* data;
+    std::size_t dataSize;
+};
+
+//!<  FNV-1a hash of the name, used to reject most entries before comparing names.
+uint32_t HashBankName(const char* name);
+
+/**
+* @brief  Checks the header, the entry table, and that every payload is aligned and inside the bank.
+*
+*  Call it once on a loaded bank; the accessors below assume a valid bank.
+*/
+BankResult ValidateBank(const void* bank, std::size_t size);
+
+const char* GetBankResultString(BankResult result);
+
+inline const BankHeader* GetBankHeader(const void* bank)
+{
+    return static_cast<const BankHeader*>(bank);
+}
+
+inline int GetBankEntryCount(const void* bank)
+{
+    return GetBankHeader(bank)->entryCount;
+}
+
+inline const BankEntry* GetBankEntry(const void* bank, int index)
+{
+    return reinterpret_cast<const BankEntry*>(static_cast<const uint8_t*>(bank) + sizeof(BankHeader)) + index;
+}
+
+inline const void* GetBankEntryData(const void* bank, int index)
+{
+    return static_cast<const uint8_t*>(bank) + GetBankEntry(bank, index)->dataOffset;
+}
+
+//!<  Index of the entry named name, or -1.
+int FindBankEntry(const void* bank, const char* name);
+
+/**
+* @brief  Lays out a bank in buffer.
+*
+*  alignment must be a power of two. With a null buffer only the size is computed.
+*  Names longer than BankNameLengthMax are cut.
+*
+* @param[out] pOutSize  Bytes of the bank.
+*/
+BankResult BuildBank(void* buffer, std::size_t bufferSize, std::size_t* pOutSize, const BankSource* sources, int sourceCount, std::size_t alignment);
+
+}
@@ -0,0 +1,187 @@
+#include "AudioDspBiquad.h"
+
+#include <cmath>
+
+#include "AudioDspSimd.h"
+
+namespace AudioDsp {
+
+namespace {
+
+const float Pi = 3.1415926535897932384626433f;
+
+// Keeps the designs finite at the edges of a sweep.
+const float FrequencyMaxRatio = 0.499f;
+const float FrequencyMin = 1.0f;
+const float QMin = 0.01f;
+
+// Runs four samples of the recursion in double precision.
+void RunGroup(const BiquadCoefficients& c, const double* x, double x1, double x2, double y1, double y2, float* pOut)
+{
+    for (int k = 0; k < 4; ++k)
+    {
+        const double y = c.b0 * x[k] + c.b1 * x1 + c.b2 * x2 - c.a1 * y1 - c.a2 * y2;
+        x2 = x1;
+        x1 = x[k];
+        y2 = y1;
+        y1 = y;
+        pOut[k] = static_cast<float>(y);
+    }
+}
+
+}
+
+BiquadCoefficients DesignBiquad(BiquadType type, float sampleRate, float frequency, float q, float gainDb)
+{
+    frequency = std::fmin(std::fmax(frequency, FrequencyMin), sampleRate * FrequencyMaxRatio);
+    q = std::fmax(q, QMin);
+
+    const float w0 = 2.0f * Pi * frequency / sampleRate;
+    const float A = std::pow(10.0f, gainDb / 40.0f);
+    return detail::Design(type, std::cos(w0), std::sin(w0) / (2.0f * q), A, std::sqrt(A));
+}
+
+BiquadCoefficients FromBiquadQ14(const int16_t* numerator, const int16_t* denominator)
+{
+    const float scale = 1.0f / 16384.0f;
+    BiquadCoefficients coefficients;
+    coefficients.b0 = numerator[0] * scale;
+    coefficients.b1 = numerator[1] * scale;
+    coefficients.b2 = numerator[2] * scale;
+    coefficients.a1 = -denominator[0] * scale;
+    coefficients.a2 = -denominator[1] * scale;
+    return coefficients;
+}
+
+void PrepareBiquadBlockSection(BiquadBlockSection* pOutSection, const BiquadCoefficients& coefficients)
+{
+    pOutSection->coefficients = coefficients;
+
+    // Each column is the response of the first four outputs to one unit input or one unit of state.
+    for (int j = 0; j < 4; ++j)
+    {
+        double x[4] = { 0.0, 0.0, 0.0, 0.0 };
+        x[j] = 1.0;
+        RunGroup(coefficients, x, 0.0, 0.0, 0.0, 0.0, pOutSection->inputColumn[j]);
+    }
+    const double zero[4] = { 0.0, 0.0, 0.0, 0.0 };
+    RunGroup(coefficients, zero, 1.0, 0.0, 0.0, 0.0, pOutSection->stateColumn[0]);
+    RunGroup(coefficients, zero, 0.0, 1.0, 0.0, 0.0, pOutSection->stateColumn[1]);
+    RunGroup(coefficients, zero, 0.0, 0.0, 1.0, 0.0, pOutSection->stateColumn[2]);
+    RunGroup(coefficients, zero, 0.0, 0.0, 0.0, 1.0, pOutSection->stateColumn[3]);
+}
+
+void ProcessBiquadBlock(float* pData, int count, const BiquadBlockSection& section, float* pState)
+{
+    const Float4 in0 = Load4(section.inputColumn[0]);
+    const Float4 in1 = Load4(section.inputColumn[1]);
+    const Float4 in2 = Load4(section.inputColumn[2]);
+    const Float4 in3 = Load4(section.inputColumn[3]);
+    const Float4 stX1 = Load4(section.stateColumn[0]);
+    const Float4 stX2 = Load4(section.stateColumn[1]);
+    const Float4 stY1 = Load4(section.stateColumn[2]);
+    const Float4 stY2 = Load4(section.stateColumn[3]);
+
+    float x1 = pState[0];
+    float x2 = pState[1];
+    float y1 = pState[2];
+    float y2 = pState[3];
+
+    int i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        const float x0 = pData[i];
+        const float xa = pData[i + 1];
+        const float xb = pData[i + 2];
+        const float xc = pData[i + 3];
+
+        Float4 y = Mul4(in0, Set4(x0));
+        y = MulAdd4(y, in1, Set4(xa));
+        y = MulAdd4(y, in2, Set4(xb));
+        y = MulAdd4(y, in3, Set4(xc));
+        y = MulAdd4(y, stX1, Set4(x1));
+        y = MulAdd4(y, stX2, Set4(x2));
+        y = MulAdd4(y, stY1, Set4(y1));
+        y = MulAdd4(y, stY2, Set4(y2));
+        Store4(pData + i, y);
+
+        x1 = xc;
+        x2 = xb;
+        y1 = pData[i + 3];
+        y2 = pData[i + 2];
+    }
+
+    const BiquadCoefficients& c = section.coefficients;
+    for (; i < count; ++i)
+    {
+        const float x = pData[i];
+        const float y = c.b0 * x + c.b1 * x1 + c.b2 * x2 - c.a1 * y1 - c.a2 * y2;
+        x2 = x1;
+        x1 = x;
+        y2 = y1;
+        y1 = y;
+        pData[i] = y;
+    }
+
+    // Flush the feedback path to zero once it decays into the denormal range.
+    if (y1 < 1.0e-20f && y1 > -1.0e-20f && y2 < 1.0e-20f && y2 > -1.0e-20f)
+    {
+        y1 = 0.0f;
+        y2 = 0.0f;
+    }
+    pState[0] = x1;
+    pState[1] = x2;
+    pState[2] = y1;
+    pState[3] = y2;
+}
+
+BiquadCascade::BiquadCascade()
+{
+    for (int i = 0; i < SectionCountMax; ++i)
+    {
+        m_IsEnabled[i] = false;
+    }
+    Reset();
+}
+
+void BiquadCascade::SetSection(int index, const BiquadCoefficients& coefficients)
+{
+    if (!m_IsEnabled[index])
+    {
+        for (int s = 0; s < 4; ++s)
+        {
+            m_State[index][s] = 0.0f;
+        }
+        m_IsEnabled[index] = true;
+    }
+    PrepareBiquadBlockSection(&m_Sections[index], coefficients);
+}
+
+void BiquadCascade::DisableSection(int index)
+{
+    m_IsEnabled[index] = false;
+}
+
+void BiquadCascade::Reset()
+{
+    for (int i = 0; i < SectionCountMax; ++i)
+    {
+        for (int s = 0; s < 4; ++s)
+        {
+            m_State[i][s] = 0.0f;
+        }
+    }
+}
+
+void BiquadCascade::Process(float* pData, int count)
+{
+    for (int i = 0; i < SectionCountMax; ++i)
+    {
+        if (m_IsEnabled[i])
+        {
+            ProcessBiquadBlock(pData, count, m_Sections[i], m_State[i]);
+        }
+    }
+}
+
+}
@@ -0,0 +1,204 @@
+#pragma once
+
+/**
+* @brief
+*  Biquad filter design and a block-processed biquad cascade.
+*
+*  The designer implements the usual bilinear-transform designs (low-pass, high-pass, band-pass, shelves, and peaking)
+*  for any sample rate, so a filter keeps its cutoff whether the renderer runs at 32 or 48 kHz.
+*  <tt>DesignBiquadConstant()</tt> is constexpr and evaluates fixed designs at compile time;
+*  <tt>DesignBiquad()</tt> uses the math library and is cheap enough to call every audio frame during a sweep.
+*  <tt>ToBiquadQ14()</tt> converts a design to the Q14 format of <tt>nn::audio::BiquadFilterParameter</tt>.
+*
+*  A biquad is recursive, so its samples cannot simply be computed four at a time. The block section instead
+*  precomputes how four outputs depend on four inputs and on the filter state, which turns each group of four samples
+*  into eight vector multiply-adds with <tt>AudioDsp::Float4</tt>. Summing eight products per output leaves about 10 dB more
+*  rounding noise than the per-sample recursion in float, which is still far below the 16-bit output.
+*/
+
+#include <cstdint>
+
+namespace AudioDsp {
+
+enum BiquadType
+{
+    BiquadType_LowPass,
+    BiquadType_HighPass,
+    BiquadType_BandPass,        //!<  0 dB at the center frequency.
+    BiquadType_LowShelf,
+    BiquadType_HighShelf,
+    BiquadType_Peaking
+};
+
+//!<  Normalized so that a0 is 1: y[n] = b0 x[n] + b1 x[n-1] + b2 x[n-2] - a1 y[n-1] - a2 y[n-2].
+struct BiquadCoefficients
+{
+    float b0;
+    float b1;
+    float b2;
+    float a1;
+    float a2;
+};
+
+//!<  Same layout as nn::audio::BiquadFilterParameter without the enable flag: b0, b1, b2 and -a1, -a2 in Q14.
+struct BiquadQ14
+{
+    int16_t numerator[3];
+    int16_t denominator[2];
+};
+
+namespace detail {
+
+constexpr double Pi = 3.14159265358979323846;
+constexpr double Ln10 = 2.30258509299404568402;
+
+// Taylor series written as single-expression recursions so they stay constexpr in C++11.
+// Accurate to double precision for |x| <= pi (sine and cosine) and |x| <= 4 (exponential).
+constexpr double TrigSeries(double x2, double term, int n)
+{
+    return n > 28 ? term : term + TrigSeries(x2, -term * x2 / ((n + 1) * (n + 2)), n + 2);
+}
+
+constexpr double Sin(double x) { return TrigSeries(x * x, x, 1); }
+constexpr double Cos(double x) { return TrigSeries(x * x, 1.0, 0); }
+
+constexpr double ExpSeries(double x, double term, int n)
+{
+    return n > 40 ? term : term + ExpSeries(x, term * x / (n + 1), n + 1);
+}
+
+constexpr double Exp(double x) { return ExpSeries(x, 1.0, 0); }
+
+constexpr BiquadCoefficients Normalize(double b0, double b1, double b2, double a0, double a1, double a2)
+{
+    return BiquadCoefficients{ static_cast<float>(b0 / a0), static_cast<float>(b1 / a0), static_cast<float>(b2 / a0),
+                               static_cast<float>(a1 / a0), static_cast<float>(a2 / a0) };
+}
+
+// c = cos(w0), alpha = sin(w0) / (2 Q), A = 10^(gain / 40), and s = 2 sqrt(A) alpha.
+constexpr BiquadCoefficients DesignShelf(bool isHigh, double c, double A, double s)
+{
+    return isHigh
+        ? Normalize(A * ((A + 1) + (A - 1) * c + s), -2 * A * ((A - 1) + (A + 1) * c), A * ((A + 1) + (A - 1) * c - s),
+                    (A + 1) - (A - 1) * c + s, 2 * ((A - 1) - (A + 1) * c), (A + 1) - (A - 1) * c - s)
+        : Normalize(A * ((A + 1) - (A - 1) * c + s), 2 * A * ((A - 1) - (A + 1) * c), A * ((A + 1) - (A - 1) * c - s),
+                    (A + 1) + (A - 1) * c + s, -2 * ((A - 1) + (A + 1) * c), (A + 1) + (A - 1) * c - s);
+}
+
+constexpr BiquadCoefficients Design(BiquadType type, double c, double alpha, double A, double sqrtA)
+{
+    return type == BiquadType_LowPass  ? Normalize((1 - c) / 2, 1 - c, (1 - c) / 2, 1 + alpha, -2 * c, 1 - alpha)
+         : type == BiquadType_HighPass ? Normalize((1 + c) / 2, -(1 + c), (1 + c) / 2, 1 + alpha, -2 * c, 1 - alpha)
+         : type == BiquadType_BandPass ? Normalize(alpha, 0, -alpha, 1 + alpha, -2 * c, 1 - alpha)
+         : type == BiquadType_Peaking  ? Normalize(1 + alpha * A, -2 * c, 1 - alpha * A, 1 + alpha / A, -2 * c, 1 - alpha / A)
+         : DesignShelf(type == BiquadType_HighShelf, c, A, 2 * sqrtA * alpha);
+}
+
+constexpr int16_t ToQ14(double value)
+{
+    return value * 16384 >= 32767 ? 32767
+         : value * 16384 <= -32768 ? -32768
+         : static_cast<int16_t>(value * 16384 + (value < 0 ? -0.5 : 0.5));
+}
+
+}
+
+/**
+* @brief  Designs a biquad at compile time.
+*
+*  frequency must be below half of sampleRate and q above zero. gainDb is used by the shelves and the peaking filter only
+*  and must stay within +-48 dB.
+*/
+constexpr BiquadCoefficients DesignBiquadConstant(BiquadType type, double sampleRate, double frequency, double q, double gainDb = 0.0)
+{
+    return detail::Design(type, detail::Cos(2 * detail::Pi * frequency / sampleRate),
+                          detail::Sin(2 * detail::Pi * frequency / sampleRate) / (2 * q),
+                          detail::Exp(gainDb * detail::Ln10 / 40), detail::Exp(gainDb * detail::Ln10 / 80));
+}
+
+/**
+* @brief  Designs a biquad at run time.
+*
+*  frequency is clamped to just below half of sampleRate and q to a small positive value, so a sweep may run past the edges.
+*/
+BiquadCoefficients DesignBiquad(BiquadType type, float sampleRate, float frequency, float q, float gainDb = 0.0f);
+
+/**
+* @brief  Converts to Q14, rounding to nearest.
+*
+*  Q14 holds values in [-2, 2). Boosts of more than about 6 dB push b0 past that and saturate, so boost with the voice volume instead.
+*/
+constexpr BiquadQ14 ToBiquadQ14(const BiquadCoefficients& coefficients)
+{
+    return BiquadQ14{ { detail::ToQ14(coefficients.b0), detail::ToQ14(coefficients.b1), detail::ToQ14(coefficients.b2) },
+                      { detail::ToQ14(-coefficients.a1), detail::ToQ14(-coefficients.a2) } };
+}
+
+//!<  Converts a Q14 filter back to coefficients.
+BiquadCoefficients FromBiquadQ14(const int16_t* numerator, const int16_t* denominator);
+
+/**
+* @brief  Fills an nn::audio::BiquadFilterParameter, or any struct with the same enable, numerator, and denominator members.
+*/
+template <typename Parameter>
+Parameter ToBiquadFilterParameter(const BiquadQ14& q14, bool enable)
+{
+    Parameter parameter = { enable, { q14.numerator[0], q14.numerator[1], q14.numerator[2] }, { q14.denominator[0], q14.denominator[1] } };
+    return parameter;
+}
+
+/**
+* @brief  One biquad prepared for block processing. Plain data, so it can live in zero-initialized memory.
+*
+*  inputColumn[j][k] is the contribution of input j of a group of four to output k, and stateColumn[s][k] that of
+*  x[n-1], x[n-2], y[n-1], y[n-2]. The scalar coefficients handle groups of fewer than four samples.
+*/
+struct BiquadBlockSection
+{
+    float inputColumn[4][4];
+    float stateColumn[4][4];
+    BiquadCoefficients coefficients;
+};
+
+//!<  Prepares a section. Call it again whenever the coefficients change; the filter state is kept.
+void PrepareBiquadBlockSection(BiquadBlockSection* pOutSection, const BiquadCoefficients& coefficients);
+
+/**
+* @brief  Runs one prepared section in place.
+*
+* @param[in,out] pState  x[n-1], x[n-2], y[n-1], y[n-2], carried between calls. Zero for a filter starting from silence.
+*/
+void ProcessBiquadBlock(float* pData, int count, const BiquadBlockSection& section, float* pState);
+
+/**
+* @brief  Up to <tt>SectionCountMax</tt> biquads in series on one channel, for mixing done in software.
+*
+*  Each section is enabled by setting its coefficients. Changing the coefficients of an enabled section keeps its state,
+*  so a sweep stays continuous; a section that was disabled starts from silence.
+*/
+class BiquadCascade
+{
+public:
+    static const int SectionCountMax = 4;
+
+    BiquadCascade();
+
+    void SetSection(int index, const BiquadCoefficients& coefficients);
+
+    //!<  The section passes samples through unchanged.
+    void DisableSection(int index);
+
+    bool IsSectionEnabled(int index) const { return m_IsEnabled[index]; }
+
+    //!<  Clears the state of every section.
+    void Reset();
+
+    void Process(float* pData, int count);
+
+private:
+    BiquadBlockSection m_Sections[SectionCountMax];
+    float m_State[SectionCountMax][4];
+    bool m_IsEnabled[SectionCountMax];
+};
+
+}
@@ -0,0 +1,95 @@
+#include "AudioDspBudget.h"
+
+#include <cstring>
+
+namespace AudioDsp {
+
+namespace {
+
+std::size_t AlignUp(std::size_t value, std::size_t alignment)
+{
+    return (value + alignment - 1) & ~(alignment - 1);
+}
+
+BankResult ReadHeader(BankHeader* pOutHeader, int bank, BudgetReadFunction readFunction, void* pUserData)
+{
+    if (!readFunction(pUserData, bank, 0, pOutHeader, sizeof(*pOutHeader)))
+    {
+        return BankResult_TooSmall;
+    }
+    if (pOutHeader->signature != BankSignature)
+    {
+        return BankResult_NotBank;
+    }
+    if (pOutHeader->version != BankVersion)
+    {
+        return BankResult_UnsupportedVersion;
+    }
+    return BankResult_Success;
+}
+
+//!<  Channel count of the entry named name, or 0 if the bank has none.
+int FindChannelCount(const BankHeader& header, int bank, const char* name, BudgetReadFunction readFunction, void* pUserData)
+{
+    // The entries are compared by hash first, as FindBankEntry() does, so a name is read only for a likely match.
+    const uint32_t hash = HashBankName(name);
+    for (int i = 0; i < header.entryCount; ++i)
+    {
+        BankEntry entry;
+        if (!readFunction(pUserData, bank, sizeof(BankHeader) + sizeof(BankEntry) * i, &entry, sizeof(entry)))
+        {
+            return 0;
+        }
+        if (entry.nameHash == hash && std::strncmp(entry.name, name, sizeof(entry.name)) == 0)
+        {
+            return entry.channelCount;
+        }
+    }
+    return 0;
+}
+
+}
+
+BankResult ComputeBudget(Budget* pOutBudget, int bankCount, const BudgetSound* sounds, int soundCount, std::size_t alignment,
+                         BudgetReadFunction readFunction, void* pUserData)
+{
+    pOutBudget->voiceCount = 0;
+    pOutBudget->voiceChannelCountMax = 1;
+    pOutBudget->bankPoolSize = 0;
+    pOutBudget->missingSound = -1;
+
+    for (int i = 0; i < bankCount; ++i)
+    {
+        BankHeader header;
+        const BankResult result = ReadHeader(&header, i, readFunction, pUserData);
+        if (result != BankResult_Success)
+        {
+            return result;
+        }
+        pOutBudget->bankPoolSize += AlignUp(header.fileSize, alignment);
+    }
+
+    for (int i = 0; i < soundCount; ++i)
+    {
+        const BudgetSound& sound = sounds[i];
+        BankHeader header;
+        int channelCount = 0;
+        if (sound.bank >= 0 && sound.bank < bankCount && ReadHeader(&header, sound.bank, readFunction, pUserData) == BankResult_Success)
+        {
+            channelCount = FindChannelCount(header, sound.bank, sound.name, readFunction, pUserData);
+        }
+        if (channelCount == 0)
+        {
+            if (pOutBudget->missingSound < 0)
+            {
+                pOutBudget->missingSound = i;
+            }
+            continue;
+        }
+        pOutBudget->voiceCount += sound.polyphonyMax;
+        pOutBudget->voiceChannelCountMax = channelCount > pOutBudget->voiceChannelCountMax ? channelCount : pOutBudget->voiceChannelCountMax;
+    }
+    return BankResult_Success;
+}
+
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+/**
+* @brief
+*  Voice and sample memory budget of a set of banks and the sounds played from them.
+*
+*  The budget is what the banks and the polyphony of each sound need, so a graph sized from it holds every instance of
+*  every sound at once and every bank at the same time, with nothing reserved on top. Only the bank headers and entry
+*  tables are read, through a read function, so the budget is known before the memory the banks go into is allocated.
+*  The host tools and the console engine compute it the same way.
+*/
+
+#include <cstddef>
+#include <cstdint>
+
+#include "AudioDspBank.h"
+
+namespace AudioDsp {
+
+//!<  Reads <tt>size</tt> bytes at <tt>offset</tt> of bank number <tt>bank</tt>. Returns false on failure.
+typedef bool (*BudgetReadFunction)(void* pUserData, int bank, int64_t offset, void* buffer, std::size_t size);
+
+struct BudgetSound
+{
+    int bank;                               //!<  Index of the bank holding the sound.
+    const char* name;
+    int polyphonyMax;                       //!<  Instances of the sound that may play at once.
+};
+
+struct Budget
+{
+    int voiceCount;                         //!<  Pooled voices for every instance of every sound at once.
+    int voiceChannelCountMax;               //!<  Largest channel count of the sounds; 1 if there are none.
+    std::size_t bankPoolSize;               //!<  Sum of the bank file sizes, each rounded up to the alignment.
+    int missingSound;                       //!<  Index of the first sound its bank does not hold, or -1.
+};
+
+/**
+* @brief  Computes the budget of bankCount banks and the sounds played from them.
+*
+*  Reads each bank header and, for each sound, the entries of its bank up to the one named. alignment is a power of two,
+*  nn::audio::BufferAlignSize for banks loaded into a wave pool. Fails on the first bank that cannot be read or is not a
+*  bank; a sound missing from its bank does not fail the call but is reported through Budget::missingSound.
+*/
+BankResult ComputeBudget(Budget* pOutBudget, int bankCount, const BudgetSound* sounds, int soundCount, std::size_t alignment,
+                         BudgetReadFunction readFunction, void* pUserData);
+
+}
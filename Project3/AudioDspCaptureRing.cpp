@@ -0,0 +1,137 @@
+#include "AudioDspCaptureRing.h"
+
+#include <cstring>
+
+namespace AudioDsp {
+
+namespace {
+
+int16_t ClampToInt16(int32_t sample)
+{
+    return static_cast<int16_t>(sample < -32768 ? -32768 : (sample > 32767 ? 32767 : sample));
+}
+
+}
+
+CaptureRing::CaptureRing()
+    : m_pFrames(nullptr)
+    , m_FrameSampleCount(0)
+    , m_ChannelCount(0)
+    , m_FrameCount(0)
+    , m_WritePosition(0)
+    , m_ReadPosition(0)
+    , m_DroppedFrameCount(0)
+    , m_PeakFrameCount(0)
+{
+}
+
+std::size_t CaptureRing::GetRequiredWorkBufferSize(int frameSampleCount, int channelCount, int frameCount)
+{
+    return sizeof(int16_t) * frameSampleCount * channelCount * frameCount;
+}
+
+void CaptureRing::Initialize(void* workBuffer, std::size_t workBufferSize, int frameSampleCount, int channelCount, int frameCount)
+{
+    m_pFrames = nullptr;
+    m_FrameSampleCount = 0;
+    m_ChannelCount = 0;
+    m_FrameCount = 0;
+    m_WritePosition.store(0, std::memory_order_relaxed);
+    m_ReadPosition.store(0, std::memory_order_relaxed);
+    m_DroppedFrameCount.store(0, std::memory_order_relaxed);
+    m_PeakFrameCount.store(0, std::memory_order_relaxed);
+
+    if (workBuffer == nullptr || frameSampleCount <= 0 || channelCount <= 0 || frameCount <= 0 || (frameCount & (frameCount - 1)) != 0
+        || workBufferSize < GetRequiredWorkBufferSize(frameSampleCount, channelCount, frameCount))
+    {
+        return;
+    }
+    m_pFrames = static_cast<int16_t*>(workBuffer);
+    m_FrameSampleCount = frameSampleCount;
+    m_ChannelCount = channelCount;
+    m_FrameCount = frameCount;
+}
+
+int16_t* CaptureRing::BeginPush()
+{
+    const uint32_t writePosition = m_WritePosition.load(std::memory_order_relaxed);
+    const uint32_t readPosition = m_ReadPosition.load(std::memory_order_acquire);
+    const int waitingCount = static_cast<int>(writePosition - readPosition);
+    if (m_pFrames == nullptr || waitingCount >= m_FrameCount)
+    {
+        m_DroppedFrameCount.fetch_add(1, std::memory_order_relaxed);
+        return nullptr;
+    }
+    if (waitingCount + 1 > m_PeakFrameCount.load(std::memory_order_relaxed))
+    {
+        m_PeakFrameCount.store(waitingCount + 1, std::memory_order_relaxed);
+    }
+    return m_pFrames + static_cast<std::size_t>(writePosition & (m_FrameCount - 1)) * m_FrameSampleCount * m_ChannelCount;
+}
+
+void CaptureRing::EndPush()
+{
+    // Publishes the frame: the consumer reads it only after seeing the new position.
+    m_WritePosition.store(m_WritePosition.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+}
+
+bool CaptureRing::PushPlanar(const int32_t* planar)
+{
+    int16_t* pFrame = BeginPush();
+    if (pFrame == nullptr)
+    {
+        return false;
+    }
+    for (int c = 0; c < m_ChannelCount; ++c)
+    {
+        const int32_t* pChannel = planar + c * m_FrameSampleCount;
+        for (int i = 0; i < m_FrameSampleCount; ++i)
+        {
+            pFrame[i * m_ChannelCount + c] = ClampToInt16(pChannel[i]);
+        }
+    }
+    EndPush();
+    return true;
+}
+
+bool CaptureRing::PushInterleaved(const int16_t* interleaved, int sampleCount)
+{
+    if (sampleCount != m_FrameSampleCount)
+    {
+        m_DroppedFrameCount.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    int16_t* pFrame = BeginPush();
+    if (pFrame == nullptr)
+    {
+        return false;
+    }
+    std::memcpy(pFrame, interleaved, GetFrameSize());
+    EndPush();
+    return true;
+}
+
+int CaptureRing::Peek(const int16_t** pOutFrames) const
+{
+    const uint32_t readPosition = m_ReadPosition.load(std::memory_order_relaxed);
+    const uint32_t writePosition = m_WritePosition.load(std::memory_order_acquire);
+    const int waitingCount = static_cast<int>(writePosition - readPosition);
+    if (waitingCount == 0)
+    {
+        *pOutFrames = nullptr;
+        return 0;
+    }
+
+    // Frames past the end of the memory continue at its start; they are returned by the next Peek().
+    const int first = static_cast<int>(readPosition & (m_FrameCount - 1));
+    *pOutFrames = m_pFrames + static_cast<std::size_t>(first) * m_FrameSampleCount * m_ChannelCount;
+    return waitingCount < m_FrameCount - first ? waitingCount : m_FrameCount - first;
+}
+
+void CaptureRing::Pop(int frameCount)
+{
+    // Releases the slots: the producer reuses them only after seeing the new position.
+    m_ReadPosition.store(m_ReadPosition.load(std::memory_order_relaxed) + static_cast<uint32_t>(frameCount), std::memory_order_release);
+}
+
+}
@@ -0,0 +1,85 @@
+#pragma once
+
+/**
+* @brief
+*  Lock-free ring of audio frames from the thread that renders them to a thread that writes them out.
+*
+*  Capturing the final mix must not slow the audio thread down, so the audio thread only copies each frame into the
+*  ring, as interleaved 16-bit PCM, and a writer thread takes whole runs of frames out and hands them to the file system
+*  in one write each. The two threads share nothing but the read and write positions, each advanced by one thread only.
+*  When the writer falls behind and the ring is full, the frame is dropped and counted instead of waiting, so the count
+*  tells whether the captured file has gaps.
+*
+*  There must be one producer and one consumer thread at a time.
+*/
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace AudioDsp {
+
+class CaptureRing
+{
+public:
+    CaptureRing();
+
+    //!<  Size of the frame memory for frameCount frames of frameSampleCount samples per channel.
+    static std::size_t GetRequiredWorkBufferSize(int frameSampleCount, int channelCount, int frameCount);
+
+    /**
+    * @brief  Prepares an empty ring in workBuffer.
+    *
+    *  frameCount must be a power of two. With an invalid argument or a buffer too small, the ring has no frames and
+    *  every push is dropped. Call this before either thread uses the ring.
+    */
+    void Initialize(void* workBuffer, std::size_t workBufferSize, int frameSampleCount, int channelCount, int frameCount);
+
+    // Producer.
+
+    //!<  Appends a frame stored channel after channel as 32-bit samples, as an aux effect sends it, clamping to 16 bits. Returns false if it was dropped.
+    bool PushPlanar(const int32_t* planar);
+
+    //!<  Appends a frame of interleaved samples. Returns false if it was dropped, or if sampleCount is not the frame size.
+    bool PushInterleaved(const int16_t* interleaved, int sampleCount);
+
+    // Consumer.
+
+    //!<  The oldest frames stored one after another, without wrapping. Returns their count, 0 if the ring is empty.
+    int Peek(const int16_t** pOutFrames) const;
+
+    //!<  Releases frameCount frames returned by <tt>Peek()</tt>.
+    void Pop(int frameCount);
+
+    // Any thread.
+
+    int GetFrameSampleCount() const { return m_FrameSampleCount; }
+    int GetChannelCount() const { return m_ChannelCount; }
+
+    //!<  Bytes of one frame.
+    std::size_t GetFrameSize() const { return sizeof(int16_t) * m_FrameSampleCount * m_ChannelCount; }
+
+    uint32_t GetDroppedFrameCount() const { return m_DroppedFrameCount.load(std::memory_order_relaxed); }
+
+    //!<  Most frames that were waiting at once, for sizing the ring.
+    int GetPeakFrameCount() const { return m_PeakFrameCount.load(std::memory_order_relaxed); }
+
+private:
+    CaptureRing(const CaptureRing&);
+    CaptureRing& operator=(const CaptureRing&);
+
+    //!<  The slot for the next frame, or null after counting a drop if the ring is full.
+    int16_t* BeginPush();
+    void EndPush();
+
+    int16_t* m_pFrames;
+    int m_FrameSampleCount;
+    int m_ChannelCount;
+    int m_FrameCount;
+    std::atomic<uint32_t> m_WritePosition;      //!<  Frames pushed; advanced by the producer.
+    std::atomic<uint32_t> m_ReadPosition;       //!<  Frames popped; advanced by the consumer.
+    std::atomic<uint32_t> m_DroppedFrameCount;
+    std::atomic<int> m_PeakFrameCount;
+};
+
+}
@@ -0,0 +1,214 @@
+#include "AudioDspConvolver.h"
+
+#include <cstring>
+
+#include "AudioDspSimd.h"
+
+namespace AudioDsp {
+
+namespace {
+
+const std::size_t ArrayAlignment = 16;
+
+std::size_t AlignUp(std::size_t value, std::size_t alignment)
+{
+    return (value + alignment - 1) & ~(alignment - 1);
+}
+
+template <typename T>
+T* AllocateArray(uintptr_t* pCursor, std::size_t count)
+{
+    *pCursor = AlignUp(*pCursor, ArrayAlignment);
+    T* p = reinterpret_cast<T*>(*pCursor);
+    *pCursor += sizeof(T) * count;
+    return p;
+}
+
+// pAccumulator += pInput * pImpulse for binCount complex bins, a multiple of four, in split form.
+// Bin 0 holds two real values; the caller overwrites what this makes of it.
+void MultiplyAccumulate(float* pAccumulator, const float* pInput, const float* pImpulse, int binCount)
+{
+    float* pAccumulatorImag = pAccumulator + binCount;
+    const float* pInputImag = pInput + binCount;
+    const float* pImpulseImag = pImpulse + binCount;
+    for (int k = 0; k < binCount; k += SimdWidth)
+    {
+        const Float4 xr = Load4(pInput + k);
+        const Float4 xi = Load4(pInputImag + k);
+        const Float4 hr = Load4(pImpulse + k);
+        const Float4 hi = Load4(pImpulseImag + k);
+        Float4 real = Load4(pAccumulator + k);
+        Float4 imag = Load4(pAccumulatorImag + k);
+        real = MulAdd4(real, xr, hr);
+        real = Sub4(real, Mul4(xi, hi));
+        imag = MulAdd4(imag, xr, hi);
+        imag = MulAdd4(imag, xi, hr);
+        Store4(pAccumulator + k, real);
+        Store4(pAccumulatorImag + k, imag);
+    }
+}
+
+}
+
+PartitionedConvolver::PartitionedConvolver()
+    : m_BlockSize(0)
+    , m_FftSize(0)
+    , m_BinCount(0)
+    , m_PartitionCountMax(0)
+    , m_PartitionCount(0)
+    , m_Head(0)
+    , m_pInput(nullptr)
+    , m_pTime(nullptr)
+    , m_pAccumulator(nullptr)
+    , m_pInputSpectra(nullptr)
+    , m_pImpulseSpectra(nullptr)
+{
+}
+
+int PartitionedConvolver::GetFftSize(int blockSize)
+{
+    int size = RealFft::SizeMin;
+    while (size < 2 * blockSize)
+    {
+        size *= 2;
+    }
+    return size;
+}
+
+int PartitionedConvolver::GetPartitionCount(int blockSize, int impulseSampleCount)
+{
+    return (impulseSampleCount + blockSize - 1) / blockSize;
+}
+
+std::size_t PartitionedConvolver::GetRequiredWorkBufferSize(int blockSize, int impulseSampleCountMax)
+{
+    if (blockSize <= 0 || impulseSampleCountMax <= 0)
+    {
+        return 0;
+    }
+    const int fftSize = GetFftSize(blockSize);
+    const std::size_t spectrumSize = AlignUp(fftSize * sizeof(float), ArrayAlignment);
+    return ArrayAlignment - 1
+         + AlignUp(RealFft::GetRequiredWorkBufferSize(fftSize), ArrayAlignment)
+         + 3 * spectrumSize
+         + 2 * spectrumSize * GetPartitionCount(blockSize, impulseSampleCountMax);
+}
+
+void PartitionedConvolver::Initialize(void* workBuffer, std::size_t workBufferSize, int blockSize, int impulseSampleCountMax)
+{
+    m_PartitionCount = 0;
+    m_Head = 0;
+    if (workBuffer == nullptr || blockSize <= 0 || impulseSampleCountMax <= 0
+        || workBufferSize < GetRequiredWorkBufferSize(blockSize, impulseSampleCountMax))
+    {
+        // Leave the convolver without partitions; Process() outputs silence.
+        m_BlockSize = blockSize > 0 ? blockSize : 0;
+        m_PartitionCountMax = 0;
+        return;
+    }
+
+    m_BlockSize = blockSize;
+    m_FftSize = GetFftSize(blockSize);
+    m_BinCount = m_FftSize / 2;
+    m_PartitionCountMax = GetPartitionCount(blockSize, impulseSampleCountMax);
+
+    uintptr_t cursor = reinterpret_cast<uintptr_t>(workBuffer);
+    const std::size_t fftWorkBufferSize = RealFft::GetRequiredWorkBufferSize(m_FftSize);
+    m_Fft.Initialize(AllocateArray<char>(&cursor, fftWorkBufferSize), fftWorkBufferSize, m_FftSize);
+    m_pInput = AllocateArray<float>(&cursor, m_FftSize);
+    m_pTime = AllocateArray<float>(&cursor, m_FftSize);
+    m_pAccumulator = AllocateArray<float>(&cursor, m_FftSize);
+    m_pInputSpectra = AllocateArray<float>(&cursor, static_cast<std::size_t>(m_PartitionCountMax) * m_FftSize);
+    m_pImpulseSpectra = AllocateArray<float>(&cursor, static_cast<std::size_t>(m_PartitionCountMax) * m_FftSize);
+    std::memset(m_pImpulseSpectra, 0, sizeof(float) * m_PartitionCountMax * m_FftSize);
+    Reset();
+}
+
+void PartitionedConvolver::SetImpulse(const float* pSamples, int sampleCount, int stride, float gain)
+{
+    SetImpulseImpl(pSamples, sampleCount, stride, gain);
+}
+
+void PartitionedConvolver::SetImpulse(const int16_t* pSamples, int sampleCount, int stride, float gain)
+{
+    SetImpulseImpl(pSamples, sampleCount, stride, gain);
+}
+
+template <typename T>
+void PartitionedConvolver::SetImpulseImpl(const T* pSamples, int sampleCount, int stride, float gain)
+{
+    if (m_PartitionCountMax == 0)
+    {
+        return;
+    }
+    if (sampleCount > m_PartitionCountMax * m_BlockSize)
+    {
+        sampleCount = m_PartitionCountMax * m_BlockSize;
+    }
+
+    // Each partition is zero-padded to the FFT size, which keeps the circular wrap out of the last block of the output.
+    const float scale = gain / m_FftSize;
+    m_PartitionCount = GetPartitionCount(m_BlockSize, sampleCount);
+    for (int p = 0; p < m_PartitionCount; ++p)
+    {
+        const int offset = p * m_BlockSize;
+        const int count = sampleCount - offset < m_BlockSize ? sampleCount - offset : m_BlockSize;
+        for (int i = 0; i < count; ++i)
+        {
+            m_pTime[i] = static_cast<float>(pSamples[static_cast<std::ptrdiff_t>(offset + i) * stride]) * scale;
+        }
+        std::memset(m_pTime + count, 0, sizeof(float) * (m_FftSize - count));
+        float* pSpectrum = GetImpulseSpectrum(p);
+        m_Fft.Forward(pSpectrum, pSpectrum + m_BinCount, m_pTime);
+    }
+}
+
+void PartitionedConvolver::Reset()
+{
+    if (m_PartitionCountMax == 0)
+    {
+        return;
+    }
+    std::memset(m_pInput, 0, sizeof(float) * m_FftSize);
+    std::memset(m_pInputSpectra, 0, sizeof(float) * m_PartitionCountMax * m_FftSize);
+    m_Head = 0;
+}
+
+void PartitionedConvolver::Process(float* pOut, const float* pIn)
+{
+    if (m_PartitionCount == 0)
+    {
+        std::memset(pOut, 0, sizeof(float) * m_BlockSize);
+        return;
+    }
+
+    // Slide the input window by one block and transform it into the next slot of the ring.
+    std::memmove(m_pInput, m_pInput + m_BlockSize, sizeof(float) * (m_FftSize - m_BlockSize));
+    std::memcpy(m_pInput + m_FftSize - m_BlockSize, pIn, sizeof(float) * m_BlockSize);
+    m_Head = m_Head + 1 < m_PartitionCountMax ? m_Head + 1 : 0;
+    float* pNewest = GetInputSpectrum(m_Head);
+    m_Fft.Forward(pNewest, pNewest + m_BinCount, m_pInput);
+
+    // Partition p meets the input of p blocks ago. The packed DC and Nyquist bins are real and summed on their own.
+    std::memset(m_pAccumulator, 0, sizeof(float) * m_FftSize);
+    float dc = 0.0f;
+    float nyquist = 0.0f;
+    int slot = m_Head;
+    for (int p = 0; p < m_PartitionCount; ++p)
+    {
+        const float* pInput = GetInputSpectrum(slot);
+        const float* pImpulse = GetImpulseSpectrum(p);
+        MultiplyAccumulate(m_pAccumulator, pInput, pImpulse, m_BinCount);
+        dc += pInput[0] * pImpulse[0];
+        nyquist += pInput[m_BinCount] * pImpulse[m_BinCount];
+        slot = slot > 0 ? slot - 1 : m_PartitionCountMax - 1;
+    }
+    m_pAccumulator[0] = dc;
+    m_pAccumulator[m_BinCount] = nyquist;
+
+    // The last block of the circular convolution is free of wrap-around.
+    m_Fft.Inverse(m_pTime, m_pAccumulator, m_pAccumulator + m_BinCount);
+    std::memcpy(pOut, m_pTime + m_FftSize - m_BlockSize, sizeof(float) * m_BlockSize);
+}
+
+}
@@ -0,0 +1,89 @@
+#pragma once
+
+/**
+* @brief
+*  Uniformly partitioned FFT convolution, for reverbs with measured or designed impulse responses.
+*
+*  The impulse response is cut into partitions of one block each, and the spectrum of every partition is computed once
+*  when the impulse is set. Each <tt>Process()</tt> call transforms the newest block of input, keeps its spectrum in a
+*  ring of the last partition-count spectra, multiplies every partition with the input spectrum of matching age, and
+*  transforms the sum back (overlap-save). The output has no latency beyond the block itself.
+*
+*  The cost of a block is one forward and one inverse FFT plus one complex multiply-accumulate per bin and partition,
+*  done four bins at a time with <tt>AudioDsp::Float4</tt>. It is the same for every block and grows linearly with the
+*  length of the impulse response. The FFT size is the power of two at or above twice the block, so for a renderer
+*  frame of 160 samples (32 kHz) the spectra have 256 bins where 160 would do; at 48 kHz, 240 samples fill them.
+*/
+
+#include <cstddef>
+#include <cstdint>
+
+#include "AudioDspFft.h"
+
+namespace AudioDsp {
+
+class PartitionedConvolver
+{
+public:
+    PartitionedConvolver();
+
+    //!<  FFT size used for blocks of blockSize samples.
+    static int GetFftSize(int blockSize);
+
+    //!<  Partitions needed for impulseSampleCount samples.
+    static int GetPartitionCount(int blockSize, int impulseSampleCount);
+
+    //!<  Size of the work buffer to pass to <tt>Initialize()</tt>.
+    static std::size_t GetRequiredWorkBufferSize(int blockSize, int impulseSampleCountMax);
+
+    /**
+    * @brief  Prepares a convolver for impulse responses of up to impulseSampleCountMax samples.
+    *
+    *  The work buffer holds the spectra of the impulse and of the input history and must stay valid while the
+    *  convolver is in use. It needs no particular alignment. The impulse is silent until <tt>SetImpulse()</tt>.
+    */
+    void Initialize(void* workBuffer, std::size_t workBufferSize, int blockSize, int impulseSampleCountMax);
+
+    /**
+    * @brief  Replaces the impulse response.
+    *
+    *  Reads sampleCount samples, stride apart, so one channel of interleaved data can be passed directly. Samples
+    *  beyond impulseSampleCountMax are ignored. Each sample is scaled by gain. This transforms every partition, so it
+    *  belongs in the update, not in the audio frame. The input history is kept.
+    */
+    void SetImpulse(const float* pSamples, int sampleCount, int stride, float gain);
+    void SetImpulse(const int16_t* pSamples, int sampleCount, int stride, float gain);
+
+    //!<  Clears the input history, so the tail of earlier input stops.
+    void Reset();
+
+    //!<  Convolves one block. pOut may equal pIn.
+    void Process(float* pOut, const float* pIn);
+
+    int GetBlockSize() const { return m_BlockSize; }
+
+    //!<  Partitions of the current impulse response, which is what the cost of Process() is proportional to.
+    int GetPartitionCount() const { return m_PartitionCount; }
+
+private:
+    template <typename T>
+    void SetImpulseImpl(const T* pSamples, int sampleCount, int stride, float gain);
+
+    float* GetInputSpectrum(int index) const { return m_pInputSpectra + static_cast<std::size_t>(index) * m_BinCount * 2; }
+    float* GetImpulseSpectrum(int index) const { return m_pImpulseSpectra + static_cast<std::size_t>(index) * m_BinCount * 2; }
+
+    RealFft m_Fft;
+    int m_BlockSize;
+    int m_FftSize;
+    int m_BinCount;                     //!<  FftSize / 2; each spectrum is this many real parts followed by as many imaginary parts.
+    int m_PartitionCountMax;
+    int m_PartitionCount;
+    int m_Head;                         //!<  Slot of the newest input spectrum.
+    float* m_pInput;                    //!<  The last FftSize input samples.
+    float* m_pTime;                     //!<  FftSize samples of scratch.
+    float* m_pAccumulator;              //!<  One spectrum.
+    float* m_pInputSpectra;             //!<  Ring of m_PartitionCountMax spectra.
+    float* m_pImpulseSpectra;           //!<  m_PartitionCountMax spectra, scaled by 1 / FftSize for the unnormalized inverse FFT.
+};
+
+}
@@ -0,0 +1,191 @@
+#include "AudioDspFft.h"
+
+#include <cmath>
+#include <cstdint>
+
+namespace AudioDsp {
+
+namespace {
+
+const double Pi = 3.14159265358979323846;
+
+const std::size_t ArrayAlignment = 16;
+
+std::size_t AlignUp(std::size_t value, std::size_t alignment)
+{
+    return (value + alignment - 1) & ~(alignment - 1);
+}
+
+template <typename T>
+T* AllocateArray(uintptr_t* pCursor, int count)
+{
+    *pCursor = AlignUp(*pCursor, ArrayAlignment);
+    T* p = reinterpret_cast<T*>(*pCursor);
+    *pCursor += sizeof(T) * count;
+    return p;
+}
+
+bool IsValidSize(int size)
+{
+    return size >= RealFft::SizeMin && (size & (size - 1)) == 0;
+}
+
+}
+
+RealFft::RealFft()
+    : m_Size(0)
+    , m_pData(nullptr)
+    , m_pTwiddles(nullptr)
+    , m_pRealTwiddles(nullptr)
+    , m_pBitReverse(nullptr)
+{
+}
+
+std::size_t RealFft::GetRequiredWorkBufferSize(int size)
+{
+    if (!IsValidSize(size))
+    {
+        return 0;
+    }
+    return ArrayAlignment - 1
+         + AlignUp(size * sizeof(float), ArrayAlignment)
+         + AlignUp(size / 2 * sizeof(float), ArrayAlignment)
+         + AlignUp(size * sizeof(float), ArrayAlignment)
+         + AlignUp(size / 2 * sizeof(int), ArrayAlignment);
+}
+
+void RealFft::Initialize(void* workBuffer, std::size_t workBufferSize, int size)
+{
+    if (workBuffer == nullptr || !IsValidSize(size) || workBufferSize < GetRequiredWorkBufferSize(size))
+    {
+        m_Size = 0;
+        return;
+    }
+
+    const int complexSize = size / 2;
+    uintptr_t cursor = reinterpret_cast<uintptr_t>(workBuffer);
+    m_Size = size;
+    m_pData = AllocateArray<float>(&cursor, size);
+    m_pTwiddles = AllocateArray<float>(&cursor, complexSize);
+    m_pRealTwiddles = AllocateArray<float>(&cursor, size);
+    m_pBitReverse = AllocateArray<int>(&cursor, complexSize);
+
+    for (int k = 0; k < complexSize / 2; ++k)
+    {
+        m_pTwiddles[2 * k] = static_cast<float>(std::cos(2.0 * Pi * k / complexSize));
+        m_pTwiddles[2 * k + 1] = static_cast<float>(std::sin(2.0 * Pi * k / complexSize));
+    }
+    for (int k = 0; k < complexSize; ++k)
+    {
+        m_pRealTwiddles[2 * k] = static_cast<float>(std::cos(2.0 * Pi * k / size));
+        m_pRealTwiddles[2 * k + 1] = static_cast<float>(std::sin(2.0 * Pi * k / size));
+    }
+
+    int bitCount = 0;
+    while ((1 << bitCount) < complexSize)
+    {
+        ++bitCount;
+    }
+    for (int i = 0; i < complexSize; ++i)
+    {
+        int reversed = 0;
+        for (int b = 0; b < bitCount; ++b)
+        {
+            reversed |= ((i >> b) & 1) << (bitCount - 1 - b);
+        }
+        m_pBitReverse[i] = reversed;
+    }
+}
+
+void RealFft::Forward(float* pOutReal, float* pOutImag, const float* pInput)
+{
+    const int complexSize = m_Size / 2;
+
+    // Even samples become the real parts and odd samples the imaginary parts.
+    for (int i = 0; i < complexSize; ++i)
+    {
+        const int source = m_pBitReverse[i];
+        m_pData[2 * i] = pInput[2 * source];
+        m_pData[2 * i + 1] = pInput[2 * source + 1];
+    }
+    Transform(false);
+
+    // Bin k of the even and odd halves follow from bins k and complexSize - k of the complex transform.
+    pOutReal[0] = m_pData[0] + m_pData[1];
+    pOutImag[0] = m_pData[0] - m_pData[1];
+    for (int k = 1; k < complexSize; ++k)
+    {
+        const float zr = m_pData[2 * k];
+        const float zi = m_pData[2 * k + 1];
+        const float wr = m_pData[2 * (complexSize - k)];
+        const float wi = m_pData[2 * (complexSize - k) + 1];
+        const float evenReal = 0.5f * (zr + wr);
+        const float evenImag = 0.5f * (zi - wi);
+        const float oddReal = 0.5f * (zi + wi);
+        const float oddImag = 0.5f * (wr - zr);
+        const float c = m_pRealTwiddles[2 * k];
+        const float s = m_pRealTwiddles[2 * k + 1];
+        pOutReal[k] = evenReal + c * oddReal + s * oddImag;
+        pOutImag[k] = evenImag + c * oddImag - s * oddReal;
+    }
+}
+
+void RealFft::Inverse(float* pOutput, const float* pReal, const float* pImag)
+{
+    const int complexSize = m_Size / 2;
+
+    // The reverse of the separation in Forward(), unscaled, written straight into bit-reversed order.
+    m_pData[0] = pReal[0] + pImag[0];
+    m_pData[1] = pReal[0] - pImag[0];
+    for (int k = 1; k < complexSize; ++k)
+    {
+        const float xr = pReal[k];
+        const float xi = pImag[k];
+        const float yr = pReal[complexSize - k];
+        const float yi = pImag[complexSize - k];
+        const float differenceReal = xr - yr;
+        const float differenceImag = xi + yi;
+        const float c = m_pRealTwiddles[2 * k];
+        const float s = m_pRealTwiddles[2 * k + 1];
+        const float oddReal = differenceReal * c - differenceImag * s;
+        const float oddImag = differenceReal * s + differenceImag * c;
+        const int target = m_pBitReverse[k];
+        m_pData[2 * target] = (xr + yr) - oddImag;
+        m_pData[2 * target + 1] = (xi - yi) + oddReal;
+    }
+    Transform(true);
+
+    for (int i = 0; i < m_Size; ++i)
+    {
+        pOutput[i] = m_pData[i];
+    }
+}
+
+void RealFft::Transform(bool isInverse)
+{
+    const int complexSize = m_Size / 2;
+    const float sign = isInverse ? 1.0f : -1.0f;
+    for (int length = 2; length <= complexSize; length <<= 1)
+    {
+        const int half = length / 2;
+        const int twiddleStep = complexSize / length;
+        for (int start = 0; start < complexSize; start += length)
+        {
+            float* pA = m_pData + 2 * start;
+            float* pB = pA + 2 * half;
+            for (int j = 0; j < half; ++j)
+            {
+                const float c = m_pTwiddles[2 * j * twiddleStep];
+                const float s = sign * m_pTwiddles[2 * j * twiddleStep + 1];
+                const float tr = pB[2 * j] * c - pB[2 * j + 1] * s;
+                const float ti = pB[2 * j] * s + pB[2 * j + 1] * c;
+                pB[2 * j] = pA[2 * j] - tr;
+                pB[2 * j + 1] = pA[2 * j + 1] - ti;
+                pA[2 * j] += tr;
+                pA[2 * j + 1] += ti;
+            }
+        }
+    }
+}
+
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+/**
+* @brief
+*  Power-of-two FFT of real signals.
+*
+*  A real signal of <tt>size</tt> samples is transformed as a complex signal of half the size, followed by one pass
+*  that separates the even and odd samples again. Spectra are kept in split form, one array of real parts and one of
+*  imaginary parts, so they can be multiplied four bins at a time with <tt>AudioDsp::Float4</tt>. Bins 0 and size / 2
+*  are both real; the second is stored in the imaginary part of bin 0, so each array holds exactly size / 2 values.
+*
+*  The transforms are not normalized: <tt>Inverse(Forward(x))</tt> is <tt>size * x</tt>.
+*/
+
+#include <cstddef>
+
+namespace AudioDsp {
+
+class RealFft
+{
+public:
+    static const int SizeMin = 8;
+
+    RealFft();
+
+    //!<  Size of the work buffer to pass to <tt>Initialize()</tt>.
+    static std::size_t GetRequiredWorkBufferSize(int size);
+
+    /**
+    * @brief  Prepares the tables for a transform of size samples, a power of two of at least SizeMin.
+    *
+    *  The work buffer holds the tables and the scratch of the transforms and must stay valid while the FFT is in use.
+    *  It needs no particular alignment.
+    */
+    void Initialize(void* workBuffer, std::size_t workBufferSize, int size);
+
+    int GetSize() const { return m_Size; }
+
+    //!<  Transforms size samples into size / 2 packed bins. The output arrays must not overlap the input.
+    void Forward(float* pOutReal, float* pOutImag, const float* pInput);
+
+    //!<  Transforms size / 2 packed bins back into size samples, scaled by size.
+    void Inverse(float* pOutput, const float* pReal, const float* pImag);
+
+private:
+    //!<  In-place complex FFT of m_pData, in bit-reversed order on input. The inverse uses the conjugate twiddles.
+    void Transform(bool isInverse);
+
+    int m_Size;
+    float* m_pData;                 //!<  size / 2 interleaved complex values.
+    float* m_pTwiddles;             //!<  cos and sin of 2 pi k / (size / 2), interleaved, for k below size / 4.
+    float* m_pRealTwiddles;         //!<  cos and sin of 2 pi k / size, interleaved, for k below size / 2.
+    int* m_pBitReverse;             //!<  size / 2 indices.
+};
+
+}
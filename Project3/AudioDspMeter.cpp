@@ -0,0 +1,288 @@
+#include "AudioDspMeter.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "AudioDspSimd.h"
+
+namespace AudioDsp {
+
+namespace {
+
+const float FullScale = 32768.0f;
+const int BlocksPerSecond = 10;
+
+// Loudness of a full-scale 997 Hz sine on one channel is -3.01 LUFS with this offset.
+const double LoudnessOffset = -0.691;
+
+// Stage 1 of the K-weighting, a high shelf modelling the head, and stage 2, the RLB high-pass, as in BS.1770.
+// The analog prototypes are mapped to sampleRate with the bilinear transform, which reproduces the 48 kHz
+// coefficients of the standard and keeps the response at other rates.
+void DesignKWeighting(BiquadCoefficients* pOutShelf, BiquadCoefficients* pOutHighPass, double sampleRate)
+{
+    const double pi = 3.14159265358979323846;
+    {
+        const double frequency = 1681.974450955533;
+        const double gainDb = 3.999843853973347;
+        const double q = 0.7071752369554196;
+        const double k = std::tan(pi * frequency / sampleRate);
+        const double vh = std::pow(10.0, gainDb / 20.0);
+        const double vb = std::pow(vh, 0.4996667741545416);
+        const double a0 = 1.0 + k / q + k * k;
+        pOutShelf->b0 = static_cast<float>((vh + vb * k / q + k * k) / a0);
+        pOutShelf->b1 = static_cast<float>(2.0 * (k * k - vh) / a0);
+        pOutShelf->b2 = static_cast<float>((vh - vb * k / q + k * k) / a0);
+        pOutShelf->a1 = static_cast<float>(2.0 * (k * k - 1.0) / a0);
+        pOutShelf->a2 = static_cast<float>((1.0 - k / q + k * k) / a0);
+    }
+    {
+        const double frequency = 38.13547087602444;
+        const double q = 0.5003270373238773;
+        const double k = std::tan(pi * frequency / sampleRate);
+        const double a0 = 1.0 + k / q + k * k;
+        pOutHighPass->b0 = 1.0f;
+        pOutHighPass->b1 = -2.0f;
+        pOutHighPass->b2 = 1.0f;
+        pOutHighPass->a1 = static_cast<float>(2.0 * (k * k - 1.0) / a0);
+        pOutHighPass->a2 = static_cast<float>((1.0 - k / q + k * k) / a0);
+    }
+}
+
+float ToDb(double power)
+{
+    return power > 0.0 ? std::max(static_cast<float>(10.0 * std::log10(power)), Meter::SilenceDb) : Meter::SilenceDb;
+}
+
+}
+
+const float Meter::SilenceDb = -120.0f;
+
+Meter::Meter()
+    : m_ChannelCount(0)
+    , m_BlockSampleCount(0)
+    , m_BlockSampleCountDone(0)
+    , m_HistoryIndex(0)
+    , m_PeakMax(0.0f)
+    , m_ClipCount(0)
+    , m_BlockCount(0)
+    , m_Sequence(0)
+{
+    MeterReading reading = {};
+    Publish(reading);
+}
+
+void Meter::Initialize(int channelCount, int sampleRate)
+{
+    MeterReading reading = {};
+    if (channelCount <= 0 || channelCount > MeterChannelCountMax || sampleRate < BlocksPerSecond)
+    {
+        // Leave the meter without channels; Process() does nothing.
+        m_ChannelCount = 0;
+        Publish(reading);
+        return;
+    }
+
+    m_ChannelCount = channelCount;
+    m_BlockSampleCount = sampleRate / BlocksPerSecond;
+    m_BlockSampleCountDone = 0;
+
+    BiquadCoefficients shelf;
+    BiquadCoefficients highPass;
+    DesignKWeighting(&shelf, &highPass, sampleRate);
+    for (int c = 0; c < channelCount; ++c)
+    {
+        m_Weights[c] = 1.0f;
+        m_KWeighting[c].Reset();
+        m_KWeighting[c].SetSection(0, shelf);
+        m_KWeighting[c].SetSection(1, highPass);
+        m_BlockPeak[c] = 0.0f;
+        m_BlockPower[c] = 0.0f;
+        m_BlockWeightedPower[c] = 0.0f;
+    }
+    if (channelCount == 6)
+    {
+        m_Weights[3] = 0.0f;
+        m_Weights[4] = 1.41f;
+        m_Weights[5] = 1.41f;
+    }
+    for (int i = 0; i < ShortTermBlockCount; ++i)
+    {
+        m_History[i] = 0.0f;
+    }
+    m_HistoryIndex = 0;
+    m_PeakMax = 0.0f;
+    m_ClipCount = 0;
+    m_BlockCount = 0;
+
+    reading.channelCount = channelCount;
+    for (int c = 0; c < channelCount; ++c)
+    {
+        reading.peakDb[c] = SilenceDb;
+        reading.rmsDb[c] = SilenceDb;
+    }
+    reading.momentaryLufs = SilenceDb;
+    reading.shortTermLufs = SilenceDb;
+    reading.peakMaxDb = SilenceDb;
+    Publish(reading);
+}
+
+void Meter::Process(const int32_t* pSamples, int sampleCount)
+{
+    if (m_ChannelCount == 0)
+    {
+        return;
+    }
+
+    const Float4 clipLevel = Set4(FullScale);
+    const Float4 one = Set4(1.0f);
+    const Float4 zero = Set4(0.0f);
+    int offset = 0;
+    while (offset < sampleCount)
+    {
+        // Never past the end of the block, so each block is measured on its own samples.
+        const int count = std::min(std::min(sampleCount - offset, m_BlockSampleCount - m_BlockSampleCountDone), static_cast<int>(ChunkSampleCount));
+        for (int c = 0; c < m_ChannelCount; ++c)
+        {
+            const int32_t* pIn = pSamples + static_cast<std::size_t>(c) * sampleCount + offset;
+            float filtered[ChunkSampleCount];
+            Float4 peak = zero;
+            Float4 power = zero;
+            Float4 clips = zero;
+            int n = 0;
+            for (; n + SimdWidth <= count; n += SimdWidth)
+            {
+                const Float4 x = LoadInt32x4(pIn + n);
+                const Float4 magnitude = Abs4(x);
+                Store4(filtered + n, x);
+                peak = Max4(peak, magnitude);
+                power = MulAdd4(power, x, x);
+                clips = Add4(clips, SelectNonNegative4(Sub4(magnitude, clipLevel), one, zero));
+            }
+            float peakSum = HorizontalMax4(peak);
+            float powerSum = HorizontalAdd4(power);
+            uint32_t clipCount = static_cast<uint32_t>(HorizontalAdd4(clips));
+            for (; n < count; ++n)
+            {
+                const float x = static_cast<float>(pIn[n]);
+                filtered[n] = x;
+                peakSum = std::max(peakSum, std::fabs(x));
+                powerSum += x * x;
+                clipCount += std::fabs(x) >= FullScale ? 1 : 0;
+            }
+
+            m_KWeighting[c].Process(filtered, count);
+            Float4 weightedPower = zero;
+            n = 0;
+            for (; n + SimdWidth <= count; n += SimdWidth)
+            {
+                const Float4 y = Load4(filtered + n);
+                weightedPower = MulAdd4(weightedPower, y, y);
+            }
+            float weightedPowerSum = HorizontalAdd4(weightedPower);
+            for (; n < count; ++n)
+            {
+                weightedPowerSum += filtered[n] * filtered[n];
+            }
+
+            m_BlockPeak[c] = std::max(m_BlockPeak[c], peakSum);
+            m_BlockPower[c] += powerSum;
+            m_BlockWeightedPower[c] += weightedPowerSum;
+            m_ClipCount += clipCount;
+        }
+
+        offset += count;
+        m_BlockSampleCountDone += count;
+        if (m_BlockSampleCountDone == m_BlockSampleCount)
+        {
+            EndBlock();
+        }
+    }
+}
+
+void Meter::EndBlock()
+{
+    MeterReading reading;
+    reading.channelCount = m_ChannelCount;
+    const double fullScalePower = double(FullScale) * FullScale;
+    double weightedMeanSquare = 0.0;
+    for (int c = 0; c < m_ChannelCount; ++c)
+    {
+        reading.peakDb[c] = ToDb(double(m_BlockPeak[c]) * m_BlockPeak[c] / fullScalePower);
+        reading.rmsDb[c] = ToDb(m_BlockPower[c] / m_BlockSampleCount / fullScalePower);
+        weightedMeanSquare += m_Weights[c] * m_BlockWeightedPower[c] / m_BlockSampleCount / fullScalePower;
+        m_PeakMax = std::max(m_PeakMax, m_BlockPeak[c]);
+        m_BlockPeak[c] = 0.0f;
+        m_BlockPower[c] = 0.0f;
+        m_BlockWeightedPower[c] = 0.0f;
+    }
+    m_BlockSampleCountDone = 0;
+
+    m_History[m_HistoryIndex] = static_cast<float>(weightedMeanSquare);
+    m_HistoryIndex = (m_HistoryIndex + 1) % ShortTermBlockCount;
+    ++m_BlockCount;
+
+    // Until the windows fill, they cover the blocks measured so far.
+    double sum = 0.0;
+    for (int i = 1; i <= ShortTermBlockCount && static_cast<uint32_t>(i) <= m_BlockCount; ++i)
+    {
+        sum += m_History[(m_HistoryIndex - i + ShortTermBlockCount) % ShortTermBlockCount];
+        if (i == MomentaryBlockCount || (i < MomentaryBlockCount && static_cast<uint32_t>(i) == m_BlockCount))
+        {
+            reading.momentaryLufs = static_cast<float>(LoudnessOffset) + ToDb(sum / i);
+        }
+        reading.shortTermLufs = static_cast<float>(LoudnessOffset) + ToDb(sum / i);
+    }
+    reading.peakMaxDb = ToDb(double(m_PeakMax) * m_PeakMax / fullScalePower);
+    reading.clipCount = m_ClipCount;
+    reading.blockCount = m_BlockCount;
+    Publish(reading);
+}
+
+void Meter::Publish(const MeterReading& reading)
+{
+    const uint32_t sequence = m_Sequence.load(std::memory_order_relaxed);
+    m_Sequence.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    for (int c = 0; c < MeterChannelCountMax; ++c)
+    {
+        m_PublishedPeakDb[c].store(c < reading.channelCount ? reading.peakDb[c] : SilenceDb, std::memory_order_relaxed);
+        m_PublishedRmsDb[c].store(c < reading.channelCount ? reading.rmsDb[c] : SilenceDb, std::memory_order_relaxed);
+    }
+    m_PublishedMomentaryLufs.store(reading.momentaryLufs, std::memory_order_relaxed);
+    m_PublishedShortTermLufs.store(reading.shortTermLufs, std::memory_order_relaxed);
+    m_PublishedPeakMaxDb.store(reading.peakMaxDb, std::memory_order_relaxed);
+    m_PublishedClipCount.store(reading.clipCount, std::memory_order_relaxed);
+    m_PublishedBlockCount.store(reading.blockCount, std::memory_order_relaxed);
+    m_Sequence.store(sequence + 2, std::memory_order_release);
+}
+
+void Meter::Read(MeterReading* pOutReading) const
+{
+    for (;;)
+    {
+        // The writer holds the sequence odd for a few stores only, so spinning on it is brief.
+        const uint32_t sequence = m_Sequence.load(std::memory_order_acquire);
+        if ((sequence & 1) != 0)
+        {
+            continue;
+        }
+        pOutReading->channelCount = m_ChannelCount;
+        for (int c = 0; c < MeterChannelCountMax; ++c)
+        {
+            pOutReading->peakDb[c] = m_PublishedPeakDb[c].load(std::memory_order_relaxed);
+            pOutReading->rmsDb[c] = m_PublishedRmsDb[c].load(std::memory_order_relaxed);
+        }
+        pOutReading->momentaryLufs = m_PublishedMomentaryLufs.load(std::memory_order_relaxed);
+        pOutReading->shortTermLufs = m_PublishedShortTermLufs.load(std::memory_order_relaxed);
+        pOutReading->peakMaxDb = m_PublishedPeakMaxDb.load(std::memory_order_relaxed);
+        pOutReading->clipCount = m_PublishedClipCount.load(std::memory_order_relaxed);
+        pOutReading->blockCount = m_PublishedBlockCount.load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (m_Sequence.load(std::memory_order_relaxed) == sequence)
+        {
+            return;
+        }
+    }
+}
+
+}
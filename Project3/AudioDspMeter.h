@@ -0,0 +1,101 @@
+#pragma once
+
+/**
+* @brief
+*  Peak, RMS, and loudness meter for one bus, written by the audio thread and read from any thread.
+*
+*  Samples are measured in blocks of 100 ms. For each block the meter keeps the peak and RMS of every channel and the
+*  K-weighted power of the bus, from which it derives the momentary (400 ms) and short-term (3 s) loudness of
+*  ITU-R BS.1770 in LUFS, without gating. Samples are in 16-bit units, so full scale is 32768, and mix buffers may go
+*  past it before the sink saturates them: a peak at or above 0 dBFS is headroom the mix does not have, and every such
+*  sample is counted as a clip.
+*
+*  Each group of four samples costs a few <tt>AudioDsp::Float4</tt> operations for the peak, the power, and the clip
+*  count, and the K-weighting filter runs as a block biquad cascade. At the end of a block the meter publishes a
+*  <tt>MeterReading</tt> under a sequence counter: <tt>Read()</tt> copies it without a lock and retries only if a
+*  block ended during the copy, so a UI or metrics thread never delays the audio thread.
+*/
+
+#include <atomic>
+#include <cstdint>
+
+#include "AudioDspBiquad.h"
+
+namespace AudioDsp {
+
+const int MeterChannelCountMax = 6;
+
+struct MeterReading
+{
+    int channelCount;
+    float peakDb[MeterChannelCountMax];     //!<  Largest sample of the last block, in dBFS.
+    float rmsDb[MeterChannelCountMax];      //!<  Over the last block, in dBFS.
+    float momentaryLufs;                    //!<  Over the last four blocks.
+    float shortTermLufs;                    //!<  Over the last thirty blocks.
+    float peakMaxDb;                        //!<  Largest sample since <tt>Initialize()</tt>, in dBFS.
+    uint32_t clipCount;                     //!<  Samples at or past full scale since <tt>Initialize()</tt>.
+    uint32_t blockCount;                    //!<  Blocks measured; a reading is new when this changes.
+};
+
+class Meter
+{
+public:
+    //!<  Level reported for silence, and the floor of every level.
+    static const float SilenceDb;
+
+    static const int ShortTermBlockCount = 30;
+    static const int MomentaryBlockCount = 4;
+
+    Meter();
+
+    /**
+    * @brief  Prepares a meter for channelCount channels at sampleRate and clears its reading.
+    *
+    *  Channels are in nn::audio::ChannelMapping order. With six, the LFE channel is left out of the loudness and the
+    *  rear pair is weighted by +1.5 dB, as BS.1770 specifies.
+    */
+    void Initialize(int channelCount, int sampleRate);
+
+    /**
+    * @brief  Measures sampleCount samples of each channel. Call from one thread only.
+    *
+    *  Channel c starts at pSamples + c * sampleCount, which is the layout of one audio frame in an aux send buffer.
+    */
+    void Process(const int32_t* pSamples, int sampleCount);
+
+    //!<  Copies the reading of the last complete block. Safe from any thread.
+    void Read(MeterReading* pOutReading) const;
+
+private:
+    // Samples filtered at a time, on the stack.
+    static const int ChunkSampleCount = 256;
+
+    void EndBlock();
+    void Publish(const MeterReading& reading);
+
+    int m_ChannelCount;
+    int m_BlockSampleCount;
+    int m_BlockSampleCountDone;
+    float m_Weights[MeterChannelCountMax];                  //!<  Loudness weight of each channel.
+    BiquadCascade m_KWeighting[MeterChannelCountMax];
+    float m_BlockPeak[MeterChannelCountMax];
+    float m_BlockPower[MeterChannelCountMax];               //!<  Sum of squares.
+    float m_BlockWeightedPower[MeterChannelCountMax];       //!<  Sum of squares after K-weighting.
+    float m_History[ShortTermBlockCount];                   //!<  Weighted mean square of each recent block, oldest first from m_HistoryIndex.
+    int m_HistoryIndex;
+    float m_PeakMax;
+    uint32_t m_ClipCount;
+    uint32_t m_BlockCount;
+
+    // The published reading. Each field is atomic so a copy that races a block end is a retry, not a data race.
+    std::atomic<uint32_t> m_Sequence;                       //!<  Odd while a reading is being written.
+    std::atomic<float> m_PublishedPeakDb[MeterChannelCountMax];
+    std::atomic<float> m_PublishedRmsDb[MeterChannelCountMax];
+    std::atomic<float> m_PublishedMomentaryLufs;
+    std::atomic<float> m_PublishedShortTermLufs;
+    std::atomic<float> m_PublishedPeakMaxDb;
+    std::atomic<uint32_t> m_PublishedClipCount;
+    std::atomic<uint32_t> m_PublishedBlockCount;
+};
+
+}
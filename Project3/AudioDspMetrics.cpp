@@ -0,0 +1,342 @@
+#include "AudioDspMetrics.h"
+
+#include <cmath>
+#include <cstdarg>
+#include <cstdio>
+
+namespace AudioDsp {
+
+namespace {
+
+// Bins per octave of the histograms.
+const float BinsPerOctave = 4.0f;
+
+// Writes formatted text after what is already in a buffer and keeps the length snprintf() would report.
+class TextWriter
+{
+public:
+    TextWriter(char* buffer, std::size_t bufferSize)
+        : m_Buffer(buffer)
+        , m_BufferSize(bufferSize)
+        , m_Length(0)
+    {
+        if (bufferSize > 0)
+        {
+            buffer[0] = '\0';
+        }
+    }
+
+    void Append(const char* format, ...)
+    {
+        const std::size_t offset = m_Length < m_BufferSize ? m_Length : m_BufferSize;
+        va_list args;
+        va_start(args, format);
+        const int length = std::vsnprintf(m_Buffer + offset, m_BufferSize - offset, format, args);
+        va_end(args);
+        m_Length += length > 0 ? length : 0;
+    }
+
+    int GetLength() const { return static_cast<int>(m_Length); }
+
+private:
+    char* m_Buffer;
+    std::size_t m_BufferSize;
+    std::size_t m_Length;
+};
+
+}
+
+const float RenderMetrics::BinFirstEdge = 0.25f;
+
+RenderMetrics::RenderMetrics()
+{
+    Initialize(0, 1);
+}
+
+void RenderMetrics::Initialize(int sampleCount, int sampleRate)
+{
+    m_BudgetUs = 1.0e6f * sampleCount / sampleRate;
+    m_FrameCount = 0;
+    m_OverrunCount = 0;
+    for (int h = 0; h < HistogramCount; ++h)
+    {
+        m_FrameTimes[h] = 0.0f;
+        for (int b = 0; b < BinCount; ++b)
+        {
+            m_Histogram[h][b] = 0;
+        }
+    }
+    m_WindowFrameCount = 0;
+    m_WindowHead = 0;
+    for (int i = 0; i < VoiceTableSize; ++i)
+    {
+        m_Voices[i].frameCount = 0;
+    }
+    m_VoiceCount = 0;
+    m_VoiceFrameCount = 0;
+    m_DroppedVoiceCount = 0;
+    m_ReportedVoiceCount = 0;
+    m_ReportedDroppedVoiceCount = 0;
+    m_LabelCount = 0;
+}
+
+void RenderMetrics::SetLabel(uint32_t nodeId, const char* label)
+{
+    for (int i = 0; i < m_LabelCount; ++i)
+    {
+        if (m_Labels[i].nodeId == nodeId)
+        {
+            m_Labels[i].label = label;
+            return;
+        }
+    }
+    if (m_LabelCount < LabelCountMax)
+    {
+        m_Labels[m_LabelCount].nodeId = nodeId;
+        m_Labels[m_LabelCount].label = label;
+        ++m_LabelCount;
+    }
+}
+
+const char* RenderMetrics::GetLabel(uint32_t nodeId) const
+{
+    for (int i = 0; i < m_LabelCount; ++i)
+    {
+        if (m_Labels[i].nodeId == nodeId)
+        {
+            return m_Labels[i].label;
+        }
+    }
+    return nullptr;
+}
+
+void RenderMetrics::BeginFrame()
+{
+    for (int h = 0; h < HistogramCount; ++h)
+    {
+        m_FrameTimes[h] = 0.0f;
+    }
+}
+
+void RenderMetrics::AddEntry(MetricsNodeType type, uint32_t nodeId, float processingTimeUs)
+{
+    m_FrameTimes[type] += processingTimeUs;
+    if (type != MetricsNodeType_Voice)
+    {
+        return;
+    }
+
+    const int slot = FindVoiceSlot(nodeId);
+    if (slot < 0)
+    {
+        ++m_DroppedVoiceCount;
+        return;
+    }
+    VoiceCost& voice = m_Voices[slot];
+    ++voice.frameCount;
+    voice.totalUs += processingTimeUs;
+    voice.maxUs = processingTimeUs > voice.maxUs ? processingTimeUs : voice.maxUs;
+}
+
+void RenderMetrics::EndFrame(float totalProcessingTimeUs, bool isTimeLimitExceeded)
+{
+    m_FrameTimes[HistogramTotal] = totalProcessingTimeUs;
+
+    // The ring keeps the evicted frame's times, so its bins are found the same way they were added.
+    float* pSlot = m_WindowTimes[m_WindowHead];
+    if (m_WindowFrameCount == WindowFrameCount)
+    {
+        for (int h = 0; h < HistogramCount; ++h)
+        {
+            --m_Histogram[h][GetBin(pSlot[h])];
+        }
+    }
+    else
+    {
+        ++m_WindowFrameCount;
+    }
+    for (int h = 0; h < HistogramCount; ++h)
+    {
+        pSlot[h] = m_FrameTimes[h];
+        ++m_Histogram[h][GetBin(pSlot[h])];
+    }
+    m_WindowHead = (m_WindowHead + 1) % WindowFrameCount;
+
+    ++m_FrameCount;
+    if (isTimeLimitExceeded)
+    {
+        ++m_OverrunCount;
+    }
+    if (++m_VoiceFrameCount == WindowFrameCount)
+    {
+        CompleteWindow();
+    }
+}
+
+void RenderMetrics::GetSummary(Summary* pOutSummary, int histogram) const
+{
+    pOutSummary->frameCount = m_WindowFrameCount;
+    pOutSummary->meanUs = 0.0f;
+    pOutSummary->p50Us = 0.0f;
+    pOutSummary->p95Us = 0.0f;
+    pOutSummary->p99Us = 0.0f;
+    pOutSummary->maxUs = 0.0f;
+    if (m_WindowFrameCount == 0)
+    {
+        return;
+    }
+
+    double sum = 0.0;
+    for (int i = 0; i < m_WindowFrameCount; ++i)
+    {
+        const float time = m_WindowTimes[i][histogram];
+        sum += time;
+        pOutSummary->maxUs = time > pOutSummary->maxUs ? time : pOutSummary->maxUs;
+    }
+    pOutSummary->meanUs = static_cast<float>(sum / m_WindowFrameCount);
+
+    const float fractions[3] = { 0.50f, 0.95f, 0.99f };
+    float* const pPercentiles[3] = { &pOutSummary->p50Us, &pOutSummary->p95Us, &pOutSummary->p99Us };
+    for (int p = 0; p < 3; ++p)
+    {
+        const int rank = static_cast<int>(std::ceil(fractions[p] * m_WindowFrameCount));
+        int count = 0;
+        int bin = 0;
+        while (bin < BinCount - 1 && (count += m_Histogram[histogram][bin]) < rank)
+        {
+            ++bin;
+        }
+        *pPercentiles[p] = GetBinEdge(bin);
+    }
+}
+
+int RenderMetrics::Dump(char* buffer, std::size_t bufferSize, const char* source) const
+{
+    TextWriter writer(buffer, bufferSize);
+    writer.Append("{\"schema\":1,\"source\":\"%s\",\"frame\":%lld,\"budgetUs\":%.2f,\"overruns\":%lld,\"windowFrames\":%d,\"nodes\":{",
+                  source, static_cast<long long>(m_FrameCount), m_BudgetUs, static_cast<long long>(m_OverrunCount), m_WindowFrameCount);
+    for (int h = 0; h < HistogramCount; ++h)
+    {
+        Summary summary;
+        GetSummary(&summary, h);
+        writer.Append("%s\"%s\":{\"meanUs\":%.2f,\"p50Us\":%.2f,\"p95Us\":%.2f,\"p99Us\":%.2f,\"maxUs\":%.2f,\"bins\":[",
+                      h > 0 ? "," : "", GetNodeTypeName(h), summary.meanUs, summary.p50Us, summary.p95Us, summary.p99Us, summary.maxUs);
+        const char* separator = "";
+        for (int b = 0; b < BinCount; ++b)
+        {
+            if (m_Histogram[h][b] > 0)
+            {
+                writer.Append("%s[%.2f,%d]", separator, GetBinEdge(b), m_Histogram[h][b]);
+                separator = ",";
+            }
+        }
+        writer.Append("]}");
+    }
+
+    // The shares are of all voice time in the window, so they add up to one.
+    double voiceTotal = 0.0;
+    for (int i = 0; i < m_ReportedVoiceCount; ++i)
+    {
+        voiceTotal += m_ReportedVoices[i].totalUs;
+    }
+    writer.Append("},\"voiceWindowFrames\":%d,\"droppedVoiceEntries\":%lld,\"voices\":[",
+                  m_ReportedVoiceCount > 0 ? WindowFrameCount : 0, static_cast<long long>(m_ReportedDroppedVoiceCount));
+    for (int i = 0; i < m_ReportedVoiceCount; ++i)
+    {
+        const VoiceCost& voice = GetVoiceCost(i);
+        const char* label = GetLabel(voice.nodeId);
+        writer.Append("%s{\"node\":%u,\"label\":\"%s\",\"frames\":%d,\"meanUs\":%.2f,\"maxUs\":%.2f,\"share\":%.4f}",
+                      i > 0 ? "," : "", static_cast<unsigned int>(voice.nodeId), label != nullptr ? label : "",
+                      voice.frameCount, voice.totalUs / voice.frameCount, voice.maxUs,
+                      voiceTotal > 0.0 ? voice.totalUs / voiceTotal : 0.0);
+    }
+    writer.Append("]}\n");
+    return writer.GetLength();
+}
+
+const char* RenderMetrics::GetNodeTypeName(int histogram)
+{
+    switch (histogram)
+    {
+    case MetricsNodeType_Voice:
+        return "voice";
+    case MetricsNodeType_SubMix:
+        return "subMix";
+    case MetricsNodeType_FinalMix:
+        return "finalMix";
+    case MetricsNodeType_Sink:
+        return "sink";
+    case MetricsNodeType_Effect:
+        return "effect";
+    case HistogramTotal:
+        return "total";
+    default:
+        return "unknown";
+    }
+}
+
+int RenderMetrics::GetBin(float timeUs)
+{
+    if (!(timeUs > BinFirstEdge))
+    {
+        return 0;
+    }
+    const int bin = static_cast<int>(std::ceil(BinsPerOctave * std::log2(timeUs / BinFirstEdge)));
+    return bin < BinCount - 1 ? bin : BinCount - 1;
+}
+
+float RenderMetrics::GetBinEdge(int bin)
+{
+    return BinFirstEdge * std::exp2(bin / BinsPerOctave);
+}
+
+int RenderMetrics::FindVoiceSlot(uint32_t nodeId)
+{
+    int slot = static_cast<int>((nodeId * 2654435761u) >> 25) & (VoiceTableSize - 1);
+    while (m_Voices[slot].frameCount > 0)
+    {
+        if (m_Voices[slot].nodeId == nodeId)
+        {
+            return slot;
+        }
+        slot = (slot + 1) & (VoiceTableSize - 1);
+    }
+    if (m_VoiceCount == VoiceCountMax)
+    {
+        return -1;
+    }
+    ++m_VoiceCount;
+    m_Voices[slot].nodeId = nodeId;
+    m_Voices[slot].totalUs = 0.0f;
+    m_Voices[slot].maxUs = 0.0f;
+    return slot;
+}
+
+void RenderMetrics::CompleteWindow()
+{
+    m_ReportedVoiceCount = 0;
+    for (int i = 0; i < VoiceTableSize; ++i)
+    {
+        if (m_Voices[i].frameCount == 0)
+        {
+            continue;
+        }
+        // Insertion by total time; the table holds at most VoiceCountMax voices.
+        const int index = m_ReportedVoiceCount++;
+        m_ReportedVoices[index] = m_Voices[i];
+        int position = index;
+        while (position > 0 && m_ReportedVoices[m_ReportedOrder[position - 1]].totalUs < m_Voices[i].totalUs)
+        {
+            m_ReportedOrder[position] = m_ReportedOrder[position - 1];
+            --position;
+        }
+        m_ReportedOrder[position] = index;
+        m_Voices[i].frameCount = 0;
+    }
+    m_ReportedDroppedVoiceCount = m_DroppedVoiceCount;
+    m_VoiceCount = 0;
+    m_VoiceFrameCount = 0;
+    m_DroppedVoiceCount = 0;
+}
+
+}
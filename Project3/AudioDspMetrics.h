@@ -0,0 +1,153 @@
+#pragma once
+
+/**
+* @brief
+*  Aggregates audio renderer performance frames into rolling histograms and a per-voice cost breakdown.
+*
+*  The console renderer and the host software mixer both report, for every audio frame, the processing time of each
+*  voice, sub mix, final mix, sink, and effect. Their adapters feed those entries to <tt>RenderMetrics</tt>, which keeps
+*  the same statistics for both, and <tt>RenderMetrics::Dump()</tt> writes them in one schema so console and host runs can
+*  be compared line by line.
+*
+*  Per node type, the time of all its nodes in a frame is summed and kept for the last <tt>WindowFrameCount</tt> frames
+*  in a histogram of quarter-octave bins. The per-voice breakdown covers the last complete window of
+*  <tt>WindowFrameCount</tt> frames. Nothing is allocated; adding an entry costs a hash probe.
+*/
+
+#include <cstddef>
+#include <cstdint>
+
+namespace AudioDsp {
+
+enum MetricsNodeType
+{
+    MetricsNodeType_Voice,
+    MetricsNodeType_SubMix,
+    MetricsNodeType_FinalMix,           //!<  Includes the effects of the final mix.
+    MetricsNodeType_Sink,
+    MetricsNodeType_Effect,
+    MetricsNodeType_Count
+};
+
+class RenderMetrics
+{
+public:
+    static const int WindowFrameCount = 200;        //!<  One second of 5 ms audio frames.
+    static const int BinCount = 64;
+    static const float BinFirstEdge;                 //!<  Upper edge of bin 0 in microseconds; each further bin is 2^(1/4) wider.
+    static const int VoiceCountMax = 96;             //!<  Voices tracked per window. Further voices count as dropped.
+    static const int LabelCountMax = 16;
+
+    //!<  The histograms: one per node type, and the total processing time of the frame.
+    static const int HistogramCount = MetricsNodeType_Count + 1;
+    static const int HistogramTotal = MetricsNodeType_Count;
+
+    //!<  Statistics of one histogram over the window. The percentiles are upper bin edges, so they err high by up to 19%.
+    struct Summary
+    {
+        int frameCount;
+        float meanUs;
+        float p50Us;
+        float p95Us;
+        float p99Us;
+        float maxUs;
+    };
+
+    //!<  One voice over the last complete window.
+    struct VoiceCost
+    {
+        uint32_t nodeId;
+        int frameCount;                 //!<  Frames the voice was rendered in.
+        float totalUs;
+        float maxUs;
+    };
+
+    RenderMetrics();
+
+    /**
+    * @brief  Clears all statistics.
+    *
+    *  sampleCount and sampleRate give the length of an audio frame, which is the time budget of a frame.
+    */
+    void Initialize(int sampleCount, int sampleRate);
+
+    //!<  Names a voice in the dump. label must stay valid; a label set again for the same nodeId replaces the old one.
+    void SetLabel(uint32_t nodeId, const char* label);
+
+    //!<  Starts a frame. Call AddEntry() for each entry of the frame and then EndFrame().
+    void BeginFrame();
+    void AddEntry(MetricsNodeType type, uint32_t nodeId, float processingTimeUs);
+    void EndFrame(float totalProcessingTimeUs, bool isTimeLimitExceeded);
+
+    int64_t GetFrameCount() const { return m_FrameCount; }
+
+    //!<  Frames the renderer reported as over its time limit, since Initialize().
+    int64_t GetOverrunCount() const { return m_OverrunCount; }
+
+    float GetBudget() const { return m_BudgetUs; }
+
+    //!<  histogram is a MetricsNodeType or HistogramTotal.
+    void GetSummary(Summary* pOutSummary, int histogram) const;
+
+    //!<  Number of voices in the breakdown; GetVoiceCost() returns them from the most to the least expensive.
+    int GetVoiceCostCount() const { return m_ReportedVoiceCount; }
+    const VoiceCost& GetVoiceCost(int index) const { return m_ReportedVoices[m_ReportedOrder[index]]; }
+
+    //!<  Label set for nodeId, or null.
+    const char* GetLabel(uint32_t nodeId) const;
+
+    /**
+    * @brief  Writes the statistics as one line of JSON, terminated by a newline.
+    *
+    *  source names the renderer, such as "nx" or "host". The output is cut at bufferSize - 1 characters and always
+    *  zero-terminated.
+    *
+    * @return  The length of the complete line, as snprintf() would return it.
+    */
+    int Dump(char* buffer, std::size_t bufferSize, const char* source) const;
+
+    static const char* GetNodeTypeName(int histogram);
+
+private:
+    static const int VoiceTableSize = 128;          //!<  Power of two above VoiceCountMax, for open addressing.
+
+    struct Label
+    {
+        uint32_t nodeId;
+        const char* label;
+    };
+
+    static int GetBin(float timeUs);
+    static float GetBinEdge(int bin);
+
+    //!<  The voice table slot for nodeId, or -1 if the table is full.
+    int FindVoiceSlot(uint32_t nodeId);
+
+    //!<  Publishes the voice table as the breakdown of the window just completed and clears it.
+    void CompleteWindow();
+
+    float m_BudgetUs;
+    int64_t m_FrameCount;
+    int64_t m_OverrunCount;
+
+    float m_FrameTimes[HistogramCount];                         //!<  Sums of the frame being added.
+    float m_WindowTimes[WindowFrameCount][HistogramCount];      //!<  Ring of the frame sums of the window.
+    int m_Histogram[HistogramCount][BinCount];
+    int m_WindowFrameCount;                                     //!<  Frames in the ring, up to WindowFrameCount.
+    int m_WindowHead;                                           //!<  Slot of the next frame.
+
+    VoiceCost m_Voices[VoiceTableSize];                         //!<  Open-addressed by nodeId; frameCount 0 marks a free slot.
+    int m_VoiceCount;
+    int m_VoiceFrameCount;                                      //!<  Frames of the window in m_Voices.
+    int64_t m_DroppedVoiceCount;
+
+    VoiceCost m_ReportedVoices[VoiceCountMax];
+    int m_ReportedOrder[VoiceCountMax];
+    int m_ReportedVoiceCount;
+    int64_t m_ReportedDroppedVoiceCount;
+
+    Label m_Labels[LabelCountMax];
+    int m_LabelCount;
+};
+
+}
@@ -0,0 +1,165 @@
+#pragma once
+
+/**
+* @brief
+*  Bounded lock-free queue with any number of producer threads and one consumer thread.
+*
+*  Each slot carries a sequence number that says whether it is free for the producer of a given position or holds the
+*  value for the consumer of that position. A producer claims a position with one compare-and-swap on the enqueue
+*  counter and publishes its value by storing the slot's sequence; the consumer reads slots in position order without
+*  any read-modify-write. No thread ever waits for another: a full queue refuses the value and counts it, and a
+*  slot that is claimed but not yet published ends the consumer's pass until the next one. Values from one producer
+*  are consumed in the order they were pushed.
+*
+*  The capacity is a power of two. T is copied in and out of the slots and should be a small plain struct.
+*/
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+
+namespace AudioDsp {
+
+template <typename T>
+class MpscQueue
+{
+public:
+    struct Slot
+    {
+        std::atomic<uint32_t> sequence;
+        T value;
+    };
+
+    MpscQueue()
+        : m_pSlots(nullptr)
+        , m_Mask(0)
+        , m_EnqueuePosition(0)
+        , m_DequeuePosition(0)
+        , m_OverflowCount(0)
+        , m_PeakCount(0)
+    {
+    }
+
+    //!<  Size of the slot array to pass to <tt>Initialize()</tt>.
+    static std::size_t GetRequiredWorkBufferSize(int capacity)
+    {
+        return sizeof(Slot) * capacity;
+    }
+
+    /**
+    * @brief  Prepares an empty queue of capacity slots in workBuffer.
+    *
+    *  capacity must be a power of two. The buffer must be aligned for Slot and stay valid while the queue is in use.
+    *  Call this before any thread uses the queue.
+    */
+    void Initialize(void* workBuffer, std::size_t workBufferSize, int capacity)
+    {
+        if (workBuffer == nullptr || capacity <= 0 || (capacity & (capacity - 1)) != 0 || workBufferSize < GetRequiredWorkBufferSize(capacity))
+        {
+            // Leave the queue without slots; every push overflows.
+            m_pSlots = nullptr;
+            m_Mask = 0;
+            return;
+        }
+        m_pSlots = static_cast<Slot*>(workBuffer);
+        m_Mask = static_cast<uint32_t>(capacity - 1);
+        for (int i = 0; i < capacity; ++i)
+        {
+            new (&m_pSlots[i].sequence) std::atomic<uint32_t>(static_cast<uint32_t>(i));
+        }
+        m_EnqueuePosition.store(0, std::memory_order_relaxed);
+        m_DequeuePosition = 0;
+        m_OverflowCount.store(0, std::memory_order_relaxed);
+        m_PeakCount = 0;
+    }
+
+    //!<  Appends a copy of value. Safe from any thread. Returns false, and counts an overflow, if the queue is full.
+    bool TryPush(const T& value)
+    {
+        if (m_pSlots == nullptr)
+        {
+            m_OverflowCount.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+
+        uint32_t position = m_EnqueuePosition.load(std::memory_order_relaxed);
+        Slot* pSlot;
+        for (;;)
+        {
+            pSlot = &m_pSlots[position & m_Mask];
+            const uint32_t sequence = pSlot->sequence.load(std::memory_order_acquire);
+            const int32_t difference = static_cast<int32_t>(sequence - position);
+            if (difference == 0)
+            {
+                // The slot is free for this position; claim the position, or retry with the one that beat us to it.
+                if (m_EnqueuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+                {
+                    break;
+                }
+            }
+            else if (difference < 0)
+            {
+                // The slot still holds the value of the previous lap: the queue is full.
+                m_OverflowCount.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            }
+            else
+            {
+                position = m_EnqueuePosition.load(std::memory_order_relaxed);
+            }
+        }
+        pSlot->value = value;
+        pSlot->sequence.store(position + 1, std::memory_order_release);
+        return true;
+    }
+
+    //!<  Takes the oldest published value. Call from the consumer thread only. Returns false if there is none.
+    bool TryPop(T* pOutValue)
+    {
+        if (m_pSlots == nullptr)
+        {
+            return false;
+        }
+        Slot* pSlot = &m_pSlots[m_DequeuePosition & m_Mask];
+        const uint32_t sequence = pSlot->sequence.load(std::memory_order_acquire);
+        if (static_cast<int32_t>(sequence - (m_DequeuePosition + 1)) < 0)
+        {
+            return false;
+        }
+        *pOutValue = pSlot->value;
+        pSlot->sequence.store(m_DequeuePosition + m_Mask + 1, std::memory_order_release);
+        ++m_DequeuePosition;
+        return true;
+    }
+
+    /**
+    * @brief  Values claimed by producers and not yet taken, as seen by the consumer. Call from the consumer thread only.
+    *
+    *  Also records the largest count seen, for <tt>GetPeakCount()</tt>, so call it once per pass before popping.
+    */
+    int GetCount()
+    {
+        const int count = static_cast<int>(m_EnqueuePosition.load(std::memory_order_relaxed) - m_DequeuePosition);
+        m_PeakCount = count > m_PeakCount ? count : m_PeakCount;
+        return count;
+    }
+
+    int GetCapacity() const { return m_pSlots != nullptr ? static_cast<int>(m_Mask + 1) : 0; }
+
+    //!<  Pushes refused because the queue was full, since <tt>Initialize()</tt>. Safe from any thread.
+    int GetOverflowCount() const { return m_OverflowCount.load(std::memory_order_relaxed); }
+
+    //!<  Largest count <tt>GetCount()</tt> has returned. Read it on the consumer thread, or once the producers have stopped.
+    int GetPeakCount() const { return m_PeakCount; }
+
+private:
+    Slot* m_pSlots;
+    uint32_t m_Mask;
+    std::atomic<uint32_t> m_EnqueuePosition;
+    uint32_t m_DequeuePosition;         //!<  Owned by the consumer.
+    std::atomic<int> m_OverflowCount;
+    int m_PeakCount;                    //!<  Owned by the consumer.
+};
+
+}
@@ -0,0 +1,458 @@
+#include "AudioDspOscillator.h"
+
+#include <cmath>
+
+namespace AudioDsp {
+
+namespace {
+
+const float Pi = 3.1415926535897932384626433f;
+
+// Every array in the work buffer starts on this boundary.
+const std::size_t ArrayAlignment = 16;
+
+// Keeps 1 / increment finite for silent and 0 Hz lanes.
+const float IncrementMin = 1.0e-6f;
+
+std::size_t AlignUp(std::size_t value, std::size_t alignment)
+{
+    return (value + alignment - 1) & ~(alignment - 1);
+}
+
+int GetLaneCapacity(int oscillatorCountMax)
+{
+    return (oscillatorCountMax + SimdWidth - 1) / SimdWidth * SimdWidth;
+}
+
+template <typename T>
+T* AllocateArray(uintptr_t* pCursor, int count)
+{
+    *pCursor = AlignUp(*pCursor, ArrayAlignment);
+    T* p = reinterpret_cast<T*>(*pCursor);
+    *pCursor += sizeof(T) * count;
+    return p;
+}
+
+int16_t ToInt16(float value)
+{
+    const float scaled = value * 32767.0f;
+    if (scaled >= 32767.0f)
+    {
+        return 32767;
+    }
+    if (scaled <= -32768.0f)
+    {
+        return -32768;
+    }
+    return static_cast<int16_t>(scaled < 0.0f ? scaled - 0.5f : scaled + 0.5f);
+}
+
+// sin(2 pi phase) for phase in [0, 1).
+Float4 Sine(Float4 phase)
+{
+    // With t = phase - 0.5 in [-0.5, 0.5), sin(2 pi phase) = sin(-2 pi t).
+    // Fold t into [-0.25, 0.25] using sin(pi - x) = sin(x), then evaluate a degree-9 odd polynomial.
+    const Float4 zero = Set4(0.0f);
+    const Float4 two = Set4(2.0f);
+    Float4 t = Sub4(phase, Set4(0.5f));
+    t = Sub4(t, Mul4(two, Max4(Sub4(t, Set4(0.25f)), zero)));
+    t = Sub4(t, Mul4(two, Min4(Add4(t, Set4(0.25f)), zero)));
+    const Float4 x = Mul4(t, Set4(-2.0f * Pi));
+    const Float4 x2 = Mul4(x, x);
+    Float4 p = Set4(1.0f / 362880.0f);
+    p = MulAdd4(Set4(-1.0f / 5040.0f), p, x2);
+    p = MulAdd4(Set4(1.0f / 120.0f), p, x2);
+    p = MulAdd4(Set4(-1.0f / 6.0f), p, x2);
+    p = MulAdd4(Set4(1.0f), p, x2);
+    return Mul4(p, x);
+}
+
+// PolyBLEP residual of a unit downward step at phase 0, spread over one sample on either side.
+Float4 PolyBlep(Float4 phase, Float4 inverseIncrement)
+{
+    const Float4 zero = Set4(0.0f);
+    const Float4 one = Set4(1.0f);
+    const Float4 before = Max4(Sub4(one, Mul4(Sub4(one, phase), inverseIncrement)), zero);
+    const Float4 after = Max4(Sub4(one, Mul4(phase, inverseIncrement)), zero);
+    return Sub4(Mul4(before, before), Mul4(after, after));
+}
+
+Float4 Saw(Float4 phase, Float4 inverseIncrement)
+{
+    return Sub4(Sub4(Add4(phase, phase), Set4(1.0f)), PolyBlep(phase, inverseIncrement));
+}
+
+struct SineShape
+{
+    Float4 operator()(Float4 phase, Float4, const float* const*, const int*) const
+    {
+        return Sine(phase);
+    }
+};
+
+struct SawShape
+{
+    Float4 operator()(Float4 phase, Float4 increment, const float* const*, const int*) const
+    {
+        return Saw(phase, Div4(Set4(1.0f), Max4(increment, Set4(IncrementMin))));
+    }
+};
+
+struct SquareShape
+{
+    // The difference of two saws half a cycle apart is a square wave.
+    Float4 operator()(Float4 phase, Float4 increment, const float* const*, const int*) const
+    {
+        const Float4 inverseIncrement = Div4(Set4(1.0f), Max4(increment, Set4(IncrementMin)));
+        return Sub4(Saw(Fraction4(Add4(phase, Set4(0.5f))), inverseIncrement), Saw(phase, inverseIncrement));
+    }
+};
+
+struct WavetableShape
+{
+    // Table reads are gathers, so this one stays scalar per lane.
+    Float4 operator()(Float4 phase, Float4, const float* const* tables, const int* masks) const
+    {
+        float phases[SimdWidth];
+        float values[SimdWidth];
+        Store4(phases, phase);
+        for (int i = 0; i < SimdWidth; ++i)
+        {
+            const float* table = tables[i];
+            if (table == nullptr)
+            {
+                values[i] = 0.0f;
+                continue;
+            }
+            const float position = phases[i] * static_cast<float>(masks[i] + 1);
+            const int index = static_cast<int>(position) & masks[i];
+            const float fraction = position - static_cast<float>(static_cast<int>(position));
+            values[i] = table[index] + (table[index + 1] - table[index]) * fraction;
+        }
+        return Load4(values);
+    }
+};
+
+}  // namespace
+
+void BuildWavetable(float* pOutTable, int tableSize, const float* harmonicAmplitudes, int harmonicCount)
+{
+    double peak = 0.0;
+    for (int i = 0; i < tableSize; ++i)
+    {
+        double value = 0.0;
+        for (int k = 0; k < harmonicCount; ++k)
+        {
+            value += harmonicAmplitudes[k] * std::sin(2.0 * 3.14159265358979323846 * (k + 1) * i / tableSize);
+        }
+        pOutTable[i] = static_cast<float>(value);
+        peak = std::fabs(value) > peak ? std::fabs(value) : peak;
+    }
+    if (peak > 0.0)
+    {
+        const float scale = static_cast<float>(1.0 / peak);
+        for (int i = 0; i < tableSize; ++i)
+        {
+            pOutTable[i] *= scale;
+        }
+    }
+    pOutTable[tableSize] = pOutTable[0];
+}
+
+OscillatorBank::OscillatorBank()
+    : m_pSlots(nullptr)
+    , m_pFreeHandles(nullptr)
+    , m_FreeCount(0)
+    , m_CountMax(0)
+    , m_ActiveCount(0)
+    , m_SampleRate(0.0f)
+{
+    for (int i = 0; i < Waveform_Count; ++i)
+    {
+        Group& group = m_Groups[i];
+        group.phase = nullptr;
+        group.increment = nullptr;
+        group.targetIncrement = nullptr;
+        group.amplitude = nullptr;
+        group.targetAmplitude = nullptr;
+        group.table = nullptr;
+        group.tableMask = nullptr;
+        group.handle = nullptr;
+        group.count = 0;
+    }
+}
+
+std::size_t OscillatorBank::GetRequiredWorkBufferSize(int oscillatorCountMax)
+{
+    const std::size_t laneCount = GetLaneCapacity(oscillatorCountMax);
+    const std::size_t groupSize = 5 * AlignUp(laneCount * sizeof(float), ArrayAlignment)
+                                + AlignUp(laneCount * sizeof(const float*), ArrayAlignment)
+                                + 2 * AlignUp(laneCount * sizeof(int), ArrayAlignment);
+    return ArrayAlignment - 1
+         + Waveform_Count * groupSize
+         + AlignUp(oscillatorCountMax * sizeof(Slot), ArrayAlignment)
+         + AlignUp(oscillatorCountMax * sizeof(int), ArrayAlignment);
+}
+
+void OscillatorBank::Initialize(void* workBuffer, std::size_t workBufferSize, int oscillatorCountMax, int sampleRate)
+{
+    m_SampleRate = static_cast<float>(sampleRate);
+    m_ActiveCount = 0;
+    if (workBuffer == nullptr || oscillatorCountMax <= 0 || workBufferSize < GetRequiredWorkBufferSize(oscillatorCountMax))
+    {
+        // Leave the bank empty; Add() will fail.
+        m_CountMax = 0;
+        m_FreeCount = 0;
+        return;
+    }
+
+    const int laneCount = GetLaneCapacity(oscillatorCountMax);
+    uintptr_t cursor = reinterpret_cast<uintptr_t>(workBuffer);
+    for (int i = 0; i < Waveform_Count; ++i)
+    {
+        Group& group = m_Groups[i];
+        group.phase = AllocateArray<float>(&cursor, laneCount);
+        group.increment = AllocateArray<float>(&cursor, laneCount);
+        group.targetIncrement = AllocateArray<float>(&cursor, laneCount);
+        group.amplitude = AllocateArray<float>(&cursor, laneCount);
+        group.targetAmplitude = AllocateArray<float>(&cursor, laneCount);
+        group.table = AllocateArray<const float*>(&cursor, laneCount);
+        group.tableMask = AllocateArray<int>(&cursor, laneCount);
+        group.handle = AllocateArray<int>(&cursor, laneCount);
+        group.count = 0;
+        for (int lane = 0; lane < laneCount; ++lane)
+        {
+            group.phase[lane] = 0.0f;
+            group.increment[lane] = 0.0f;
+            group.targetIncrement[lane] = 0.0f;
+            group.amplitude[lane] = 0.0f;
+            group.targetAmplitude[lane] = 0.0f;
+            group.table[lane] = nullptr;
+            group.tableMask[lane] = 0;
+            group.handle[lane] = InvalidHandle;
+        }
+    }
+    m_pSlots = AllocateArray<Slot>(&cursor, oscillatorCountMax);
+    m_pFreeHandles = AllocateArray<int>(&cursor, oscillatorCountMax);
+
+    m_CountMax = oscillatorCountMax;
+    m_FreeCount = oscillatorCountMax;
+    for (int i = 0; i < oscillatorCountMax; ++i)
+    {
+        m_pSlots[i].group = 0;
+        m_pSlots[i].isUsed = false;
+        m_pSlots[i].lane = 0;
+        // Hand out low handles first.
+        m_pFreeHandles[i] = oscillatorCountMax - 1 - i;
+    }
+}
+
+int OscillatorBank::Add(Waveform waveform, float frequency, float amplitude, const float* pTable, int tableSize)
+{
+    if (waveform < 0 || waveform >= Waveform_Count || m_FreeCount == 0)
+    {
+        return InvalidHandle;
+    }
+    if (waveform == Waveform_Wavetable && (pTable == nullptr || tableSize <= 0 || (tableSize & (tableSize - 1)) != 0))
+    {
+        return InvalidHandle;
+    }
+
+    const int handle = m_pFreeHandles[--m_FreeCount];
+    Group& group = m_Groups[waveform];
+    const int lane = group.count++;
+    group.phase[lane] = 0.0f;
+    group.amplitude[lane] = 0.0f;
+    group.targetAmplitude[lane] = amplitude;
+    group.table[lane] = waveform == Waveform_Wavetable ? pTable : nullptr;
+    group.tableMask[lane] = waveform == Waveform_Wavetable ? tableSize - 1 : 0;
+    group.handle[lane] = handle;
+
+    m_pSlots[handle].group = static_cast<int8_t>(waveform);
+    m_pSlots[handle].isUsed = true;
+    m_pSlots[handle].lane = lane;
+    ++m_ActiveCount;
+
+    // A new oscillator starts at its frequency; only the amplitude fades in.
+    SetFrequency(handle, frequency);
+    group.increment[lane] = group.targetIncrement[lane];
+    return handle;
+}
+
+void OscillatorBank::Remove(int handle)
+{
+    if (!IsValid(handle))
+    {
+        return;
+    }
+    Slot& slot = m_pSlots[handle];
+    m_Groups[slot.group].targetAmplitude[slot.lane] = 0.0f;
+    slot.isUsed = false;
+}
+
+void OscillatorBank::SetFrequency(int handle, float frequency)
+{
+    if (!IsValid(handle))
+    {
+        return;
+    }
+    const float nyquist = m_SampleRate * 0.5f;
+    frequency = frequency < 0.0f ? 0.0f : (frequency > nyquist ? nyquist : frequency);
+    const Slot& slot = m_pSlots[handle];
+    m_Groups[slot.group].targetIncrement[slot.lane] = frequency / m_SampleRate;
+}
+
+void OscillatorBank::SetAmplitude(int handle, float amplitude)
+{
+    if (!IsValid(handle))
+    {
+        return;
+    }
+    const Slot& slot = m_pSlots[handle];
+    m_Groups[slot.group].targetAmplitude[slot.lane] = amplitude;
+}
+
+float OscillatorBank::GetFrequency(int handle) const
+{
+    if (!IsValid(handle))
+    {
+        return 0.0f;
+    }
+    const Slot& slot = m_pSlots[handle];
+    return m_Groups[slot.group].targetIncrement[slot.lane] * m_SampleRate;
+}
+
+float OscillatorBank::GetAmplitude(int handle) const
+{
+    if (!IsValid(handle))
+    {
+        return 0.0f;
+    }
+    const Slot& slot = m_pSlots[handle];
+    return m_Groups[slot.group].targetAmplitude[slot.lane];
+}
+
+bool OscillatorBank::IsValid(int handle) const
+{
+    return handle >= 0 && handle < m_CountMax && m_pSlots[handle].isUsed;
+}
+
+template <typename Shape>
+void OscillatorBank::AccumulateGroup(Group* pGroup, int sampleCount)
+{
+    const Shape shape = Shape();
+    const Float4 rampScale = Set4(1.0f / sampleCount);
+    for (int lane = 0; lane < pGroup->count; lane += SimdWidth)
+    {
+        Float4 phase = Load4(pGroup->phase + lane);
+        Float4 increment = Load4(pGroup->increment + lane);
+        Float4 amplitude = Load4(pGroup->amplitude + lane);
+        const Float4 targetIncrement = Load4(pGroup->targetIncrement + lane);
+        const Float4 targetAmplitude = Load4(pGroup->targetAmplitude + lane);
+        const Float4 incrementStep = Mul4(Sub4(targetIncrement, increment), rampScale);
+        const Float4 amplitudeStep = Mul4(Sub4(targetAmplitude, amplitude), rampScale);
+        const float* const* tables = pGroup->table + lane;
+        const int* masks = pGroup->tableMask + lane;
+
+        for (int i = 0; i < sampleCount; ++i)
+        {
+            increment = Add4(increment, incrementStep);
+            amplitude = Add4(amplitude, amplitudeStep);
+            m_Accumulator[i] = MulAdd4(m_Accumulator[i], shape(phase, increment, tables, masks), amplitude);
+            phase = Fraction4(Add4(phase, increment));
+        }
+
+        // Store the targets exactly so ramps do not drift.
+        Store4(pGroup->phase + lane, phase);
+        Store4(pGroup->increment + lane, targetIncrement);
+        Store4(pGroup->amplitude + lane, targetAmplitude);
+    }
+}
+
+void OscillatorBank::Accumulate(int sampleCount)
+{
+    for (int i = 0; i < sampleCount; ++i)
+    {
+        m_Accumulator[i] = Set4(0.0f);
+    }
+    AccumulateGroup<SineShape>(&m_Groups[Waveform_Sine], sampleCount);
+    AccumulateGroup<SawShape>(&m_Groups[Waveform_Saw], sampleCount);
+    AccumulateGroup<SquareShape>(&m_Groups[Waveform_Square], sampleCount);
+    AccumulateGroup<WavetableShape>(&m_Groups[Waveform_Wavetable], sampleCount);
+    for (int i = 0; i < Waveform_Count; ++i)
+    {
+        RemoveSilentLanes(&m_Groups[i]);
+    }
+}
+
+void OscillatorBank::RemoveSilentLanes(Group* pGroup)
+{
+    // Walk backwards so the lane moved into a freed position has already been checked.
+    for (int lane = pGroup->count - 1; lane >= 0; --lane)
+    {
+        const int handle = pGroup->handle[lane];
+        if (m_pSlots[handle].isUsed || pGroup->amplitude[lane] != 0.0f)
+        {
+            continue;
+        }
+
+        const int last = --pGroup->count;
+        if (lane != last)
+        {
+            pGroup->phase[lane] = pGroup->phase[last];
+            pGroup->increment[lane] = pGroup->increment[last];
+            pGroup->targetIncrement[lane] = pGroup->targetIncrement[last];
+            pGroup->amplitude[lane] = pGroup->amplitude[last];
+            pGroup->targetAmplitude[lane] = pGroup->targetAmplitude[last];
+            pGroup->table[lane] = pGroup->table[last];
+            pGroup->tableMask[lane] = pGroup->tableMask[last];
+            pGroup->handle[lane] = pGroup->handle[last];
+            m_pSlots[pGroup->handle[lane]].lane = lane;
+        }
+
+        // Padding lanes must stay silent.
+        pGroup->phase[last] = 0.0f;
+        pGroup->increment[last] = 0.0f;
+        pGroup->targetIncrement[last] = 0.0f;
+        pGroup->amplitude[last] = 0.0f;
+        pGroup->targetAmplitude[last] = 0.0f;
+        pGroup->table[last] = nullptr;
+        pGroup->tableMask[last] = 0;
+        pGroup->handle[last] = InvalidHandle;
+
+        m_pFreeHandles[m_FreeCount++] = handle;
+        --m_ActiveCount;
+    }
+}
+
+void OscillatorBank::Process(float* pOut, int sampleCount)
+{
+    while (sampleCount > 0)
+    {
+        const int count = sampleCount < RampSampleCount ? sampleCount : RampSampleCount;
+        Accumulate(count);
+        for (int i = 0; i < count; ++i)
+        {
+            pOut[i] = HorizontalAdd4(m_Accumulator[i]);
+        }
+        pOut += count;
+        sampleCount -= count;
+    }
+}
+
+void OscillatorBank::Process(int16_t* pOut, int sampleCount)
+{
+    while (sampleCount > 0)
+    {
+        const int count = sampleCount < RampSampleCount ? sampleCount : RampSampleCount;
+        Accumulate(count);
+        for (int i = 0; i < count; ++i)
+        {
+            pOut[i] = ToInt16(HorizontalAdd4(m_Accumulator[i]));
+        }
+        pOut += count;
+        sampleCount -= count;
+    }
+}
+
+}  // namespace AudioDsp
@@ -0,0 +1,127 @@
+#pragma once
+
+/**
+* @brief
+*  Bank of phase-accumulator oscillators rendered on demand.
+*
+*  Oscillators of the same waveform are stored side by side and rendered four at a time with
+*  <tt>AudioDsp::Float4</tt>, so the cost per oscillator stays low with hundreds of them running.
+*  The bank mixes every oscillator into one mono output. Frequency and amplitude changes are ramped
+*  over the first <tt>RampSampleCount</tt> samples of the next <tt>Process()</tt> call (or the whole call if it is shorter),
+*  and the phase is never reset, so changes do not click.
+*/
+
+#include <cstddef>
+#include <cstdint>
+
+#include "AudioDspSimd.h"
+
+namespace AudioDsp {
+
+enum Waveform
+{
+    Waveform_Sine,
+    Waveform_Saw,           //!<  Rising ramp, band-limited with PolyBLEP.
+    Waveform_Square,        //!<  50% duty cycle, band-limited with PolyBLEP.
+    Waveform_Wavetable,     //!<  Linearly interpolated single-cycle table.
+    Waveform_Count
+};
+
+/**
+* @brief  Fills a single-cycle table by additive synthesis and normalizes its peak to 1.
+*
+*  harmonicAmplitudes[k] is the amplitude of harmonic k + 1 (sine phase).
+*  pOutTable must hold tableSize + 1 samples; the extra sample repeats the first one for interpolation.
+*  tableSize must be a power of two.
+*/
+void BuildWavetable(float* pOutTable, int tableSize, const float* harmonicAmplitudes, int harmonicCount);
+
+class OscillatorBank
+{
+public:
+    static const int InvalidHandle = -1;
+    static const int RampSampleCount = 64;      //!<  Samples over which parameter changes are ramped.
+
+    OscillatorBank();
+
+    //!<  Size of the work buffer to pass to <tt>Initialize()</tt>.
+    static std::size_t GetRequiredWorkBufferSize(int oscillatorCountMax);
+
+    /**
+    * @brief  Prepares the bank to hold up to oscillatorCountMax oscillators.
+    *
+    *  The work buffer holds all oscillator state and must stay valid while the bank is in use.
+    *  It needs no particular alignment and does not have to be in an audio memory pool.
+    */
+    void Initialize(void* workBuffer, std::size_t workBufferSize, int oscillatorCountMax, int sampleRate);
+
+    /**
+    * @brief  Adds an oscillator and returns its handle, or InvalidHandle if the bank is full.
+    *
+    *  The oscillator fades in over RampSampleCount samples.
+    *  For Waveform_Wavetable, pTable must point at a table as produced by BuildWavetable() that outlives the oscillator.
+    */
+    int Add(Waveform waveform, float frequency, float amplitude, const float* pTable = nullptr, int tableSize = 0);
+
+    //!<  Fades the oscillator out over the next RampSampleCount samples, then frees it. The handle is invalid immediately.
+    void Remove(int handle);
+
+    //!<  Sets the frequency in Hz. Clamped to [0, sampleRate / 2].
+    void SetFrequency(int handle, float frequency);
+    void SetAmplitude(int handle, float amplitude);
+    float GetFrequency(int handle) const;
+    float GetAmplitude(int handle) const;
+
+    //!<  Number of oscillators being rendered, including ones still fading out.
+    int GetCount() const { return m_ActiveCount; }
+    int GetCountMax() const { return m_CountMax; }
+
+    //!<  Renders sampleCount samples of the mix of all oscillators.
+    void Process(float* pOut, int sampleCount);
+
+    //!<  Renders sampleCount samples scaled to int16 full scale, rounded and saturated.
+    void Process(int16_t* pOut, int sampleCount);
+
+private:
+    struct Group
+    {
+        float* phase;               //!<  In cycles, [0, 1).
+        float* increment;           //!<  Phase step per sample.
+        float* targetIncrement;
+        float* amplitude;
+        float* targetAmplitude;
+        const float** table;
+        int* tableMask;
+        int* handle;                //!<  Handle owning each lane. Removed handles keep their lane until it has faded out.
+        int count;                  //!<  Lanes in use; lanes up to the next multiple of four are kept silent.
+    };
+
+    struct Slot
+    {
+        int8_t group;
+        bool isUsed;                //!<  False once removed, while the lane may still be fading out.
+        int lane;
+    };
+
+    //!<  Renders up to RampSampleCount samples into m_Accumulator.
+    void Accumulate(int sampleCount);
+
+    template <typename Shape>
+    void AccumulateGroup(Group* pGroup, int sampleCount);
+
+    //!<  Frees the lanes that finished fading out and keeps each group contiguous.
+    void RemoveSilentLanes(Group* pGroup);
+
+    bool IsValid(int handle) const;
+
+    Group m_Groups[Waveform_Count];
+    Slot* m_pSlots;
+    int* m_pFreeHandles;
+    int m_FreeCount;
+    int m_CountMax;
+    int m_ActiveCount;
+    float m_SampleRate;
+    Float4 m_Accumulator[RampSampleCount];     //!<  Per-sample partial sums, one lane per oscillator position.
+};
+
+}  // namespace AudioDsp
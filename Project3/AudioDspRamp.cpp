@@ -0,0 +1,88 @@
+#include "AudioDspRamp.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace AudioDsp {
+
+const float Ramp::ExponentialFloor = 1.0e-5f;
+
+Ramp::Ramp()
+    : m_Start(0.0f)
+    , m_Target(0.0f)
+    , m_Value(0.0f)
+    , m_Factor(1.0f)
+    , m_Step(0)
+    , m_StepCount(0)
+    , m_Curve(RampCurve_Linear)
+{
+}
+
+void Ramp::Reset(float value)
+{
+    m_Start = value;
+    m_Target = value;
+    m_Value = value;
+    m_Factor = 1.0f;
+    m_Step = 0;
+    m_StepCount = 0;
+}
+
+void Ramp::SetTarget(float target, int stepCount, RampCurve curve)
+{
+    if (target == m_Target && (curve == m_Curve || !IsRamping()))
+    {
+        return;
+    }
+
+    m_Start = m_Value;
+    m_Target = target;
+    m_Curve = curve;
+    m_Step = 0;
+    m_StepCount = stepCount > 0 ? stepCount : 1;
+
+    if (curve == RampCurve_Exponential)
+    {
+        const float start = std::max(m_Start, ExponentialFloor);
+        const float end = std::max(target, ExponentialFloor);
+        m_Start = start;
+        m_Factor = std::pow(end / start, 1.0f / m_StepCount);
+    }
+}
+
+bool Ramp::Advance()
+{
+    if (!IsRamping())
+    {
+        return false;
+    }
+
+    const float previous = m_Value;
+    if (++m_Step == m_StepCount)
+    {
+        m_Value = m_Target;
+    }
+    else
+    {
+        const float x = static_cast<float>(m_Step) / m_StepCount;
+        switch (m_Curve)
+        {
+        case RampCurve_Exponential:
+            // Rounding of the repeated product is absorbed by landing on the target at the last step.
+            m_Value = (m_Step == 1 ? m_Start : m_Value) * m_Factor;
+            break;
+        case RampCurve_EqualPower:
+            {
+                const float startPower = m_Start * m_Start;
+                m_Value = std::sqrt(startPower + (m_Target * m_Target - startPower) * x);
+            }
+            break;
+        default:
+            m_Value = m_Start + (m_Target - m_Start) * x;
+            break;
+        }
+    }
+    return m_Value != previous;
+}
+
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+/**
+* @brief
+*  A parameter value that moves toward a target over a fixed number of steps.
+*
+*  A ramp is advanced once per control period, normally one audio frame, and reports whether its value changed.
+*  Parameters that are not ramping therefore cost nothing to update and never cause a parameter write.
+*/
+
+namespace AudioDsp {
+
+enum RampCurve
+{
+    RampCurve_Linear,           //!<  Constant step. Suits pan positions and pitch in semitones.
+    RampCurve_Exponential,      //!<  Constant ratio, i.e. constant dB per step. Suits gains and pitch ratios.
+    RampCurve_EqualPower        //!<  Linear in power (value squared). A fade to or from zero passes -3 dB halfway.
+};
+
+class Ramp
+{
+public:
+    //!<  Values are clamped to this (-100 dB) by the exponential curve, which cannot reach zero.
+    static const float ExponentialFloor;
+
+    Ramp();
+
+    //!<  Jumps to value and stops ramping.
+    void Reset(float value);
+
+    /**
+    * @brief  Starts a ramp from the current value to target over stepCount calls to <tt>Advance()</tt>.
+    *
+    *  A stepCount of zero or less jumps on the next <tt>Advance()</tt>. Setting the target already being ramped to
+    *  (or held) keeps the ramp going instead of restarting it. The exponential and equal-power curves expect values of zero or more;
+    *  the last step always lands exactly on target.
+    */
+    void SetTarget(float target, int stepCount, RampCurve curve);
+
+    //!<  Moves one step. Returns true if the value changed.
+    bool Advance();
+
+    float GetValue() const { return m_Value; }
+    float GetTarget() const { return m_Target; }
+    bool IsRamping() const { return m_Step < m_StepCount; }
+
+private:
+    float m_Start;
+    float m_Target;
+    float m_Value;
+    float m_Factor;             //!<  Per-step ratio of the exponential curve.
+    int m_Step;
+    int m_StepCount;
+    RampCurve m_Curve;
+};
+
+}
@@ -0,0 +1,110 @@
+#include "AudioDspResampler.h"
+
+#include <cmath>
+
+#include "AudioDspSimd.h"
+
+namespace AudioDsp {
+
+namespace {
+
+const double Pi = 3.14159265358979323846;
+
+// About 80 dB of stopband rejection with 32 taps.
+const double KaiserBeta = 8.0;
+
+// Fraction of the lower Nyquist frequency where the -6 dB point of the filter sits.
+const double CutoffRatio = 0.9;
+
+const int TapGroupCount = ResamplerTapCount / SimdWidth;
+const uint32_t PhaseShift = ResamplerFractionBits - 7;
+const uint32_t SubPhaseMask = (1u << PhaseShift) - 1;
+const float SubPhaseScale = 1.0f / (1u << PhaseShift);
+
+static_assert(ResamplerPhaseCount == 1 << 7, "PhaseShift assumes 128 phases");
+static_assert(ResamplerTapCount % SimdWidth == 0, "The taps are processed in groups of four");
+
+// Zeroth-order modified Bessel function of the first kind.
+double BesselI0(double x)
+{
+    const double quarterX2 = x * x / 4.0;
+    double term = 1.0;
+    double sum = 1.0;
+    for (int k = 1; k < 50 && term > sum * 1.0e-17; ++k)
+    {
+        term *= quarterX2 / (static_cast<double>(k) * k);
+        sum += term;
+    }
+    return sum;
+}
+
+// Fills one row of taps for a filter centered fraction samples after tap ResamplerDelay, normalized to unity gain at DC.
+void DesignRow(double* pRow, double cutoff, double fraction)
+{
+    const double halfLength = ResamplerTapCount / 2;
+    const double windowScale = 1.0 / BesselI0(KaiserBeta);
+    double sum = 0.0;
+    for (int t = 0; t < ResamplerTapCount; ++t)
+    {
+        const double x = t - ResamplerDelay - fraction;
+        const double sinc = x == 0.0 ? 1.0 : std::sin(Pi * cutoff * x) / (Pi * cutoff * x);
+        const double r = x / halfLength;
+        const double window = r * r < 1.0 ? BesselI0(KaiserBeta * std::sqrt(1.0 - r * r)) * windowScale : 0.0;
+        pRow[t] = cutoff * sinc * window;
+        sum += pRow[t];
+    }
+    for (int t = 0; t < ResamplerTapCount; ++t)
+    {
+        pRow[t] /= sum;
+    }
+}
+
+}
+
+float GetResamplerCutoff(double ratio)
+{
+    return static_cast<float>(CutoffRatio * (ratio > 1.0 ? 1.0 / ratio : 1.0));
+}
+
+void DesignPolyphaseFilter(PolyphaseFilter* pOutFilter, float cutoff)
+{
+    double row[ResamplerTapCount];
+    double next[ResamplerTapCount];
+    DesignRow(row, cutoff, 0.0);
+    for (int p = 0; p < ResamplerPhaseCount; ++p)
+    {
+        DesignRow(next, cutoff, static_cast<double>(p + 1) / ResamplerPhaseCount);
+        for (int t = 0; t < ResamplerTapCount; ++t)
+        {
+            pOutFilter->coefficients[p][t] = static_cast<float>(row[t]);
+            pOutFilter->deltas[p][t] = static_cast<float>(next[t] - row[t]);
+            row[t] = next[t];
+        }
+    }
+}
+
+void ResamplePolyphase(float* pDst, int dstCount, const float* pSrc, uint64_t position, uint64_t step, const PolyphaseFilter& filter)
+{
+    for (int i = 0; i < dstCount; ++i)
+    {
+        const float* pInput = pSrc + (position >> ResamplerFractionBits);
+        const uint32_t fraction = static_cast<uint32_t>(position);
+        const int phase = static_cast<int>(fraction >> PhaseShift);
+        const float* pCoefficients = filter.coefficients[phase];
+        const float* pDeltas = filter.deltas[phase];
+
+        // Interpolating between phases is folded into a second dot product with the row differences.
+        Float4 sum = Set4(0.0f);
+        Float4 delta = Set4(0.0f);
+        for (int g = 0; g < TapGroupCount; ++g)
+        {
+            const Float4 x = Load4(pInput + g * SimdWidth);
+            sum = MulAdd4(sum, x, Load4(pCoefficients + g * SimdWidth));
+            delta = MulAdd4(delta, x, Load4(pDeltas + g * SimdWidth));
+        }
+        pDst[i] = HorizontalAdd4(MulAdd4(sum, delta, Set4((fraction & SubPhaseMask) * SubPhaseScale)));
+        position += step;
+    }
+}
+
+}
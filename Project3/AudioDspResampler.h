@@ -0,0 +1,58 @@
+#pragma once
+
+/**
+* @brief
+*  Polyphase windowed-sinc resampler.
+*
+*  The filter is a Kaiser-windowed sinc of <tt>ResamplerTapCount</tt> taps, tabulated at <tt>ResamplerPhaseCount</tt>
+*  sub-sample phases. Each table row also stores its difference to the next phase, so an output sample at any
+*  fractional position costs two dot products of <tt>ResamplerTapCount</tt> taps, done four taps at a time with
+*  <tt>AudioDsp::Float4</tt>. Positions are Q32, which keeps the drift of a fixed step below one sample per hour.
+*
+*  When downsampling, the cutoff must follow the output Nyquist frequency or the top octave aliases;
+*  <tt>GetResamplerCutoff()</tt> gives the cutoff for a ratio.
+*/
+
+#include <cstdint>
+
+namespace AudioDsp {
+
+const int ResamplerTapCount = 32;
+const int ResamplerPhaseCount = 128;
+const int ResamplerFractionBits = 32;
+
+//!<  Input samples that precede the center of the filter. An output at position p is centered on input p + ResamplerDelay.
+const int ResamplerDelay = ResamplerTapCount / 2 - 1;
+
+/**
+* @brief  One tabulated filter. Plain data, about 32 KB.
+*
+*  coefficients[p] is the filter at fraction p / ResamplerPhaseCount, and deltas[p] is coefficients[p + 1] - coefficients[p].
+*/
+struct PolyphaseFilter
+{
+    float coefficients[ResamplerPhaseCount][ResamplerTapCount];
+    float deltas[ResamplerPhaseCount][ResamplerTapCount];
+};
+
+/**
+* @brief  Cutoff for a resampling ratio, relative to the input Nyquist frequency.
+*
+*  ratio is input samples per output sample. The passband ends a little below the lower of the two Nyquist frequencies
+*  so the transition band of the short filter stays clear of aliasing.
+*/
+float GetResamplerCutoff(double ratio);
+
+//!<  Tabulates the filter for a cutoff in (0, 1], relative to the input Nyquist frequency. Each phase has unity gain at DC.
+void DesignPolyphaseFilter(PolyphaseFilter* pOutFilter, float cutoff);
+
+/**
+* @brief  Resamples one channel.
+*
+*  Output i is interpolated at input position + i * step, both Q32. The integer part n of that position reads
+*  pSrc[n] through pSrc[n + ResamplerTapCount - 1], so the caller provides <tt>ResamplerDelay</tt> samples of history before
+*  the first sample it wants centered and <tt>ResamplerTapCount - ResamplerDelay</tt> after the last.
+*/
+void ResamplePolyphase(float* pDst, int dstCount, const float* pSrc, uint64_t position, uint64_t step, const PolyphaseFilter& filter);
+
+}
@@ -0,0 +1,225 @@
+#pragma once
+
+/**
+* @brief
+*  Minimal 4-lane float vector used by the portable audio DSP code.
+*
+*  Maps onto NEON on the NX (AArch64) and SSE2 on x86 hosts, and falls back to
+*  plain scalar code elsewhere. Only the handful of operations the mixer kernels
+*  need are provided; anything more exotic should stay scalar.
+*/
+
+#include <cstdint>
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define AUDIODSP_SIMD_NEON 1
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define AUDIODSP_SIMD_SSE2 1
+#else
+#include <cmath>
+#define AUDIODSP_SIMD_SCALAR 1
+#endif
+
+namespace AudioDsp {
+
+const int SimdWidth = 4;
+
+#if defined(AUDIODSP_SIMD_NEON)
+
+typedef float32x4_t Float4;
+
+inline Float4 Load4(const float* p)               { return vld1q_f32(p); }
+inline void   Store4(float* p, Float4 v)          { vst1q_f32(p, v); }
+inline Float4 Set4(float x)                       { return vdupq_n_f32(x); }
+inline Float4 Set4(float a, float b, float c, float d)
+{
+    const float values[4] = { a, b, c, d };
+    return vld1q_f32(values);
+}
+inline Float4 Add4(Float4 a, Float4 b)            { return vaddq_f32(a, b); }
+inline Float4 Sub4(Float4 a, Float4 b)            { return vsubq_f32(a, b); }
+inline Float4 Mul4(Float4 a, Float4 b)            { return vmulq_f32(a, b); }
+inline Float4 MulAdd4(Float4 acc, Float4 a, Float4 b) { return vmlaq_f32(acc, a, b); }
+inline Float4 Min4(Float4 a, Float4 b)            { return vminq_f32(a, b); }
+inline Float4 Max4(Float4 a, Float4 b)            { return vmaxq_f32(a, b); }
+inline Float4 Abs4(Float4 a)                      { return vabsq_f32(a); }
+inline Float4 Div4(Float4 a, Float4 b)            { return vdivq_f32(a, b); }
+inline Float4 Sqrt4(Float4 a)                     { return vsqrtq_f32(a); }
+
+//!<  a where condition is zero or more, b elsewhere.
+inline Float4 SelectNonNegative4(Float4 condition, Float4 a, Float4 b)
+{
+    return vbslq_f32(vcgeq_f32(condition, vdupq_n_f32(0.0f)), a, b);
+}
+
+//!<  Fractional part of non-negative values below 2^31.
+inline Float4 Fraction4(Float4 a)                 { return vsubq_f32(a, vcvtq_f32_s32(vcvtq_s32_f32(a))); }
+
+//!<  Converts four int16 samples to float.
+inline Float4 LoadInt16x4(const int16_t* p)
+{
+    return vcvtq_f32_s32(vmovl_s16(vld1_s16(p)));
+}
+
+//!<  Converts four int32 samples to float.
+inline Float4 LoadInt32x4(const int32_t* p)       { return vcvtq_f32_s32(vld1q_s32(p)); }
+
+//!<  Rounds, saturates and stores four samples as int16.
+inline void StoreInt16x4(int16_t* p, Float4 v)
+{
+    vst1_s16(p, vqmovn_s32(vcvtnq_s32_f32(v)));
+}
+
+inline float HorizontalAdd4(Float4 v)             { return vaddvq_f32(v); }
+inline float HorizontalMax4(Float4 v)             { return vmaxvq_f32(v); }
+
+#elif defined(AUDIODSP_SIMD_SSE2)
+
+typedef __m128 Float4;
+
+inline Float4 Load4(const float* p)               { return _mm_loadu_ps(p); }
+inline void   Store4(float* p, Float4 v)          { _mm_storeu_ps(p, v); }
+inline Float4 Set4(float x)                       { return _mm_set1_ps(x); }
+inline Float4 Set4(float a, float b, float c, float d) { return _mm_setr_ps(a, b, c, d); }
+inline Float4 Add4(Float4 a, Float4 b)            { return _mm_add_ps(a, b); }
+inline Float4 Sub4(Float4 a, Float4 b)            { return _mm_sub_ps(a, b); }
+inline Float4 Mul4(Float4 a, Float4 b)            { return _mm_mul_ps(a, b); }
+inline Float4 MulAdd4(Float4 acc, Float4 a, Float4 b) { return _mm_add_ps(acc, _mm_mul_ps(a, b)); }
+inline Float4 Min4(Float4 a, Float4 b)            { return _mm_min_ps(a, b); }
+inline Float4 Max4(Float4 a, Float4 b)            { return _mm_max_ps(a, b); }
+inline Float4 Abs4(Float4 a)                      { return _mm_andnot_ps(_mm_set1_ps(-0.0f), a); }
+inline Float4 Div4(Float4 a, Float4 b)            { return _mm_div_ps(a, b); }
+inline Float4 Sqrt4(Float4 a)                     { return _mm_sqrt_ps(a); }
+
+//!<  a where condition is zero or more, b elsewhere.
+inline Float4 SelectNonNegative4(Float4 condition, Float4 a, Float4 b)
+{
+    const __m128 mask = _mm_cmpge_ps(condition, _mm_setzero_ps());
+    return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+}
+
+//!<  Fractional part of non-negative values below 2^31.
+inline Float4 Fraction4(Float4 a)                 { return _mm_sub_ps(a, _mm_cvtepi32_ps(_mm_cvttps_epi32(a))); }
+
+//!<  Converts four int16 samples to float.
+inline Float4 LoadInt16x4(const int16_t* p)
+{
+    __m128i s = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(p));
+    return _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(s, s), 16));
+}
+
+//!<  Converts four int32 samples to float.
+inline Float4 LoadInt32x4(const int32_t* p)       { return _mm_cvtepi32_ps(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p))); }
+
+//!<  Rounds, saturates and stores four samples as int16.
+inline void StoreInt16x4(int16_t* p, Float4 v)
+{
+    __m128i i = _mm_cvtps_epi32(v);
+    _mm_storel_epi64(reinterpret_cast<__m128i*>(p), _mm_packs_epi32(i, i));
+}
+
+inline float HorizontalAdd4(Float4 v)
+{
+    __m128 s = _mm_add_ps(v, _mm_movehl_ps(v, v));
+    s = _mm_add_ss(s, _mm_shuffle_ps(s, s, 1));
+    return _mm_cvtss_f32(s);
+}
+
+inline float HorizontalMax4(Float4 v)
+{
+    __m128 s = _mm_max_ps(v, _mm_movehl_ps(v, v));
+    s = _mm_max_ss(s, _mm_shuffle_ps(s, s, 1));
+    return _mm_cvtss_f32(s);
+}
+
+#else
+
+struct Float4
+{
+    float v[4];
+};
+
+inline Float4 Load4(const float* p)               { Float4 r = { { p[0], p[1], p[2], p[3] } }; return r; }
+inline void   Store4(float* p, Float4 a)          { p[0] = a.v[0]; p[1] = a.v[1]; p[2] = a.v[2]; p[3] = a.v[3]; }
+inline Float4 Set4(float x)                       { Float4 r = { { x, x, x, x } }; return r; }
+inline Float4 Set4(float a, float b, float c, float d) { Float4 r = { { a, b, c, d } }; return r; }
+
+#define AUDIODSP_SCALAR_BINARY_OP(name, expr) \
+    inline Float4 name(Float4 a, Float4 b) \
+    { \
+        Float4 r; \
+        for (int i = 0; i < 4; ++i) { const float x = a.v[i]; const float y = b.v[i]; r.v[i] = (expr); } \
+        return r; \
+    }
+AUDIODSP_SCALAR_BINARY_OP(Add4, x + y)
+AUDIODSP_SCALAR_BINARY_OP(Sub4, x - y)
+AUDIODSP_SCALAR_BINARY_OP(Mul4, x * y)
+AUDIODSP_SCALAR_BINARY_OP(Min4, x < y ? x : y)
+AUDIODSP_SCALAR_BINARY_OP(Max4, x > y ? x : y)
+AUDIODSP_SCALAR_BINARY_OP(Div4, x / y)
+#undef AUDIODSP_SCALAR_BINARY_OP
+
+inline Float4 MulAdd4(Float4 acc, Float4 a, Float4 b) { return Add4(acc, Mul4(a, b)); }
+inline Float4 Abs4(Float4 a)
+{
+    Float4 r;
+    for (int i = 0; i < 4; ++i) { r.v[i] = a.v[i] < 0.0f ? -a.v[i] : a.v[i]; }
+    return r;
+}
+
+inline Float4 Sqrt4(Float4 a)
+{
+    Float4 r;
+    for (int i = 0; i < 4; ++i) { r.v[i] = std::sqrt(a.v[i]); }
+    return r;
+}
+
+inline Float4 SelectNonNegative4(Float4 condition, Float4 a, Float4 b)
+{
+    Float4 r;
+    for (int i = 0; i < 4; ++i) { r.v[i] = condition.v[i] >= 0.0f ? a.v[i] : b.v[i]; }
+    return r;
+}
+
+inline Float4 Fraction4(Float4 a)
+{
+    Float4 r;
+    for (int i = 0; i < 4; ++i) { r.v[i] = a.v[i] - static_cast<float>(static_cast<int32_t>(a.v[i])); }
+    return r;
+}
+
+inline Float4 LoadInt16x4(const int16_t* p)
+{
+    Float4 r = { { float(p[0]), float(p[1]), float(p[2]), float(p[3]) } };
+    return r;
+}
+
+inline Float4 LoadInt32x4(const int32_t* p)
+{
+    Float4 r = { { float(p[0]), float(p[1]), float(p[2]), float(p[3]) } };
+    return r;
+}
+
+inline void StoreInt16x4(int16_t* p, Float4 a)
+{
+    for (int i = 0; i < 4; ++i)
+    {
+        float x = a.v[i];
+        x = x < -32768.0f ? -32768.0f : (x > 32767.0f ? 32767.0f : x);
+        p[i] = static_cast<int16_t>(x < 0.0f ? x - 0.5f : x + 0.5f);
+    }
+}
+
+inline float HorizontalAdd4(Float4 a)             { return (a.v[0] + a.v[1]) + (a.v[2] + a.v[3]); }
+inline float HorizontalMax4(Float4 a)
+{
+    float m = a.v[0];
+    for (int i = 1; i < 4; ++i) { m = a.v[i] > m ? a.v[i] : m; }
+    return m;
+}
+
+#endif
+
+}  // namespace AudioDsp
@@ -0,0 +1,361 @@
+#include "AudioDspSpatializer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#include "AudioDspSimd.h"
+
+namespace AudioDsp {
+
+namespace {
+
+const std::size_t ArrayAlignment = 16;
+const float Pi = 3.14159265358979f;
+
+// Horizontal distance below which a source is taken to be straight ahead, and the squared distance gains start to fall at.
+const float HorizontalLengthSquaredMin = 1.0e-8f;
+const float ReferenceDistanceSquared = 1.0f;
+
+std::size_t AlignUp(std::size_t value, std::size_t alignment)
+{
+    return (value + alignment - 1) & ~(alignment - 1);
+}
+
+template <typename T>
+T* AllocateArray(uintptr_t* pCursor, std::size_t count)
+{
+    *pCursor = AlignUp(*pCursor, ArrayAlignment);
+    T* p = reinterpret_cast<T*>(*pCursor);
+    *pCursor += sizeof(T) * count;
+    return p;
+}
+
+int GetStride(int emitterCountMax)
+{
+    return (emitterCountMax + SimdWidth - 1) / SimdWidth * SimdWidth;
+}
+
+// Azimuth in [0, 360).
+float WrapAzimuth(float azimuth)
+{
+    const float wrapped = std::fmod(azimuth, 360.0f);
+    return wrapped < 0.0f ? wrapped + 360.0f : wrapped;
+}
+
+}
+
+const float Spatializer::NonDirectional = 1000.0f;
+const float Spatializer::ChangeThreshold = 1.0e-3f;
+
+Spatializer::Spatializer()
+    : m_ChannelCount(0)
+    , m_EmitterCountMax(0)
+    , m_EmitterCount(0)
+    , m_Stride(0)
+    , m_Mode(Mode_Silent)
+    , m_DirectionalCount(0)
+    , m_pX(nullptr)
+    , m_pY(nullptr)
+    , m_pZ(nullptr)
+    , m_pGains(nullptr)
+    , m_pIsChanged(nullptr)
+{
+    SetListenerOrientation(0.0f, 0.0f, 0.0f, 1.0f);
+}
+
+void Spatializer::GetDefaultLayout(float* pOutAzimuths, int channelCount)
+{
+    static const float Quad[4] = { -45.0f, 45.0f, -135.0f, 135.0f };
+    static const float Surround[6] = { -30.0f, 30.0f, 0.0f, NonDirectional, -110.0f, 110.0f };
+
+    for (int i = 0; i < channelCount; ++i)
+    {
+        if (channelCount == 1)
+        {
+            pOutAzimuths[i] = 0.0f;
+        }
+        else if (channelCount == 4)
+        {
+            pOutAzimuths[i] = Quad[i];
+        }
+        else if (channelCount == 6)
+        {
+            pOutAzimuths[i] = Surround[i];
+        }
+        else
+        {
+            pOutAzimuths[i] = i < 2 ? Surround[i] : NonDirectional;
+        }
+    }
+}
+
+std::size_t Spatializer::GetRequiredWorkBufferSize(int emitterCountMax)
+{
+    if (emitterCountMax <= 0)
+    {
+        return 0;
+    }
+    const std::size_t stride = GetStride(emitterCountMax);
+    return ArrayAlignment - 1
+         + (3 + ChannelCountMax) * AlignUp(stride * sizeof(float), ArrayAlignment)
+         + stride;
+}
+
+void Spatializer::Initialize(void* workBuffer, std::size_t workBufferSize, int emitterCountMax, const float* pAzimuths, int channelCount)
+{
+    m_EmitterCount = 0;
+    if (workBuffer == nullptr || emitterCountMax <= 0 || channelCount <= 0 || channelCount > ChannelCountMax
+        || workBufferSize < GetRequiredWorkBufferSize(emitterCountMax))
+    {
+        // Leave the spatializer without room; AddEmitter() fails.
+        m_ChannelCount = 0;
+        m_EmitterCountMax = 0;
+        m_Stride = 0;
+        m_Mode = Mode_Silent;
+        return;
+    }
+
+    m_ChannelCount = channelCount;
+    m_EmitterCountMax = emitterCountMax;
+    m_Stride = GetStride(emitterCountMax);
+
+    uintptr_t cursor = reinterpret_cast<uintptr_t>(workBuffer);
+    m_pX = AllocateArray<float>(&cursor, m_Stride);
+    m_pY = AllocateArray<float>(&cursor, m_Stride);
+    m_pZ = AllocateArray<float>(&cursor, m_Stride);
+    m_pGains = AllocateArray<float>(&cursor, static_cast<std::size_t>(ChannelCountMax) * m_Stride);
+    m_pIsChanged = AllocateArray<uint8_t>(&cursor, m_Stride);
+
+    // The unused lanes of the last group of four are computed like any emitter, so they hold a valid position.
+    std::memset(m_pX, 0, sizeof(float) * m_Stride);
+    std::memset(m_pY, 0, sizeof(float) * m_Stride);
+    std::memset(m_pZ, 0, sizeof(float) * m_Stride);
+    std::memset(m_pGains, 0, sizeof(float) * ChannelCountMax * m_Stride);
+    std::memset(m_pIsChanged, 0, m_Stride);
+    SetLayout(pAzimuths, channelCount);
+}
+
+void Spatializer::SetLayout(const float* pAzimuths, int channelCount)
+{
+    m_DirectionalCount = 0;
+    for (int i = 0; i < channelCount; ++i)
+    {
+        if (pAzimuths[i] != NonDirectional)
+        {
+            m_Directional[m_DirectionalCount++] = i;
+        }
+    }
+
+    // Sort the speakers clockwise from the front. For a pair, the first is then the one further left.
+    struct LessAzimuth
+    {
+        const float* pAzimuths;
+        bool operator()(int a, int b) const
+        {
+            const float first = WrapAzimuth(pAzimuths[a] + 180.0f);
+            const float second = WrapAzimuth(pAzimuths[b] + 180.0f);
+            return first < second;
+        }
+    };
+    const LessAzimuth less = { pAzimuths };
+    std::sort(m_Directional, m_Directional + m_DirectionalCount, less);
+
+    if (m_DirectionalCount < 3)
+    {
+        m_Mode = m_DirectionalCount == 0 ? Mode_Silent : (m_DirectionalCount == 1 ? Mode_Mono : Mode_Pair);
+        return;
+    }
+
+    // Each neighbor pair solves gains * directions = source direction, with directions as (right, forward).
+    m_Mode = Mode_Ring;
+    for (int i = 0; i < m_DirectionalCount; ++i)
+    {
+        SpeakerPair& pair = m_Pairs[i];
+        pair.first = m_Directional[i];
+        pair.second = m_Directional[(i + 1) % m_DirectionalCount];
+        const float gap = WrapAzimuth(pAzimuths[pair.second] - pAzimuths[pair.first]);
+        if (gap <= 0.0f || gap >= 180.0f)
+        {
+            m_Mode = Mode_Uniform;
+            return;
+        }
+
+        const float firstAngle = pAzimuths[pair.first] * (Pi / 180.0f);
+        const float secondAngle = pAzimuths[pair.second] * (Pi / 180.0f);
+        const float firstRight = std::sin(firstAngle);
+        const float firstForward = std::cos(firstAngle);
+        const float secondRight = std::sin(secondAngle);
+        const float secondForward = std::cos(secondAngle);
+        const float determinant = firstRight * secondForward - firstForward * secondRight;
+        pair.firstRight = secondForward / determinant;
+        pair.firstForward = -secondRight / determinant;
+        pair.secondRight = -firstForward / determinant;
+        pair.secondForward = firstRight / determinant;
+    }
+}
+
+int Spatializer::AddEmitter(float x, float y, float z)
+{
+    if (m_EmitterCount >= m_EmitterCountMax)
+    {
+        return InvalidEmitter;
+    }
+    const int emitter = m_EmitterCount++;
+    SetEmitterPosition(emitter, x, y, z);
+    return emitter;
+}
+
+void Spatializer::SetEmitterPosition(int emitter, float x, float y, float z)
+{
+    m_pX[emitter] = x;
+    m_pY[emitter] = y;
+    m_pZ[emitter] = z;
+}
+
+void Spatializer::SetListenerOrientation(float x, float y, float z, float w)
+{
+    const float lengthSquared = x * x + y * y + z * z + w * w;
+    if (!(lengthSquared > 0.0f))
+    {
+        x = 0.0f;
+        y = 0.0f;
+        z = 0.0f;
+        w = 1.0f;
+    }
+    else
+    {
+        const float scale = 1.0f / std::sqrt(lengthSquared);
+        x *= scale;
+        y *= scale;
+        z *= scale;
+        w *= scale;
+    }
+
+    // The quaternion rotates the listener's space into the positions'; positions are brought back by its transpose.
+    m_Rotation[0] = 1.0f - 2.0f * (y * y + z * z);
+    m_Rotation[1] = 2.0f * (x * y + z * w);
+    m_Rotation[2] = 2.0f * (x * z - y * w);
+    m_Rotation[3] = 2.0f * (x * y - z * w);
+    m_Rotation[4] = 1.0f - 2.0f * (x * x + z * z);
+    m_Rotation[5] = 2.0f * (y * z + x * w);
+    m_Rotation[6] = 2.0f * (x * z + y * w);
+    m_Rotation[7] = 2.0f * (y * z - x * w);
+    m_Rotation[8] = 1.0f - 2.0f * (x * x + y * y);
+}
+
+void Spatializer::Update()
+{
+    if (m_EmitterCount == 0)
+    {
+        return;
+    }
+
+    const Float4 zero = Set4(0.0f);
+    const Float4 one = Set4(1.0f);
+    const Float4 half = Set4(0.5f);
+    const Float4 r00 = Set4(m_Rotation[0]);
+    const Float4 r01 = Set4(m_Rotation[1]);
+    const Float4 r02 = Set4(m_Rotation[2]);
+    const Float4 r10 = Set4(m_Rotation[3]);
+    const Float4 r11 = Set4(m_Rotation[4]);
+    const Float4 r12 = Set4(m_Rotation[5]);
+    const Float4 r20 = Set4(m_Rotation[6]);
+    const Float4 r21 = Set4(m_Rotation[7]);
+    const Float4 r22 = Set4(m_Rotation[8]);
+    const Float4 uniform = Set4(m_DirectionalCount > 0 ? 1.0f / std::sqrt(static_cast<float>(m_DirectionalCount)) : 0.0f);
+    const Float4 threshold = Set4(ChangeThreshold);
+
+    for (int e = 0; e < m_EmitterCount; e += SimdWidth)
+    {
+        // Into the listener's space. Only the horizontal direction pans; the full distance attenuates.
+        const Float4 x = Load4(m_pX + e);
+        const Float4 y = Load4(m_pY + e);
+        const Float4 z = Load4(m_pZ + e);
+        const Float4 right = MulAdd4(MulAdd4(Mul4(r00, x), r01, y), r02, z);
+        const Float4 up = MulAdd4(MulAdd4(Mul4(r10, x), r11, y), r12, z);
+        const Float4 forward = Sub4(zero, MulAdd4(MulAdd4(Mul4(r20, x), r21, y), r22, z));
+        const Float4 horizontalSquared = MulAdd4(Mul4(right, right), forward, forward);
+        const Float4 distanceSquared = MulAdd4(horizontalSquared, up, up);
+        const Float4 attenuation = Div4(one, Sqrt4(Max4(distanceSquared, Set4(ReferenceDistanceSquared))));
+
+        // A source straight above or below is panned to the front.
+        const Float4 isHorizontal = Sub4(horizontalSquared, Set4(HorizontalLengthSquaredMin));
+        const Float4 inverseLength = Div4(one, Sqrt4(Max4(horizontalSquared, Set4(HorizontalLengthSquaredMin))));
+        const Float4 directionRight = SelectNonNegative4(isHorizontal, Mul4(right, inverseLength), zero);
+        const Float4 directionForward = SelectNonNegative4(isHorizontal, Mul4(forward, inverseLength), one);
+
+        Float4 gains[ChannelCountMax];
+        for (int c = 0; c < m_ChannelCount; ++c)
+        {
+            gains[c] = zero;
+        }
+        switch (m_Mode)
+        {
+        case Mode_Mono:
+            gains[m_Directional[0]] = attenuation;
+            break;
+        case Mode_Pair:
+            {
+                // Equal power on the lateral position, which runs from -1 at the left to +1 at the right.
+                const Float4 lateral = Max4(Min4(directionRight, one), Sub4(zero, one));
+                gains[m_Directional[0]] = Mul4(attenuation, Sqrt4(Sub4(half, Mul4(half, lateral))));
+                gains[m_Directional[1]] = Mul4(attenuation, Sqrt4(MulAdd4(half, half, lateral)));
+            }
+            break;
+        case Mode_Ring:
+            {
+                // Only the pair around the source has two non-negative gains; on a speaker, both of its pairs agree.
+                for (int p = 0; p < m_DirectionalCount; ++p)
+                {
+                    const SpeakerPair& pair = m_Pairs[p];
+                    const Float4 first = MulAdd4(Mul4(Set4(pair.firstRight), directionRight), Set4(pair.firstForward), directionForward);
+                    const Float4 second = MulAdd4(Mul4(Set4(pair.secondRight), directionRight), Set4(pair.secondForward), directionForward);
+                    const Float4 isInside = Min4(first, second);
+                    gains[pair.first] = SelectNonNegative4(isInside, first, gains[pair.first]);
+                    gains[pair.second] = SelectNonNegative4(isInside, second, gains[pair.second]);
+                }
+                Float4 power = zero;
+                for (int i = 0; i < m_DirectionalCount; ++i)
+                {
+                    power = MulAdd4(power, gains[m_Directional[i]], gains[m_Directional[i]]);
+                }
+                const Float4 scale = Div4(attenuation, Sqrt4(Max4(power, Set4(HorizontalLengthSquaredMin))));
+                for (int i = 0; i < m_DirectionalCount; ++i)
+                {
+                    gains[m_Directional[i]] = Mul4(gains[m_Directional[i]], scale);
+                }
+            }
+            break;
+        case Mode_Uniform:
+            for (int i = 0; i < m_DirectionalCount; ++i)
+            {
+                gains[m_Directional[i]] = Mul4(attenuation, uniform);
+            }
+            break;
+        default:
+            break;
+        }
+
+        // Keep the gains of emitters that moved less than the threshold on every channel, so they report no change.
+        Float4 change = zero;
+        for (int c = 0; c < m_ChannelCount; ++c)
+        {
+            change = Max4(change, Abs4(Sub4(gains[c], Load4(m_pGains + static_cast<std::size_t>(c) * m_Stride + e))));
+        }
+        const Float4 isChanged = Sub4(change, threshold);
+        for (int c = 0; c < m_ChannelCount; ++c)
+        {
+            float* pRow = m_pGains + static_cast<std::size_t>(c) * m_Stride + e;
+            Store4(pRow, SelectNonNegative4(isChanged, gains[c], Load4(pRow)));
+        }
+        float flags[SimdWidth];
+        Store4(flags, isChanged);
+        for (int i = 0; i < SimdWidth; ++i)
+        {
+            m_pIsChanged[e + i] = flags[i] >= 0.0f ? 1 : 0;
+        }
+    }
+}
+
+}
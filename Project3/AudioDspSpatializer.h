@@ -0,0 +1,123 @@
+#pragma once
+
+/**
+* @brief
+*  Positional panning of many point sources over the channels of one output, for a listener that turns its head.
+*
+*  Emitter positions are relative to the listener, in a right-handed space where the listener faces -z with +y up and
+*  +x to its right. The listener orientation is a unit quaternion that rotates this space into the one the positions
+*  are given in, so an orientation read from a motion sensor turns every source the opposite way. Speakers are given by
+*  azimuth, in degrees clockwise from the front seen from above, and only the horizontal direction of a source is used.
+*
+*  The gains follow the speaker count. One speaker gets every source. Two are panned with the equal-power law on the
+*  lateral position of the source, so a stereo pair has no front and back. Three or more form a ring and are panned
+*  pairwise with VBAP (vector base amplitude panning): the source is split between the two speakers around it and the
+*  pair is scaled to unit power. Within one unit of the listener the gains have unit power; beyond it they fall by
+*  1 / distance.
+*
+*  <tt>Update()</tt> computes the whole gain matrix, channels by emitters, four emitters at a time with
+*  <tt>AudioDsp::Float4</tt>, using a rotation matrix built once per call; there is no trigonometry per emitter. Gains are
+*  kept until they move by more than <tt>ChangeThreshold</tt>, and <tt>IsChanged()</tt> reports which emitters moved, so a
+*  listener that holds still causes no parameter writes.
+*/
+
+#include <cstddef>
+#include <cstdint>
+
+namespace AudioDsp {
+
+class Spatializer
+{
+public:
+    static const int ChannelCountMax = 6;
+    static const int InvalidEmitter = -1;
+
+    //!<  Azimuth of a channel that takes no positional signal, such as the LFE channel.
+    static const float NonDirectional;
+
+    //!<  Largest change of a gain that is not reported; about -60 dB of full scale.
+    static const float ChangeThreshold;
+
+    Spatializer();
+
+    /**
+    * @brief  Fills the speaker azimuths of the usual layout of channelCount channels, in nn::audio::ChannelMapping order.
+    *
+    *  One channel is mono, two are a stereo pair at +-30 degrees, four are a square (front left, front right, rear left,
+    *  rear right at +-45 and +-135 degrees), and six are 5.1 (front left, front right, center, LFE, rear left, rear right,
+    *  with the rear pair at +-110 degrees). Other counts get the stereo pair followed by non-directional channels.
+    */
+    static void GetDefaultLayout(float* pOutAzimuths, int channelCount);
+
+    //!<  Size of the work buffer to pass to <tt>Initialize()</tt>.
+    static std::size_t GetRequiredWorkBufferSize(int emitterCountMax);
+
+    /**
+    * @brief  Prepares a spatializer for up to emitterCountMax emitters over channelCount speakers at pAzimuths.
+    *
+    *  The work buffer holds the positions and the gain matrix and must stay valid while the spatializer is in use. It
+    *  needs no particular alignment. A ring of three or more speakers must leave no gap of 180 degrees or more between
+    *  neighbors; a ring that does is not panned, and every directional speaker gets every source at equal power.
+    */
+    void Initialize(void* workBuffer, std::size_t workBufferSize, int emitterCountMax, const float* pAzimuths, int channelCount);
+
+    //!<  Adds an emitter at the given position. Returns its index, or InvalidEmitter once emitterCountMax are in use.
+    int AddEmitter(float x, float y, float z);
+
+    void SetEmitterPosition(int emitter, float x, float y, float z);
+
+    //!<  Sets the listener orientation as a quaternion (x, y, z, w). It need not be normalized; zero means no rotation.
+    void SetListenerOrientation(float x, float y, float z, float w);
+
+    //!<  Recomputes the gains of every emitter. Call once per audio frame.
+    void Update();
+
+    //!<  True if the gains of emitter moved in the last <tt>Update()</tt>.
+    bool IsChanged(int emitter) const { return m_pIsChanged[emitter] != 0; }
+
+    //!<  Gain of emitter on channel, as of the last update in which it changed.
+    float GetGain(int emitter, int channel) const { return m_pGains[static_cast<std::size_t>(channel) * m_Stride + emitter]; }
+
+    int GetEmitterCount() const { return m_EmitterCount; }
+    int GetChannelCount() const { return m_ChannelCount; }
+
+private:
+    enum Mode
+    {
+        Mode_Silent,                    //!<  No directional speaker.
+        Mode_Mono,
+        Mode_Pair,
+        Mode_Ring,
+        Mode_Uniform                    //!<  A ring with a gap of 180 degrees or more.
+    };
+
+    //!<  Two neighbors of the ring and the inverse of the matrix of their directions.
+    struct SpeakerPair
+    {
+        int first;
+        int second;
+        float firstRight;               //!<  Gain of first = firstRight * right + firstForward * forward.
+        float firstForward;
+        float secondRight;
+        float secondForward;
+    };
+
+    void SetLayout(const float* pAzimuths, int channelCount);
+
+    int m_ChannelCount;
+    int m_EmitterCountMax;
+    int m_EmitterCount;
+    int m_Stride;                       //!<  m_EmitterCountMax rounded up to a multiple of SimdWidth.
+    Mode m_Mode;
+    int m_DirectionalCount;
+    int m_Directional[ChannelCountMax]; //!<  Channels with an azimuth; for Mode_Pair, left then right.
+    SpeakerPair m_Pairs[ChannelCountMax];
+    float m_Rotation[9];                //!<  Row-major matrix from the space of the positions to the listener's.
+    float* m_pX;
+    float* m_pY;
+    float* m_pZ;
+    float* m_pGains;                    //!<  m_ChannelCount rows of m_Stride gains.
+    uint8_t* m_pIsChanged;
+};
+
+}
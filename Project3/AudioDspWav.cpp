@@ -0,0 +1,216 @@
+#include "AudioDspWav.h"
+
+#include <cstring>
+
+namespace AudioDsp {
+
+namespace {
+
+const uint16_t WaveFormatPcm = 0x0001;
+const uint16_t WaveFormatExtensible = 0xFFFE;
+
+// Largest fmt body we look at (WAVEFORMATEXTENSIBLE).
+const std::size_t FormatChunkReadSize = 40;
+// smpl header plus the first loop record.
+const std::size_t SampleChunkReadSize = 36 + 24;
+
+uint32_t ReadU32(const uint8_t* p)
+{
+    return p[0] | (p[1] << 8) | (p[2] << 16) | (static_cast<uint32_t>(p[3]) << 24);
+}
+
+uint16_t ReadU16(const uint8_t* p)
+{
+    return static_cast<uint16_t>(p[0] | (p[1] << 8));
+}
+
+void WriteU32(uint8_t* p, uint32_t value)
+{
+    p[0] = static_cast<uint8_t>(value);
+    p[1] = static_cast<uint8_t>(value >> 8);
+    p[2] = static_cast<uint8_t>(value >> 16);
+    p[3] = static_cast<uint8_t>(value >> 24);
+}
+
+void WriteU16(uint8_t* p, uint16_t value)
+{
+    p[0] = static_cast<uint8_t>(value);
+    p[1] = static_cast<uint8_t>(value >> 8);
+}
+
+struct MemoryReader
+{
+    const uint8_t* data;
+    std::size_t size;
+};
+
+bool ReadMemory(void* pUserData, int64_t offset, void* buffer, std::size_t size)
+{
+    const MemoryReader* pReader = static_cast<const MemoryReader*>(pUserData);
+    if (offset < 0 || static_cast<uint64_t>(offset) + size > pReader->size)
+    {
+        return false;
+    }
+    std::memcpy(buffer, pReader->data + offset, size);
+    return true;
+}
+
+}  // namespace
+
+WavResult ParseWavLayout(WavLayout* pOutLayout, WavReadFunction readFunction, void* pUserData, int64_t fileSize)
+{
+    std::memset(pOutLayout, 0, sizeof(*pOutLayout));
+
+    uint8_t riff[12];
+    if (fileSize < static_cast<int64_t>(sizeof(riff)) || !readFunction(pUserData, 0, riff, sizeof(riff)))
+    {
+        return WavResult_ReadError;
+    }
+    if (ReadU32(riff) != MakeFourCc('R', 'I', 'F', 'F') || ReadU32(riff + 8) != MakeFourCc('W', 'A', 'V', 'E'))
+    {
+        return WavResult_NotRiffWave;
+    }
+
+    // Trust the file size over the RIFF size; writers that crash before patching the header leave it at 0.
+    bool hasFormat = false;
+    bool hasData = false;
+    uint16_t formatTag = 0;
+    uint32_t dataChunkSize = 0;
+    int64_t offset = sizeof(riff);
+    while (offset + 8 <= fileSize)
+    {
+        uint8_t header[8];
+        if (!readFunction(pUserData, offset, header, sizeof(header)))
+        {
+            return WavResult_ReadError;
+        }
+        WavChunk chunk;
+        chunk.id = ReadU32(header);
+        chunk.size = ReadU32(header + 4);
+        chunk.offset = offset + 8;
+        if (pOutLayout->chunkCount < WavChunkCountMax)
+        {
+            pOutLayout->chunks[pOutLayout->chunkCount++] = chunk;
+        }
+
+        const int64_t available = fileSize - chunk.offset;
+        if (chunk.id == MakeFourCc('f', 'm', 't', ' '))
+        {
+            uint8_t body[FormatChunkReadSize] = {};
+            const std::size_t readSize = static_cast<std::size_t>(chunk.size < FormatChunkReadSize ? chunk.size : FormatChunkReadSize);
+            if (readSize < 16 || static_cast<int64_t>(readSize) > available || !readFunction(pUserData, chunk.offset, body, readSize))
+            {
+                return WavResult_ReadError;
+            }
+            formatTag = ReadU16(body);
+            pOutLayout->channelCount = ReadU16(body + 2);
+            pOutLayout->sampleRate = static_cast<int>(ReadU32(body + 4));
+            pOutLayout->blockAlign = ReadU16(body + 12);
+            pOutLayout->bitsPerSample = ReadU16(body + 14);
+            if (formatTag == WaveFormatExtensible && readSize >= FormatChunkReadSize)
+            {
+                // The first two bytes of the subformat GUID carry the format tag.
+                formatTag = ReadU16(body + 24);
+            }
+            hasFormat = true;
+        }
+        else if (chunk.id == MakeFourCc('s', 'm', 'p', 'l') && chunk.size >= SampleChunkReadSize && static_cast<int64_t>(SampleChunkReadSize) <= available)
+        {
+            uint8_t body[SampleChunkReadSize];
+            if (!readFunction(pUserData, chunk.offset, body, sizeof(body)))
+            {
+                return WavResult_ReadError;
+            }
+            if (ReadU32(body + 28) > 0)
+            {
+                // Loop end in a smpl chunk is inclusive.
+                pOutLayout->hasLoop = true;
+                pOutLayout->loopStartFrame = ReadU32(body + 36 + 8);
+                pOutLayout->loopEndFrame = static_cast<int64_t>(ReadU32(body + 36 + 12)) + 1;
+            }
+        }
+        else if (chunk.id == MakeFourCc('d', 'a', 't', 'a') && !hasData)
+        {
+            pOutLayout->dataOffset = chunk.offset;
+            dataChunkSize = chunk.size;
+            hasData = true;
+        }
+
+        offset = chunk.offset + chunk.size + (chunk.size & 1);
+    }
+
+    if (!hasFormat)
+    {
+        return WavResult_NoFormatChunk;
+    }
+    if (!hasData)
+    {
+        return WavResult_NoDataChunk;
+    }
+    if (formatTag != WaveFormatPcm || pOutLayout->channelCount <= 0 || pOutLayout->bitsPerSample <= 0
+        || pOutLayout->blockAlign != pOutLayout->channelCount * ((pOutLayout->bitsPerSample + 7) / 8))
+    {
+        return WavResult_UnsupportedFormat;
+    }
+
+    int64_t dataSize = fileSize - pOutLayout->dataOffset;
+    if (static_cast<int64_t>(dataChunkSize) < dataSize)
+    {
+        dataSize = dataChunkSize;
+    }
+    pOutLayout->frameCount = dataSize / pOutLayout->blockAlign;
+    pOutLayout->dataSize = pOutLayout->frameCount * pOutLayout->blockAlign;
+
+    if (pOutLayout->hasLoop && (pOutLayout->loopStartFrame >= pOutLayout->loopEndFrame || pOutLayout->loopEndFrame > pOutLayout->frameCount))
+    {
+        pOutLayout->hasLoop = false;
+        pOutLayout->loopStartFrame = 0;
+        pOutLayout->loopEndFrame = 0;
+    }
+    return WavResult_Success;
+}
+
+WavResult ParseWavLayout(WavLayout* pOutLayout, const void* data, std::size_t size)
+{
+    MemoryReader reader = { static_cast<const uint8_t*>(data), size };
+    return ParseWavLayout(pOutLayout, ReadMemory, &reader, static_cast<int64_t>(size));
+}
+
+const char* GetWavResultString(WavResult result)
+{
+    switch (result)
+    {
+    case WavResult_Success:
+        return "Success";
+    case WavResult_ReadError:
+        return "ReadError";
+    case WavResult_NotRiffWave:
+        return "NotRiffWave";
+    case WavResult_NoFormatChunk:
+        return "NoFormatChunk";
+    case WavResult_NoDataChunk:
+        return "NoDataChunk";
+    case WavResult_UnsupportedFormat:
+        return "UnsupportedFormat";
+    default:
+        return "Unknown";
+    }
+}
+
+void MakeWavHeader(void* header, int sampleRate, int channelCount, uint32_t dataSize)
+{
+    uint8_t* p = static_cast<uint8_t*>(header);
+    std::memcpy(p, "RIFF\0\0\0\0WAVEfmt ", 16);
+    WriteU32(p + 4, 36 + dataSize);
+    WriteU32(p + 16, 16);
+    WriteU16(p + 20, WaveFormatPcm);
+    WriteU16(p + 22, static_cast<uint16_t>(channelCount));
+    WriteU32(p + 24, static_cast<uint32_t>(sampleRate));
+    WriteU32(p + 28, static_cast<uint32_t>(sampleRate * channelCount * 2));
+    WriteU16(p + 32, static_cast<uint16_t>(channelCount * 2));
+    WriteU16(p + 34, 16);
+    std::memcpy(p + 36, "data", 4);
+    WriteU32(p + 40, dataSize);
+}
+
+}  // namespace AudioDsp
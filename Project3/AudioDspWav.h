@@ -0,0 +1,79 @@
+#pragma once
+
+/**
+* @brief
+*  RIFF/WAVE chunk parser shared by the console loaders and the host tools.
+*
+*  The parser only reads chunk headers and the small chunks it understands (<tt>fmt </tt>, <tt>smpl</tt>),
+*  so the sample data can be read straight into its final location afterwards.
+*/
+
+#include <cstddef>
+#include <cstdint>
+
+namespace AudioDsp {
+
+const int WavChunkCountMax = 16;            //!<  Chunks recorded in WavLayout::chunks; later ones are walked but not recorded.
+
+enum WavResult
+{
+    WavResult_Success,
+    WavResult_ReadError,                    //!<  The read function failed or the file ended inside a header.
+    WavResult_NotRiffWave,                  //!<  The file does not start with a RIFF/WAVE header.
+    WavResult_NoFormatChunk,
+    WavResult_NoDataChunk,
+    WavResult_UnsupportedFormat             //!<  Not integer PCM (WAVE_FORMAT_PCM or WAVE_FORMAT_EXTENSIBLE with a PCM subformat).
+};
+
+struct WavChunk
+{
+    uint32_t id;                            //!<  FourCC as stored in the file, see MakeFourCc().
+    uint32_t size;                          //!<  Body size from the chunk header, without padding.
+    int64_t  offset;                        //!<  File offset of the chunk body.
+};
+
+struct WavLayout
+{
+    int      channelCount;
+    int      sampleRate;
+    int      bitsPerSample;
+    int      blockAlign;                    //!<  Bytes per sample frame.
+    int64_t  dataOffset;                    //!<  File offset of the first sample frame.
+    int64_t  dataSize;                      //!<  Bytes of sample data, clamped to the file size and rounded down to whole frames.
+    int64_t  frameCount;
+    bool     hasLoop;                       //!<  True if a <tt>smpl</tt> chunk defines a loop.
+    int64_t  loopStartFrame;
+    int64_t  loopEndFrame;                  //!<  Exclusive.
+    WavChunk chunks[WavChunkCountMax];
+    int      chunkCount;
+};
+
+//!<  Reads <tt>size</tt> bytes at <tt>offset</tt>. Returns false on failure.
+typedef bool (*WavReadFunction)(void* pUserData, int64_t offset, void* buffer, std::size_t size);
+
+inline uint32_t MakeFourCc(char a, char b, char c, char d)
+{
+    return static_cast<uint32_t>(static_cast<uint8_t>(a))
+        | (static_cast<uint32_t>(static_cast<uint8_t>(b)) << 8)
+        | (static_cast<uint32_t>(static_cast<uint8_t>(c)) << 16)
+        | (static_cast<uint32_t>(static_cast<uint8_t>(d)) << 24);
+}
+
+/**
+* @brief  Walks the RIFF chunks of a file of <tt>fileSize</tt> bytes through <tt>readFunction</tt>.
+*
+*  Every read is a chunk header (8 bytes) or a <tt>fmt </tt>/<tt>smpl</tt> body, so the cost does not depend on the data size.
+*/
+WavResult ParseWavLayout(WavLayout* pOutLayout, WavReadFunction readFunction, void* pUserData, int64_t fileSize);
+
+//!<  Same as above for a file already in memory.
+WavResult ParseWavLayout(WavLayout* pOutLayout, const void* data, std::size_t size);
+
+const char* GetWavResultString(WavResult result);
+
+const std::size_t WavHeaderSize = 44;       //!<  Bytes of the header written by MakeWavHeader().
+
+//!<  Fills header with a canonical 16-bit PCM WAV header for dataSize bytes of samples, which follow it directly.
+void MakeWavHeader(void* header, int sampleRate, int channelCount, uint32_t dataSize);
+
+}  // namespace AudioDsp
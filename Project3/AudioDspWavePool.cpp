@@ -0,0 +1,194 @@
+#include "AudioDspWavePool.h"
+
+namespace AudioDsp {
+
+namespace {
+
+std::size_t AlignUp(std::size_t value, std::size_t alignment)
+{
+    return (value + alignment - 1) & ~(alignment - 1);
+}
+
+}
+
+WavePool::WavePool()
+    : m_SlabCount(0)
+    , m_Alignment(1)
+    , m_Size(0)
+    , m_pLongLivedBegin(nullptr)
+    , m_pLongLivedEnd(nullptr)
+    , m_pLongLivedTop(nullptr)
+    , m_LongLivedCount(0)
+    , m_LongLivedFreedSize(0)
+    , m_LongLivedPeakSize(0)
+    , m_FailureCount(0)
+{
+}
+
+std::size_t WavePool::GetRequiredSlabSize(const WavePoolSlabConfig* slabs, int slabCount, std::size_t alignment)
+{
+    std::size_t size = 0;
+    for (int i = 0; i < slabCount; ++i)
+    {
+        size += AlignUp(slabs[i].blockSize, alignment) * slabs[i].blockCount;
+    }
+    return size;
+}
+
+void WavePool::Initialize(void* buffer, std::size_t size, std::size_t alignment, const WavePoolSlabConfig* slabs, int slabCount)
+{
+    m_SlabCount = 0;
+    m_Alignment = 1;
+    m_Size = 0;
+    m_pLongLivedBegin = nullptr;
+    m_pLongLivedEnd = nullptr;
+    m_pLongLivedTop = nullptr;
+    m_LongLivedCount = 0;
+    m_LongLivedFreedSize = 0;
+    m_LongLivedPeakSize = 0;
+    m_FailureCount = 0;
+
+    // Blocks must hold the free list link.
+    const bool isAlignmentValid = alignment >= sizeof(void*) && (alignment & (alignment - 1)) == 0;
+    if (buffer == nullptr || !isAlignmentValid || reinterpret_cast<uintptr_t>(buffer) % alignment != 0
+        || slabCount < 0 || slabCount > WavePoolSlabCountMax)
+    {
+        return;
+    }
+    for (int i = 0; i < slabCount; ++i)
+    {
+        if (slabs[i].blockSize == 0 || slabs[i].blockCount < 0)
+        {
+            return;
+        }
+    }
+    if (GetRequiredSlabSize(slabs, slabCount, alignment) > size)
+    {
+        return;
+    }
+
+    // Each slab is threaded into a free list in address order, so the first blocks handed out are the lowest.
+    char* pCursor = static_cast<char*>(buffer);
+    for (int i = 0; i < slabCount; ++i)
+    {
+        Slab& slab = m_Slabs[i];
+        slab.blockSize = AlignUp(slabs[i].blockSize, alignment);
+        slab.blockCount = slabs[i].blockCount;
+        slab.usedCount = 0;
+        slab.peakUsedCount = 0;
+        slab.pBegin = pCursor;
+        slab.pEnd = pCursor + slab.blockSize * slab.blockCount;
+        slab.pFreeList = nullptr;
+        for (int j = slab.blockCount - 1; j >= 0; --j)
+        {
+            void* pBlock = slab.pBegin + slab.blockSize * j;
+            *static_cast<void**>(pBlock) = slab.pFreeList;
+            slab.pFreeList = pBlock;
+        }
+        pCursor = slab.pEnd;
+    }
+    m_SlabCount = slabCount;
+    m_Alignment = alignment;
+    m_Size = size;
+    m_pLongLivedBegin = pCursor;
+    m_pLongLivedEnd = static_cast<char*>(buffer) + size;
+    m_pLongLivedTop = pCursor;
+}
+
+void* WavePool::AllocateBlock(std::size_t size)
+{
+    // Slabs are few, so finding the size class is a short scan.
+    Slab* pSlab = nullptr;
+    for (int i = 0; i < m_SlabCount; ++i)
+    {
+        if (m_Slabs[i].blockSize >= size && (pSlab == nullptr || m_Slabs[i].blockSize < pSlab->blockSize))
+        {
+            pSlab = &m_Slabs[i];
+        }
+    }
+    if (pSlab == nullptr || pSlab->pFreeList == nullptr)
+    {
+        ++m_FailureCount;
+        return nullptr;
+    }
+    void* pBlock = pSlab->pFreeList;
+    pSlab->pFreeList = *static_cast<void**>(pBlock);
+    ++pSlab->usedCount;
+    pSlab->peakUsedCount = pSlab->usedCount > pSlab->peakUsedCount ? pSlab->usedCount : pSlab->peakUsedCount;
+    return pBlock;
+}
+
+void* WavePool::AllocateLongLived(std::size_t size)
+{
+    const std::size_t alignedSize = AlignUp(size, m_Alignment);
+    if (m_pLongLivedTop == nullptr || size == 0 || alignedSize > static_cast<std::size_t>(m_pLongLivedEnd - m_pLongLivedTop))
+    {
+        ++m_FailureCount;
+        return nullptr;
+    }
+    void* p = m_pLongLivedTop;
+    m_pLongLivedTop += alignedSize;
+    ++m_LongLivedCount;
+    const std::size_t usedSize = static_cast<std::size_t>(m_pLongLivedTop - m_pLongLivedBegin);
+    m_LongLivedPeakSize = usedSize > m_LongLivedPeakSize ? usedSize : m_LongLivedPeakSize;
+    return p;
+}
+
+void WavePool::FreeBlock(void* p)
+{
+    char* pBlock = static_cast<char*>(p);
+    for (int i = 0; i < m_SlabCount; ++i)
+    {
+        Slab& slab = m_Slabs[i];
+        if (pBlock >= slab.pBegin && pBlock < slab.pEnd)
+        {
+            *static_cast<void**>(p) = slab.pFreeList;
+            slab.pFreeList = p;
+            --slab.usedCount;
+            return;
+        }
+    }
+}
+
+void WavePool::FreeLongLived(void* p, std::size_t size)
+{
+    char* pPiece = static_cast<char*>(p);
+    if (pPiece == nullptr || pPiece < m_pLongLivedBegin || pPiece >= m_pLongLivedTop)
+    {
+        return;
+    }
+    --m_LongLivedCount;
+    if (m_LongLivedCount == 0)
+    {
+        m_pLongLivedTop = m_pLongLivedBegin;
+        m_LongLivedFreedSize = 0;
+    }
+    else if (pPiece + AlignUp(size, m_Alignment) == m_pLongLivedTop)
+    {
+        m_pLongLivedTop = pPiece;
+    }
+    else
+    {
+        m_LongLivedFreedSize += AlignUp(size, m_Alignment);
+    }
+}
+
+void WavePool::GetStatistics(WavePoolStatistics* pOutStatistics) const
+{
+    pOutStatistics->size = m_Size;
+    pOutStatistics->slabCount = m_SlabCount;
+    for (int i = 0; i < m_SlabCount; ++i)
+    {
+        pOutStatistics->slabs[i].blockSize = m_Slabs[i].blockSize;
+        pOutStatistics->slabs[i].blockCount = m_Slabs[i].blockCount;
+        pOutStatistics->slabs[i].usedCount = m_Slabs[i].usedCount;
+        pOutStatistics->slabs[i].peakUsedCount = m_Slabs[i].peakUsedCount;
+    }
+    pOutStatistics->longLivedSize = static_cast<std::size_t>(m_pLongLivedEnd - m_pLongLivedBegin);
+    pOutStatistics->longLivedUsedSize = static_cast<std::size_t>(m_pLongLivedTop - m_pLongLivedBegin);
+    pOutStatistics->longLivedFreedSize = m_LongLivedFreedSize;
+    pOutStatistics->longLivedPeakSize = m_LongLivedPeakSize;
+    pOutStatistics->failureCount = m_FailureCount;
+}
+
+}
@@ -0,0 +1,108 @@
+#pragma once
+
+/**
+* @brief
+*  Allocator for sample memory, split into slabs of fixed-size blocks and a bump region.
+*
+*  Sample memory is allocated in two patterns: blocks of a few fixed sizes that come and go while the game runs, such as
+*  the wave buffers of streams, and large pieces that live until a level or the whole engine goes away, such as banks.
+*  Mixing both in one general heap leaves holes between the long-lived pieces that the next large piece does not fit.
+*  Here each block size has a slab of its own, carved out once, so a freed block is always reused by the next block of
+*  its size and the slabs never fragment. The long-lived pieces are bumped from the rest of the memory. Freeing the
+*  topmost piece lowers the top; any other piece is counted as freed and its bytes come back once every piece is
+*  freed, so the region holds no holes after a level unloads all its banks.
+*
+*  Every block and piece starts at a multiple of the alignment (nn::audio::BufferAlignSize for the renderer), and every
+*  call is O(1) in the number of blocks. Free blocks are linked through their own first bytes, so the pool needs no
+*  memory besides the one it manages. The pool is not thread-safe.
+*/
+
+#include <cstddef>
+#include <cstdint>
+
+namespace AudioDsp {
+
+const int WavePoolSlabCountMax = 4;
+
+struct WavePoolSlabConfig
+{
+    std::size_t blockSize;                  //!<  Rounded up to the alignment.
+    int blockCount;
+};
+
+struct WavePoolSlabStatistics
+{
+    std::size_t blockSize;
+    int blockCount;
+    int usedCount;
+    int peakUsedCount;
+};
+
+struct WavePoolStatistics
+{
+    std::size_t size;
+    int slabCount;
+    WavePoolSlabStatistics slabs[WavePoolSlabCountMax];
+    std::size_t longLivedSize;              //!<  Bytes of the bump region.
+    std::size_t longLivedUsedSize;          //!<  Bytes below the top of the bump region, freed pieces included.
+    std::size_t longLivedFreedSize;         //!<  Bytes of freed pieces waiting for the pieces above them to be freed.
+    std::size_t longLivedPeakSize;
+    int failureCount;                       //!<  Allocations refused since <tt>Initialize()</tt>.
+};
+
+class WavePool
+{
+public:
+    WavePool();
+
+    //!<  Bytes Initialize() needs for the slabs alone, before any bump region.
+    static std::size_t GetRequiredSlabSize(const WavePoolSlabConfig* slabs, int slabCount, std::size_t alignment);
+
+    /**
+    * @brief  Lays out the slabs at the start of buffer and leaves the rest for the bump region.
+    *
+    *  alignment must be a power of two and buffer aligned to it. With an invalid argument or a buffer too small for
+    *  the slabs, the pool is left empty and every allocation fails.
+    */
+    void Initialize(void* buffer, std::size_t size, std::size_t alignment, const WavePoolSlabConfig* slabs, int slabCount);
+
+    //!<  A block from the smallest slab whose blocks hold size bytes. Null if that slab is full.
+    void* AllocateBlock(std::size_t size);
+
+    //!<  A long-lived piece of size bytes from the bump region. Null if the region is full.
+    void* AllocateLongLived(std::size_t size);
+
+    //!<  Returns a block to its slab. Null is ignored.
+    void FreeBlock(void* p);
+
+    //!<  Frees a piece of size bytes, as passed to <tt>AllocateLongLived()</tt>. Null is ignored.
+    void FreeLongLived(void* p, std::size_t size);
+
+    void GetStatistics(WavePoolStatistics* pOutStatistics) const;
+
+private:
+    struct Slab
+    {
+        char* pBegin;
+        char* pEnd;
+        std::size_t blockSize;
+        void* pFreeList;
+        int blockCount;
+        int usedCount;
+        int peakUsedCount;
+    };
+
+    Slab m_Slabs[WavePoolSlabCountMax];
+    int m_SlabCount;
+    std::size_t m_Alignment;
+    std::size_t m_Size;
+    char* m_pLongLivedBegin;
+    char* m_pLongLivedEnd;
+    char* m_pLongLivedTop;
+    int m_LongLivedCount;                   //!<  Live pieces.
+    std::size_t m_LongLivedFreedSize;
+    std::size_t m_LongLivedPeakSize;
+    int m_FailureCount;
+};
+
+}
@@ -0,0 +1,1364 @@
+#include <algorithm>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <new>
+
+#include <nn/fs.h>
+#include <nn/nn_Abort.h>
+#include <nn/nn_Log.h>
+
+#include "AudioEngine.h"
+
+namespace {
+
+std::size_t AlignUp(std::size_t value, std::size_t alignment)
+{
+    return (value + alignment - 1) & ~(alignment - 1);
+}
+
+// Reserves size bytes at the next multiple of alignment and returns their offset.
+std::size_t Reserve(std::size_t* pCursor, std::size_t size, std::size_t alignment)
+{
+    const std::size_t offset = AlignUp(*pCursor, alignment);
+    *pCursor = offset + size;
+    return offset;
+}
+
+// An instance with a voice ranks as this much louder, so near-equal instances do not trade the voice every update.
+const float VirtualVoiceHysteresis = 2.0f;
+
+// One block per stream, in the slab of the wave pool.
+void GetStreamSlabConfig(AudioDsp::WavePoolSlabConfig* pOutConfig, const AudioEngineGraph& graph)
+{
+    pOutConfig->blockSize = AudioStreamPlayer::GetRequiredBufferSize();
+    pOutConfig->blockCount = graph.streamCountMax;
+}
+
+// Reads the banks of a manifest for AudioDsp::ComputeBudget(), keeping the last one opened open for the reads that follow.
+struct ManifestReader
+{
+    const AudioEngineManifest* pManifest;
+    int openBank;
+    nn::fs::FileHandle handle;
+
+    static bool Read(void* pUserData, int bank, int64_t offset, void* buffer, std::size_t size)
+    {
+        ManifestReader* pReader = static_cast<ManifestReader*>(pUserData);
+        if (bank != pReader->openBank)
+        {
+            pReader->Close();
+            if (nn::fs::OpenFile(&pReader->handle, pReader->pManifest->bankFileNames[bank], nn::fs::OpenMode_Read).IsFailure())
+            {
+                return false;
+            }
+            pReader->openBank = bank;
+        }
+        std::size_t readSize;
+        return nn::fs::ReadFile(&readSize, pReader->handle, offset, buffer, size).IsSuccess() && readSize == size;
+    }
+
+    void Close()
+    {
+        if (openBank >= 0)
+        {
+            nn::fs::CloseFile(handle);
+            openBank = -1;
+        }
+    }
+};
+
+// Logs used of reserved, and the part of reserved never used.
+void DumpBudgetLine(const char* label, std::size_t used, std::size_t reserved)
+{
+    NN_LOG("[budget] %-16s %10zu of %10zu, slack %10zu\n", label, used, reserved, reserved > used ? reserved - used : 0);
+}
+
+}
+
+void InitializeAudioEngineGraph(AudioEngineGraph* pOutGraph) NN_NOEXCEPT
+{
+    pOutGraph->sampleRate = 48000;
+    pOutGraph->sampleCount = 240;
+    pOutGraph->finalMixBufferCount = 6;
+    pOutGraph->channelCount = 2;
+    for (int i = 0; i < AudioEngineChannelCountMax; ++i)
+    {
+        pOutGraph->mainBus[i] = static_cast<int8_t>(i);
+        pOutGraph->auxBus[i] = static_cast<int8_t>(i);
+    }
+    pOutGraph->isAuxBusEnabled = false;
+    pOutGraph->deviceName = "MainAudioOut";
+
+    pOutGraph->subMixCount = 0;
+    for (int i = 0; i < AudioEngineSubMixCountMax; ++i)
+    {
+        pOutGraph->subMixes[i].bufferCount = 1;
+        pOutGraph->subMixes[i].destination = AudioEngine::Destination_MainBus;
+        pOutGraph->subMixes[i].volume = 1.0f;
+    }
+
+    pOutGraph->streamCountMax = 0;
+    pOutGraph->streamChannelCountMax = 2;
+    pOutGraph->oscillatorCountMax = 0;
+    pOutGraph->oscillatorDestination = AudioEngine::Destination_MainBus;
+    pOutGraph->oscillatorVolume = 1.0f;
+    pOutGraph->voiceCount = 0;
+    pOutGraph->voiceChannelCountMax = 1;
+    pOutGraph->soundEffectCountMax = 0;
+    pOutGraph->bankCountMax = 0;
+    pOutGraph->bankPoolSize = 0;
+    pOutGraph->rampCountMax = 0;
+    pOutGraph->emitterCountMax = 0;
+    pOutGraph->commandCountMax = 64;
+    pOutGraph->scheduledCommandCountMax = 64;
+    pOutGraph->isVirtualVoiceEnabled = false;
+    pOutGraph->virtualVoiceThreshold = 0.001f;
+    pOutGraph->performanceFrameCount = 0;
+
+    pOutGraph->isMeteringEnabled = false;
+    for (int i = 0; i < AudioEngineChannelCountMax; ++i)
+    {
+        pOutGraph->meterBus[i] = static_cast<int8_t>(2 + i);
+    }
+    pOutGraph->captureFrameCount = 0;
+
+    pOutGraph->isUpdateThreadEnabled = false;
+    pOutGraph->updateThreadPriority = nn::os::DefaultThreadPriority;
+}
+
+void ApplyAudioEngineManifest(AudioEngineGraph* pGraph, const AudioEngineManifest& manifest) NN_NOEXCEPT
+{
+    NN_ABORT_UNLESS(manifest.bankCount >= 0 && manifest.soundEffectCount >= 0 && manifest.voiceCountMax >= 0);
+
+    ManifestReader reader;
+    reader.pManifest = &manifest;
+    reader.openBank = -1;
+    AudioDsp::Budget budget;
+    const AudioDsp::BankResult result = AudioDsp::ComputeBudget(&budget, manifest.bankCount, manifest.soundEffects, manifest.soundEffectCount,
+                                                                nn::audio::BufferAlignSize, ManifestReader::Read, &reader);
+    reader.Close();
+    NN_ABORT_UNLESS(result == AudioDsp::BankResult_Success, "Failed to read a bank of the manifest (%s)", AudioDsp::GetBankResultString(result));
+    NN_ABORT_UNLESS(budget.missingSound < 0, "Sound effect %s is not in its bank", budget.missingSound >= 0 ? manifest.soundEffects[budget.missingSound].name : "");
+
+    pGraph->bankCountMax = manifest.bankCount;
+    pGraph->bankPoolSize = budget.bankPoolSize;
+    pGraph->soundEffectCountMax = manifest.soundEffectCount;
+    pGraph->voiceCount = manifest.voiceCountMax > 0 ? std::min(budget.voiceCount, manifest.voiceCountMax) : budget.voiceCount;
+    pGraph->voiceChannelCountMax = budget.voiceChannelCountMax;
+}
+
+AudioEngine::AudioEngine() NN_NOEXCEPT
+    : m_pWorkBuffer(nullptr)
+    , m_pPoolBuffer(nullptr)
+    , m_WorkBufferSize(0)
+    , m_PoolBufferSize(0)
+    , m_pScheduledCommands(nullptr)
+    , m_ScheduledCommandCount(0)
+    , m_PeakScheduledCommandCount(0)
+    , m_ScheduleSequence(0)
+    , m_DroppedScheduledCommandCount(0)
+    , m_SampleTime(0)
+    , m_ListenerSequence(0)
+    , m_pStreams(nullptr)
+    , m_pSoundEffects(nullptr)
+    , m_pBanks(nullptr)
+    , m_pEmitters(nullptr)
+    , m_pMeterTaps(nullptr)
+    , m_pVoiceCandidates(nullptr)
+    , m_VirtualVoiceCount(0)
+    , m_StreamCount(0)
+    , m_SoundEffectCount(0)
+    , m_BankCount(0)
+    , m_IsInitialized(false)
+    , m_IsStarted(false)
+{
+}
+
+void AudioEngine::GetAudioRendererParameter(nn::audio::AudioRendererParameter* pOutParameter, const AudioEngineGraph& graph) NN_NOEXCEPT
+{
+    int mixBufferCount = graph.finalMixBufferCount;
+    for (int i = 0; i < graph.subMixCount; ++i)
+    {
+        // A metered sub mix has as many buffers again for the return of its tap.
+        mixBufferCount += graph.subMixes[i].bufferCount * (graph.isMeteringEnabled ? 2 : 1);
+    }
+
+    nn::audio::InitializeAudioRendererParameter(pOutParameter);
+    pOutParameter->sampleRate = graph.sampleRate;
+    pOutParameter->sampleCount = graph.sampleCount;
+    pOutParameter->mixBufferCount = mixBufferCount;
+    pOutParameter->voiceCount = graph.streamCountMax * graph.streamChannelCountMax
+                              + (graph.oscillatorCountMax > 0 ? 1 : 0)
+                              + graph.voiceCount * graph.voiceChannelCountMax;
+    pOutParameter->subMixCount = graph.subMixCount;
+    pOutParameter->sinkCount = 1;
+    pOutParameter->effectCount = (graph.isAuxBusEnabled ? 1 : 0) + (graph.isMeteringEnabled ? GetMeterTapCount(graph) : 0);
+    pOutParameter->performanceFrameCount = graph.performanceFrameCount;
+}
+
+void AudioEngine::ComputeLayout(Layout* pOutLayout, const AudioEngineGraph& graph, const nn::audio::AudioRendererParameter& parameter) NN_NOEXCEPT
+{
+    // Work buffer. The renderer and config buffers come first, at the page alignment the base is required to have.
+    std::size_t cursor = 0;
+    pOutLayout->rendererWorkBufferSize = nn::audio::GetAudioRendererWorkBufferSize(parameter);
+    pOutLayout->rendererWorkBuffer = Reserve(&cursor, pOutLayout->rendererWorkBufferSize, nn::os::MemoryPageSize);
+    pOutLayout->configBufferSize = nn::audio::GetAudioRendererConfigWorkBufferSize(parameter);
+    pOutLayout->configBuffer = Reserve(&cursor, pOutLayout->configBufferSize, nn::os::MemoryPageSize);
+    pOutLayout->metricsBufferSize = graph.performanceFrameCount > 0 ? AudioPerformanceMetrics::GetRequiredBufferSize(parameter) : 0;
+    pOutLayout->metricsBuffer = Reserve(&cursor, pOutLayout->metricsBufferSize, nn::audio::BufferAlignSize);
+    pOutLayout->voiceManagerBuffer = Reserve(&cursor, graph.voiceCount > 0 ? AudioVoiceManager::GetRequiredWorkBufferSize(graph.voiceCount) : 0, NN_ALIGNOF(std::max_align_t));
+    pOutLayout->rampBuffer = Reserve(&cursor, graph.rampCountMax > 0 ? AudioRampEngine::GetRequiredWorkBufferSize(graph.rampCountMax) : 0, NN_ALIGNOF(std::max_align_t));
+    pOutLayout->spatializerBufferSize = AudioDsp::Spatializer::GetRequiredWorkBufferSize(graph.emitterCountMax);
+    pOutLayout->spatializerBuffer = Reserve(&cursor, pOutLayout->spatializerBufferSize, NN_ALIGNOF(std::max_align_t));
+    pOutLayout->emitters = Reserve(&cursor, sizeof(EmitterEntry) * graph.emitterCountMax, NN_ALIGNOF(EmitterEntry));
+    pOutLayout->commands = Reserve(&cursor, AudioDsp::MpscQueue<Command>::GetRequiredWorkBufferSize(graph.commandCountMax),
+                                   NN_ALIGNOF(AudioDsp::MpscQueue<Command>::Slot));
+    pOutLayout->scheduledCommands = Reserve(&cursor, sizeof(Command) * graph.scheduledCommandCountMax, NN_ALIGNOF(Command));
+    const int voiceCandidateCount = graph.isVirtualVoiceEnabled ? graph.soundEffectCountMax * AudioSoundEffect::PolyphonyMax : 0;
+    pOutLayout->voiceCandidates = Reserve(&cursor, sizeof(VoiceCandidate) * voiceCandidateCount, NN_ALIGNOF(VoiceCandidate));
+    const int meterTapCount = graph.isMeteringEnabled ? GetMeterTapCount(graph) : 0;
+    const int meterChannelCountMax = GetMeterChannelCountMax(graph);
+    pOutLayout->meterTaps = Reserve(&cursor, sizeof(AudioMeterTap) * meterTapCount, NN_ALIGNOF(AudioMeterTap));
+    pOutLayout->meterReadBufferStride = AlignUp(AudioMeterTap::GetRequiredWorkBufferSize(parameter, meterChannelCountMax), NN_ALIGNOF(std::max_align_t));
+    pOutLayout->meterReadBuffers = Reserve(&cursor, pOutLayout->meterReadBufferStride * meterTapCount, NN_ALIGNOF(std::max_align_t));
+    const bool isCaptureEnabled = graph.isMeteringEnabled && graph.captureFrameCount > 0;
+    pOutLayout->captureBufferSize = isCaptureEnabled ? AudioCaptureWriter::GetRequiredWorkBufferSize(parameter, graph.channelCount, graph.captureFrameCount) : 0;
+    pOutLayout->captureBuffer = Reserve(&cursor, pOutLayout->captureBufferSize, NN_ALIGNOF(std::max_align_t));
+    pOutLayout->captureThreadStack = Reserve(&cursor, isCaptureEnabled ? AudioCaptureWriter::ThreadStackSize : 0, nn::os::ThreadStackAlignment);
+    pOutLayout->oscillatorWorkBuffer = Reserve(&cursor, graph.oscillatorCountMax > 0 ? AudioOscillatorPlayer::GetRequiredWorkBufferSize(graph.oscillatorCountMax) : 0, NN_ALIGNOF(std::max_align_t));
+    pOutLayout->streams = Reserve(&cursor, sizeof(StreamEntry) * graph.streamCountMax, NN_ALIGNOF(StreamEntry));
+    pOutLayout->streamStacks = Reserve(&cursor, AudioStreamPlayer::ThreadStackSize * graph.streamCountMax, nn::os::ThreadStackAlignment);
+    pOutLayout->soundEffects = Reserve(&cursor, sizeof(SoundEffectEntry) * graph.soundEffectCountMax, NN_ALIGNOF(SoundEffectEntry));
+    pOutLayout->banks = Reserve(&cursor, sizeof(AudioBank) * graph.bankCountMax, NN_ALIGNOF(AudioBank));
+    pOutLayout->updateThreadStack = Reserve(&cursor, graph.isUpdateThreadEnabled ? AudioUpdateThread::ThreadStackSize : 0, nn::os::ThreadStackAlignment);
+    pOutLayout->workBufferSize = cursor;
+
+    // Pool buffer. Everything the renderer reads samples from.
+    cursor = 0;
+    pOutLayout->oscillatorBuffer = Reserve(&cursor, graph.oscillatorCountMax > 0 ? AudioOscillatorPlayer::GetRequiredBufferSize() : 0, nn::audio::BufferAlignSize);
+    pOutLayout->silenceBufferSize = graph.soundEffectCountMax > 0 ? AudioSoundEffect::GetRequiredSilenceBufferSize(graph.sampleCount) : 0;
+    pOutLayout->silenceBuffer = Reserve(&cursor, pOutLayout->silenceBufferSize, nn::audio::BufferAlignSize);
+    AudioDsp::WavePoolSlabConfig streamSlab;
+    GetStreamSlabConfig(&streamSlab, graph);
+    pOutLayout->wavePoolSize = AudioDsp::WavePool::GetRequiredSlabSize(&streamSlab, 1, nn::audio::BufferAlignSize)
+                             + AlignUp(graph.bankCountMax > 0 ? graph.bankPoolSize : 0, nn::audio::BufferAlignSize);
+    pOutLayout->wavePool = Reserve(&cursor, pOutLayout->wavePoolSize, nn::audio::BufferAlignSize);
+    pOutLayout->meterBufferStride = AlignUp(AudioMeterTap::GetRequiredPoolBufferSize(parameter, meterChannelCountMax), nn::audio::BufferAlignSize);
+    pOutLayout->meterBuffers = Reserve(&cursor, pOutLayout->meterBufferStride * meterTapCount, nn::audio::BufferAlignSize);
+    pOutLayout->poolBufferSize = AlignUp(cursor, nn::audio::MemoryPoolType::SizeGranularity);
+}
+
+std::size_t AudioEngine::GetRequiredWorkBufferSize(const AudioEngineGraph& graph) NN_NOEXCEPT
+{
+    nn::audio::AudioRendererParameter parameter;
+    GetAudioRendererParameter(&parameter, graph);
+    Layout layout;
+    ComputeLayout(&layout, graph, parameter);
+    return layout.workBufferSize;
+}
+
+std::size_t AudioEngine::GetRequiredPoolBufferSize(const AudioEngineGraph& graph) NN_NOEXCEPT
+{
+    nn::audio::AudioRendererParameter parameter;
+    GetAudioRendererParameter(&parameter, graph);
+    Layout layout;
+    ComputeLayout(&layout, graph, parameter);
+    return layout.poolBufferSize;
+}
+
+void AudioEngine::Initialize(const AudioEngineGraph& graph, void* workBuffer, std::size_t workBufferSize,
+                             void* poolBuffer, std::size_t poolBufferSize) NN_NOEXCEPT
+{
+    NN_ABORT_UNLESS(!m_IsInitialized);
+    NN_ABORT_UNLESS(graph.channelCount > 0 && graph.channelCount <= AudioEngineChannelCountMax);
+    for (int i = 0; i < graph.channelCount; ++i)
+    {
+        NN_ABORT_UNLESS_RANGE(graph.mainBus[i], 0, graph.finalMixBufferCount);
+        NN_ABORT_UNLESS(!graph.isAuxBusEnabled || (graph.auxBus[i] >= 0 && graph.auxBus[i] < graph.finalMixBufferCount));
+        if (graph.isMeteringEnabled)
+        {
+            // The taps write their return to meterBus, so it must not be a buffer anything listens to.
+            NN_ABORT_UNLESS_RANGE(graph.meterBus[i], 0, graph.finalMixBufferCount);
+            for (int j = 0; j < graph.channelCount; ++j)
+            {
+                NN_ABORT_UNLESS(graph.meterBus[i] != graph.mainBus[j]);
+                NN_ABORT_UNLESS(!graph.isAuxBusEnabled || graph.meterBus[i] != graph.auxBus[j]);
+            }
+        }
+    }
+    NN_ABORT_UNLESS(!graph.isMeteringEnabled || graph.channelCount <= AudioDsp::MeterChannelCountMax);
+    NN_ABORT_UNLESS(graph.captureFrameCount == 0
+        || (graph.isMeteringEnabled && graph.captureFrameCount > 0 && (graph.captureFrameCount & (graph.captureFrameCount - 1)) == 0));
+    NN_ABORT_UNLESS_MINMAX(graph.subMixCount, 0, AudioEngineSubMixCountMax);
+    NN_ABORT_UNLESS(graph.streamCountMax >= 0 && graph.oscillatorCountMax >= 0 && graph.voiceCount >= 0);
+    NN_ABORT_UNLESS(graph.soundEffectCountMax >= 0 && graph.bankCountMax >= 0 && graph.rampCountMax >= 0 && graph.emitterCountMax >= 0);
+    NN_ABORT_UNLESS(graph.soundEffectCountMax == 0 || graph.voiceCount > 0);
+    NN_ABORT_UNLESS(graph.commandCountMax > 0 && (graph.commandCountMax & (graph.commandCountMax - 1)) == 0);
+    NN_ABORT_UNLESS(graph.scheduledCommandCountMax >= 0);
+
+    m_Graph = graph;
+    GetAudioRendererParameter(&m_Parameter, graph);
+    NN_ABORT_UNLESS(
+        nn::audio::IsValidAudioRendererParameter(m_Parameter),
+        "Invalid AudioRendererParameter specified."
+    );
+    ComputeLayout(&m_Layout, graph, m_Parameter);
+
+    NN_ABORT_UNLESS_NOT_NULL(workBuffer);
+    NN_ABORT_UNLESS(reinterpret_cast<uintptr_t>(workBuffer) % nn::os::MemoryPageSize == 0);
+    NN_ABORT_UNLESS(workBufferSize >= m_Layout.workBufferSize);
+    NN_ABORT_UNLESS_NOT_NULL(poolBuffer);
+    NN_ABORT_UNLESS(reinterpret_cast<uintptr_t>(poolBuffer) % nn::audio::MemoryPoolType::AddressAlignment == 0);
+    NN_ABORT_UNLESS(poolBufferSize >= m_Layout.poolBufferSize);
+    m_pWorkBuffer = static_cast<char*>(workBuffer);
+    m_pPoolBuffer = static_cast<char*>(poolBuffer);
+    m_WorkBufferSize = workBufferSize;
+    m_PoolBufferSize = poolBufferSize;
+
+    NN_ABORT_UNLESS(
+        nn::audio::OpenAudioRenderer(&m_Handle, &m_SystemEvent, m_Parameter,
+                                     m_pWorkBuffer + m_Layout.rendererWorkBuffer, m_Layout.rendererWorkBufferSize).IsSuccess(),
+        "Failed to open AudioRenderer"
+    );
+    nn::audio::InitializeAudioRendererConfig(&m_Config, m_Parameter, m_pWorkBuffer + m_Layout.configBuffer, m_Layout.configBufferSize);
+
+    NN_ABORT_UNLESS(nn::audio::AcquireFinalMix(&m_Config, &m_FinalMix, graph.finalMixBufferCount));
+    AddSubMixes();
+
+    // mainBus[nn::audio::ChannelMapping_FrontLeft] is output to the left channel, and so on.
+    nn::Result result = nn::audio::AddDeviceSink(&m_Config, &m_DeviceSink, &m_FinalMix, m_Graph.mainBus, m_Graph.channelCount, m_Graph.deviceName);
+    NN_ABORT_UNLESS_RESULT_SUCCESS(result);
+
+    if (m_Graph.isAuxBusEnabled)
+    {
+        result = nn::audio::AddBufferMixer(&m_Config, &m_BufferMixer, &m_FinalMix);
+        NN_ABORT_UNLESS_RESULT_SUCCESS(result);
+        nn::audio::SetBufferMixerInputOutput(&m_BufferMixer, m_Graph.auxBus, m_Graph.mainBus, m_Graph.channelCount);
+        for (int i = 0; i < m_Graph.channelCount; ++i)
+        {
+            nn::audio::SetBufferMixerVolume(&m_BufferMixer, i, 1.0f);
+        }
+    }
+
+    if (m_Graph.performanceFrameCount > 0)
+    {
+        m_PerformanceMetrics.Initialize(&m_Config, m_Parameter, &m_FinalMix, m_pWorkBuffer + m_Layout.metricsBuffer, m_Layout.metricsBufferSize);
+    }
+
+    result = nn::audio::RequestUpdateAudioRenderer(m_Handle, &m_Config);
+    NN_ABORT_UNLESS_RESULT_SUCCESS(result);
+    result = nn::audio::StartAudioRenderer(m_Handle);
+    NN_ABORT_UNLESS_RESULT_SUCCESS(result);
+
+    // Sound effects delayed into a frame start with this silence; all-zero ADPCM frames decode to zeros.
+    std::memset(m_pPoolBuffer + m_Layout.silenceBuffer, 0, m_Layout.silenceBufferSize);
+    NN_ABORT_UNLESS(nn::audio::AcquireMemoryPool(&m_Config, &m_MemoryPool, m_pPoolBuffer, m_Layout.poolBufferSize));
+    NN_ABORT_UNLESS(nn::audio::RequestAttachMemoryPool(&m_MemoryPool));
+
+    if (m_Graph.voiceCount > 0)
+    {
+        m_VoiceManager.Initialize(&m_Config, m_Graph.voiceCount, m_pWorkBuffer + m_Layout.voiceManagerBuffer,
+                                  AudioVoiceManager::GetRequiredWorkBufferSize(m_Graph.voiceCount));
+    }
+    if (m_Graph.rampCountMax > 0)
+    {
+        m_RampEngine.Initialize(m_Parameter, m_Graph.rampCountMax, m_pWorkBuffer + m_Layout.rampBuffer,
+                                AudioRampEngine::GetRequiredWorkBufferSize(m_Graph.rampCountMax));
+    }
+    if (m_Graph.oscillatorCountMax > 0)
+    {
+        m_OscillatorPlayer.Initialize(&m_Config, m_Parameter.sampleRate, m_Graph.oscillatorCountMax,
+                                      m_pPoolBuffer + m_Layout.oscillatorBuffer, AudioOscillatorPlayer::GetRequiredBufferSize(),
+                                      m_pWorkBuffer + m_Layout.oscillatorWorkBuffer, AudioOscillatorPlayer::GetRequiredWorkBufferSize(m_Graph.oscillatorCountMax));
+        RouteVoice(m_OscillatorPlayer.GetVoice(), 1, m_Graph.oscillatorDestination, m_Graph.oscillatorVolume);
+    }
+    if (m_Graph.emitterCountMax > 0)
+    {
+        float azimuths[AudioDsp::Spatializer::ChannelCountMax];
+        AudioDsp::Spatializer::GetDefaultLayout(azimuths, m_Graph.channelCount);
+        m_Spatializer.Initialize(m_pWorkBuffer + m_Layout.spatializerBuffer, m_Layout.spatializerBufferSize,
+                                 m_Graph.emitterCountMax, azimuths, m_Graph.channelCount);
+        m_ListenerSequence.store(0, std::memory_order_relaxed);
+        m_ListenerOrientation[0].store(0.0f, std::memory_order_relaxed);
+        m_ListenerOrientation[1].store(0.0f, std::memory_order_relaxed);
+        m_ListenerOrientation[2].store(0.0f, std::memory_order_relaxed);
+        m_ListenerOrientation[3].store(1.0f, std::memory_order_relaxed);
+    }
+    AudioDsp::WavePoolSlabConfig streamSlab;
+    GetStreamSlabConfig(&streamSlab, m_Graph);
+    m_WavePool.Initialize(m_pPoolBuffer + m_Layout.wavePool, m_Layout.wavePoolSize, nn::audio::BufferAlignSize, &streamSlab, 1);
+    if (m_Graph.isMeteringEnabled)
+    {
+        AddMeterTaps();
+    }
+    if (m_Graph.captureFrameCount > 0)
+    {
+        m_CaptureWriter.Initialize(m_Parameter, m_Graph.channelCount, m_Graph.captureFrameCount,
+                                   m_pWorkBuffer + m_Layout.captureBuffer, m_Layout.captureBufferSize,
+                                   m_pWorkBuffer + m_Layout.captureThreadStack, AudioCaptureWriter::ThreadStackSize);
+        m_pMeterTaps[GetMeterTapIndex(Destination_MainBus)].SetCaptureWriter(&m_CaptureWriter);
+    }
+
+    // The players are constructed in place as they are added.
+    m_pStreams = reinterpret_cast<StreamEntry*>(m_pWorkBuffer + m_Layout.streams);
+    m_pSoundEffects = reinterpret_cast<SoundEffectEntry*>(m_pWorkBuffer + m_Layout.soundEffects);
+    m_pBanks = reinterpret_cast<AudioBank*>(m_pWorkBuffer + m_Layout.banks);
+    m_pEmitters = reinterpret_cast<EmitterEntry*>(m_pWorkBuffer + m_Layout.emitters);
+    m_pVoiceCandidates = reinterpret_cast<VoiceCandidate*>(m_pWorkBuffer + m_Layout.voiceCandidates);
+    m_VirtualVoiceCount = 0;
+    m_Commands.Initialize(m_pWorkBuffer + m_Layout.commands, AudioDsp::MpscQueue<Command>::GetRequiredWorkBufferSize(m_Graph.commandCountMax),
+                          m_Graph.commandCountMax);
+    m_pScheduledCommands = reinterpret_cast<Command*>(m_pWorkBuffer + m_Layout.scheduledCommands);
+    m_ScheduledCommandCount = 0;
+    m_PeakScheduledCommandCount = 0;
+    m_ScheduleSequence = 0;
+    m_DroppedScheduledCommandCount = 0;
+    m_SampleTime.store(0, std::memory_order_release);
+    m_StreamCount = 0;
+    m_SoundEffectCount = 0;
+    m_BankCount = 0;
+    m_IsStarted = false;
+    m_IsInitialized = true;
+}
+
+void AudioEngine::Finalize() NN_NOEXCEPT
+{
+    if (!m_IsInitialized)
+    {
+        return;
+    }
+
+    // Once the update thread has stopped, the engine belongs to this thread again. Run the commands posted since the last update.
+    if (m_IsStarted && m_Graph.isUpdateThreadEnabled)
+    {
+        m_UpdateThread.Finalize();
+    }
+    ExecuteCommands();
+
+    // Stop the capture writer and the stream reader threads first, then release every voice.
+    if (m_Graph.captureFrameCount > 0)
+    {
+        m_CaptureWriter.Finalize();
+    }
+    for (int i = 0; i < m_StreamCount; ++i)
+    {
+        m_pStreams[i].player.Finalize();
+    }
+    if (m_Graph.oscillatorCountMax > 0)
+    {
+        m_OscillatorPlayer.Finalize();
+    }
+    for (int i = 0; i < m_SoundEffectCount; ++i)
+    {
+        m_pSoundEffects[i].soundEffect.Finalize();
+        m_pSoundEffects[i].~SoundEffectEntry();
+    }
+    if (m_Graph.voiceCount > 0)
+    {
+        m_VoiceManager.Finalize();
+    }
+    if (m_Graph.rampCountMax > 0)
+    {
+        m_RampEngine.Finalize();
+    }
+    if (m_Graph.performanceFrameCount > 0)
+    {
+        m_PerformanceMetrics.Finalize();
+    }
+    if (m_Graph.isMeteringEnabled)
+    {
+        for (int i = 0; i < GetMeterTapCount(m_Graph); ++i)
+        {
+            m_pMeterTaps[i].Finalize();
+            m_pMeterTaps[i].~AudioMeterTap();
+        }
+    }
+
+    // No voice or tap reads from the pool buffer any more. Banks go newest first, so the long-lived region unwinds.
+    DetachMemoryPool();
+    for (int i = 0; i < m_StreamCount; ++i)
+    {
+        m_WavePool.FreeBlock(m_pStreams[i].pBuffer);
+        m_pStreams[i].~StreamEntry();
+    }
+    for (int i = m_BankCount - 1; i >= 0; --i)
+    {
+        m_pBanks[i].Unload();
+        m_pBanks[i].~AudioBank();
+    }
+
+    nn::audio::StopAudioRenderer(m_Handle);
+    nn::audio::CloseAudioRenderer(m_Handle);
+    nn::os::DestroySystemEvent(m_SystemEvent.GetBase());
+
+    m_pStreams = nullptr;
+    m_pSoundEffects = nullptr;
+    m_pBanks = nullptr;
+    m_pEmitters = nullptr;
+    m_pMeterTaps = nullptr;
+    m_pVoiceCandidates = nullptr;
+    m_pScheduledCommands = nullptr;
+    m_ScheduledCommandCount = 0;
+    m_StreamCount = 0;
+    m_SoundEffectCount = 0;
+    m_BankCount = 0;
+    m_pWorkBuffer = nullptr;
+    m_pPoolBuffer = nullptr;
+    m_WorkBufferSize = 0;
+    m_PoolBufferSize = 0;
+    m_IsStarted = false;
+    m_IsInitialized = false;
+}
+
+void AudioEngine::Start() NN_NOEXCEPT
+{
+    NN_ABORT_UNLESS(m_IsInitialized && !m_IsStarted);
+
+    if (m_Graph.oscillatorCountMax > 0)
+    {
+        m_OscillatorPlayer.Start();
+    }
+    for (int i = 0; i < m_StreamCount; ++i)
+    {
+        m_pStreams[i].player.Start();
+    }
+    m_IsStarted = true;
+
+    if (m_Graph.isUpdateThreadEnabled)
+    {
+        m_UpdateThread.Initialize(m_Handle, &m_Config, &m_SystemEvent, UpdateFunction, this,
+                                  m_pWorkBuffer + m_Layout.updateThreadStack, AudioUpdateThread::ThreadStackSize, m_Graph.updateThreadPriority);
+        m_UpdateThread.Start();
+    }
+}
+
+int AudioEngine::AddStream(const char* filename, bool loop, int destination, float volume) NN_NOEXCEPT
+{
+    NN_ABORT_UNLESS(m_IsInitialized && !m_IsStarted);
+    NN_ABORT_UNLESS(m_StreamCount < m_Graph.streamCountMax);
+
+    const int index = m_StreamCount;
+    StreamEntry* pEntry = new (&m_pStreams[index]) StreamEntry();
+    ++m_StreamCount;
+    pEntry->destination = destination;
+    pEntry->volume = volume;
+    pEntry->emitter = AudioDsp::Spatializer::InvalidEmitter;
+    pEntry->pBuffer = m_WavePool.AllocateBlock(AudioStreamPlayer::GetRequiredBufferSize());
+    NN_ABORT_UNLESS_NOT_NULL(pEntry->pBuffer);
+
+    // The channel count and sample rate come from the file header.
+    AudioStreamPlayer* pStream = &pEntry->player;
+    pStream->Initialize(&m_Config, filename, loop, pEntry->pBuffer, AudioStreamPlayer::GetRequiredBufferSize(),
+                        m_pWorkBuffer + m_Layout.streamStacks + AudioStreamPlayer::ThreadStackSize * index, AudioStreamPlayer::ThreadStackSize);
+    NN_ABORT_UNLESS(pStream->GetChannelCount() <= m_Graph.streamChannelCountMax);
+    RouteVoice(pStream->GetVoice(), pStream->GetChannelCount(), destination, volume);
+    return index;
+}
+
+int AudioEngine::LoadBank(const char* filename) NN_NOEXCEPT
+{
+    NN_ABORT_UNLESS(m_IsInitialized && !m_IsStarted);
+    NN_ABORT_UNLESS(m_BankCount < m_Graph.bankCountMax);
+
+    const int index = m_BankCount;
+    AudioBank* pBank = new (&m_pBanks[index]) AudioBank();
+    ++m_BankCount;
+    pBank->Load(filename, &m_WavePool);
+    return index;
+}
+
+int AudioEngine::AddSoundEffect(int bank, const char* name, const AudioSoundEffectConfig& config, int destination, float volume) NN_NOEXCEPT
+{
+    NN_ABORT_UNLESS(m_IsInitialized && !m_IsStarted);
+    NN_ABORT_UNLESS_RANGE(bank, 0, m_BankCount);
+    NN_ABORT_UNLESS(m_SoundEffectCount < m_Graph.soundEffectCountMax);
+
+    const AudioBank& soundBank = m_pBanks[bank];
+    const int sound = soundBank.FindSound(name);
+    NN_ABORT_UNLESS(sound != AudioBank::InvalidIndex && soundBank.GetSampleFormat(sound) == nn::audio::SampleFormat_Adpcm);
+    NN_ABORT_UNLESS(soundBank.GetChannelCount(sound) <= m_Graph.voiceChannelCountMax);
+
+    const int index = m_SoundEffectCount;
+    SoundEffectEntry* pEntry = new (&m_pSoundEffects[index]) SoundEffectEntry();
+    ++m_SoundEffectCount;
+
+    // Every instance shares the header and plays the data from the bank in place.
+    soundBank.GetAdpcmHeader(&pEntry->header, sound);
+    pEntry->channelCount = soundBank.GetChannelCount(sound);
+    pEntry->destination = destination;
+    pEntry->volume = volume;
+    pEntry->emitter = AudioDsp::Spatializer::InvalidEmitter;
+    pEntry->soundEffect.Initialize(&m_VoiceManager, &pEntry->header, soundBank.GetData(sound), soundBank.GetDataSize(sound), config);
+    pEntry->soundEffect.SetSilenceBuffer(m_pPoolBuffer + m_Layout.silenceBuffer, m_Layout.silenceBufferSize);
+    return index;
+}
+
+AudioVoiceManager::Handle AudioEngine::PlaySoundEffect(int index) NN_NOEXCEPT
+{
+    return PlaySoundEffect(index, 0);
+}
+
+AudioVoiceManager::Handle AudioEngine::PlaySoundEffect(int index, int delaySampleCount) NN_NOEXCEPT
+{
+    NN_ABORT_UNLESS_RANGE(index, 0, m_SoundEffectCount);
+    NN_ABORT_UNLESS_RANGE(delaySampleCount, 0, m_Graph.sampleCount);
+
+    SoundEffectEntry& entry = m_pSoundEffects[index];
+    const AudioVoiceManager::Handle handle = entry.soundEffect.Play(delaySampleCount);
+    RouteSoundEffectVoice(entry, handle);
+    return handle;
+}
+
+void AudioEngine::RouteSoundEffectVoice(const SoundEffectEntry& entry, AudioVoiceManager::Handle handle) NN_NOEXCEPT
+{
+    if (nn::audio::VoiceType* pVoice = m_VoiceManager.GetVoice(handle))
+    {
+        RouteVoice(pVoice, entry.channelCount, entry.destination, entry.volume);
+        if (entry.emitter != AudioDsp::Spatializer::InvalidEmitter)
+        {
+            ApplyEmitterGains(entry.emitter, pVoice, entry.channelCount, entry.destination, entry.volume);
+        }
+    }
+}
+
+void AudioEngine::StopSoundEffect(int index) NN_NOEXCEPT
+{
+    NN_ABORT_UNLESS_RANGE(index, 0, m_SoundEffectCount);
+    m_pSoundEffects[index].soundEffect.StopAll();
+}
+
+void AudioEngine::SetStreamPaused(int index, bool isPaused) NN_NOEXCEPT
+{
+    NN_ABORT_UNLESS_RANGE(index, 0, m_StreamCount);
+    nn::audio::SetVoicePlayState(m_pStreams[index].player.GetVoice(),
+                                 isPaused ? nn::audio::VoiceType::PlayState_Pause : nn::audio::VoiceType::PlayState_Play);
+}
+
+bool AudioEngine::IsStreamPaused(int index) const NN_NOEXCEPT
+{
+    NN_ABORT_UNLESS_RANGE(index, 0, m_StreamCount);
+    return nn::audio::GetVoicePlayState(m_pStreams[index].player.GetVoice()) != nn::audio::VoiceType::PlayState_Play;
+}
+
+void AudioEngine::RouteVoice(nn::audio::VoiceType* pVoice, int channelCount, int destination, float volume) NN_NOEXCEPT
+{
+    NN_ABORT_UNLESS_NOT_NULL(pVoice);
+    NN_ABORT_UNLESS(channelCount > 0);
+
+    const int destinationChannelCount = GetDestinationChannelCount(destination);
+    const int sendCount = channelCount > destinationChannelCount ? channelCount : destinationChannelCount;
+    if (destination >= 0)
+    {
+        nn::audio::SubMixType* pSubMix = &m_SubMixes[destination];
+        nn::audio::SetVoiceDestination(&m_Config, pVoice, pSubMix);
+        for (int i = 0; i < sendCount; ++i)
+        {
+            nn::audio::SetVoiceMixVolume(pVoice, pSubMix, volume, i % channelCount, i % destinationChannelCount);
+        }
+    }
+    else
+    {
+        nn::audio::SetVoiceDestination(&m_Config, pVoice, &m_FinalMix);
+        for (int i = 0; i < sendCount; ++i)
+        {
+            nn::audio::SetVoiceMixVolume(pVoice, &m_FinalMix, volume, i % channelCount, GetDestinationBuffer(destination, i % destinationChannelCount));
+        }
+    }
+}
+
+int AudioEngine::AddStreamEmitter(int stream, float x, float y, float z) NN_NOEXCEPT
+{
+    NN_ABORT_UNLESS(m_IsInitialized && !m_IsStarted);
+    NN_ABORT_UNLESS_RANGE(stream, 0, m_StreamCount);
+
+    StreamEntry& entry = m_pStreams[stream];
+    NN_ABORT_UNLESS(entry.destination < 0 && entry.emitter == AudioDsp::Spatializer::InvalidEmitter);
+    const int emitter = m_Spatializer.AddEmitter(x, y, z);
+    NN_ABORT_UNLESS(emitter != AudioDsp::Spatializer::InvalidEmitter);
+    m_pEmitters[emitter].source = stream;
+    m_pEmitters[emitter].isSoundEffect = false;
+    entry.emitter = emitter;
+    return emitter;
+}
+
+int AudioEngine::AddSoundEffectEmitter(int soundEffect, float x, float y, float z) NN_NOEXCEPT
+{
+    NN_ABORT_UNLESS(m_IsInitialized && !m_IsStarted);
+    NN_ABORT_UNLESS_RANGE(soundEffect, 0, m_SoundEffectCount);
+
+    SoundEffectEntry& entry = m_pSoundEffects[soundEffect];
+    NN_ABORT_UNLESS(entry.destination < 0 && entry.emitter == AudioDsp::Spatializer::InvalidEmitter);
+    const int emitter = m_Spatializer.AddEmitter(x, y, z);
+    NN_ABORT_UNLESS(emitter != AudioDsp::Spatializer::InvalidEmitter);
+    m_pEmitters[emitter].source = soundEffect;
+    m_pEmitters[emitter].isSoundEffect = true;
+    entry.emitter = emitter;
+    return emitter;
+}
+
+void AudioEngine::SetEmitterPosition(int emitter, float x, float y, float z) NN_NOEXCEPT
+{
+    NN_ABORT_UNLESS_RANGE(emitter, 0, m_Spatializer.GetEmitterCount());
+    m_Spatializer.SetEmitterPosition(emitter, x, y, z);
+}
+
+void AudioEngine::SetListenerOrientation(float x, float y, float z, float w) NN_NOEXCEPT
+{
+    NN_ABORT_UNLESS(m_Graph.emitterCountMax > 0);
+    const uint32_t sequence = m_ListenerSequence.load(std::memory_order_relaxed);
+    m_ListenerSequence.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    m_ListenerOrientation[0].store(x, std::memory_order_relaxed);
+    m_ListenerOrientation[1].store(y, std::memory_order_relaxed);
+    m_ListenerOrientation[2].store(z, std::memory_order_relaxed);
+    m_ListenerOrientation[3].store(w, std::memory_order_relaxed);
+    m_ListenerSequence.store(sequence + 2, std::memory_order_release);
+}
+
+nn::audio::VoiceType* AudioEngine::GetStreamVoice(int index) NN_NOEXCEPT
+{
+    NN_ABORT_UNLESS_RANGE(index, 0, m_StreamCount);
+    return m_pStreams[index].player.GetVoice();
+}
+
+AudioDsp::OscillatorBank* AudioEngine::GetOscillatorBank() NN_NOEXCEPT
+{
+    NN_ABORT_UNLESS(m_Graph.oscillatorCountMax > 0);
+    return m_OscillatorPlayer.GetBank();
+}
+
+nn::audio::VoiceType* AudioEngine::GetOscillatorVoice() NN_NOEXCEPT
+{
+    NN_ABORT_UNLESS(m_Graph.oscillatorCountMax > 0);
+    return m_OscillatorPlayer.GetVoice();
+}
+
+AudioPerformanceMetrics* AudioEngine::GetPerformanceMetrics() NN_NOEXCEPT
+{
+    return m_Graph.performanceFrameCount > 0 ? &m_PerformanceMetrics : nullptr;
+}
+
+void AudioEngine::GetWavePoolStatistics(AudioDsp::WavePoolStatistics* pOutStatistics) const NN_NOEXCEPT
+{
+    m_WavePool.GetStatistics(pOutStatistics);
+}
+
+const AudioDsp::Meter& AudioEngine::GetMeter(int destination) const NN_NOEXCEPT
+{
+    NN_ABORT_UNLESS(m_Graph.isMeteringEnabled);
+    NN_ABORT_UNLESS(destination != Destination_AuxBus || m_Graph.isAuxBusEnabled);
+    return m_pMeterTaps[GetMeterTapIndex(destination)].GetMeter();
+}
+
+bool AudioEngine::StartCapture(const char* path) NN_NOEXCEPT
+{
+    NN_ABORT_UNLESS(m_IsInitialized);
+    NN_ABORT_UNLESS(m_Graph.captureFrameCount > 0);
+    return m_CaptureWriter.Start(path);
+}
+
+void AudioEngine::StopCapture() NN_NOEXCEPT
+{
+    NN_ABORT_UNLESS(m_IsInitialized);
+    NN_ABORT_UNLESS(m_Graph.captureFrameCount > 0);
+    m_CaptureWriter.Stop();
+}
+
+void AudioEngine::DumpMeters() const NN_NOEXCEPT
+{
+    if (!m_Graph.isMeteringEnabled)
+    {
+        return;
+    }
+    m_pMeterTaps[GetMeterTapIndex(Destination_MainBus)].Dump("main");
+    if (m_Graph.isAuxBusEnabled)
+    {
+        m_pMeterTaps[GetMeterTapIndex(Destination_AuxBus)].Dump("aux");
+    }
+    for (int i = 0; i < m_Graph.subMixCount; ++i)
+    {
+        char label[8];
+        std::snprintf(label, sizeof(label), "sub%d", i);
+        m_pMeterTaps[GetMeterTapIndex(i)].Dump(label);
+    }
+}
+
+void AudioEngine::DumpBudget() const NN_NOEXCEPT
+{
+    NN_ABORT_UNLESS(m_IsInitialized);
+
+    // The arenas are what the graph needs against what the caller gave; the rest is what was used against the graph.
+    NN_LOG("[budget] renderer work buffer %zu bytes, config %zu bytes, %d voices, %d mix buffers, %d effects\n",
+           m_Layout.rendererWorkBufferSize, m_Layout.configBufferSize, m_Parameter.voiceCount, m_Parameter.mixBufferCount, m_Parameter.effectCount);
+    DumpBudgetLine("work buffer", m_Layout.workBufferSize, m_WorkBufferSize);
+    DumpBudgetLine("pool buffer", m_Layout.poolBufferSize, m_PoolBufferSize);
+    if (m_Graph.voiceCount > 0)
+    {
+        DumpBudgetLine("voices", m_VoiceManager.GetPeakActiveCount(), m_Graph.voiceCount);
+    }
+    AudioDsp::WavePoolStatistics statistics;
+    m_WavePool.GetStatistics(&statistics);
+    DumpBudgetLine("bank memory", statistics.longLivedPeakSize, statistics.longLivedSize);
+    DumpBudgetLine("banks", m_BankCount, m_Graph.bankCountMax);
+    DumpBudgetLine("sound effects", m_SoundEffectCount, m_Graph.soundEffectCountMax);
+    if (statistics.slabCount > 0)
+    {
+        DumpBudgetLine("streams", statistics.slabs[0].peakUsedCount, m_Graph.streamCountMax);
+    }
+    DumpBudgetLine("commands", m_Commands.GetPeakCount(), m_Graph.commandCountMax);
+    DumpBudgetLine("scheduled", m_PeakScheduledCommandCount, m_Graph.scheduledCommandCountMax);
+    if (m_Graph.captureFrameCount > 0)
+    {
+        DumpBudgetLine("capture frames", m_CaptureWriter.GetPeakFrameCount(), m_Graph.captureFrameCount);
+    }
+}
+
+void AudioEngine::WaitForFrame() NN_NOEXCEPT
+{
+    m_SystemEvent.Wait();
+}
+
+void AudioEngine::Update() NN_NOEXCEPT
+{
+    // Apply what other threads have posted since the last update.
+    ExecuteCommands();
+
+    // Refill the stream buffers that have finished playing.
+    for (int i = 0; i < m_StreamCount; ++i)
+    {
+        m_pStreams[i].player.Update();
+    }
+
+    // Generate the next blocks of the oscillators into the buffers that have finished playing.
+    if (m_Graph.oscillatorCountMax > 0)
+    {
+        m_OscillatorPlayer.Update();
+    }
+
+    // Return the voices of finished sound effects to the pool.
+    if (m_Graph.voiceCount > 0)
+    {
+        m_VoiceManager.Update();
+    }
+
+    // Pan the streams and the sound effects still playing for the latest listener orientation.
+    if (m_Graph.emitterCountMax > 0)
+    {
+        UpdateEmitters();
+    }
+
+    // Hand the voices to the most audible sound effect instances, for the latest emitter gains.
+    if (m_Graph.isVirtualVoiceEnabled)
+    {
+        UpdateVirtualVoices();
+    }
+
+    // Move the ramping parameters one audio frame toward their targets.
+    if (m_Graph.rampCountMax > 0)
+    {
+        m_RampEngine.Update();
+    }
+
+    // Collect the times of the frames rendered since the last update. Their count is what the clock advances by: a late
+    // update sees the auto-clear event once for several frames, and the renderer has played every one of them.
+    int renderedFrameCount = 1;
+    if (m_Graph.performanceFrameCount > 0)
+    {
+        renderedFrameCount = std::max(m_PerformanceMetrics.Update(), 1);
+    }
+    const int renderedSampleCount = m_Graph.sampleCount * renderedFrameCount;
+
+    // Meter the frames the taps sent since the last update.
+    if (m_Graph.isMeteringEnabled)
+    {
+        for (int i = 0; i < GetMeterTapCount(m_Graph); ++i)
+        {
+            if (i != GetMeterTapIndex(Destination_AuxBus) || m_Graph.isAuxBusEnabled)
+            {
+                m_pMeterTaps[i].Update();
+            }
+        }
+    }
+
+    // Every sound effect instance, with a voice or not, moves on by the frames rendered.
+    for (int i = 0; i < m_SoundEffectCount; ++i)
+    {
+        m_pSoundEffects[i].soundEffect.Advance(renderedSampleCount, m_Graph.sampleRate);
+    }
+
+    // The frames rendered since the last update are accounted for; the next one starts where they end.
+    m_SampleTime.store(m_SampleTime.load(std::memory_order_relaxed) + renderedSampleCount, std::memory_order_release);
+}
+
+void AudioEngine::RequestUpdate() NN_NOEXCEPT
+{
+    nn::Result result = nn::audio::RequestUpdateAudioRenderer(m_Handle, &m_Config);
+    NN_ABORT_UNLESS_RESULT_SUCCESS(result);
+}
+
+bool AudioEngine::PostPlaySoundEffect(int index) NN_NOEXCEPT
+{
+    return SchedulePlaySoundEffect(index, 0);
+}
+
+bool AudioEngine::PostStopSoundEffect(int index) NN_NOEXCEPT
+{
+    return ScheduleStopSoundEffect(index, 0);
+}
+
+bool AudioEngine::PostStreamPaused(int index, bool isPaused) NN_NOEXCEPT
+{
+    return ScheduleStreamPaused(index, isPaused, 0);
+}
+
+bool AudioEngine::PostEmitterPosition(int emitter, float x, float y, float z) NN_NOEXCEPT
+{
+    return ScheduleEmitterPosition(emitter, x, y, z, 0);
+}
+
+bool AudioEngine::PostRampTarget(int ramp, float target, nn::TimeSpan duration, AudioDsp::RampCurve curve) NN_NOEXCEPT
+{
+    return ScheduleRampTarget(ramp, target, duration, curve, 0);
+}
+
+bool AudioEngine::Post(AudioUpdateThread::CommandFunction function, void* pUserData, uintptr_t argument) NN_NOEXCEPT
+{
+    return Schedule(function, pUserData, argument, 0);
+}
+
+bool AudioEngine::SchedulePlaySoundEffect(int index, int64_t sampleTime) NN_NOEXCEPT
+{
+    NN_ABORT_UNLESS_RANGE(index, 0, m_SoundEffectCount);
+    Command command = {};
+    command.type = CommandType_PlaySoundEffect;
+    command.target = index;
+    command.sampleTime = sampleTime;
+    return PostCommand(command);
+}
+
+bool AudioEngine::ScheduleStopSoundEffect(int index, int64_t sampleTime) NN_NOEXCEPT
+{
+    NN_ABORT_UNLESS_RANGE(index, 0, m_SoundEffectCount);
+    Command command = {};
+    command.type = CommandType_StopSoundEffect;
+    command.target = index;
+    command.sampleTime = sampleTime;
+    return PostCommand(command);
+}
+
+bool AudioEngine::ScheduleStreamPaused(int index, bool isPaused, int64_t sampleTime) NN_NOEXCEPT
+{
+    NN_ABORT_UNLESS_RANGE(index, 0, m_StreamCount);
+    Command command = {};
+    command.type = CommandType_SetStreamPaused;
+    command.target = index;
+    command.option = isPaused ? 1 : 0;
+    command.sampleTime = sampleTime;
+    return PostCommand(command);
+}
+
+bool AudioEngine::ScheduleEmitterPosition(int emitter, float x, float y, float z, int64_t sampleTime) NN_NOEXCEPT
+{
+    NN_ABORT_UNLESS_RANGE(emitter, 0, m_Spatializer.GetEmitterCount());
+    Command command = {};
+    command.type = CommandType_SetEmitterPosition;
+    command.target = emitter;
+    command.values[0] = x;
+    command.values[1] = y;
+    command.values[2] = z;
+    command.sampleTime = sampleTime;
+    return PostCommand(command);
+}
+
+bool AudioEngine::ScheduleRampTarget(int ramp, float target, nn::TimeSpan duration, AudioDsp::RampCurve curve, int64_t sampleTime) NN_NOEXCEPT
+{
+    NN_ABORT_UNLESS(m_Graph.rampCountMax > 0);
+    Command command = {};
+    command.type = CommandType_SetRampTarget;
+    command.target = ramp;
+    command.option = curve;
+    command.values[0] = target;
+    command.duration = duration.GetNanoSeconds();
+    command.sampleTime = sampleTime;
+    return PostCommand(command);
+}
+
+bool AudioEngine::Schedule(AudioUpdateThread::CommandFunction function, void* pUserData, uintptr_t argument, int64_t sampleTime) NN_NOEXCEPT
+{
+    NN_ABORT_UNLESS_NOT_NULL(function);
+    Command command = {};
+    command.type = CommandType_Call;
+    command.function = function;
+    command.pUserData = pUserData;
+    command.argument = argument;
+    command.sampleTime = sampleTime;
+    return PostCommand(command);
+}
+
+bool AudioEngine::PostCommand(const Command& command) NN_NOEXCEPT
+{
+    NN_ABORT_UNLESS(m_IsInitialized);
+    return m_Commands.TryPush(command);
+}
+
+void AudioEngine::ExecuteCommands() NN_NOEXCEPT
+{
+    const int64_t frameBegin = m_SampleTime.load(std::memory_order_relaxed);
+    const int64_t frameEnd = frameBegin + m_Graph.sampleCount;
+
+    // Scheduled commands due in this frame run first; they were posted before anything now in the queue.
+    while (m_ScheduledCommandCount > 0 && m_pScheduledCommands[0].sampleTime < frameEnd)
+    {
+        std::pop_heap(m_pScheduledCommands, m_pScheduledCommands + m_ScheduledCommandCount, IsLater);
+        --m_ScheduledCommandCount;
+        const Command& command = m_pScheduledCommands[m_ScheduledCommandCount];
+        ExecuteCommand(command, static_cast<int>(std::max<int64_t>(command.sampleTime - frameBegin, 0)));
+    }
+
+    // Bounded by the count at the start, so a thread that keeps posting cannot hold up the update.
+    const int count = m_Commands.GetCount();
+    Command command;
+    for (int i = 0; i < count && m_Commands.TryPop(&command); ++i)
+    {
+        if (command.sampleTime < frameEnd)
+        {
+            ExecuteCommand(command, static_cast<int>(std::max<int64_t>(command.sampleTime - frameBegin, 0)));
+        }
+        else if (m_ScheduledCommandCount < m_Graph.scheduledCommandCountMax)
+        {
+            command.sequence = m_ScheduleSequence++;
+            m_pScheduledCommands[m_ScheduledCommandCount++] = command;
+            std::push_heap(m_pScheduledCommands, m_pScheduledCommands + m_ScheduledCommandCount, IsLater);
+            m_PeakScheduledCommandCount = std::max(m_PeakScheduledCommandCount, m_ScheduledCommandCount);
+        }
+        else
+        {
+            ++m_DroppedScheduledCommandCount;
+        }
+    }
+}
+
+void AudioEngine::ExecuteCommand(const Command& command, int delaySampleCount) NN_NOEXCEPT
+{
+    switch (command.type)
+    {
+    case CommandType_PlaySoundEffect:
+        PlaySoundEffect(command.target, delaySampleCount);
+        break;
+    case CommandType_StopSoundEffect:
+        StopSoundEffect(command.target);
+        break;
+    case CommandType_SetStreamPaused:
+        SetStreamPaused(command.target, command.option != 0);
+        break;
+    case CommandType_SetEmitterPosition:
+        SetEmitterPosition(command.target, command.values[0], command.values[1], command.values[2]);
+        break;
+    case CommandType_SetRampTarget:
+        m_RampEngine.SetTarget(command.target, command.values[0], nn::TimeSpan::FromNanoSeconds(command.duration),
+                               static_cast<AudioDsp::RampCurve>(command.option));
+        break;
+    default:
+        command.function(command.pUserData, command.argument);
+        break;
+    }
+}
+
+bool AudioEngine::IsLater(const Command& lhs, const Command& rhs) NN_NOEXCEPT
+{
+    // The sequence wraps, so it is compared by difference.
+    if (lhs.sampleTime != rhs.sampleTime)
+    {
+        return lhs.sampleTime > rhs.sampleTime;
+    }
+    return static_cast<int32_t>(lhs.sequence - rhs.sequence) > 0;
+}
+
+void AudioEngine::UpdateFunction(void* pUserData) NN_NOEXCEPT
+{
+    static_cast<AudioEngine*>(pUserData)->Update();
+}
+
+void AudioEngine::AddSubMixes() NN_NOEXCEPT
+{
+    for (int i = 0; i < m_Graph.subMixCount; ++i)
+    {
+        NN_ABORT_UNLESS(m_Graph.subMixes[i].bufferCount > 0);
+        const int bufferCount = m_Graph.subMixes[i].bufferCount * (m_Graph.isMeteringEnabled ? 2 : 1);
+        NN_ABORT_UNLESS(nn::audio::AcquireSubMix(&m_Config, &m_SubMixes[i], m_Parameter.sampleRate, bufferCount));
+    }
+
+    // Routed once all are acquired, so a sub mix may send to one declared after it.
+    for (int i = 0; i < m_Graph.subMixCount; ++i)
+    {
+        const AudioEngineSubMix& subMix = m_Graph.subMixes[i];
+        NN_ABORT_UNLESS(subMix.destination != i);
+        const int destinationChannelCount = GetDestinationChannelCount(subMix.destination);
+        const int sendCount = subMix.bufferCount > destinationChannelCount ? subMix.bufferCount : destinationChannelCount;
+        if (subMix.destination >= 0)
+        {
+            nn::audio::SubMixType* pDestination = &m_SubMixes[subMix.destination];
+            nn::audio::SetSubMixDestination(&m_Config, &m_SubMixes[i], pDestination);
+            for (int j = 0; j < sendCount; ++j)
+            {
+                nn::audio::SetSubMixMixVolume(&m_SubMixes[i], pDestination, subMix.volume, j % subMix.bufferCount, j % destinationChannelCount);
+            }
+        }
+        else
+        {
+            nn::audio::SetSubMixDestination(&m_Config, &m_SubMixes[i], &m_FinalMix);
+            for (int j = 0; j < sendCount; ++j)
+            {
+                nn::audio::SetSubMixMixVolume(&m_SubMixes[i], &m_FinalMix, subMix.volume, j % subMix.bufferCount,
+                                              GetDestinationBuffer(subMix.destination, j % destinationChannelCount));
+            }
+        }
+    }
+}
+
+int AudioEngine::GetMeterTapCount(const AudioEngineGraph& graph) NN_NOEXCEPT
+{
+    return 2 + graph.subMixCount;
+}
+
+int AudioEngine::GetMeterChannelCountMax(const AudioEngineGraph& graph) NN_NOEXCEPT
+{
+    int channelCount = graph.channelCount;
+    for (int i = 0; i < graph.subMixCount; ++i)
+    {
+        channelCount = graph.subMixes[i].bufferCount > channelCount ? graph.subMixes[i].bufferCount : channelCount;
+    }
+    return channelCount;
+}
+
+int AudioEngine::GetMeterTapIndex(int destination) const NN_NOEXCEPT
+{
+    if (destination == Destination_MainBus)
+    {
+        return 0;
+    }
+    if (destination == Destination_AuxBus)
+    {
+        return 1;
+    }
+    NN_ABORT_UNLESS_RANGE(destination, 0, m_Graph.subMixCount);
+    return 2 + destination;
+}
+
+void AudioEngine::AddMeterTaps() NN_NOEXCEPT
+{
+    // Added after the BufferMixer, so the mainBus tap meters what the device sink outputs.
+    m_pMeterTaps = reinterpret_cast<AudioMeterTap*>(m_pWorkBuffer + m_Layout.meterTaps);
+    for (int i = 0; i < GetMeterTapCount(m_Graph); ++i)
+    {
+        new (&m_pMeterTaps[i]) AudioMeterTap();
+    }
+
+    const int destinations[2] = { Destination_MainBus, Destination_AuxBus };
+    for (int i = 0; i < 2; ++i)
+    {
+        if (destinations[i] == Destination_AuxBus && !m_Graph.isAuxBusEnabled)
+        {
+            continue;
+        }
+        const int tap = GetMeterTapIndex(destinations[i]);
+        m_pMeterTaps[tap].Initialize(&m_Config, &m_FinalMix, m_Parameter,
+                                     destinations[i] == Destination_MainBus ? m_Graph.mainBus : m_Graph.auxBus, m_Graph.meterBus, m_Graph.channelCount,
+                                     m_pPoolBuffer + m_Layout.meterBuffers + m_Layout.meterBufferStride * tap, m_Layout.meterBufferStride,
+                                     m_pWorkBuffer + m_Layout.meterReadBuffers + m_Layout.meterReadBufferStride * tap, m_Layout.meterReadBufferStride);
+    }
+
+    // A sub mix tap reads the buffers the sub mix routes and returns to the extra ones after them.
+    for (int i = 0; i < m_Graph.subMixCount; ++i)
+    {
+        const int bufferCount = m_Graph.subMixes[i].bufferCount;
+        int8_t input[AudioDsp::MeterChannelCountMax];
+        int8_t output[AudioDsp::MeterChannelCountMax];
+        NN_ABORT_UNLESS(bufferCount <= AudioDsp::MeterChannelCountMax);
+        for (int j = 0; j < bufferCount; ++j)
+        {
+            input[j] = static_cast<int8_t>(j);
+            output[j] = static_cast<int8_t>(bufferCount + j);
+        }
+        const int tap = GetMeterTapIndex(i);
+        m_pMeterTaps[tap].Initialize(&m_Config, &m_SubMixes[i], m_Parameter, input, output, bufferCount,
+                                     m_pPoolBuffer + m_Layout.meterBuffers + m_Layout.meterBufferStride * tap, m_Layout.meterBufferStride,
+                                     m_pWorkBuffer + m_Layout.meterReadBuffers + m_Layout.meterReadBufferStride * tap, m_Layout.meterReadBufferStride);
+    }
+}
+
+int AudioEngine::GetDestinationBuffer(int destination, int channel) const NN_NOEXCEPT
+{
+    if (destination == Destination_MainBus)
+    {
+        return m_Graph.mainBus[channel];
+    }
+    if (destination == Destination_AuxBus)
+    {
+        return m_Graph.auxBus[channel];
+    }
+    return channel;
+}
+
+int AudioEngine::GetDestinationChannelCount(int destination) const NN_NOEXCEPT
+{
+    if (destination == Destination_MainBus)
+    {
+        return m_Graph.channelCount;
+    }
+    if (destination == Destination_AuxBus)
+    {
+        NN_ABORT_UNLESS(m_Graph.isAuxBusEnabled);
+        return m_Graph.channelCount;
+    }
+    NN_ABORT_UNLESS_RANGE(destination, 0, m_Graph.subMixCount);
+    return m_Graph.subMixes[destination].bufferCount;
+}
+
+void AudioEngine::UpdateEmitters() NN_NOEXCEPT
+{
+    // Unlike Meter::Read(), one try only: if the orientation is being written, this update keeps the last one rather
+    // than wait on a thread that may have been preempted.
+    const uint32_t sequence = m_ListenerSequence.load(std::memory_order_acquire);
+    if ((sequence & 1) == 0)
+    {
+        float orientation[4];
+        for (int i = 0; i < 4; ++i)
+        {
+            orientation[i] = m_ListenerOrientation[i].load(std::memory_order_relaxed);
+        }
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (m_ListenerSequence.load(std::memory_order_relaxed) == sequence)
+        {
+            m_Spatializer.SetListenerOrientation(orientation[0], orientation[1], orientation[2], orientation[3]);
+        }
+    }
+    m_Spatializer.Update();
+
+    // Only emitters whose gains moved are written, so a still listener costs no parameter writes.
+    for (int emitter = 0; emitter < m_Spatializer.GetEmitterCount(); ++emitter)
+    {
+        if (!m_Spatializer.IsChanged(emitter))
+        {
+            continue;
+        }
+        const EmitterEntry& emitterEntry = m_pEmitters[emitter];
+        if (!emitterEntry.isSoundEffect)
+        {
+            StreamEntry& entry = m_pStreams[emitterEntry.source];
+            ApplyEmitterGains(emitter, entry.player.GetVoice(), entry.player.GetChannelCount(), entry.destination, entry.volume);
+            continue;
+        }
+
+        SoundEffectEntry& entry = m_pSoundEffects[emitterEntry.source];
+        for (int slot = 0; slot < entry.soundEffect.GetSlotCount(); ++slot)
+        {
+            if (nn::audio::VoiceType* pVoice = m_VoiceManager.GetVoice(entry.soundEffect.GetVoiceHandle(slot)))
+            {
+                ApplyEmitterGains(emitter, pVoice, entry.channelCount, entry.destination, entry.volume);
+            }
+        }
+    }
+}
+
+void AudioEngine::UpdateVirtualVoices() NN_NOEXCEPT
+{
+    // Score every instance of a virtualizable sound effect. Those of other sound effects keep the voice they have.
+    int candidateCount = 0;
+    int reservedCount = 0;
+    for (int i = 0; i < m_SoundEffectCount; ++i)
+    {
+        SoundEffectEntry& entry = m_pSoundEffects[i];
+        float audibility = entry.volume;
+        if (entry.emitter != AudioDsp::Spatializer::InvalidEmitter)
+        {
+            float gain = 0.0f;
+            for (int channel = 0; channel < m_Graph.channelCount; ++channel)
+            {
+                gain = std::max(gain, m_Spatializer.GetGain(entry.emitter, channel));
+            }
+            audibility *= gain;
+        }
+        for (int slot = 0; slot < entry.soundEffect.GetSlotCount(); ++slot)
+        {
+            if (!entry.soundEffect.IsActive(slot))
+            {
+                continue;
+            }
+            if (!entry.soundEffect.IsVirtualizable())
+            {
+                reservedCount += entry.soundEffect.IsVirtual(slot) ? 0 : 1;
+                continue;
+            }
+            VoiceCandidate& candidate = m_pVoiceCandidates[candidateCount++];
+            candidate.score = entry.soundEffect.IsVirtual(slot) ? audibility : audibility * VirtualVoiceHysteresis;
+            candidate.soundEffect = i;
+            candidate.slot = slot;
+        }
+    }
+
+    // The loudest instances that fit in the voices left over get one; a partial sort finds them in linear time.
+    const int voiceCount = std::max(std::min(m_VoiceManager.GetVoiceCount() - reservedCount, candidateCount), 0);
+    if (voiceCount < candidateCount)
+    {
+        struct Louder
+        {
+            bool operator()(const VoiceCandidate& lhs, const VoiceCandidate& rhs) const
+            {
+                return lhs.score > rhs.score;
+            }
+        };
+        std::nth_element(m_pVoiceCandidates, m_pVoiceCandidates + voiceCount, m_pVoiceCandidates + candidateCount, Louder());
+    }
+
+    // Free the voices first, so every promotion finds one without stealing.
+    m_VirtualVoiceCount = 0;
+    for (int i = 0; i < candidateCount; ++i)
+    {
+        const VoiceCandidate& candidate = m_pVoiceCandidates[i];
+        AudioSoundEffect& soundEffect = m_pSoundEffects[candidate.soundEffect].soundEffect;
+        const bool isAudible = i < voiceCount && candidate.score >= m_Graph.virtualVoiceThreshold;
+        if (!isAudible && !soundEffect.IsVirtual(candidate.slot))
+        {
+            soundEffect.Virtualize(candidate.slot);
+        }
+    }
+    for (int i = 0; i < candidateCount; ++i)
+    {
+        const VoiceCandidate& candidate = m_pVoiceCandidates[i];
+        SoundEffectEntry& entry = m_pSoundEffects[candidate.soundEffect];
+        const bool isAudible = i < voiceCount && candidate.score >= m_Graph.virtualVoiceThreshold;
+        if (isAudible && entry.soundEffect.IsVirtual(candidate.slot))
+        {
+            RouteSoundEffectVoice(entry, entry.soundEffect.Realize(candidate.slot));
+        }
+        m_VirtualVoiceCount += entry.soundEffect.IsVirtual(candidate.slot) ? 1 : 0;
+    }
+}
+
+void AudioEngine::ApplyEmitterGains(int emitter, nn::audio::VoiceType* pVoice, int channelCount, int destination, float volume) NN_NOEXCEPT
+{
+    // Every source channel is sent to every channel of the bus, which sums the source to the point of the emitter.
+    for (int channel = 0; channel < m_Graph.channelCount; ++channel)
+    {
+        const float gain = volume * m_Spatializer.GetGain(emitter, channel);
+        const int buffer = GetDestinationBuffer(destination, channel);
+        for (int source = 0; source < channelCount; ++source)
+        {
+            nn::audio::SetVoiceMixVolume(pVoice, &m_FinalMix, gain, source, buffer);
+        }
+    }
+}
+
+void AudioEngine::DetachMemoryPool() NN_NOEXCEPT
+{
+    // The renderer lets go of the pool at an update, so keep updating until it has.
+    NN_ABORT_UNLESS(nn::audio::RequestDetachMemoryPool(&m_MemoryPool));
+    do
+    {
+        RequestUpdate();
+        m_SystemEvent.Wait();
+    } while (nn::audio::IsMemoryPoolAttached(&m_MemoryPool));
+    nn::audio::ReleaseMemoryPool(&m_Config, &m_MemoryPool);
+}
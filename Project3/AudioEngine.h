@@ -0,0 +1,526 @@
+#pragma once
+
+/**
+* @brief
+*  Owns an audio renderer and everything that plays through it, sized once from a graph description.
+*
+*  <tt>AudioEngineGraph</tt> declares the mix graph (the final mix, its output and aux buses, and a chain of sub mixes)
+*  and the most of each kind of source the engine will hold: streams, oscillators, pooled sound effect voices, banks,
+*  and ramps. From it the engine derives the renderer parameter and the size of two arenas, one for the renderer,
+*  the config, and the bookkeeping of every player, and one that is attached as the memory pool for sample data.
+*  <tt>ApplyAudioEngineManifest()</tt> fills in the sound effect part of a graph from the banks to load and the
+*  polyphony of each sound, read from the bank files, and <tt>DumpBudget()</tt> logs how much of each budget the
+*  engine has used, so neither has to be guessed with room to spare.
+*  Every object is placed in these arenas by <tt>Initialize()</tt> and the <tt>Add</tt> and <tt>Load</tt> calls before
+*  <tt>Start()</tt>, so nothing is allocated while the engine runs, and <tt>Finalize()</tt> tears everything down in a
+*  fixed order: the update thread, the players and voices, the memory pool, and last the renderer. The sample memory of
+*  streams and banks comes from an <tt>AudioDsp::WavePool</tt> in the pool buffer: each stream takes a block of a slab
+*  sized for the stream ring, and banks are bumped from the region after it, so neither leaves holes for the other.
+*
+*  Sources are routed by destination: <tt>Destination_MainBus</tt>, <tt>Destination_AuxBus</tt>, or the index of a sub
+*  mix. Source channel n is sent to destination channel n, wrapping the side with fewer channels, so a mono source
+*  reaches both sides of a stereo bus and a stereo source is summed into a mono sub mix.
+*
+*  A stream or sound effect can be given an emitter, a position relative to the listener. From then on its voices are
+*  panned over the channels of its bus by <tt>AudioDsp::Spatializer</tt> once per update, in the default speaker layout
+*  of the bus's channel count, with its source channels summed to the point. The listener orientation can be set from
+*  any thread, so the head pose of the render loop reaches the audio thread without a command per video frame.
+*
+*  With virtual voices enabled, the instances of sound effects may outnumber the pooled voices. Each update ranks every
+*  instance by its audibility, the volume of its sound effect times the loudest gain of its emitter, and gives the
+*  voices to the loudest instances above virtualVoiceThreshold. The rest of the virtualizable instances become virtual
+*  and keep only their position, and resume there when they rank high enough again. An instance with a voice counts
+*  as twice as loud, so two instances of about the same audibility do not trade the voice back and forth.
+*
+*  With metering enabled, an aux effect taps mainBus (after the BufferMixer has added auxBus to it), auxBus, and every
+*  sub mix, and each update feeds what they sent to an <tt>AudioDsp::Meter</tt>. The taps write their return to buffers
+*  nothing else reads, so the mix itself is unchanged, and the meters can be read from any thread. The mainBus tap can
+*  also capture the final mix to a WAV file: each frame it reads is copied into a lock-free ring that a writer thread
+*  drains to the file system, so a slow card loses frames from the file, counted, rather than from the audio thread.
+*
+*  Without an update thread, the caller calls <tt>WaitForFrame()</tt>, <tt>Update()</tt>, and <tt>RequestUpdate()</tt>
+*  in its own loop. With one, the engine updates itself once per audio frame after <tt>Start()</tt>.
+*
+*  Either way, any thread (input, gameplay, loading) can change the engine through the <tt>Post</tt> calls. They push a
+*  command onto a bounded lock-free queue and never block, and <tt>Update()</tt> runs the queued commands in order before
+*  anything else, on the thread that owns the engine. A full queue drops the command and counts it. The direct calls
+*  below remain for that owning thread.
+*
+*  The <tt>Schedule</tt> calls post the same commands for a sample time of the engine's clock, which counts the samples
+*  of every audio frame rendered since <tt>Initialize()</tt>. The count comes from the performance frames, so an update
+*  that woke late, once for several frames, moves the clock past all of them; a graph without performance frames has a
+*  clock that counts updates instead and falls behind with each missed one. A command for a later frame waits in a heap ordered by time
+*  until the update that prepares the frame holding its time. A sound effect then starts that many samples into the
+*  frame, behind a lead-in of ADPCM silence, so triggers keep their spacing to the sample however the updates jitter.
+*  The other commands take effect at the start of that frame, as the renderer applies parameters once per frame.
+*/
+
+#include <atomic>
+
+#include <nn/nn_Common.h>
+#include <nn/nn_Macro.h>
+#include <nn/audio.h>
+#include <nn/os.h>
+
+#include "AudioBank.h"
+#include "AudioCaptureWriter.h"
+#include "AudioDspBudget.h"
+#include "AudioDspMpscQueue.h"
+#include "AudioDspSpatializer.h"
+#include "AudioDspWavePool.h"
+#include "AudioMeterTap.h"
+#include "AudioOscillatorPlayer.h"
+#include "AudioPerformanceMetrics.h"
+#include "AudioRampEngine.h"
+#include "AudioSoundEffect.h"
+#include "AudioStreamPlayer.h"
+#include "AudioUpdateThread.h"
+#include "AudioVoiceManager.h"
+
+const int AudioEngineChannelCountMax = 6;      //!<  Entries of each bus; the final mix has at most six buffers.
+const int AudioEngineSubMixCountMax = 8;
+
+struct AudioEngineSubMix
+{
+    int bufferCount;
+    int destination;                            //!<  Destination_MainBus, Destination_AuxBus, or the index of another sub mix.
+    float volume;                               //!<  Mix volume of each send to the destination.
+};
+
+struct AudioEngineGraph
+{
+    int sampleRate;
+    int sampleCount;                            //!<  Samples per audio frame.
+    int finalMixBufferCount;
+    int channelCount;                           //!<  Output channels, and the entries of mainBus and auxBus in use.
+    int8_t mainBus[AudioEngineChannelCountMax]; //!<  Final mix buffers sent to the device, by nn::audio::ChannelMapping.
+    bool isAuxBusEnabled;
+    int8_t auxBus[AudioEngineChannelCountMax];  //!<  Final mix buffers a BufferMixer adds to mainBus at unity gain.
+    const char* deviceName;
+
+    int subMixCount;
+    AudioEngineSubMix subMixes[AudioEngineSubMixCountMax];
+
+    int streamCountMax;
+    int streamChannelCountMax;                  //!<  Voices are budgeted for streams of this many channels.
+    int oscillatorCountMax;                     //!<  Oscillators of the oscillator player; 0 leaves it out.
+    int oscillatorDestination;
+    float oscillatorVolume;
+    int voiceCount;                             //!<  Pooled voices the sound effects share.
+    int voiceChannelCountMax;                   //!<  Largest channel count of a sound effect.
+    int soundEffectCountMax;
+    int bankCountMax;
+    std::size_t bankPoolSize;                   //!<  Memory pool bytes for the banks; each takes its file size rounded up to BufferAlignSize.
+    int rampCountMax;
+    int emitterCountMax;                        //!<  Spatialized streams and sound effects; 0 leaves out the spatializer.
+    int commandCountMax;                        //!<  Commands that can wait for the next update; a power of two.
+    int scheduledCommandCountMax;               //!<  Scheduled commands that can wait for a later audio frame.
+    bool isVirtualVoiceEnabled;                 //!<  Gives the pooled voices to the most audible sound effect instances each update.
+    float virtualVoiceThreshold;                //!<  Audibility, a linear gain, below which an instance stays virtual.
+    int performanceFrameCount;                  //!<  0 leaves out the performance metrics, and the clock then counts updates rather than rendered frames.
+
+    bool isMeteringEnabled;                     //!<  Meters mainBus, auxBus, and each sub mix; every sub mix gets bufferCount more buffers.
+    int8_t meterBus[AudioEngineChannelCountMax]; //!<  Final mix buffers the mainBus and auxBus taps write to; used by nothing else.
+    int captureFrameCount;                      //!<  Audio frames a capture of mainBus may fall behind by; a power of two, or 0 to leave capture out. Needs metering.
+
+    bool isUpdateThreadEnabled;
+    int updateThreadPriority;
+};
+
+//!<  Sets a graph to a stereo 48 kHz final mix of six buffers on "MainAudioOut", with no aux bus, sub mixes, sources, meters, capture, or virtual voices, and room for 64 commands and 64 scheduled ones.
+void InitializeAudioEngineGraph(AudioEngineGraph* pOutGraph) NN_NOEXCEPT;
+
+//!<  The banks and sound effects an engine will load and add, for sizing its graph.
+struct AudioEngineManifest
+{
+    const char* const* bankFileNames;           //!<  Banks to load, in the order of AudioDsp::BudgetSound::bank.
+    int bankCount;
+    const AudioDsp::BudgetSound* soundEffects;  //!<  Sound effects to add, each with the polyphonyMax of its config.
+    int soundEffectCount;
+    int voiceCountMax;                          //!<  Caps the voice pool, for voices stolen or virtualized past it; 0 gives every instance a voice.
+};
+
+/**
+* @brief  Sets the banks, bank memory, sound effects, and voice pool of a graph to what a manifest needs.
+*
+*  Reads the header and entry table of each bank through nn::fs, which must be mounted, and nothing else of it.
+*  Aborts if a bank cannot be read or a sound effect is not in its bank.
+*/
+void ApplyAudioEngineManifest(AudioEngineGraph* pGraph, const AudioEngineManifest& manifest) NN_NOEXCEPT;
+
+class AudioEngine
+{
+    NN_DISALLOW_COPY(AudioEngine);
+    NN_DISALLOW_MOVE(AudioEngine);
+
+public:
+    static const int Destination_MainBus = -1;
+    static const int Destination_AuxBus = -2;
+
+    AudioEngine() NN_NOEXCEPT;
+
+    //!<  The renderer parameter the graph needs.
+    static void GetAudioRendererParameter(nn::audio::AudioRendererParameter* pOutParameter, const AudioEngineGraph& graph) NN_NOEXCEPT;
+
+    //!<  Size of the work buffer to pass to <tt>Initialize()</tt>. It must be aligned to nn::os::MemoryPageSize.
+    static std::size_t GetRequiredWorkBufferSize(const AudioEngineGraph& graph) NN_NOEXCEPT;
+
+    //!<  Size of the pool buffer to pass to <tt>Initialize()</tt>, a multiple of MemoryPoolType::SizeGranularity.
+    static std::size_t GetRequiredPoolBufferSize(const AudioEngineGraph& graph) NN_NOEXCEPT;
+
+    /**
+    * @brief  Opens the renderer, builds the mix graph, starts rendering, and attaches the pool buffer.
+    *
+    *  The work buffer holds the renderer and every object of the engine; the pool buffer holds the sample data and
+    *  must be aligned to nn::audio::MemoryPoolType::AddressAlignment. Both must stay valid until <tt>Finalize()</tt>.
+    *  Aborts if the graph is invalid or the renderer cannot be opened.
+    */
+    void Initialize(const AudioEngineGraph& graph, void* workBuffer, std::size_t workBufferSize,
+                    void* poolBuffer, std::size_t poolBufferSize) NN_NOEXCEPT;
+
+    //!<  Stops the update thread and every voice, detaches the pool buffer, and closes the renderer. Call it from the thread that initialized the engine.
+    void Finalize() NN_NOEXCEPT;
+
+    /**
+    * @brief  Starts the oscillator player, the streams, and the update thread, if the graph has them.
+    *
+    *  Add streams, banks, and sound effects before this; the engine does not grow afterwards.
+    */
+    void Start() NN_NOEXCEPT;
+
+    // Sources. Each Add or Load call returns the index of the new object and aborts once the graph's maximum is reached.
+
+    //!<  Opens a 16-bit PCM WAV stream and routes it. It starts playing with <tt>Start()</tt>.
+    int AddStream(const char* filename, bool loop, int destination, float volume) NN_NOEXCEPT;
+
+    //!<  Reads a bank into the pool buffer.
+    int LoadBank(const char* filename) NN_NOEXCEPT;
+
+    //!<  Binds sound name of a loaded bank to a sound effect. The sound must be ADPCM.
+    int AddSoundEffect(int bank, const char* name, const AudioSoundEffectConfig& config, int destination, float volume) NN_NOEXCEPT;
+
+    // Playback.
+
+    //!<  Starts an instance of a sound effect. Returns its voice handle, or AudioVoiceManager::InvalidHandle if the trigger was dropped.
+    AudioVoiceManager::Handle PlaySoundEffect(int index) NN_NOEXCEPT;
+
+    //!<  Starts an instance delaySampleCount samples into the next audio frame; delaySampleCount is less than graph.sampleCount.
+    AudioVoiceManager::Handle PlaySoundEffect(int index, int delaySampleCount) NN_NOEXCEPT;
+
+    //!<  Stops every instance of a sound effect.
+    void StopSoundEffect(int index) NN_NOEXCEPT;
+
+    //!<  Pauses or resumes a stream. A paused stream keeps its position.
+    void SetStreamPaused(int index, bool isPaused) NN_NOEXCEPT;
+    bool IsStreamPaused(int index) const NN_NOEXCEPT;
+
+    //!<  Sets the destination of a voice and its mix volumes, following the routing rule above.
+    void RouteVoice(nn::audio::VoiceType* pVoice, int channelCount, int destination, float volume) NN_NOEXCEPT;
+
+    // Spatialization. Emitters are added before Start() to sources routed to the main or aux bus, one per source.
+    // Positions are relative to the listener, in units where the gains have unit power within 1 and fall by 1 / distance beyond.
+
+    //!<  Pans a stream from the position (x, y, z). Returns the index of the emitter.
+    int AddStreamEmitter(int stream, float x, float y, float z) NN_NOEXCEPT;
+
+    //!<  Pans every instance of a sound effect from the position (x, y, z). Returns the index of the emitter.
+    int AddSoundEffectEmitter(int soundEffect, float x, float y, float z) NN_NOEXCEPT;
+
+    void SetEmitterPosition(int emitter, float x, float y, float z) NN_NOEXCEPT;
+
+    /**
+    * @brief  Sets the listener orientation as a quaternion (x, y, z, w), as read from a motion sensor.
+    *
+    *  Call it from one thread at a time; it need not be the thread that owns the engine. The next update takes the
+    *  latest orientation without waiting; earlier ones are never queued, and one caught mid-write is taken a frame later.
+    */
+    void SetListenerOrientation(float x, float y, float z, float w) NN_NOEXCEPT;
+
+    // Parameters. Voices, ramps, and oscillators are changed through these, on the thread that owns the engine.
+
+    nn::audio::VoiceType* GetStreamVoice(int index) NN_NOEXCEPT;
+    AudioDsp::OscillatorBank* GetOscillatorBank() NN_NOEXCEPT;
+    nn::audio::VoiceType* GetOscillatorVoice() NN_NOEXCEPT;
+    AudioRampEngine* GetRampEngine() NN_NOEXCEPT { return &m_RampEngine; }
+    AudioVoiceManager* GetVoiceManager() NN_NOEXCEPT { return &m_VoiceManager; }
+
+    //!<  Sound effect instances left virtual by the last update.
+    int GetVirtualVoiceCount() const NN_NOEXCEPT { return m_VirtualVoiceCount; }
+
+    //!<  Null if the graph has no performance frames.
+    AudioPerformanceMetrics* GetPerformanceMetrics() NN_NOEXCEPT;
+
+    //!<  Occupancy of the sample memory that streams and banks take from the pool buffer.
+    void GetWavePoolStatistics(AudioDsp::WavePoolStatistics* pOutStatistics) const NN_NOEXCEPT;
+
+    /**
+    * @brief  Logs each budget of the graph against the most of it used since <tt>Initialize()</tt>, and the bytes of
+    *  the two arenas beyond what the graph needs.
+    *
+    *  Call it on the thread that owns the engine, after a run that reached the worst case, to see what can be trimmed.
+    */
+    void DumpBudget() const NN_NOEXCEPT;
+
+    //!<  Meter of Destination_MainBus, Destination_AuxBus, or a sub mix. Its Read() is safe from any thread.
+    const AudioDsp::Meter& GetMeter(int destination) const NN_NOEXCEPT;
+
+    //!<  Logs a line for each meter. Safe from any thread.
+    void DumpMeters() const NN_NOEXCEPT;
+
+    // Capture of mainBus, for a graph with captureFrameCount. Start and stop create and finish the file and wait on the
+    // file system, so an engine with an update thread is given them from another thread, never through a command.
+
+    //!<  Starts writing mainBus to a 16-bit PCM WAV file at path, on a mounted writable file system. Returns false if the file cannot be created.
+    bool StartCapture(const char* path) NN_NOEXCEPT;
+
+    //!<  Writes what is still queued and closes the file. Finalize() stops a capture left running.
+    void StopCapture() NN_NOEXCEPT;
+
+    //!<  Frames written and dropped by the current or last capture. Safe from any thread.
+    const AudioCaptureWriter& GetCaptureWriter() const NN_NOEXCEPT { return m_CaptureWriter; }
+
+    nn::audio::AudioRendererConfig* GetConfig() NN_NOEXCEPT { return &m_Config; }
+    nn::audio::FinalMixType* GetFinalMix() NN_NOEXCEPT { return &m_FinalMix; }
+    const int8_t* GetMainBus() const NN_NOEXCEPT { return m_Graph.mainBus; }
+    const nn::audio::AudioRendererParameter& GetParameter() const NN_NOEXCEPT { return m_Parameter; }
+
+    // The frame loop, for an engine without an update thread.
+
+    //!<  Waits for the renderer to finish the next audio frame.
+    void WaitForFrame() NN_NOEXCEPT;
+
+    //!<  Refills the streams and oscillators, returns finished voices to the pool, pans the emitters, moves the ramps, and collects the performance frames.
+    void Update() NN_NOEXCEPT;
+
+    //!<  Sends the changes since the last call to the renderer.
+    void RequestUpdate() NN_NOEXCEPT;
+
+    // Commands. Safe to call from any thread once the engine is initialized; the indices are checked when posting.
+    // Each returns false if commandCountMax commands are already waiting, and the command is dropped.
+
+    bool PostPlaySoundEffect(int index) NN_NOEXCEPT;
+    bool PostStopSoundEffect(int index) NN_NOEXCEPT;
+    bool PostStreamPaused(int index, bool isPaused) NN_NOEXCEPT;
+    bool PostEmitterPosition(int emitter, float x, float y, float z) NN_NOEXCEPT;
+    bool PostRampTarget(int ramp, float target, nn::TimeSpan duration, AudioDsp::RampCurve curve) NN_NOEXCEPT;
+
+    //!<  Queues a call of function(pUserData, argument), for anything the commands above do not cover.
+    bool Post(AudioUpdateThread::CommandFunction function, void* pUserData, uintptr_t argument) NN_NOEXCEPT;
+
+    //!<  Commands dropped because the queue was full. Safe to call from any thread.
+    int GetDroppedCommandCount() const NN_NOEXCEPT { return m_Commands.GetOverflowCount(); }
+
+    //!<  Most commands that were waiting at the start of an update; read it on the thread that owns the engine.
+    int GetPeakCommandCount() const NN_NOEXCEPT { return m_Commands.GetPeakCount(); }
+
+    // Scheduled commands. Like the Post calls, for the audio frame holding sampleTime. A time already rendered runs at
+    // the next update. They return false only if the queue is full; a command that finds scheduledCommandCountMax
+    // commands waiting is dropped at the update and counted.
+
+    //!<  Sample time at which the frame prepared by the next update starts. Safe to call from any thread.
+    int64_t GetSampleTime() const NN_NOEXCEPT { return m_SampleTime.load(std::memory_order_acquire); }
+
+    bool SchedulePlaySoundEffect(int index, int64_t sampleTime) NN_NOEXCEPT;
+    bool ScheduleStopSoundEffect(int index, int64_t sampleTime) NN_NOEXCEPT;
+    bool ScheduleStreamPaused(int index, bool isPaused, int64_t sampleTime) NN_NOEXCEPT;
+    bool ScheduleEmitterPosition(int emitter, float x, float y, float z, int64_t sampleTime) NN_NOEXCEPT;
+    bool ScheduleRampTarget(int ramp, float target, nn::TimeSpan duration, AudioDsp::RampCurve curve, int64_t sampleTime) NN_NOEXCEPT;
+    bool Schedule(AudioUpdateThread::CommandFunction function, void* pUserData, uintptr_t argument, int64_t sampleTime) NN_NOEXCEPT;
+
+    //!<  Scheduled commands dropped because scheduledCommandCountMax were waiting; read it on the thread that owns the engine.
+    int GetDroppedScheduledCommandCount() const NN_NOEXCEPT { return m_DroppedScheduledCommandCount; }
+
+private:
+    enum CommandType
+    {
+        CommandType_Call,
+        CommandType_PlaySoundEffect,
+        CommandType_StopSoundEffect,
+        CommandType_SetStreamPaused,
+        CommandType_SetEmitterPosition,
+        CommandType_SetRampTarget
+    };
+
+    struct Command
+    {
+        CommandType type;
+        int target;                                 //!<  Index of the sound effect, stream, emitter, or ramp.
+        int option;                                 //!<  Pause flag, or ramp curve.
+        float values[3];                            //!<  Position, or ramp target.
+        int64_t duration;                           //!<  Ramp duration in nanoseconds.
+        AudioUpdateThread::CommandFunction function;
+        void* pUserData;
+        uintptr_t argument;
+        int64_t sampleTime;                         //!<  0 for the next update.
+        uint32_t sequence;                          //!<  Order of arrival in the heap, for commands of the same time.
+    };
+
+    struct StreamEntry
+    {
+        AudioStreamPlayer player;
+        void* pBuffer;                              //!<  Block of the wave pool the player streams through.
+        int destination;
+        float volume;
+        int emitter;                                //!<  AudioDsp::Spatializer::InvalidEmitter if the stream is not panned.
+    };
+
+    struct SoundEffectEntry
+    {
+        AudioSoundEffect soundEffect;
+        nn::audio::AdpcmHeaderInfo header;
+        int channelCount;
+        int destination;
+        float volume;
+        int emitter;
+    };
+
+    //!<  The source of an emitter: a stream, or a sound effect if isSoundEffect.
+    struct EmitterEntry
+    {
+        int source;
+        bool isSoundEffect;
+    };
+
+    //!<  A sound effect instance ranked for a voice.
+    struct VoiceCandidate
+    {
+        float score;                                //!<  Audibility, doubled if the instance has a voice.
+        int soundEffect;
+        int slot;
+    };
+
+    //!<  Offsets of every piece of the two arenas, from their aligned starts.
+    struct Layout
+    {
+        std::size_t rendererWorkBuffer;
+        std::size_t rendererWorkBufferSize;
+        std::size_t configBuffer;
+        std::size_t configBufferSize;
+        std::size_t metricsBuffer;
+        std::size_t metricsBufferSize;
+        std::size_t voiceManagerBuffer;
+        std::size_t rampBuffer;
+        std::size_t spatializerBuffer;
+        std::size_t spatializerBufferSize;
+        std::size_t emitters;
+        std::size_t commands;
+        std::size_t scheduledCommands;
+        std::size_t voiceCandidates;
+        std::size_t meterTaps;
+        std::size_t meterReadBuffers;
+        std::size_t meterReadBufferStride;
+        std::size_t captureBuffer;
+        std::size_t captureBufferSize;
+        std::size_t captureThreadStack;
+        std::size_t oscillatorWorkBuffer;
+        std::size_t streams;
+        std::size_t streamStacks;
+        std::size_t soundEffects;
+        std::size_t banks;
+        std::size_t updateThreadStack;
+        std::size_t workBufferSize;
+
+        std::size_t oscillatorBuffer;
+        std::size_t silenceBuffer;
+        std::size_t silenceBufferSize;
+        std::size_t wavePool;
+        std::size_t wavePoolSize;
+        std::size_t meterBuffers;
+        std::size_t meterBufferStride;
+        std::size_t poolBufferSize;
+    };
+
+    static void ComputeLayout(Layout* pOutLayout, const AudioEngineGraph& graph, const nn::audio::AudioRendererParameter& parameter) NN_NOEXCEPT;
+
+    //!<  Update function of the update thread; pUserData is the engine.
+    static void UpdateFunction(void* pUserData) NN_NOEXCEPT;
+
+    void AddSubMixes() NN_NOEXCEPT;
+
+    //!<  Taps on mainBus, auxBus, and the sub mixes, in that order.
+    static int GetMeterTapCount(const AudioEngineGraph& graph) NN_NOEXCEPT;
+    static int GetMeterChannelCountMax(const AudioEngineGraph& graph) NN_NOEXCEPT;
+    int GetMeterTapIndex(int destination) const NN_NOEXCEPT;
+    void AddMeterTaps() NN_NOEXCEPT;
+
+    //!<  Mix buffer of channel of a destination: an entry of a bus, or the buffer of a sub mix.
+    int GetDestinationBuffer(int destination, int channel) const NN_NOEXCEPT;
+    int GetDestinationChannelCount(int destination) const NN_NOEXCEPT;
+
+    //!<  Queues a command; see the Post calls.
+    bool PostCommand(const Command& command) NN_NOEXCEPT;
+
+    //!<  Runs the scheduled commands due in the next frame and the commands queued when it is called, moving those for a later frame to the heap. Those posted meanwhile wait for the next update.
+    void ExecuteCommands() NN_NOEXCEPT;
+
+    //!<  Runs command delaySampleCount samples into the next frame, as far as the command can.
+    void ExecuteCommand(const Command& command, int delaySampleCount) NN_NOEXCEPT;
+
+    //!<  Heap order: true if lhs runs after rhs.
+    static bool IsLater(const Command& lhs, const Command& rhs) NN_NOEXCEPT;
+
+    //!<  Takes the latest listener orientation, recomputes the gains, and writes those that changed to the voices of the emitters.
+    void UpdateEmitters() NN_NOEXCEPT;
+
+    //!<  Routes a voice a sound effect has just started and pans it from the sound effect's emitter.
+    void RouteSoundEffectVoice(const SoundEffectEntry& entry, AudioVoiceManager::Handle handle) NN_NOEXCEPT;
+
+    //!<  Ranks the sound effect instances and moves the voices to the most audible ones.
+    void UpdateVirtualVoices() NN_NOEXCEPT;
+
+    //!<  Writes the gains of emitter to every send of a voice routed to destination with volume.
+    void ApplyEmitterGains(int emitter, nn::audio::VoiceType* pVoice, int channelCount, int destination, float volume) NN_NOEXCEPT;
+
+    //!<  Detaches the memory pool, updating the renderer until it lets go of the pool buffer.
+    void DetachMemoryPool() NN_NOEXCEPT;
+
+    AudioEngineGraph m_Graph;
+    nn::audio::AudioRendererParameter m_Parameter;
+    Layout m_Layout;
+    char* m_pWorkBuffer;
+    char* m_pPoolBuffer;
+    std::size_t m_WorkBufferSize;                   //!<  As given to Initialize(), for DumpBudget().
+    std::size_t m_PoolBufferSize;
+
+    nn::audio::AudioRendererHandle m_Handle;
+    nn::os::SystemEvent m_SystemEvent;
+    nn::audio::AudioRendererConfig m_Config;
+    nn::audio::FinalMixType m_FinalMix;
+    nn::audio::SubMixType m_SubMixes[AudioEngineSubMixCountMax];
+    nn::audio::DeviceSinkType m_DeviceSink;
+    nn::audio::BufferMixerType m_BufferMixer;
+    nn::audio::MemoryPoolType m_MemoryPool;
+    AudioDsp::WavePool m_WavePool;                  //!<  Stream buffers in a slab and banks in the long-lived region.
+
+    AudioVoiceManager m_VoiceManager;
+    AudioRampEngine m_RampEngine;
+    AudioOscillatorPlayer m_OscillatorPlayer;
+    AudioPerformanceMetrics m_PerformanceMetrics;
+    AudioCaptureWriter m_CaptureWriter;
+    AudioUpdateThread m_UpdateThread;
+    AudioDsp::Spatializer m_Spatializer;
+    AudioDsp::MpscQueue<Command> m_Commands;        //!<  Over commandCountMax slots in the work buffer.
+    Command* m_pScheduledCommands;                  //!<  Heap of scheduledCommandCountMax entries in the work buffer, earliest first.
+    int m_ScheduledCommandCount;
+    int m_PeakScheduledCommandCount;
+    uint32_t m_ScheduleSequence;
+    int m_DroppedScheduledCommandCount;
+    std::atomic<int64_t> m_SampleTime;              //!<  Advanced by the samples rendered since the last update, at the end of each update.
+
+    // The latest orientation set, published as AudioDsp::Meter publishes its reading.
+    std::atomic<uint32_t> m_ListenerSequence;       //!<  Odd while an orientation is being written.
+    std::atomic<float> m_ListenerOrientation[4];
+
+    StreamEntry* m_pStreams;                        //!<  streamCountMax entries in the work buffer.
+    SoundEffectEntry* m_pSoundEffects;              //!<  soundEffectCountMax entries in the work buffer.
+    AudioBank* m_pBanks;                            //!<  bankCountMax banks in the work buffer.
+    EmitterEntry* m_pEmitters;                      //!<  emitterCountMax entries in the work buffer.
+    AudioMeterTap* m_pMeterTaps;                    //!<  GetMeterTapCount() taps in the work buffer; the auxBus one is unused without an aux bus.
+    VoiceCandidate* m_pVoiceCandidates;             //!<  One per instance slot of soundEffectCountMax sound effects in the work buffer, with virtual voices.
+    int m_VirtualVoiceCount;
+    int m_StreamCount;
+    int m_SoundEffectCount;
+    int m_BankCount;
+    bool m_IsInitialized;
+    bool m_IsStarted;
+};
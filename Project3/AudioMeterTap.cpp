@@ -0,0 +1,130 @@
+#include <cstdio>
+
+#include <nn/nn_Abort.h>
+#include <nn/nn_Log.h>
+
+#include "AudioMeterTap.h"
+
+namespace {
+
+std::size_t AlignUp(std::size_t value, std::size_t alignment)
+{
+    return (value + alignment - 1) & ~(alignment - 1);
+}
+
+}
+
+AudioMeterTap::AudioMeterTap() NN_NOEXCEPT
+    : m_pReadBuffer(nullptr)
+    , m_FrameSampleCount(0)
+    , m_ChannelCount(0)
+    , m_IsInitialized(false)
+    , m_pCaptureWriter(nullptr)
+{
+}
+
+std::size_t AudioMeterTap::GetRequiredPoolBufferSize(const nn::audio::AudioRendererParameter& parameter, int channelCount) NN_NOEXCEPT
+{
+    const std::size_t size = nn::audio::GetRequiredBufferSizeForAuxSendReturnBuffer(&parameter, BufferFrameCount, channelCount);
+    return AlignUp(size, nn::audio::BufferAlignSize) * 2;
+}
+
+std::size_t AudioMeterTap::GetRequiredWorkBufferSize(const nn::audio::AudioRendererParameter& parameter, int channelCount) NN_NOEXCEPT
+{
+    return sizeof(int32_t) * parameter.sampleCount * channelCount * BufferFrameCount;
+}
+
+void AudioMeterTap::Initialize(nn::audio::AudioRendererConfig* pConfig, nn::audio::FinalMixType* pFinalMix, const nn::audio::AudioRendererParameter& parameter,
+                               const int8_t* input, const int8_t* output, int channelCount,
+                               void* poolBuffer, std::size_t poolBufferSize, void* workBuffer, std::size_t workBufferSize) NN_NOEXCEPT
+{
+    NN_ABORT_UNLESS(!m_IsInitialized);
+    NN_ABORT_UNLESS_NOT_NULL(poolBuffer);
+    NN_ABORT_UNLESS(poolBufferSize >= GetRequiredPoolBufferSize(parameter, channelCount));
+
+    const std::size_t size = GetRequiredPoolBufferSize(parameter, channelCount) / 2;
+    nn::Result result = nn::audio::AddAux(pConfig, &m_Aux, pFinalMix, poolBuffer, static_cast<char*>(poolBuffer) + size, size);
+    NN_ABORT_UNLESS_RESULT_SUCCESS(result);
+    Setup(parameter, input, output, channelCount, workBuffer, workBufferSize);
+}
+
+void AudioMeterTap::Initialize(nn::audio::AudioRendererConfig* pConfig, nn::audio::SubMixType* pSubMix, const nn::audio::AudioRendererParameter& parameter,
+                               const int8_t* input, const int8_t* output, int channelCount,
+                               void* poolBuffer, std::size_t poolBufferSize, void* workBuffer, std::size_t workBufferSize) NN_NOEXCEPT
+{
+    NN_ABORT_UNLESS(!m_IsInitialized);
+    NN_ABORT_UNLESS_NOT_NULL(poolBuffer);
+    NN_ABORT_UNLESS(poolBufferSize >= GetRequiredPoolBufferSize(parameter, channelCount));
+
+    const std::size_t size = GetRequiredPoolBufferSize(parameter, channelCount) / 2;
+    nn::Result result = nn::audio::AddAux(pConfig, &m_Aux, pSubMix, poolBuffer, static_cast<char*>(poolBuffer) + size, size);
+    NN_ABORT_UNLESS_RESULT_SUCCESS(result);
+    Setup(parameter, input, output, channelCount, workBuffer, workBufferSize);
+}
+
+void AudioMeterTap::Setup(const nn::audio::AudioRendererParameter& parameter, const int8_t* input, const int8_t* output, int channelCount,
+                          void* workBuffer, std::size_t workBufferSize) NN_NOEXCEPT
+{
+    NN_ABORT_UNLESS(channelCount > 0 && channelCount <= AudioDsp::MeterChannelCountMax);
+    NN_ABORT_UNLESS_NOT_NULL(workBuffer);
+    NN_ABORT_UNLESS(workBufferSize >= GetRequiredWorkBufferSize(parameter, channelCount));
+
+    nn::audio::SetAuxInputOutput(&m_Aux, input, output, channelCount);
+    nn::audio::SetAuxEnabled(&m_Aux, true);
+    m_pReadBuffer = static_cast<int32_t*>(workBuffer);
+    m_FrameSampleCount = parameter.sampleCount;
+    m_ChannelCount = channelCount;
+    m_Meter.Initialize(channelCount, parameter.sampleRate);
+    m_IsInitialized = true;
+}
+
+void AudioMeterTap::Finalize() NN_NOEXCEPT
+{
+    if (!m_IsInitialized)
+    {
+        return;
+    }
+    nn::audio::SetAuxEnabled(&m_Aux, false);
+    m_pReadBuffer = nullptr;
+    m_IsInitialized = false;
+}
+
+void AudioMeterTap::Update() NN_NOEXCEPT
+{
+    NN_ABORT_UNLESS(m_IsInitialized);
+
+    // The send buffer holds whole audio frames, each a block of m_FrameSampleCount samples per channel.
+    const int frameSize = m_FrameSampleCount * m_ChannelCount;
+    for (;;)
+    {
+        const int readCount = nn::audio::ReadAuxSendBuffer(&m_Aux, m_pReadBuffer, frameSize * BufferFrameCount);
+        for (int offset = 0; offset + frameSize <= readCount; offset += frameSize)
+        {
+            m_Meter.Process(m_pReadBuffer + offset, m_FrameSampleCount);
+            if (m_pCaptureWriter != nullptr)
+            {
+                m_pCaptureWriter->Push(m_pReadBuffer + offset);
+            }
+        }
+        if (readCount < frameSize * BufferFrameCount)
+        {
+            break;
+        }
+    }
+}
+
+void AudioMeterTap::Dump(const char* label) const NN_NOEXCEPT
+{
+    AudioDsp::MeterReading reading;
+    m_Meter.Read(&reading);
+
+    // Peak and RMS per channel, then the bus as a whole.
+    char channels[AudioDsp::MeterChannelCountMax * 24] = "";
+    int length = 0;
+    for (int c = 0; c < reading.channelCount && length < static_cast<int>(sizeof(channels)); ++c)
+    {
+        length += std::snprintf(channels + length, sizeof(channels) - length, "%s%.1f/%.1f", c > 0 ? " " : "", reading.peakDb[c], reading.rmsDb[c]);
+    }
+    NN_LOG("[meter] %s peak/rms dBFS %s, momentary %.1f LUFS, short-term %.1f LUFS, max peak %.1f dBFS, %u clips\n",
+           label, channels, reading.momentaryLufs, reading.shortTermLufs, reading.peakMaxDb, reading.clipCount);
+}
@@ -0,0 +1,81 @@
+#pragma once
+
+/**
+* @brief
+*  Meters one bus of the mix graph through an aux effect.
+*
+*  The aux copies the buffers of the bus into a send buffer every audio frame, and <tt>Update()</tt> reads whatever
+*  frames arrived into <tt>AudioDsp::Meter</tt>. The aux writes its return into buffers nothing else reads, so the bus
+*  itself passes on unchanged and the tap adds no latency to it. The return buffer is never filled.
+*
+*  The meter is written on the thread that updates the engine and can be read from any other without a lock. Given an
+*  <tt>AudioCaptureWriter</tt>, the tap also passes it every frame it meters.
+*/
+
+#include <nn/nn_Common.h>
+#include <nn/nn_Macro.h>
+#include <nn/audio.h>
+
+#include "AudioCaptureWriter.h"
+#include "AudioDspMeter.h"
+
+class AudioMeterTap
+{
+    NN_DISALLOW_COPY(AudioMeterTap);
+    NN_DISALLOW_MOVE(AudioMeterTap);
+
+public:
+    //!<  Audio frames the send buffer holds. Frames beyond it between two updates are lost to the meter.
+    static const int BufferFrameCount = 8;
+
+    AudioMeterTap() NN_NOEXCEPT;
+
+    //!<  Size of the send and return buffers, which must be in a memory pool.
+    static std::size_t GetRequiredPoolBufferSize(const nn::audio::AudioRendererParameter& parameter, int channelCount) NN_NOEXCEPT;
+
+    //!<  Size of the buffer the send buffer is read into.
+    static std::size_t GetRequiredWorkBufferSize(const nn::audio::AudioRendererParameter& parameter, int channelCount) NN_NOEXCEPT;
+
+    /**
+    * @brief  Adds the aux to the final mix, taking channelCount buffers from input and writing its return to output.
+    *
+    *  Effects run in the order they are added, so a tap added after a BufferMixer meters the bus it mixed into. The
+    *  output buffers must not be used by anything else. poolBuffer must be in an attached memory pool, and both buffers
+    *  must stay valid until <tt>Finalize()</tt>.
+    */
+    void Initialize(nn::audio::AudioRendererConfig* pConfig, nn::audio::FinalMixType* pFinalMix, const nn::audio::AudioRendererParameter& parameter,
+                    const int8_t* input, const int8_t* output, int channelCount,
+                    void* poolBuffer, std::size_t poolBufferSize, void* workBuffer, std::size_t workBufferSize) NN_NOEXCEPT;
+
+    //!<  Adds the aux to a sub mix; input and output are buffers of the sub mix.
+    void Initialize(nn::audio::AudioRendererConfig* pConfig, nn::audio::SubMixType* pSubMix, const nn::audio::AudioRendererParameter& parameter,
+                    const int8_t* input, const int8_t* output, int channelCount,
+                    void* poolBuffer, std::size_t poolBufferSize, void* workBuffer, std::size_t workBufferSize) NN_NOEXCEPT;
+
+    //!<  Disables the aux, so the renderer lets go of the pool buffer at its next update.
+    void Finalize() NN_NOEXCEPT;
+
+    //!<  Meters the frames the renderer sent since the last call. Call it on the thread that owns the config.
+    void Update() NN_NOEXCEPT;
+
+    //!<  Pushes every frame Update() reads to pCaptureWriter, which has the tap's channel count and must outlive the tap; null stops that.
+    void SetCaptureWriter(AudioCaptureWriter* pCaptureWriter) NN_NOEXCEPT { m_pCaptureWriter = pCaptureWriter; }
+
+    //!<  Readable from any thread.
+    const AudioDsp::Meter& GetMeter() const NN_NOEXCEPT { return m_Meter; }
+
+    //!<  Logs the latest reading as one line. Safe from any thread.
+    void Dump(const char* label) const NN_NOEXCEPT;
+
+private:
+    void Setup(const nn::audio::AudioRendererParameter& parameter, const int8_t* input, const int8_t* output, int channelCount,
+               void* workBuffer, std::size_t workBufferSize) NN_NOEXCEPT;
+
+    nn::audio::AuxType m_Aux;
+    int32_t* m_pReadBuffer;
+    int m_FrameSampleCount;             //!<  Samples of one channel in an audio frame.
+    int m_ChannelCount;
+    bool m_IsInitialized;
+    AudioDsp::Meter m_Meter;
+    AudioCaptureWriter* m_pCaptureWriter;
+};
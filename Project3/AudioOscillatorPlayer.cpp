@@ -0,0 +1,84 @@
+#include <nn/nn_Abort.h>
+
+#include "AudioOscillatorPlayer.h"
+
+AudioOscillatorPlayer::AudioOscillatorPlayer() NN_NOEXCEPT
+    : m_pConfig(nullptr)
+    , m_pBuffer(nullptr)
+{
+}
+
+std::size_t AudioOscillatorPlayer::GetRequiredBufferSize() NN_NOEXCEPT
+{
+    return BufferCount * BufferSampleCount * sizeof(int16_t);
+}
+
+std::size_t AudioOscillatorPlayer::GetRequiredWorkBufferSize(int oscillatorCountMax) NN_NOEXCEPT
+{
+    return AudioDsp::OscillatorBank::GetRequiredWorkBufferSize(oscillatorCountMax);
+}
+
+void AudioOscillatorPlayer::Initialize(nn::audio::AudioRendererConfig* pConfig, int sampleRate, int oscillatorCountMax,
+                                       void* buffer, std::size_t bufferSize, void* workBuffer, std::size_t workBufferSize) NN_NOEXCEPT
+{
+    NN_ABORT_UNLESS_NOT_NULL(pConfig);
+    NN_ABORT_UNLESS_NOT_NULL(buffer);
+    NN_ABORT_UNLESS(bufferSize >= GetRequiredBufferSize());
+    NN_ABORT_UNLESS_NOT_NULL(workBuffer);
+    NN_ABORT_UNLESS(oscillatorCountMax > 0);
+    NN_ABORT_UNLESS(workBufferSize >= GetRequiredWorkBufferSize(oscillatorCountMax));
+
+    m_pConfig = pConfig;
+    m_pBuffer = static_cast<int16_t*>(buffer);
+    m_Bank.Initialize(workBuffer, workBufferSize, oscillatorCountMax, sampleRate);
+
+    nn::audio::AcquireVoiceSlot(pConfig, &m_Voice, sampleRate, 1, nn::audio::SampleFormat_PcmInt16, nn::audio::VoiceType::PriorityHighest, nullptr, 0);
+
+    for (int i = 0; i < BufferCount; ++i)
+    {
+        nn::audio::WaveBuffer& waveBuffer = m_WaveBuffers[i];
+        waveBuffer.buffer = m_pBuffer + i * BufferSampleCount;
+        waveBuffer.size = BufferSampleCount * sizeof(int16_t);
+        waveBuffer.startSampleOffset = 0;
+        waveBuffer.endSampleOffset = BufferSampleCount;
+        waveBuffer.loop = false;
+        waveBuffer.isEndOfStream = false;
+        waveBuffer.pContext = nullptr;
+        waveBuffer.contextSize = 0;
+    }
+}
+
+void AudioOscillatorPlayer::Finalize() NN_NOEXCEPT
+{
+    nn::audio::SetVoicePlayState(&m_Voice, nn::audio::VoiceType::PlayState_Stop);
+    nn::audio::ReleaseVoiceSlot(m_pConfig, &m_Voice);
+    m_pConfig = nullptr;
+    m_pBuffer = nullptr;
+}
+
+void AudioOscillatorPlayer::Start() NN_NOEXCEPT
+{
+    for (int i = 0; i < BufferCount; ++i)
+    {
+        FillBuffer(i);
+        nn::audio::AppendWaveBuffer(&m_Voice, &m_WaveBuffers[i]);
+    }
+    nn::audio::SetVoicePlayState(&m_Voice, nn::audio::VoiceType::PlayState_Play);
+}
+
+void AudioOscillatorPlayer::Update() NN_NOEXCEPT
+{
+    // Buffers are released in the order they were queued, so the bank output stays continuous.
+    while (const nn::audio::WaveBuffer* pWaveBuffer = nn::audio::GetReleasedWaveBuffer(&m_Voice))
+    {
+        const ptrdiff_t index = pWaveBuffer - m_WaveBuffers;
+        NN_ABORT_UNLESS(index >= 0 && index < BufferCount);
+        FillBuffer(static_cast<int>(index));
+        nn::audio::AppendWaveBuffer(&m_Voice, &m_WaveBuffers[index]);
+    }
+}
+
+void AudioOscillatorPlayer::FillBuffer(int index) NN_NOEXCEPT
+{
+    m_Bank.Process(m_pBuffer + index * BufferSampleCount, BufferSampleCount);
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+/**
+* @brief
+*  Plays an <tt>AudioDsp::OscillatorBank</tt> through a single mono voice.
+*
+*  The bank is rendered on demand into a ring of <tt>BufferCount</tt> wave buffers of <tt>BufferSampleCount</tt> samples,
+*  so the ring is the only memory pool memory the oscillators use, however many of them there are.
+*  Oscillators are added and changed through <tt>GetBank()</tt>; changes are heard once the buffers queued before them have played.
+*  All calls must come from the thread that calls <tt>Update()</tt>.
+*/
+
+#include <nn/nn_Common.h>
+#include <nn/nn_Macro.h>
+#include <nn/audio.h>
+
+#include "AudioDspOscillator.h"
+
+class AudioOscillatorPlayer
+{
+    NN_DISALLOW_COPY(AudioOscillatorPlayer);
+    NN_DISALLOW_MOVE(AudioOscillatorPlayer);
+
+public:
+    static const int BufferCount = 4;                   //!<  Number of wave buffers a voice can hold at once.
+    static const int BufferSampleCount = 480;           //!<  Samples per wave buffer (15 ms at 32 kHz).
+
+    AudioOscillatorPlayer() NN_NOEXCEPT;
+
+    //!<  Size of the sample memory to pass to <tt>Initialize()</tt>. It must be in an attached memory pool.
+    static std::size_t GetRequiredBufferSize() NN_NOEXCEPT;
+
+    //!<  Size of the oscillator state to pass to <tt>Initialize()</tt>. It does not need to be in a memory pool.
+    static std::size_t GetRequiredWorkBufferSize(int oscillatorCountMax) NN_NOEXCEPT;
+
+    /**
+    * @brief  Acquires a mono voice at sampleRate and prepares a bank of up to oscillatorCountMax oscillators.
+    *
+    *  Set the voice destination and mix volumes through <tt>GetVoice()</tt> before calling <tt>Start()</tt>.
+    *  <tt>buffer</tt> must be aligned to <tt>nn::audio::BufferAlignSize</tt>.
+    */
+    void Initialize(nn::audio::AudioRendererConfig* pConfig, int sampleRate, int oscillatorCountMax,
+                    void* buffer, std::size_t bufferSize, void* workBuffer, std::size_t workBufferSize) NN_NOEXCEPT;
+
+    //!<  Stops and releases the voice.
+    void Finalize() NN_NOEXCEPT;
+
+    //!<  Renders and queues every buffer, then starts playback.
+    void Start() NN_NOEXCEPT;
+
+    //!<  Renders the next block of the bank into each released buffer and queues it again. Call once per update.
+    void Update() NN_NOEXCEPT;
+
+    AudioDsp::OscillatorBank* GetBank() NN_NOEXCEPT { return &m_Bank; }
+    nn::audio::VoiceType* GetVoice() NN_NOEXCEPT { return &m_Voice; }
+
+private:
+    //!<  Renders the bank into the given buffer.
+    void FillBuffer(int index) NN_NOEXCEPT;
+
+    nn::audio::AudioRendererConfig* m_pConfig;
+    nn::audio::VoiceType m_Voice;
+    nn::audio::WaveBuffer m_WaveBuffers[BufferCount];
+    int16_t* m_pBuffer;
+    AudioDsp::OscillatorBank m_Bank;
+};
@@ -0,0 +1,123 @@
+#include <nn/nn_Abort.h>
+#include <nn/nn_Log.h>
+
+#include "AudioPerformanceMetrics.h"
+
+AudioPerformanceMetrics::AudioPerformanceMetrics() NN_NOEXCEPT
+    : m_pConfig(nullptr)
+    , m_BufferSize(0)
+    , m_NextBuffer(0)
+{
+    m_Buffers[0] = nullptr;
+    m_Buffers[1] = nullptr;
+}
+
+std::size_t AudioPerformanceMetrics::GetRequiredBufferSize(const nn::audio::AudioRendererParameter& parameter) NN_NOEXCEPT
+{
+    return nn::audio::GetRequiredBufferSizeForPerformanceFrames(parameter) * 2;
+}
+
+void AudioPerformanceMetrics::Initialize(nn::audio::AudioRendererConfig* pConfig, const nn::audio::AudioRendererParameter& parameter, const nn::audio::FinalMixType* pFinalMix,
+                                         void* buffer, std::size_t bufferSize) NN_NOEXCEPT
+{
+    NN_ABORT_UNLESS_NOT_NULL(pConfig);
+    NN_ABORT_UNLESS_NOT_NULL(buffer);
+    NN_ABORT_UNLESS(parameter.performanceFrameCount > 0);
+    NN_ABORT_UNLESS(bufferSize >= GetRequiredBufferSize(parameter));
+
+    m_pConfig = pConfig;
+    m_BufferSize = nn::audio::GetRequiredBufferSizeForPerformanceFrames(parameter);
+    m_Buffers[0] = buffer;
+    m_Buffers[1] = static_cast<char*>(buffer) + m_BufferSize;
+    m_NextBuffer = 1;
+    m_Metrics.Initialize(parameter.sampleCount, parameter.sampleRate);
+
+    nn::audio::SetPerformanceFrameBuffer(pConfig, m_Buffers[0], m_BufferSize);
+    if (pFinalMix != nullptr)
+    {
+        nn::audio::SetPerformanceDetailTarget(pConfig, pFinalMix);
+    }
+}
+
+void AudioPerformanceMetrics::Finalize() NN_NOEXCEPT
+{
+    if (m_pConfig != nullptr)
+    {
+        nn::audio::SetPerformanceFrameBuffer(m_pConfig, nullptr, 0);
+        m_pConfig = nullptr;
+    }
+    m_Buffers[0] = nullptr;
+    m_Buffers[1] = nullptr;
+}
+
+int AudioPerformanceMetrics::Update() NN_NOEXCEPT
+{
+    NN_ABORT_UNLESS_NOT_NULL(m_pConfig);
+
+    // The renderer returns the buffer it filled since the previous call.
+    const void* filled = nn::audio::SetPerformanceFrameBuffer(m_pConfig, m_Buffers[m_NextBuffer], m_BufferSize);
+    m_NextBuffer ^= 1;
+    return filled != nullptr ? AddFrames(filled) : 0;
+}
+
+void AudioPerformanceMetrics::SetLabel(const nn::audio::VoiceType* pVoice, const char* label) NN_NOEXCEPT
+{
+    m_Metrics.SetLabel(nn::audio::GetVoiceNodeId(pVoice), label);
+}
+
+void AudioPerformanceMetrics::Dump() NN_NOEXCEPT
+{
+    m_Metrics.Dump(m_DumpBuffer, sizeof(m_DumpBuffer), "nx");
+    NN_LOG("%s", m_DumpBuffer);
+}
+
+int AudioPerformanceMetrics::AddFrames(const void* buffer) NN_NOEXCEPT
+{
+    nn::audio::PerformanceInfo info;
+    if (!info.SetBuffer(buffer, m_BufferSize))
+    {
+        return 0;
+    }
+    int frameCount = 0;
+    do
+    {
+        ++frameCount;
+        m_Metrics.BeginFrame();
+        int entryCount;
+        const nn::audio::PerformanceEntry* pEntries = info.GetEntries(&entryCount);
+        for (int i = 0; i < entryCount; ++i)
+        {
+            const float time = static_cast<float>(pEntries[i].processingTime);
+            switch (pEntries[i].entryType)
+            {
+            case nn::audio::PerformanceEntryType_Voice:
+                m_Metrics.AddEntry(AudioDsp::MetricsNodeType_Voice, pEntries[i].nodeId, time);
+                break;
+            case nn::audio::PerformanceEntryType_SubMix:
+                m_Metrics.AddEntry(AudioDsp::MetricsNodeType_SubMix, pEntries[i].nodeId, time);
+                break;
+            case nn::audio::PerformanceEntryType_FinalMix:
+                m_Metrics.AddEntry(AudioDsp::MetricsNodeType_FinalMix, pEntries[i].nodeId, time);
+                break;
+            case nn::audio::PerformanceEntryType_Sink:
+                m_Metrics.AddEntry(AudioDsp::MetricsNodeType_Sink, pEntries[i].nodeId, time);
+                break;
+            default:
+                break;
+            }
+        }
+
+        // Only the final mix is a detail target, and besides its volume it processes nothing but its effects.
+        int detailCount;
+        const nn::audio::PerformanceDetailEntry* pDetails = info.GetDetailEntries(&detailCount);
+        for (int i = 0; i < detailCount; ++i)
+        {
+            if (pDetails[i].parentEntryType == nn::audio::PerformanceEntryType_FinalMix)
+            {
+                m_Metrics.AddEntry(AudioDsp::MetricsNodeType_Effect, pDetails[i].nodeId, static_cast<float>(pDetails[i].processingTime));
+            }
+        }
+        m_Metrics.EndFrame(static_cast<float>(info.GetTotalProcessingTime()), info.IsRenderingTimeLimitExceeded());
+    } while (info.MoveToNextFrame());
+    return frameCount;
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+/**
+* @brief
+*  Collects the renderer's performance frames into <tt>AudioDsp::RenderMetrics</tt>.
+*
+*  With <tt>performanceFrameCount</tt> above zero, the renderer writes the processing time of every voice, sub mix,
+*  final mix, and sink of each audio frame into a buffer set on the config. This class keeps two such buffers: each
+*  <tt>Update()</tt> hands the renderer the empty one and parses the frames of the one it filled. The effects of the final
+*  mix are timed as its detail entries.
+*
+*  The host software mixer (<tt>HostAudioTool render --metrics</tt>) writes the same metrics, so its dump lines can be
+*  compared with the ones logged here.
+*/
+
+#include <nn/nn_Common.h>
+#include <nn/nn_Macro.h>
+#include <nn/audio.h>
+
+#include "AudioDspMetrics.h"
+
+class AudioPerformanceMetrics
+{
+    NN_DISALLOW_COPY(AudioPerformanceMetrics);
+    NN_DISALLOW_MOVE(AudioPerformanceMetrics);
+
+public:
+    static const std::size_t DumpBufferSize = 16 * 1024;    //!<  Holds a dump with every voice of the breakdown.
+
+    AudioPerformanceMetrics() NN_NOEXCEPT;
+
+    //!<  Size of the buffer to pass to <tt>Initialize()</tt>, for the parameter the renderer was opened with.
+    static std::size_t GetRequiredBufferSize(const nn::audio::AudioRendererParameter& parameter) NN_NOEXCEPT;
+
+    /**
+    * @brief  Hands the first performance buffer to the renderer.
+    *
+    *  <tt>parameter.performanceFrameCount</tt> must cover the audio frames between two <tt>Update()</tt> calls; frames beyond
+    *  it are not recorded. pFinalMix may be null, in which case no effect times are collected.
+    */
+    void Initialize(nn::audio::AudioRendererConfig* pConfig, const nn::audio::AudioRendererParameter& parameter, const nn::audio::FinalMixType* pFinalMix,
+                    void* buffer, std::size_t bufferSize) NN_NOEXCEPT;
+
+    //!<  Takes the performance buffer back from the config. The buffer may be freed afterwards.
+    void Finalize() NN_NOEXCEPT;
+
+    /**
+    * @brief  Swaps the performance buffers and adds the frames the renderer wrote since the last call.
+    *
+    *  Call it before each <tt>nn::audio::RequestUpdateAudioRenderer()</tt>, on the thread that owns the config. Returns
+    *  the audio frames added, which are the frames rendered since the last call up to <tt>performanceFrameCount</tt>.
+    */
+    int Update() NN_NOEXCEPT;
+
+    //!<  Names a voice in the dump. label must stay valid.
+    void SetLabel(const nn::audio::VoiceType* pVoice, const char* label) NN_NOEXCEPT;
+
+    const AudioDsp::RenderMetrics& GetMetrics() const NN_NOEXCEPT { return m_Metrics; }
+
+    //!<  Logs the metrics as one line of the schema in AudioDspMetrics.h.
+    void Dump() NN_NOEXCEPT;
+
+private:
+    //!<  Returns the frames added.
+    int AddFrames(const void* buffer) NN_NOEXCEPT;
+
+    nn::audio::AudioRendererConfig* m_pConfig;
+    void* m_Buffers[2];
+    std::size_t m_BufferSize;           //!<  Of each of m_Buffers.
+    int m_NextBuffer;                   //!<  Index of the buffer the renderer gets at the next Update().
+    AudioDsp::RenderMetrics m_Metrics;
+    char m_DumpBuffer[DumpBufferSize];
+};
@@ -0,0 +1,208 @@
+#include <algorithm>
+#include <cmath>
+#include <new>
+
+#include <nn/nn_Abort.h>
+
+#include "AudioRampEngine.h"
+
+namespace {
+
+const float HalfPi = 1.5707963267948966f;
+
+uintptr_t AlignUp(uintptr_t value, std::size_t alignment)
+{
+    return (value + alignment - 1) & ~static_cast<uintptr_t>(alignment - 1);
+}
+
+}
+
+AudioRampEngine::AudioRampEngine() NN_NOEXCEPT
+    : m_pEntries(nullptr)
+    , m_RampCountMax(0)
+    , m_SampleRate(0)
+    , m_SampleCount(0)
+    , m_WriteCount(0)
+{
+}
+
+std::size_t AudioRampEngine::GetRequiredWorkBufferSize(int rampCountMax) NN_NOEXCEPT
+{
+    return NN_ALIGNOF(Entry) - 1 + sizeof(Entry) * rampCountMax;
+}
+
+void AudioRampEngine::Initialize(const nn::audio::AudioRendererParameter& parameter, int rampCountMax, void* workBuffer, std::size_t workBufferSize) NN_NOEXCEPT
+{
+    NN_ABORT_UNLESS(rampCountMax > 0);
+    NN_ABORT_UNLESS_NOT_NULL(workBuffer);
+    NN_ABORT_UNLESS(workBufferSize >= GetRequiredWorkBufferSize(rampCountMax));
+
+    m_pEntries = reinterpret_cast<Entry*>(AlignUp(reinterpret_cast<uintptr_t>(workBuffer), NN_ALIGNOF(Entry)));
+    m_RampCountMax = rampCountMax;
+    m_SampleRate = parameter.sampleRate;
+    m_SampleCount = parameter.sampleCount;
+    m_WriteCount = 0;
+
+    for (int i = 0; i < rampCountMax; ++i)
+    {
+        Entry* pEntry = new (&m_pEntries[i]) Entry();
+        pEntry->target = Target_None;
+        pEntry->pVoice = nullptr;
+        pEntry->pFinalMix = nullptr;
+    }
+}
+
+void AudioRampEngine::Finalize() NN_NOEXCEPT
+{
+    for (int i = 0; i < m_RampCountMax; ++i)
+    {
+        m_pEntries[i].~Entry();
+    }
+    m_pEntries = nullptr;
+    m_RampCountMax = 0;
+}
+
+int AudioRampEngine::AddVoiceVolume(nn::audio::VoiceType* pVoice) NN_NOEXCEPT
+{
+    return Add(Target_VoiceVolume, pVoice, nn::audio::GetVoiceVolume(pVoice));
+}
+
+int AudioRampEngine::AddVoicePitch(nn::audio::VoiceType* pVoice) NN_NOEXCEPT
+{
+    return Add(Target_VoicePitch, pVoice, nn::audio::GetVoicePitch(pVoice));
+}
+
+int AudioRampEngine::AddVoiceMixVolume(nn::audio::VoiceType* pVoice, nn::audio::FinalMixType* pFinalMix, int sourceChannel, int destinationBus) NN_NOEXCEPT
+{
+    NN_ABORT_UNLESS_NOT_NULL(pFinalMix);
+
+    const int handle = Add(Target_VoiceMixVolume, pVoice, nn::audio::GetVoiceMixVolume(pVoice, pFinalMix, sourceChannel, destinationBus));
+    if (handle != InvalidHandle)
+    {
+        Entry& entry = m_pEntries[handle];
+        entry.pFinalMix = pFinalMix;
+        entry.sourceChannel[0] = sourceChannel;
+        entry.destinationBus[0] = destinationBus;
+    }
+    return handle;
+}
+
+int AudioRampEngine::AddVoicePan(nn::audio::VoiceType* pVoice, nn::audio::FinalMixType* pFinalMix, int leftChannel, int rightChannel,
+                                 int leftBus, int rightBus, float gain, float pan) NN_NOEXCEPT
+{
+    NN_ABORT_UNLESS_NOT_NULL(pFinalMix);
+
+    const int handle = Add(Target_VoicePan, pVoice, pan);
+    if (handle != InvalidHandle)
+    {
+        Entry& entry = m_pEntries[handle];
+        entry.pFinalMix = pFinalMix;
+        entry.sourceChannel[0] = leftChannel;
+        entry.sourceChannel[1] = rightChannel;
+        entry.destinationBus[0] = leftBus;
+        entry.destinationBus[1] = rightBus;
+        entry.gain = gain;
+        Apply(entry);
+    }
+    return handle;
+}
+
+void AudioRampEngine::Remove(int handle) NN_NOEXCEPT
+{
+    NN_ABORT_UNLESS(handle >= 0 && handle < m_RampCountMax);
+
+    m_pEntries[handle].target = Target_None;
+    m_pEntries[handle].pVoice = nullptr;
+    m_pEntries[handle].pFinalMix = nullptr;
+}
+
+void AudioRampEngine::SetTarget(int handle, float target, nn::TimeSpan duration, AudioDsp::RampCurve curve) NN_NOEXCEPT
+{
+    NN_ABORT_UNLESS(handle >= 0 && handle < m_RampCountMax);
+    NN_ABORT_UNLESS(m_pEntries[handle].target != Target_None);
+
+    // Round up to whole frames so a ramp never runs faster than asked.
+    const int64_t frameMicroSeconds = static_cast<int64_t>(m_SampleCount) * 1000000;
+    const int64_t stepCount = (duration.GetMicroSeconds() * m_SampleRate + frameMicroSeconds - 1) / frameMicroSeconds;
+    m_pEntries[handle].ramp.SetTarget(target, static_cast<int>(stepCount), curve);
+}
+
+float AudioRampEngine::GetValue(int handle) const NN_NOEXCEPT
+{
+    return GetEntry(handle).ramp.GetValue();
+}
+
+float AudioRampEngine::GetTarget(int handle) const NN_NOEXCEPT
+{
+    return GetEntry(handle).ramp.GetTarget();
+}
+
+bool AudioRampEngine::IsRamping(int handle) const NN_NOEXCEPT
+{
+    return GetEntry(handle).ramp.IsRamping();
+}
+
+void AudioRampEngine::Update() NN_NOEXCEPT
+{
+    for (int i = 0; i < m_RampCountMax; ++i)
+    {
+        Entry& entry = m_pEntries[i];
+        if (entry.target != Target_None && entry.ramp.Advance())
+        {
+            Apply(entry);
+        }
+    }
+}
+
+int AudioRampEngine::Add(Target target, nn::audio::VoiceType* pVoice, float value) NN_NOEXCEPT
+{
+    NN_ABORT_UNLESS_NOT_NULL(pVoice);
+
+    for (int i = 0; i < m_RampCountMax; ++i)
+    {
+        Entry& entry = m_pEntries[i];
+        if (entry.target == Target_None)
+        {
+            entry.target = target;
+            entry.pVoice = pVoice;
+            entry.ramp.Reset(value);
+            return i;
+        }
+    }
+    return InvalidHandle;
+}
+
+void AudioRampEngine::Apply(const Entry& entry) NN_NOEXCEPT
+{
+    const float value = entry.ramp.GetValue();
+    switch (entry.target)
+    {
+    case Target_VoiceVolume:
+        nn::audio::SetVoiceVolume(entry.pVoice, value);
+        break;
+    case Target_VoicePitch:
+        nn::audio::SetVoicePitch(entry.pVoice, value);
+        break;
+    case Target_VoiceMixVolume:
+        nn::audio::SetVoiceMixVolume(entry.pVoice, entry.pFinalMix, value, entry.sourceChannel[0], entry.destinationBus[0]);
+        break;
+    case Target_VoicePan:
+        {
+            const float angle = HalfPi * std::min(std::max(value, 0.0f), 1.0f);
+            nn::audio::SetVoiceMixVolume(entry.pVoice, entry.pFinalMix, entry.gain * std::cos(angle), entry.sourceChannel[0], entry.destinationBus[0]);
+            nn::audio::SetVoiceMixVolume(entry.pVoice, entry.pFinalMix, entry.gain * std::sin(angle), entry.sourceChannel[1], entry.destinationBus[1]);
+            ++m_WriteCount;
+        }
+        break;
+    default:
+        NN_ABORT("Unexpected ramp target\n");
+        break;
+    }
+    ++m_WriteCount;
+}
+
+const AudioRampEngine::Entry& AudioRampEngine::GetEntry(int handle) const NN_NOEXCEPT
+{
+    NN_ABORT_UNLESS(handle >= 0 && handle < m_RampCountMax);
+    return m_pEntries[handle];
+}
@@ -0,0 +1,106 @@
+#pragma once
+
+/**
+* @brief
+*  Glides voice volume, pitch, mix volume, and stereo pan to a target over a duration.
+*
+*  Each ramp is bound to one voice parameter. <tt>Update()</tt> advances every ramp by one audio frame and writes
+*  the new value to the voice only while the ramp is moving, so a parameter at rest costs no writes at all.
+*  The renderer ramps volume and mix volume changes over the frame they are applied in, so a volume ramp
+*  is piecewise linear at the sample level instead of stepping once per update.
+*  All calls must come from the thread that calls <tt>Update()</tt>.
+*/
+
+#include <nn/nn_Common.h>
+#include <nn/nn_Macro.h>
+#include <nn/audio.h>
+
+#include "AudioDspRamp.h"
+
+class AudioRampEngine
+{
+    NN_DISALLOW_COPY(AudioRampEngine);
+    NN_DISALLOW_MOVE(AudioRampEngine);
+
+public:
+    static const int InvalidHandle = -1;
+
+    AudioRampEngine() NN_NOEXCEPT;
+
+    //!<  Size of the work buffer to pass to <tt>Initialize()</tt>.
+    static std::size_t GetRequiredWorkBufferSize(int rampCountMax) NN_NOEXCEPT;
+
+    //!<  Prepares room for rampCountMax ramps. The frame length is taken from the renderer parameter.
+    void Initialize(const nn::audio::AudioRendererParameter& parameter, int rampCountMax, void* workBuffer, std::size_t workBufferSize) NN_NOEXCEPT;
+
+    void Finalize() NN_NOEXCEPT;
+
+    // Each Add function returns a ramp handle, or InvalidHandle if every ramp is in use. The ramp starts at the parameter's current value.
+    int AddVoiceVolume(nn::audio::VoiceType* pVoice) NN_NOEXCEPT;
+    int AddVoicePitch(nn::audio::VoiceType* pVoice) NN_NOEXCEPT;
+    int AddVoiceMixVolume(nn::audio::VoiceType* pVoice, nn::audio::FinalMixType* pFinalMix, int sourceChannel, int destinationBus) NN_NOEXCEPT;
+
+    /**
+    * @brief  Binds a pan position from 0 (left) to 1 (right) to two mix volumes, using the equal-power pan law.
+    *
+    *  leftChannel is sent to leftBus with gain * cos(pan * pi / 2) and rightChannel to rightBus with gain * sin(pan * pi / 2).
+    *  Pass the same channel twice for a mono voice. The mix volumes are written right away for the initial pan.
+    */
+    int AddVoicePan(nn::audio::VoiceType* pVoice, nn::audio::FinalMixType* pFinalMix, int leftChannel, int rightChannel,
+                    int leftBus, int rightBus, float gain, float pan) NN_NOEXCEPT;
+
+    //!<  Unbinds the ramp. The parameter keeps its last value.
+    void Remove(int handle) NN_NOEXCEPT;
+
+    /**
+    * @brief  Moves the parameter to target over duration, starting with the next <tt>Update()</tt>.
+    *
+    *  The duration is rounded up to whole audio frames; zero applies the target on the next update.
+    *  Calling this every update with an unchanged target does not restart the ramp.
+    */
+    void SetTarget(int handle, float target, nn::TimeSpan duration, AudioDsp::RampCurve curve) NN_NOEXCEPT;
+
+    float GetValue(int handle) const NN_NOEXCEPT;
+    float GetTarget(int handle) const NN_NOEXCEPT;
+    bool IsRamping(int handle) const NN_NOEXCEPT;
+
+    //!<  Advances every ramp by one audio frame. Call once per update, before nn::audio::RequestUpdateAudioRenderer().
+    void Update() NN_NOEXCEPT;
+
+    //!<  Voice parameter writes since <tt>Initialize()</tt>.
+    int64_t GetWriteCount() const NN_NOEXCEPT { return m_WriteCount; }
+
+private:
+    enum Target
+    {
+        Target_None,
+        Target_VoiceVolume,
+        Target_VoicePitch,
+        Target_VoiceMixVolume,
+        Target_VoicePan
+    };
+
+    struct Entry
+    {
+        AudioDsp::Ramp ramp;
+        Target target;
+        nn::audio::VoiceType* pVoice;
+        nn::audio::FinalMixType* pFinalMix;
+        int sourceChannel[2];       //!<  Left and right for a pan; only [0] is used by a mix volume.
+        int destinationBus[2];
+        float gain;                 //!<  Pan only.
+    };
+
+    int Add(Target target, nn::audio::VoiceType* pVoice, float value) NN_NOEXCEPT;
+
+    //!<  Writes the ramp's current value to its parameter.
+    void Apply(const Entry& entry) NN_NOEXCEPT;
+
+    const Entry& GetEntry(int handle) const NN_NOEXCEPT;
+
+    Entry* m_pEntries;
+    int m_RampCountMax;
+    int m_SampleRate;
+    int m_SampleCount;              //!<  Samples per audio frame.
+    int64_t m_WriteCount;
+};
@@ -51,6 +51,7 @@
 *  <tr><td> [Left][Right]   </td><td> Changes the volume for the SampleBgm0-2ch left channel.  </td></tr>
 *  <tr><td> [Up][Down]      </td><td> Changes the volume for the SampleBgm0-2ch right channel.  </td></tr>
 *  <tr><td> [AnalogStickR]  </td><td> Raises and lowers the pitch of the sine wave.                     </td></tr>
+*  <tr><td> [Select/C]      </td><td> Starts or stops capturing the output to <tt>sd:/AudioRendererCapture.wav</tt>. </td></tr>
 *  <tr><td> [Start/Space]   </td><td> Exits the program.                               </td></tr>
 *  </table>
 *  </p>
@@ -110,10 +111,17 @@
 *  The various settings are applied to actual processing by calling the <tt>nn::audio::RequestUpdateAudioRenderer()</tt>
 *  function after they have been set in the <tt>nn::audio::AudioRendererConfig</tt> structure.
 *
+*  The renderer, the mix graph, and the players belong to <tt>AudioEngine</tt>, which sizes all of its memory from a
+*  description of the graph when it is initialized and allocates nothing afterwards.
 *  Parameter changes, state acquisition, and buffer adding are performed in the main loop.
-*  This sample loops BGM while streaming the sine wave data.
+*  This sample streams the looping BGM from the file with <tt>AudioStreamPlayer</tt>, and <tt>AudioOscillatorPlayer</tt> generates the sine wave
+*  a few milliseconds at a time instead of pre-rendering it.
+*  <tt>AudioStreamPlayer</tt> reads the BGM in fixed-size chunks on a background thread, so only a few small wave buffers stay in memory.
 *  During playback, you can use input from the keyboard and DebugPad for the operations described in the How to Operate section.
 *
+*  The renderer also reports how long it spends on each voice, mix, sink, and effect. <tt>AudioPerformanceMetrics</tt>
+*  collects these times, and every five seconds the sample logs them as one line of JSON.
+*
 *  When a request to exit the program is made, this repeated process is exited and playback stops,
 *  the audio renderer is closed, and the memory is freed.
 */
@@ -131,7 +139,6 @@
 
 #include <nn/audio.h>
 #include <nns/audio/audio_HidUtilities.h>
-#include <nns/audio/audio_WavFormat.h>
 
 #include <nn/hid.h>
 #include <nn/hid/hid_KeyboardKey.h>
@@ -139,6 +146,9 @@
 
 #include <nn/settings/settings_DebugPad.h>
 
+#include "AudioDspBiquad.h"
+#include "AudioEngine.h"
+
 namespace {
 
 // Select the rendering engine sample rate.
@@ -149,6 +159,24 @@ const int RenderCount = (RenderRate / 200);
 // Select the number of files to play.
 const int BgmCount = 1;
 const int SeCount = 4;
+// Voices the sound effects share, fewer than SeCount * SePolyphonyMax; further triggers steal the quietest or oldest one.
+const int SeVoiceCount = 8;
+// Overlapping instances of one sound effect; a further trigger cuts off its oldest instance.
+const int SePolyphonyMax = 3;
+// The BGM voice is budgeted for stereo files.
+const int BgmChannelCountMax = 2;
+// Ramped parameters: the sine volume and the pan of each BGM.
+const int RampCount = 1 + BgmCount;
+// BGM filters, designed for RenderRate at compile time so they keep their cutoff at either rate.
+constexpr AudioDsp::BiquadQ14 BgmLowPassFilter = AudioDsp::ToBiquadQ14(AudioDsp::DesignBiquadConstant(AudioDsp::BiquadType_LowPass, RenderRate, 2048.0, 0.7071));
+constexpr AudioDsp::BiquadQ14 BgmHighPassFilter = AudioDsp::ToBiquadQ14(AudioDsp::DesignBiquadConstant(AudioDsp::BiquadType_HighPass, RenderRate, 1024.0, 0.7071));
+// Audio frames a performance buffer holds. The loop updates once per audio frame; the rest is slack for a late update.
+const int PerformanceFrameCount = 8;
+// Updates between two metrics dumps (five seconds).
+const int MetricsDumpInterval = 1000;
+// Audio frames the capture of the output may fall behind the SD card by (1.28 s at RenderCount).
+const int CaptureFrameCount = 256;
+const char CaptureFileName[] = "sd:/AudioRendererCapture.wav";
 
 const char Title[] = "AudioRenderer";
 
@@ -158,21 +186,24 @@ const char* g_BgmFileNames[BgmCount] =
     "Contents:/AudioRenderer/SampleBgm0-2ch.wav",
 };
 
-const char* g_SeFileNames[SeCount] =
+// The sound effects are packed into one bank; rebuild it with HostAudioTool bank-build after changing the list.
+const char g_SeBankFileName[] = "Contents:/AudioCommon/SampleSe.bank";
+
+const char* g_SeNames[SeCount] =
 {
-    "Contents:/AudioCommon/SampleSe0.adpcm",
-    "Contents:/AudioCommon/SampleSe1.adpcm",
-    "Contents:/AudioCommon/SampleSe2.adpcm",
-    "Contents:/AudioCommon/SampleSe3.adpcm",
+    "SampleSe0",
+    "SampleSe1",
+    "SampleSe2",
+    "SampleSe3",
 };
 
 NN_ALIGNAS(4096) char g_WorkBuffer[8 * 1024 * 1024];
-NN_AUDIO_ALIGNAS_MEMORY_POOL_ALIGN char g_WaveBufferPoolMemory[14 * 1024 * 1024];
 
 nn::mem::StandardAllocator g_Allocator;
-nn::mem::StandardAllocator g_WaveBufferAllocator;
 
 char* g_MountRomCacheBuffer = NULL;
+// The SD card is mounted by the first capture, so a unit without one still runs the sample.
+bool g_IsSdCardMounted = false;
 
 }
 
@@ -187,77 +218,6 @@ void Deallocate(void* p, size_t size)
     g_Allocator.Free(p);
 }
 
-std::size_t GenerateSineWave(void** data, int sampleRate, int frequency, int sampleCount)
-{
-    // The entire memory region managed with g_WaveBufferAllocator is added to the memory pool, waveBufferMemoryPool.
-    int16_t* p = static_cast<int16_t*>(g_WaveBufferAllocator.Allocate(sampleCount * sizeof(int16_t), nn::audio::BufferAlignSize));
-    NN_ABORT_UNLESS_NOT_NULL(p);
-    const float Pi = 3.1415926535897932384626433f;
-    for (auto i = 0; i < sampleCount; ++i)
-    {
-        p[i] = static_cast<int16_t>(std::numeric_limits<int16_t>::max() * sinf(2 * Pi * frequency * i / sampleRate));
-    }
-    *data = p;
-    return sampleCount * sizeof(int16_t);
-}
-
-std::size_t ReadAdpcmFile(nn::audio::AdpcmHeaderInfo* header, void** adpcmData, const char* filename)
-{
-    nn::fs::FileHandle handle;
-    nn::Result result = nn::fs::OpenFile(&handle, filename, nn::fs::OpenMode_Read);
-    NN_ABORT_UNLESS_RESULT_SUCCESS(result);
-
-    int64_t size;
-    uint8_t adpcmheader[nn::audio::AdpcmHeaderSize];
-
-    result = nn::fs::GetFileSize(&size, handle);
-    NN_ABORT_UNLESS_RESULT_SUCCESS(result);
-
-    *adpcmData = g_WaveBufferAllocator.Allocate(static_cast<std::size_t>(size) - sizeof(adpcmheader), nn::audio::BufferAlignSize);
-    NN_ABORT_UNLESS_NOT_NULL(*adpcmData);
-
-    result = nn::fs::ReadFile(handle, 0, adpcmheader, sizeof(adpcmheader));
-    NN_ABORT_UNLESS_RESULT_SUCCESS(result);
-    result = nn::fs::ReadFile(handle, sizeof(adpcmheader), *adpcmData, static_cast<size_t>(size) - sizeof(adpcmheader));
-    NN_ABORT_UNLESS_RESULT_SUCCESS(result);
-    nn::fs::CloseFile(handle);
-
-    nn::audio::ParseAdpcmHeader(header, adpcmheader, sizeof(adpcmheader));
-
-    return static_cast<std::size_t>(size) - sizeof(adpcmheader);
-}
-
-std::size_t ReadWavFile(nns::audio::WavFormat* format, void** data, const char* filename)
-{
-    nn::fs::FileHandle handle;
-    nn::Result result = nn::fs::OpenFile(&handle, filename, nn::fs::OpenMode_Read);
-    NN_ABORT_UNLESS_RESULT_SUCCESS(result);
-
-    int64_t size;
-
-    result = nn::fs::GetFileSize(&size, handle);
-    NN_ABORT_UNLESS_RESULT_SUCCESS(result);
-
-    *data = g_WaveBufferAllocator.Allocate(static_cast<std::size_t>(size), nn::audio::BufferAlignSize);
-    NN_ABORT_UNLESS_NOT_NULL(*data);
-
-    // The DATA chunk must be read, but this sample assumes that it is found to be 1024 bits or less.
-    const std::size_t WavHeaderDataSize = 1024;
-
-    result = nn::fs::ReadFile(handle, 0, *data, WavHeaderDataSize);
-    NN_ABORT_UNLESS_RESULT_SUCCESS(result);
-
-    nns::audio::WavResult wavResult = nns::audio::ParseWavFormat(format, *data, WavHeaderDataSize);
-    NN_ABORT_UNLESS_EQUAL(wavResult, nns::audio::WavResult_Success);
-    NN_ABORT_UNLESS_EQUAL(format->bitsPerSample, 16);  // This sample assumes 16-bit PCM.
-
-    result = nn::fs::ReadFile(handle, static_cast<std::size_t>(format->dataOffset), *data, static_cast<std::size_t>(format->dataSize));
-    NN_ABORT_UNLESS_RESULT_SUCCESS(result);
-    nn::fs::CloseFile(handle);
-
-    return static_cast<std::size_t>(format->dataSize);
-}
-
 void InitializeFileSystem()
 {
     nn::fs::SetAllocator(Allocate, Deallocate);
@@ -274,6 +234,11 @@ void InitializeFileSystem()
 
 void FinalizeFileSystem()
 {
+    if (g_IsSdCardMounted)
+    {
+        nn::fs::Unmount("sd");
+        g_IsSdCardMounted = false;
+    }
     nn::fs::Unmount("Contents");
 
     delete[] g_MountRomCacheBuffer;
@@ -304,6 +269,7 @@ void InitializeHidDevices()
     map.buttonUp    = nn::hid::KeyboardKey::UpArrow::Index;
     map.buttonDown  = nn::hid::KeyboardKey::DownArrow::Index;
     map.buttonStart = nn::hid::KeyboardKey::Space::Index;
+    map.buttonSelect = nn::hid::KeyboardKey::C::Index;
     nn::settings::SetDebugPadKeyboardMap(map);
 }
 
@@ -324,6 +290,7 @@ void PrintUsage()
     NNS_LOG("[Up][Down]      ControlPitch                 (SineWave)\n");
     NNS_LOG("[ZLeft/U]       PanVolume (Left)             (SampleBgm0-2ch)\n");
     NNS_LOG("[ZRight/V]      PanVolume (Right)            (SampleBgm0-2ch)\n");
+    NNS_LOG("[Select/C]      Start/stop capture           (sd:/AudioRendererCapture.wav)\n");
     NNS_LOG("[Start/Space]   Shut down sample program\n");
     NNS_LOG("-------------------------------------------------------\n");
 }
@@ -331,219 +298,162 @@ void PrintUsage()
 extern "C" void nnMain_Sound()
 {
     g_Allocator.Initialize(g_WorkBuffer, sizeof(g_WorkBuffer));
-    g_WaveBufferAllocator.Initialize(g_WaveBufferPoolMemory, sizeof(g_WaveBufferPoolMemory));
 
     InitializeFileSystem();
     InitializeHidDevices();
 
-    // Specify a renderer parameter.
-    nn::audio::AudioRendererParameter parameter;
-    nn::audio::InitializeAudioRendererParameter(&parameter);
-    parameter.sampleRate = RenderRate;
-    parameter.sampleCount = RenderCount;
-    parameter.mixBufferCount = 6 + 2; // FinalMix(6) + SubMix(2)
-    parameter.voiceCount = 24;
-    parameter.subMixCount = 2;
-    parameter.sinkCount = 1;
-    parameter.effectCount = 2;
-    parameter.performanceFrameCount = 0;
+    // Describe the mix graph. The engine derives the renderer parameter and the size of its arenas from it.
+    AudioEngineGraph graph;
+    InitializeAudioEngineGraph(&graph);
+    graph.sampleRate = RenderRate;
+    graph.sampleCount = RenderCount;
 
     // Define the relationship between the mix buffer and audio bus.
-    int channelCount = 2;
-    int8_t mainBus[2];
-    mainBus[nn::audio::ChannelMapping_FrontLeft] = 4;
-    mainBus[nn::audio::ChannelMapping_FrontRight] = 5;
-    int8_t auxBusA[2];
-    auxBusA[nn::audio::ChannelMapping_FrontLeft] = 0;
-    auxBusA[nn::audio::ChannelMapping_FrontRight] = 1;
-
-    // Check whether the parameter is supported by the system.
-    NN_ABORT_UNLESS(
-        nn::audio::IsValidAudioRendererParameter(parameter),
-        "Invalid AudioRendererParameter specified."
-    );
-
-    // Prepare a renderer work buffer.
-    size_t workBufferSize = nn::audio::GetAudioRendererWorkBufferSize(parameter);
-    void* workBuffer = g_Allocator.Allocate(workBufferSize, nn::os::MemoryPageSize);
-    NN_ABORT_UNLESS_NOT_NULL(workBuffer);
-
-    nn::os::SystemEvent systemEvent;
-
-    // Initialize the renderer.
-    nn::audio::AudioRendererHandle handle;
-    NN_ABORT_UNLESS(
-        nn::audio::OpenAudioRenderer(&handle, &systemEvent, parameter, workBuffer, workBufferSize).IsSuccess(),
-        "Failed to open AudioRenderer"
-    );
-
-    // Initialize AudioRendererConfig.
-    size_t configBufferSize = nn::audio::GetAudioRendererConfigWorkBufferSize(parameter);
-    void* configBuffer = g_Allocator.Allocate(configBufferSize, nn::os::MemoryPageSize);
-    NN_ABORT_UNLESS_NOT_NULL(configBuffer);
-    nn::audio::AudioRendererConfig config;
-    nn::audio::InitializeAudioRendererConfig(&config, parameter, configBuffer, configBufferSize);
-
-    nn::audio::FinalMixType finalMix;
-    nn::audio::AcquireFinalMix(&config, &finalMix, 6);
-
-    nn::audio::SubMixType subMix0;
-    nn::audio::AcquireSubMix(&config, &subMix0, parameter.sampleRate, 1);
-    nn::audio::SubMixType subMix1;
-    nn::audio::AcquireSubMix(&config, &subMix1, parameter.sampleRate, 1);
-
-    // Specify the renderer output destination.
-    nn::audio::DeviceSinkType deviceSink;
-    // Configure the input for the audio output device.
-    // The output channel is set in conjunction with the mix buffer index specified for mainBus.
-    // mainBus[nn::audio::ChannelMapping_FrontLeft] is output to the left channel and
-    // mainBus[nn::audio::ChannelMapping_FrontRight] is output to the right channel.
-    nn::Result result = nn::audio::AddDeviceSink(&config, &deviceSink, &finalMix, mainBus, channelCount, "MainAudioOut");
-    NN_ABORT_UNLESS_RESULT_SUCCESS(result);
-
-    // Connect SubMix(0) to FinalMix.
-    nn::audio::SetSubMixDestination(&config, &subMix0, &finalMix);
-
-    // Configure so that you send the 0th buffer of SubMix(0) to mainBus[0]
-    // and mainBus[1] of FinalMix, using a volume of 0.5f for the mix.
-    nn::audio::SetSubMixMixVolume(&subMix0, &finalMix, 0.5f, 0, mainBus[0]);
-    nn::audio::SetSubMixMixVolume(&subMix0, &finalMix, 0.5f, 0, mainBus[1]);
-
-    // Connect SubMix(1) to SubMix(0).
-    nn::audio::SetSubMixDestination(&config, &subMix1, &subMix0);
-
-    // Configure so that you send the 0th buffer of SubMix(1) to the 0th buffer of SubMix(0)
-    // and mainBus[1] of FinalMix, using a volume of 0.5f for the mix.
-    nn::audio::SetSubMixMixVolume(&subMix1, &subMix0, 0.5f, 0, 0);
-
-    // Prepare and register BufferMixer.
-    nn::audio::BufferMixerType mixer1;
-    result = nn::audio::AddBufferMixer(&config, &mixer1, &finalMix);
-    NN_ABORT_UNLESS_RESULT_SUCCESS(result);
-    nn::audio::SetBufferMixerInputOutput(&mixer1, auxBusA, mainBus, channelCount);
-
-    // Set buffer mixer parameters.
-    nn::audio::SetBufferMixerVolume(&mixer1, 0, 1.0f);
-    nn::audio::SetBufferMixerVolume(&mixer1, 1, 1.0f);
-
-    // The specified parameters are applied in the renderer.
-    result = nn::audio::RequestUpdateAudioRenderer(handle, &config);
-    NN_ABORT_UNLESS_RESULT_SUCCESS(result);
-
-    // Start rendering.
-    result = nn::audio::StartAudioRenderer(handle);
-    NN_ABORT_UNLESS_RESULT_SUCCESS(result);
-
-    // Prepare Voice.
-    nn::audio::VoiceType voiceSine;
-    nn::audio::WaveBuffer waveBufferSine;
-    void* dataSine;
-
-    // Prepare a memory pool to maintain the sample data added to WaveBuffer.
-    nn::audio::MemoryPoolType waveBufferMemoryPool;
-    auto ret = AcquireMemoryPool(&config, &waveBufferMemoryPool, g_WaveBufferPoolMemory, sizeof(g_WaveBufferPoolMemory));
-    NN_ABORT_UNLESS(ret);
-    ret = RequestAttachMemoryPool(&waveBufferMemoryPool);
-    NN_ABORT_UNLESS(ret);
-
-    // Prepare the waveform to play with Voice.
+    // mainBus is output to the audio output device: mainBus[nn::audio::ChannelMapping_FrontLeft] to the left channel and
+    // mainBus[nn::audio::ChannelMapping_FrontRight] to the right channel. A BufferMixer adds auxBus to mainBus.
+    graph.finalMixBufferCount = 6;
+    graph.channelCount = 2;
+    graph.mainBus[nn::audio::ChannelMapping_FrontLeft] = 4;
+    graph.mainBus[nn::audio::ChannelMapping_FrontRight] = 5;
+    graph.isAuxBusEnabled = true;
+    graph.auxBus[nn::audio::ChannelMapping_FrontLeft] = 0;
+    graph.auxBus[nn::audio::ChannelMapping_FrontRight] = 1;
+
+    // SubMix(0) sends its buffer to both channels of mainBus, and SubMix(1) sends its buffer to SubMix(0), each with a volume of 0.5f.
+    graph.subMixCount = 2;
+    graph.subMixes[0].bufferCount = 1;
+    graph.subMixes[0].destination = AudioEngine::Destination_MainBus;
+    graph.subMixes[0].volume = 0.5f;
+    graph.subMixes[1].bufferCount = 1;
+    graph.subMixes[1].destination = 0;
+    graph.subMixes[1].volume = 0.5f;
+
+    // BGM streams, the sine wave oscillator on SubMix(1), and the voice pool and bank of the sound effects.
+    graph.streamCountMax = BgmCount;
+    graph.streamChannelCountMax = BgmChannelCountMax;
+    graph.oscillatorCountMax = 1;
+    graph.oscillatorDestination = 1;
+    graph.oscillatorVolume = 0.707f / 2;
+    // The bank memory, sound effects, and voice pool are sized from the bank and the polyphony of each sound effect.
+    const char* seBankFileNames[] = { g_SeBankFileName };
+    AudioDsp::BudgetSound seBudgetSounds[SeCount];
+    for (int i = 0; i < SeCount; ++i)
     {
-        const int sineSampleRate = 32000;
-        const int sineFrequency = 440;
-        const int sineSampleCount = 32000;
-        std::size_t size = GenerateSineWave(&dataSine, sineSampleRate, sineFrequency, sineSampleCount);
-
-        nn::audio::AcquireVoiceSlot(&config, &voiceSine, sineSampleRate, 1, nn::audio::SampleFormat_PcmInt16, nn::audio::VoiceType::PriorityHighest, nullptr, 0);
-        nn::audio::SetVoiceDestination(&config, &voiceSine, &subMix1);
-
-        waveBufferSine.buffer = dataSine;
-        waveBufferSine.size = size;
-        waveBufferSine.startSampleOffset = 0;
-        waveBufferSine.endSampleOffset = sineSampleCount;
-        waveBufferSine.loop = 0;
-        waveBufferSine.isEndOfStream = false;
-
-        // Add the waveform to Voice.
-        nn::audio::AppendWaveBuffer(&voiceSine, &waveBufferSine);
-        nn::audio::AppendWaveBuffer(&voiceSine, &waveBufferSine);
-        nn::audio::AppendWaveBuffer(&voiceSine, &waveBufferSine);
-        nn::audio::AppendWaveBuffer(&voiceSine, &waveBufferSine);
-        nn::audio::SetVoicePlayState(&voiceSine, nn::audio::VoiceType::PlayState_Play);
-        nn::audio::SetVoiceMixVolume(&voiceSine, &subMix1, 0.707f / 2, 0, 0);
+        seBudgetSounds[i].bank = 0;
+        seBudgetSounds[i].name = g_SeNames[i];
+        seBudgetSounds[i].polyphonyMax = SePolyphonyMax;
     }
+    AudioEngineManifest manifest;
+    manifest.bankFileNames = seBankFileNames;
+    manifest.bankCount = 1;
+    manifest.soundEffects = seBudgetSounds;
+    manifest.soundEffectCount = SeCount;
+    manifest.voiceCountMax = SeVoiceCount;
+    ApplyAudioEngineManifest(&graph, manifest);
+    graph.rampCountMax = RampCount;
+    graph.performanceFrameCount = PerformanceFrameCount;
+
+    // Meter mainBus, auxBus, and both sub mixes. The taps on mainBus and auxBus write their return to buffers 2 and 3,
+    // which nothing else uses, and each sub mix gets a second buffer for the return of its tap.
+    graph.isMeteringEnabled = true;
+    graph.meterBus[nn::audio::ChannelMapping_FrontLeft] = 2;
+    graph.meterBus[nn::audio::ChannelMapping_FrontRight] = 3;
+
+    // The mainBus tap also feeds the capture, which may fall up to CaptureFrameCount audio frames behind.
+    graph.captureFrameCount = CaptureFrameCount;
+
+    // Allocate both arenas of the engine once. Nothing is allocated for audio after this.
+    size_t audioWorkBufferSize = AudioEngine::GetRequiredWorkBufferSize(graph);
+    void* audioWorkBuffer = g_Allocator.Allocate(audioWorkBufferSize, nn::os::MemoryPageSize);
+    NN_ABORT_UNLESS_NOT_NULL(audioWorkBuffer);
+    size_t audioPoolBufferSize = AudioEngine::GetRequiredPoolBufferSize(graph);
+    void* audioPoolBuffer = g_Allocator.Allocate(audioPoolBufferSize, nn::audio::MemoryPoolType::AddressAlignment);
+    NN_ABORT_UNLESS_NOT_NULL(audioPoolBuffer);
+    // g_WorkBuffer also holds the ROM cache, so what is left here is what it could shrink by.
+    NNS_LOG("Heap: %zu work and %zu pool bytes for audio, %zu of %zu bytes free\n",
+            audioWorkBufferSize, audioPoolBufferSize, g_Allocator.GetTotalFreeSize(), sizeof(g_WorkBuffer));
+
+    // Open the renderer, build the graph, start rendering, and attach the pool buffer as a memory pool.
+    AudioEngine engine;
+    engine.Initialize(graph, audioWorkBuffer, audioWorkBufferSize, audioPoolBuffer, audioPoolBufferSize);
+    AudioPerformanceMetrics* pPerformanceMetrics = engine.GetPerformanceMetrics();
+
+    // Sine wave
+    // The tone is generated on demand by an oscillator bank, so only AudioOscillatorPlayer::GetRequiredBufferSize() bytes are used.
+    const float sineFrequency = 440.0f;
+    float sinePitch = 1.0f;
+    nn::audio::VoiceType* voiceSine = engine.GetOscillatorVoice();
+    pPerformanceMetrics->SetLabel(voiceSine, "sine");
+    const int sineOscillator = engine.GetOscillatorBank()->Add(AudioDsp::Waveform_Sine, sineFrequency, 1.0f);
+    NN_ABORT_UNLESS(sineOscillator != AudioDsp::OscillatorBank::InvalidHandle);
 
     // Background music
-    nn::audio::VoiceType voiceBgm[BgmCount];
-    nn::audio::WaveBuffer waveBufferBgm;
-    void* dataBgm[BgmCount];
+    // The BGM is streamed, so only AudioStreamPlayer::GetRequiredBufferSize() bytes of each track are resident at a time.
+    int bgm[BgmCount];
+    nn::audio::VoiceType* voiceBgm[BgmCount];
 
     for (int i = 0; i < BgmCount; ++i)
     {
-        nns::audio::WavFormat format;
-        std::size_t dataSize = ReadWavFile(&format, &dataBgm[i], g_BgmFileNames[i]);
-
-        // Specify the number of channels and get the voices for the loaded WAV file.
-        // Note that if multiple channels of data are loaded, a number of voices commensurate with the number of channels is used.
-        nn::audio::AcquireVoiceSlot(&config, &voiceBgm[i], format.sampleRate, format.channelCount, nn::audio::SampleFormat_PcmInt16, nn::audio::VoiceType::PriorityHighest, nullptr, 0);
-        nn::audio::SetVoiceDestination(&config, &voiceBgm[i], &finalMix);
-
-        waveBufferBgm.buffer = dataBgm[i];
-        waveBufferBgm.size = dataSize;
-        waveBufferBgm.startSampleOffset = 0;
-        waveBufferBgm.endSampleOffset = static_cast<int32_t>(dataSize / sizeof(int16_t)) / format.channelCount;
-        waveBufferBgm.loop = true;
-        waveBufferBgm.isEndOfStream = false;
-        waveBufferBgm.pContext = nullptr;
-        waveBufferBgm.contextSize = 0;
-
-        nn::audio::AppendWaveBuffer(&voiceBgm[i], &waveBufferBgm);
-        nn::audio::SetVoicePlayState(&voiceBgm[i], nn::audio::VoiceType::PlayState_Play);
-        // Set the mix volume, sending the voice's channel 0 to mainBus[0] and channel 1 to mainBus[1].
-        nn::audio::SetVoiceMixVolume(&voiceBgm[i], &finalMix, 0.5f, 0, mainBus[0]);
-        nn::audio::SetVoiceMixVolume(&voiceBgm[i], &finalMix, 0.5f, 1, mainBus[1]);
+        // The channel count and sample rate come from the file header.
+        // Channel 0 of the voice is sent to mainBus[0] and channel 1 to mainBus[1], with a volume of 0.5f.
+        bgm[i] = engine.AddStream(g_BgmFileNames[i], true, AudioEngine::Destination_MainBus, 0.5f);
+        voiceBgm[i] = engine.GetStreamVoice(bgm[i]);
+        pPerformanceMetrics->SetLabel(voiceBgm[i], "bgm");
 
         // Set a 2048 Hz cutoff low-pass filter.
-        nn::audio::BiquadFilterParameter firstFilter = { true, {720, 1439, 720}, {22684, -9350} };
-        nn::audio::SetVoiceBiquadFilterParameter(&voiceBgm[i], 0, firstFilter);
+        nn::audio::BiquadFilterParameter firstFilter = AudioDsp::ToBiquadFilterParameter<nn::audio::BiquadFilterParameter>(BgmLowPassFilter, true);
+        nn::audio::SetVoiceBiquadFilterParameter(voiceBgm[i], 0, firstFilter);
         // Set a high-pass filter with a cutoff frequency of 1024 Hz, but leave it disabled for now.
-        nn::audio::BiquadFilterParameter secondFilter = { false, {14041, -28083, 14041}, {29547, -13563} };
-        nn::audio::SetVoiceBiquadFilterParameter(&voiceBgm[i], 1, secondFilter);
+        nn::audio::BiquadFilterParameter secondFilter = AudioDsp::ToBiquadFilterParameter<nn::audio::BiquadFilterParameter>(BgmHighPassFilter, false);
+        nn::audio::SetVoiceBiquadFilterParameter(voiceBgm[i], 1, secondFilter);
     }
 
     // Sound effects
-    nn::audio::VoiceType voiceSe[SeCount];
-    nn::audio::WaveBuffer waveBufferSe[SeCount];
-    nn::audio::AdpcmHeaderInfo* header[SeCount];
-    void* dataSe[SeCount];
+    // Voices come from the engine's pool, so a sound effect only holds a voice while it plays.
+    // Every instance of a sound effect shares its ADPCM data and header. The data is played from the bank in place.
+    AudioSoundEffectConfig seConfig;
+    InitializeAudioSoundEffectConfig(&seConfig);
+    seConfig.polyphonyMax = SePolyphonyMax;
+    seConfig.retriggerPolicy = AudioRetriggerPolicy_StealOldest;
+
+    const int seBank = engine.LoadBank(g_SeBankFileName);
+    int se[SeCount];
+    for (int i = 0; i < SeCount; ++i)
+    {
+        se[i] = engine.AddSoundEffect(seBank, g_SeNames[i], seConfig, AudioEngine::Destination_AuxBus, 0.707f / 2);
+    }
+
+    // How much of the sample memory the streams and the bank took.
+    AudioDsp::WavePoolStatistics poolStatistics;
+    engine.GetWavePoolStatistics(&poolStatistics);
+    NNS_LOG("Wave pool: %d of %d stream buffers, %zu of %zu bank bytes\n",
+            poolStatistics.slabs[0].usedCount, poolStatistics.slabs[0].blockCount, poolStatistics.longLivedUsedSize, poolStatistics.longLivedSize);
 
+    // Play each sound effect once, and start the sine wave and the BGM with them.
     for (int i = 0; i < SeCount; ++i)
     {
-        header[i] = reinterpret_cast<nn::audio::AdpcmHeaderInfo*>(g_WaveBufferAllocator.Allocate(sizeof(nn::audio::AdpcmHeaderInfo), NN_ALIGNOF(nn::audio::AdpcmHeaderInfo)));
-        std::size_t dataSeSize = ReadAdpcmFile(header[i], &dataSe[i], g_SeFileNames[i]);
-        nn::audio::AcquireVoiceSlot(&config, &voiceSe[i], header[i]->sampleRate, 1, nn::audio::SampleFormat_Adpcm, nn::audio::VoiceType::PriorityHighest, &header[i]->parameter, sizeof(nn::audio::AdpcmParameter));
-        nn::audio::SetVoiceDestination(&config, &voiceSe[i], &finalMix);
-
-        waveBufferSe[i].buffer = dataSe[i];
-        waveBufferSe[i].size = dataSeSize;
-        waveBufferSe[i].startSampleOffset = 0;
-        waveBufferSe[i].endSampleOffset = header[i]->sampleCount;
-        waveBufferSe[i].loop = false;
-        waveBufferSe[i].isEndOfStream = false;
-        waveBufferSe[i].pContext = &header[i]->loopContext;
-        waveBufferSe[i].contextSize = sizeof(nn::audio::AdpcmContext);
-
-        nn::audio::AppendWaveBuffer(&voiceSe[i], &waveBufferSe[i]);
-        nn::audio::SetVoicePlayState(&voiceSe[i], nn::audio::VoiceType::PlayState_Play);
-        nn::audio::SetVoiceMixVolume(&voiceSe[i], &finalMix, 0.707f / 2, 0, auxBusA[0]);
-        nn::audio::SetVoiceMixVolume(&voiceSe[i], &finalMix, 0.707f / 2, 0, auxBusA[1]);
+        engine.PlaySoundEffect(se[i]);
+    }
+    engine.Start();
+
+    // Parameter ramps
+    // Input only moves the targets; the ramp engine glides each parameter there and writes it only while it moves.
+    const nn::TimeSpan inputRampTime = nn::TimeSpan::FromMilliSeconds(20);
+    AudioRampEngine* pRampEngine = engine.GetRampEngine();
+    const int sineVolumeRamp = pRampEngine->AddVoiceVolume(voiceSine);
+    int bgmPanRamp[BgmCount];
+    for (int i = 0; i < BgmCount; ++i)
+    {
+        // Centered, a gain of 0.707f keeps the 0.5f mix volume set above on both channels.
+        bgmPanRamp[i] = pRampEngine->AddVoicePan(voiceBgm[i], engine.GetFinalMix(), 0, 1, engine.GetMainBus()[0], engine.GetMainBus()[1], 0.707f, 0.5f);
     }
 
     PrintUsage();
 
     // Wait for the waveform playback to finish and update the parameters.
-    for (;;)
+    for (int updateCount = 1; ; ++updateCount)
     {
-        systemEvent.Wait();
+        engine.WaitForFrame();
 
         nn::hid::NpadButtonSet npadButtonCurrent = {};
         nn::hid::NpadButtonSet npadButtonDown = {};
@@ -596,21 +506,18 @@ extern "C" void nnMain_Sound()
             nns::audio::ConvertDebugPadButtonsToNpadButtons(&npadButtonDown, debugPadButtonDown);
         }
 
-        //Play sound effects. (The same SE is not overlaid.)
+        //Play sound effects. Each press starts a new instance; past SePolyphonyMax the oldest instance of that SE is cut off.
         for (int i = 0; i < SeCount; ++i)
         {
             // SE numbers {0, 1, 2, 3, 4, 5} correspond to buttons {A, B, X, Y, L, R}.
             if(npadButtonDown.Test(i))
             {
-                if (nn::audio::GetReleasedWaveBuffer(&voiceSe[i]))
-                {
-                    nn::audio::AppendWaveBuffer(&voiceSe[i], &waveBufferSe[i]);
-                }
+                engine.PlaySoundEffect(se[i]);
             }
         }
 
         //Manipulate the volume of the sine wave.
-        float sineVolume = nn::audio::GetVoiceVolume(&voiceSine) + 0.01f * analogStickStateL.x / (::nn::hid::AnalogStickMax + 1);
+        float sineVolume = pRampEngine->GetTarget(sineVolumeRamp) + 0.01f * analogStickStateL.x / (::nn::hid::AnalogStickMax + 1);
 
         if(npadButtonCurrent.Test< ::nn::hid::NpadButton::Right >())
         {
@@ -623,9 +530,10 @@ extern "C" void nnMain_Sound()
 
         // For the Voice object's volume and mix volume, you can set any value between nn::audio::VoiceType::GetVolumeMin() and nn::audio::VoiceType::GetVolumeMax().
         // To be polite about noise, the ranges in this sample program have been limited to (0.0f, 2.0f) or (0.0f, 1.0f).
+        // Volume steps are ramped in equal dB steps, which sounds even across the range.
         if (sineVolume < 2.0f && sineVolume > 0.0f)
         {
-            nn::audio::SetVoiceVolume(&voiceSine, sineVolume);
+            pRampEngine->SetTarget(sineVolumeRamp, sineVolume, inputRampTime, AudioDsp::RampCurve_Exponential);
         }
 
         for (int i = 0; i < BgmCount; ++i)
@@ -633,74 +541,82 @@ extern "C" void nnMain_Sound()
             if(npadButtonDown.Test< ::nn::hid::NpadButton::L >())
             {
                 // Enable or disable the second biquad filter setting.
-                nn::audio::BiquadFilterParameter biquadFilterParameter(nn::audio::GetVoiceBiquadFilterParameter(&voiceBgm[i], 1));
+                nn::audio::BiquadFilterParameter biquadFilterParameter(nn::audio::GetVoiceBiquadFilterParameter(voiceBgm[i], 1));
                 biquadFilterParameter.enable = !biquadFilterParameter.enable;
-                nn::audio::SetVoiceBiquadFilterParameter(&voiceBgm[i], 1, biquadFilterParameter);
+                nn::audio::SetVoiceBiquadFilterParameter(voiceBgm[i], 1, biquadFilterParameter);
             }
 
             if(npadButtonDown.Test< ::nn::hid::NpadButton::R >())
             {
-                // Enable or disable BGM.
-                switch (nn::audio::GetVoicePlayState(&voiceBgm[i]))
-                {
-                case nn::audio::VoiceType::PlayState_Play:
-                    nn::audio::SetVoicePlayState(&voiceBgm[i], nn::audio::VoiceType::PlayState_Pause);
-                    break;
-                case nn::audio::VoiceType::PlayState_Pause:
-                case nn::audio::VoiceType::PlayState_Stop:
-                    nn::audio::SetVoicePlayState(&voiceBgm[i], nn::audio::VoiceType::PlayState_Play);
-                    break;
-                default:
-                    NN_ABORT("Unexpected play state\n");
-                    break;
-                }
+                // Pause or resume the BGM.
+                engine.SetStreamPaused(bgm[i], !engine.IsStreamPaused(bgm[i]));
             }
 
-            // Left channel.
-            float bgmLeftVolume = nn::audio::GetVoiceMixVolume(&voiceBgm[i], &finalMix, 0, mainBus[0]);
+            // Pan between the left and right channels. The equal-power law keeps the loudness steady across the pan.
+            float bgmPan = pRampEngine->GetTarget(bgmPanRamp[i]);
             if(npadButtonCurrent.Test< ::nn::hid::NpadButton::ZL >())
             {
-                bgmLeftVolume += 0.01f;
+                bgmPan -= 0.01f;
             }
 
             if(npadButtonCurrent.Test< ::nn::hid::NpadButton::ZR >())
             {
-                bgmLeftVolume -= 0.01f;
-            }
-
-            if (bgmLeftVolume < 1.0f && bgmLeftVolume > 0.0f)
-            {
-                nn::audio::SetVoiceMixVolume(&voiceBgm[i], &finalMix, bgmLeftVolume, 0, mainBus[0]);
+                bgmPan += 0.01f;
             }
 
-            // Right channel.
-            float bgmRightVolume = 1.0f - bgmLeftVolume;
-
-            if (bgmRightVolume < 1.0f && bgmRightVolume > 0.0f)
+            if (bgmPan <= 1.0f && bgmPan >= 0.0f)
             {
-                nn::audio::SetVoiceMixVolume(&voiceBgm[i], &finalMix, bgmRightVolume, 1, mainBus[1]);
+                pRampEngine->SetTarget(bgmPanRamp[i], bgmPan, inputRampTime, AudioDsp::RampCurve_Linear);
             }
         }
 
         //Manipulate the pitch of the sine wave.
-        float sinePitch = nn::audio::GetVoicePitch(&voiceSine) + 0.01f * analogStickStateR.x / (::nn::hid::AnalogStickMax + 1);
+        // The oscillator changes frequency itself, so the voice keeps playing at its native rate and the change is ramped without a click.
+        float newSinePitch = sinePitch + 0.01f * analogStickStateR.x / (::nn::hid::AnalogStickMax + 1);
         if(npadButtonCurrent.Test< ::nn::hid::NpadButton::Up >())
         {
-            sinePitch += 0.01f;
+            newSinePitch += 0.01f;
         }
         if(npadButtonCurrent.Test< ::nn::hid::NpadButton::Down >())
         {
-            sinePitch -= 0.01f;
+            newSinePitch -= 0.01f;
         }
 
-        if (sinePitch < nn::audio::VoiceType::GetPitchMax() && sinePitch > nn::audio::VoiceType::GetPitchMin())
+        if (newSinePitch < nn::audio::VoiceType::GetPitchMax() && newSinePitch > nn::audio::VoiceType::GetPitchMin())
         {
-            nn::audio::SetVoicePitch(&voiceSine, sinePitch);
+            sinePitch = newSinePitch;
+            engine.GetOscillatorBank()->SetFrequency(sineOscillator, sineFrequency * sinePitch);
         }
 
-        if (const nn::audio::WaveBuffer* pWaveBuffer = nn::audio::GetReleasedWaveBuffer(&voiceSine))
+        // Start or stop capturing the output. Creating and finishing the file blocks this loop for a moment;
+        // while capturing, the frames only pass through a ring to the writer thread.
+        if(npadButtonDown.Test< ::nn::hid::NpadButton::Minus >())
         {
-            nn::audio::AppendWaveBuffer(&voiceSine, pWaveBuffer);
+            const AudioCaptureWriter& captureWriter = engine.GetCaptureWriter();
+            if (captureWriter.IsCapturing())
+            {
+                engine.StopCapture();
+                NNS_LOG("Captured %lld frames to %s, %u dropped, at most %d of %d waiting\n",
+                        static_cast<long long>(captureWriter.GetWrittenFrameCount()), CaptureFileName, captureWriter.GetDroppedFrameCount(),
+                        captureWriter.GetPeakFrameCount(), CaptureFrameCount);
+            }
+            else
+            {
+                // The capture of the output is written to the SD card.
+                if (!g_IsSdCardMounted)
+                {
+                    const nn::Result result = nn::fs::MountSdCardForDebug("sd");
+                    g_IsSdCardMounted = result.IsSuccess();
+                    if (!g_IsSdCardMounted)
+                    {
+                        NNS_LOG("Cannot mount the SD card (module %d, description %d); not capturing\n", result.GetModule(), result.GetDescription());
+                    }
+                }
+                if (g_IsSdCardMounted && !engine.StartCapture(CaptureFileName))
+                {
+                    NNS_LOG("Cannot create %s; not capturing\n", CaptureFileName);
+                }
+            }
         }
 
         if(npadButtonDown.Test< ::nn::hid::NpadButton::Plus >())
@@ -708,50 +624,27 @@ extern "C" void nnMain_Sound()
             break;
         }
 
-        result = nn::audio::RequestUpdateAudioRenderer(handle, &config);
-        NN_ABORT_UNLESS_RESULT_SUCCESS(result);
+        // Refill the BGM and sine wave buffers, return the voices of finished sound effects to the pool,
+        // move the ramping parameters one audio frame, collect the times of the frames rendered since the last update,
+        // and meter the buses.
+        engine.Update();
+        if (updateCount % MetricsDumpInterval == 0)
+        {
+            pPerformanceMetrics->Dump();
+            engine.DumpMeters();
+            engine.DumpBudget();
+        }
 
+        engine.RequestUpdate();
     }
 
-    // End rendering.
-    nn::audio::StopAudioRenderer(handle);
-    nn::audio::CloseAudioRenderer(handle);
-    nn::os::DestroySystemEvent(systemEvent.GetBase());
+    // Stop the BGM reader threads and every voice, detach the memory pool, and close the renderer.
+    engine.DumpBudget();
+    engine.Finalize();
 
     // Free memory.
-    if (dataSine)
-    {
-        g_WaveBufferAllocator.Free(dataSine);
-        dataSine = nullptr;
-    }
-    for (int i = 0; i < BgmCount; ++i)
-    {
-        if (dataBgm[i])
-        {
-            g_WaveBufferAllocator.Free(dataBgm[i]);
-            dataBgm[i] = nullptr;
-        }
-    }
-    for (int i = 0; i < SeCount; ++i)
-    {
-        if (dataSe[i])
-        {
-            g_WaveBufferAllocator.Free(dataSe[i]);
-            dataSe[i] = nullptr;
-            g_WaveBufferAllocator.Free(header[i]);
-            header[i] = nullptr;
-        }
-    }
-    if (configBuffer)
-    {
-        g_Allocator.Free(configBuffer);
-        configBuffer = nullptr;
-    }
-    if (workBuffer)
-    {
-        g_Allocator.Free(workBuffer);
-        workBuffer = nullptr;
-    }
+    g_Allocator.Free(audioPoolBuffer);
+    g_Allocator.Free(audioWorkBuffer);
 
     FinalizeFileSystem();
 }  // NOLINT(readability/fn_size)
@@ -0,0 +1,331 @@
+#include <algorithm>
+#include <cstring>
+
+#include <nn/nn_Abort.h>
+
+#include "AudioDspAdpcm.h"
+#include "AudioSoundEffect.h"
+
+namespace {
+
+// Samples decoded at a time while taking seek points or seeking.
+const int SeekChunkSampleCount = AudioDsp::AdpcmFrameSampleCount * 16;
+
+// Advances context by sampleCount samples from startSampleOffset, decoding into a scratch block.
+void SkipAdpcm(nn::audio::AdpcmContext* pContext, const void* data, std::size_t dataSize, int startSampleOffset, int sampleCount,
+               const nn::audio::AdpcmParameter& parameter)
+{
+    NN_STATIC_ASSERT(sizeof(nn::audio::AdpcmParameter) == sizeof(AudioDsp::AdpcmParameter));
+    NN_STATIC_ASSERT(sizeof(nn::audio::AdpcmContext) == sizeof(AudioDsp::AdpcmContext));
+
+    AudioDsp::AdpcmParameter dspParameter;
+    AudioDsp::AdpcmContext dspContext;
+    std::memcpy(&dspParameter, &parameter, sizeof(dspParameter));
+    std::memcpy(&dspContext, pContext, sizeof(dspContext));
+    int16_t scratch[SeekChunkSampleCount];
+    for (int done = 0; done < sampleCount; done += SeekChunkSampleCount)
+    {
+        const int count = std::min(sampleCount - done, SeekChunkSampleCount);
+        AudioDsp::DecodeAdpcm(scratch, data, dataSize, startSampleOffset + done, count, dspParameter, &dspContext);
+    }
+    std::memcpy(pContext, &dspContext, sizeof(*pContext));
+}
+
+}
+
+void InitializeAudioSoundEffectConfig(AudioSoundEffectConfig* pOutConfig) NN_NOEXCEPT
+{
+    pOutConfig->polyphonyMax = 4;
+    pOutConfig->retriggerPolicy = AudioRetriggerPolicy_StealOldest;
+    pOutConfig->priority = nn::audio::VoiceType::PriorityHighest;
+    pOutConfig->volume = 1.0f;
+    pOutConfig->isVirtualizable = false;
+}
+
+AudioSoundEffect::AudioSoundEffect() NN_NOEXCEPT
+    : m_pVoiceManager(nullptr)
+    , m_pHeader(nullptr)
+    , m_pData(nullptr)
+    , m_DataSize(0)
+    , m_pSilence(nullptr)
+    , m_SilenceSize(0)
+    , m_SilenceSampleCount(0)
+    , m_SeekStride(0)
+    , m_OutputSampleRate(0)
+    , m_Sequence(0)
+{
+    InitializeAudioSoundEffectConfig(&m_Config);
+    for (int i = 0; i < PolyphonyMax; ++i)
+    {
+        m_Instances[i].isActive = false;
+    }
+}
+
+void AudioSoundEffect::Initialize(AudioVoiceManager* pVoiceManager, const nn::audio::AdpcmHeaderInfo* pHeader,
+                                  const void* data, std::size_t dataSize, const AudioSoundEffectConfig& config) NN_NOEXCEPT
+{
+    NN_ABORT_UNLESS_NOT_NULL(pVoiceManager);
+    NN_ABORT_UNLESS_NOT_NULL(pHeader);
+    NN_ABORT_UNLESS_NOT_NULL(data);
+    NN_ABORT_UNLESS(config.polyphonyMax > 0 && config.polyphonyMax <= PolyphonyMax);
+
+    m_pVoiceManager = pVoiceManager;
+    m_pHeader = pHeader;
+    m_pData = data;
+    m_DataSize = dataSize;
+    m_Config = config;
+    m_OutputSampleRate = 0;
+    m_Sequence = 0;
+    for (int i = 0; i < PolyphonyMax; ++i)
+    {
+        m_Instances[i].isActive = false;
+    }
+
+    // Every instance queues this same buffer; the renderer only reads it.
+    m_WaveBuffer.buffer = data;
+    m_WaveBuffer.size = dataSize;
+    m_WaveBuffer.startSampleOffset = 0;
+    m_WaveBuffer.endSampleOffset = pHeader->sampleCount;
+    m_WaveBuffer.loop = false;
+    m_WaveBuffer.isEndOfStream = false;
+    m_WaveBuffer.pContext = &pHeader->loopContext;
+    m_WaveBuffer.contextSize = sizeof(nn::audio::AdpcmContext);
+
+    // Decode the sound once, from the context its instances start with, and keep the state at evenly spaced frames.
+    // Resuming then decodes less than one stride instead of everything before the position.
+    const int frameCount = (pHeader->sampleCount + AudioDsp::AdpcmFrameSampleCount - 1) / AudioDsp::AdpcmFrameSampleCount;
+    m_SeekStride = std::max((frameCount + SeekPointCount - 1) / SeekPointCount, 1) * AudioDsp::AdpcmFrameSampleCount;
+    if (config.isVirtualizable)
+    {
+        nn::audio::AdpcmContext context = pHeader->loopContext;
+        for (int i = 0; i < SeekPointCount; ++i)
+        {
+            m_SeekContexts[i] = context;
+            const int begin = i * m_SeekStride;
+            SkipAdpcm(&context, data, dataSize, begin, std::max(std::min(m_SeekStride, pHeader->sampleCount - begin), 0), pHeader->parameter);
+        }
+    }
+}
+
+void AudioSoundEffect::Finalize() NN_NOEXCEPT
+{
+    StopAll();
+    m_pVoiceManager = nullptr;
+    m_pHeader = nullptr;
+    m_pData = nullptr;
+    m_DataSize = 0;
+    m_pSilence = nullptr;
+    m_SilenceSize = 0;
+    m_SilenceSampleCount = 0;
+}
+
+std::size_t AudioSoundEffect::GetRequiredSilenceBufferSize(int sampleCount) NN_NOEXCEPT
+{
+    return static_cast<std::size_t>((sampleCount + AudioDsp::AdpcmFrameSampleCount - 1) / AudioDsp::AdpcmFrameSampleCount) * AudioDsp::AdpcmFrameSize;
+}
+
+void AudioSoundEffect::SetSilenceBuffer(const void* data, std::size_t dataSize) NN_NOEXCEPT
+{
+    NN_ABORT_UNLESS_NOT_NULL(data);
+    m_pSilence = data;
+    m_SilenceSize = dataSize;
+    m_SilenceSampleCount = static_cast<int>(dataSize / AudioDsp::AdpcmFrameSize) * AudioDsp::AdpcmFrameSampleCount;
+}
+
+AudioVoiceManager::Handle AudioSoundEffect::Play() NN_NOEXCEPT
+{
+    return Play(0);
+}
+
+AudioVoiceManager::Handle AudioSoundEffect::Play(int delaySampleCount) NN_NOEXCEPT
+{
+    NN_ABORT_UNLESS_MINMAX(delaySampleCount, 0, m_SilenceSampleCount);
+
+    RemoveFinishedInstances();
+    Instance* pInstance = nullptr;
+    Instance* pOldest = nullptr;
+    for (int i = 0; i < m_Config.polyphonyMax; ++i)
+    {
+        Instance& instance = m_Instances[i];
+        if (!instance.isActive)
+        {
+            pInstance = pInstance != nullptr ? pInstance : &instance;
+        }
+        else if (pOldest == nullptr || static_cast<int32_t>(instance.sequence - pOldest->sequence) < 0)
+        {
+            pOldest = &instance;
+        }
+    }
+    if (pInstance == nullptr)
+    {
+        if (m_Config.retriggerPolicy == AudioRetriggerPolicy_Ignore)
+        {
+            return AudioVoiceManager::InvalidHandle;
+        }
+        m_pVoiceManager->Stop(pOldest->handle);
+        pInstance = pOldest;
+    }
+
+    pInstance->isActive = true;
+    pInstance->sequence = m_Sequence++;
+    pInstance->elapsed = -delaySampleCount;
+    pInstance->handle = StartVoice(pInstance);
+    if (pInstance->handle == AudioVoiceManager::InvalidHandle && !m_Config.isVirtualizable)
+    {
+        pInstance->isActive = false;
+    }
+    return pInstance->handle;
+}
+
+void AudioSoundEffect::StopAll() NN_NOEXCEPT
+{
+    for (int i = 0; i < PolyphonyMax; ++i)
+    {
+        if (m_Instances[i].isActive)
+        {
+            m_pVoiceManager->Stop(m_Instances[i].handle);
+            m_Instances[i].isActive = false;
+        }
+    }
+}
+
+int AudioSoundEffect::GetPlayingCount() NN_NOEXCEPT
+{
+    RemoveFinishedInstances();
+    int count = 0;
+    for (int i = 0; i < m_Config.polyphonyMax; ++i)
+    {
+        count += m_Instances[i].isActive ? 1 : 0;
+    }
+    return count;
+}
+
+void AudioSoundEffect::Advance(int sampleCount, int sampleRate) NN_NOEXCEPT
+{
+    m_OutputSampleRate = sampleRate;
+    for (int i = 0; i < m_Config.polyphonyMax; ++i)
+    {
+        m_Instances[i].elapsed += m_Instances[i].isActive ? sampleCount : 0;
+    }
+    RemoveFinishedInstances();
+}
+
+bool AudioSoundEffect::IsActive(int slot) const NN_NOEXCEPT
+{
+    NN_ABORT_UNLESS_RANGE(slot, 0, m_Config.polyphonyMax);
+    return m_Instances[slot].isActive;
+}
+
+bool AudioSoundEffect::IsVirtual(int slot) const NN_NOEXCEPT
+{
+    NN_ABORT_UNLESS_RANGE(slot, 0, m_Config.polyphonyMax);
+    return m_Instances[slot].isActive && m_Instances[slot].handle == AudioVoiceManager::InvalidHandle;
+}
+
+AudioVoiceManager::Handle AudioSoundEffect::GetVoiceHandle(int slot) const NN_NOEXCEPT
+{
+    NN_ABORT_UNLESS_RANGE(slot, 0, m_Config.polyphonyMax);
+    return m_Instances[slot].isActive ? m_Instances[slot].handle : AudioVoiceManager::InvalidHandle;
+}
+
+AudioVoiceManager::Handle AudioSoundEffect::Realize(int slot) NN_NOEXCEPT
+{
+    NN_ABORT_UNLESS(IsVirtual(slot));
+    Instance& instance = m_Instances[slot];
+    if (GetPosition(instance) >= m_pHeader->sampleCount)
+    {
+        instance.isActive = false;
+        return AudioVoiceManager::InvalidHandle;
+    }
+    instance.handle = StartVoice(&instance);
+    return instance.handle;
+}
+
+void AudioSoundEffect::Virtualize(int slot) NN_NOEXCEPT
+{
+    NN_ABORT_UNLESS(m_Config.isVirtualizable && IsActive(slot));
+    Instance& instance = m_Instances[slot];
+    m_pVoiceManager->Stop(instance.handle);
+    instance.handle = AudioVoiceManager::InvalidHandle;
+}
+
+AudioVoiceManager::Handle AudioSoundEffect::StartVoice(Instance* pInstance) NN_NOEXCEPT
+{
+    AudioVoiceRequest request;
+    InitializeAudioVoiceRequest(&request);
+    request.sampleRate = m_pHeader->sampleRate;
+    request.sampleFormat = nn::audio::SampleFormat_Adpcm;
+    request.priority = m_Config.priority;
+    request.pParameter = &m_pHeader->parameter;
+    request.parameterSize = sizeof(nn::audio::AdpcmParameter);
+    request.pWaveBuffer = &m_WaveBuffer;
+    request.volume = m_Config.volume;
+
+    // Frames of zeros decode to zeros from any predictor, and leave the history at zero for the sound's own context.
+    if (pInstance->elapsed < 0)
+    {
+        nn::audio::WaveBuffer& leadIn = pInstance->leadIn;
+        leadIn.buffer = m_pSilence;
+        leadIn.size = m_SilenceSize;
+        leadIn.startSampleOffset = 0;
+        leadIn.endSampleOffset = static_cast<int32_t>(-pInstance->elapsed);
+        leadIn.loop = false;
+        leadIn.isEndOfStream = false;
+        leadIn.pContext = nullptr;
+        leadIn.contextSize = 0;
+        request.pLeadInWaveBuffer = &leadIn;
+    }
+    else if (pInstance->elapsed > 0)
+    {
+        // A virtual instance resumes where it would be, with the decoder state of that sample.
+        const int position = GetPosition(*pInstance);
+        Seek(&pInstance->context, position);
+        nn::audio::WaveBuffer& resume = pInstance->resume;
+        resume = m_WaveBuffer;
+        resume.startSampleOffset = position;
+        resume.pContext = &pInstance->context;
+        request.pWaveBuffer = &resume;
+    }
+    return m_pVoiceManager->Play(request);
+}
+
+int AudioSoundEffect::GetPosition(const Instance& instance) const NN_NOEXCEPT
+{
+    if (instance.elapsed <= 0 || m_OutputSampleRate == 0)
+    {
+        return 0;
+    }
+    const int64_t position = instance.elapsed * m_pHeader->sampleRate / m_OutputSampleRate;
+    return static_cast<int>(std::min<int64_t>(position, m_pHeader->sampleCount));
+}
+
+void AudioSoundEffect::Seek(nn::audio::AdpcmContext* pOutContext, int position) const NN_NOEXCEPT
+{
+    const int point = std::min(position / m_SeekStride, SeekPointCount - 1);
+    *pOutContext = m_SeekContexts[point];
+    SkipAdpcm(pOutContext, m_pData, m_DataSize, point * m_SeekStride, position - point * m_SeekStride, m_pHeader->parameter);
+}
+
+void AudioSoundEffect::RemoveFinishedInstances() NN_NOEXCEPT
+{
+    for (int i = 0; i < m_Config.polyphonyMax; ++i)
+    {
+        Instance& instance = m_Instances[i];
+        if (!instance.isActive)
+        {
+            continue;
+        }
+        const bool isPastEnd = GetPosition(instance) >= m_pHeader->sampleCount;
+        if (instance.handle == AudioVoiceManager::InvalidHandle)
+        {
+            // Virtual: only the position can end it.
+            instance.isActive = !isPastEnd;
+        }
+        else if (!m_pVoiceManager->IsPlaying(instance.handle))
+        {
+            // The voice finished or was taken. Before the end, a virtualizable instance carries on without it.
+            instance.handle = AudioVoiceManager::InvalidHandle;
+            instance.isActive = !isPastEnd && m_Config.isVirtualizable;
+        }
+    }
+}
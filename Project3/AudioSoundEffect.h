@@ -0,0 +1,155 @@
+#pragma once
+
+/**
+* @brief
+*  One sound effect that can play several overlapping instances.
+*
+*  Every instance gets its own voice from an <tt>AudioVoiceManager</tt>, while the ADPCM data, the header,
+*  and the wave buffer are shared read-only, so a second footstep or impact costs a voice and no sample memory.
+*  The number of instances is capped per sound; what happens to a trigger beyond the cap is set by the retrigger policy.
+*
+*  An instance can start a given number of samples into the next audio frame. Given a silence buffer, <tt>Play()</tt>
+*  queues that many samples of it before the sound, so the start is exact to the sample instead of to the frame.
+*
+*  A virtualizable sound keeps an instance that has no voice, because none was free or its voice was taken, as a
+*  virtual instance: only its position moves on with <tt>Advance()</tt>. <tt>Realize()</tt> gives it a voice again,
+*  starting at that position with the decoder state there, which is decoded from the nearest of a few states taken
+*  when the sound is initialized.
+*/
+
+#include <nn/nn_Common.h>
+#include <nn/nn_Macro.h>
+#include <nn/audio.h>
+
+#include "AudioVoiceManager.h"
+
+enum AudioRetriggerPolicy
+{
+    AudioRetriggerPolicy_StealOldest,   //!<  Stop the oldest instance of this sound and start a new one.
+    AudioRetriggerPolicy_Ignore         //!<  Drop the trigger while the sound is at its polyphony limit.
+};
+
+struct AudioSoundEffectConfig
+{
+    int polyphonyMax;                   //!<  Instances of this sound that may play at once, up to AudioSoundEffect::PolyphonyMax.
+    AudioRetriggerPolicy retriggerPolicy;
+    int priority;                       //!<  Voice priority passed to the manager; see AudioVoiceRequest::priority.
+    float volume;
+    bool isVirtualizable;               //!<  Keep instances without a voice as virtual instead of dropping them.
+};
+
+//!<  Sets a config to four instances, StealOldest, VoiceType::PriorityHighest, volume 1, and no virtual instances.
+void InitializeAudioSoundEffectConfig(AudioSoundEffectConfig* pOutConfig) NN_NOEXCEPT;
+
+class AudioSoundEffect
+{
+    NN_DISALLOW_COPY(AudioSoundEffect);
+    NN_DISALLOW_MOVE(AudioSoundEffect);
+
+public:
+    static const int PolyphonyMax = 16;
+    static const int SeekPointCount = 32;       //!<  Decoder states kept per sound for resuming a virtual instance.
+
+    AudioSoundEffect() NN_NOEXCEPT;
+
+    /**
+    * @brief  Binds the sound to its ADPCM data.
+    *
+    *  pHeader and data are only read and must stay valid until <tt>Finalize()</tt>. data must be in an attached memory pool.
+    */
+    void Initialize(AudioVoiceManager* pVoiceManager, const nn::audio::AdpcmHeaderInfo* pHeader,
+                    const void* data, std::size_t dataSize, const AudioSoundEffectConfig& config) NN_NOEXCEPT;
+
+    //!<  Stops every instance.
+    void Finalize() NN_NOEXCEPT;
+
+    //!<  Bytes of silence that delay a start by up to sampleCount samples.
+    static std::size_t GetRequiredSilenceBufferSize(int sampleCount) NN_NOEXCEPT;
+
+    /**
+    * @brief  Sets the zeroed ADPCM data that <tt>Play(delaySampleCount)</tt> plays before the sound.
+    *
+    *  Its size caps the delay. Every sound effect may share the same data, which must be in an attached memory pool and
+    *  stay valid until <tt>Finalize()</tt>.
+    */
+    void SetSilenceBuffer(const void* data, std::size_t dataSize) NN_NOEXCEPT;
+
+    /**
+    * @brief  Starts a new instance.
+    *
+    *  Set the destination and mix volumes through <tt>AudioVoiceManager::GetVoice()</tt>.
+    *
+    * @return  The voice handle of the instance, or AudioVoiceManager::InvalidHandle if the trigger was dropped or the instance is virtual.
+    */
+    AudioVoiceManager::Handle Play() NN_NOEXCEPT;
+
+    //!<  Starts a new instance after delaySampleCount samples of silence, at most as many as the silence buffer holds.
+    AudioVoiceManager::Handle Play(int delaySampleCount) NN_NOEXCEPT;
+
+    void StopAll() NN_NOEXCEPT;
+
+    //!<  Instances still playing, virtual ones included.
+    int GetPlayingCount() NN_NOEXCEPT;
+
+    /**
+    * @brief  Moves every instance sampleCount samples at sampleRate further into the sound. Call once per update.
+    *
+    *  Instances past the end are forgotten, and virtualizable ones whose voice was taken become virtual.
+    */
+    void Advance(int sampleCount, int sampleRate) NN_NOEXCEPT;
+
+    // Instances by slot, for the caller that decides which instances get voices. There are polyphonyMax slots.
+
+    int GetSlotCount() const NN_NOEXCEPT { return m_Config.polyphonyMax; }
+    bool IsVirtualizable() const NN_NOEXCEPT { return m_Config.isVirtualizable; }
+    bool IsActive(int slot) const NN_NOEXCEPT;
+    bool IsVirtual(int slot) const NN_NOEXCEPT;
+
+    //!<  Voice handle of the instance in slot, or AudioVoiceManager::InvalidHandle if the slot is free or the instance virtual.
+    AudioVoiceManager::Handle GetVoiceHandle(int slot) const NN_NOEXCEPT;
+
+    //!<  Gives the virtual instance in slot a voice at its position. Returns the handle, or InvalidHandle if no voice was free.
+    AudioVoiceManager::Handle Realize(int slot) NN_NOEXCEPT;
+
+    //!<  Stops the voice of the instance in slot and keeps the instance as virtual.
+    void Virtualize(int slot) NN_NOEXCEPT;
+
+private:
+    struct Instance
+    {
+        AudioVoiceManager::Handle handle;       //!<  InvalidHandle while virtual.
+        uint32_t sequence;                      //!<  Trigger order, for finding the oldest.
+        int64_t elapsed;                        //!<  Output samples since the start; negative during the delay.
+        nn::audio::WaveBuffer leadIn;           //!<  Silence of a delayed start.
+        nn::audio::WaveBuffer resume;           //!<  The rest of the sound from where a virtual instance was.
+        nn::audio::AdpcmContext context;        //!<  Decoder state at resume.startSampleOffset.
+        bool isActive;
+    };
+
+    //!<  Starts a voice for instance, behind its delay or from its position.
+    AudioVoiceManager::Handle StartVoice(Instance* pInstance) NN_NOEXCEPT;
+
+    //!<  Sample of the sound the instance has reached.
+    int GetPosition(const Instance& instance) const NN_NOEXCEPT;
+
+    //!<  Decoder state at position, from the seek point before it.
+    void Seek(nn::audio::AdpcmContext* pOutContext, int position) const NN_NOEXCEPT;
+
+    //!<  Forgets instances that are past the end or whose voice was taken, unless they can be virtual.
+    void RemoveFinishedInstances() NN_NOEXCEPT;
+
+    AudioVoiceManager* m_pVoiceManager;
+    const nn::audio::AdpcmHeaderInfo* m_pHeader;
+    const void* m_pData;
+    std::size_t m_DataSize;
+    nn::audio::WaveBuffer m_WaveBuffer;
+    const void* m_pSilence;
+    std::size_t m_SilenceSize;
+    int m_SilenceSampleCount;
+    AudioSoundEffectConfig m_Config;
+    nn::audio::AdpcmContext m_SeekContexts[SeekPointCount];
+    int m_SeekStride;                           //!<  Samples between seek points, a whole number of frames.
+    int m_OutputSampleRate;                     //!<  Rate of the last Advance(); 0 before the first.
+    Instance m_Instances[PolyphonyMax];         //!<  Slots stay put while their voices play, as the voices keep pointers to the wave buffers.
+    uint32_t m_Sequence;
+};
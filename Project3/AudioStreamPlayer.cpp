@@ -0,0 +1,212 @@
+#include <algorithm>
+
+#include <nn/nn_Abort.h>
+
+#include "AudioStreamPlayer.h"
+#include "AudioWavFile.h"
+
+namespace {
+
+// Sent through the free queue to stop the reader thread.
+const int QuitMessage = AudioStreamPlayer::BufferCount;
+
+}
+
+AudioStreamPlayer::AudioStreamPlayer() NN_NOEXCEPT
+    : m_pConfig(nullptr)
+    , m_pBuffer(nullptr)
+    , m_DataOffset(0)
+    , m_SampleRate(0)
+    , m_ChannelCount(0)
+    , m_FrameSize(0)
+    , m_LoopStartFrame(0)
+    , m_LoopEndFrame(0)
+    , m_ReadFrame(0)
+    , m_Loop(false)
+    , m_IsEndOfStreamRead(false)
+    , m_IsEndOfStreamQueued(false)
+    , m_IsThreadStarted(false)
+{
+}
+
+std::size_t AudioStreamPlayer::GetRequiredBufferSize() NN_NOEXCEPT
+{
+    return BufferCount * BufferSize;
+}
+
+void AudioStreamPlayer::Initialize(nn::audio::AudioRendererConfig* pConfig, const char* filename, bool loop,
+                                   void* buffer, std::size_t bufferSize, void* threadStack, std::size_t threadStackSize) NN_NOEXCEPT
+{
+    NN_ABORT_UNLESS_NOT_NULL(pConfig);
+    NN_ABORT_UNLESS_NOT_NULL(buffer);
+    NN_ABORT_UNLESS(bufferSize >= GetRequiredBufferSize());
+    NN_ABORT_UNLESS_NOT_NULL(threadStack);
+    NN_ABORT_UNLESS(threadStackSize >= ThreadStackSize);
+
+    m_pConfig = pConfig;
+    m_pBuffer = static_cast<char*>(buffer);
+    m_Loop = loop;
+
+    nn::Result result = nn::fs::OpenFile(&m_FileHandle, filename, nn::fs::OpenMode_Read);
+    NN_ABORT_UNLESS_RESULT_SUCCESS(result);
+
+    // Only the chunk headers are read here; the samples are read a chunk at a time by the reader thread.
+    AudioDsp::WavLayout layout;
+    ReadWavLayout(&layout, m_FileHandle);
+    NN_ABORT_UNLESS_EQUAL(layout.bitsPerSample, 16);  // Streams are 16-bit PCM.
+
+    m_DataOffset = layout.dataOffset;
+    m_SampleRate = layout.sampleRate;
+    m_ChannelCount = layout.channelCount;
+    m_FrameSize = layout.blockAlign;
+    // Loop the whole track unless the file has a smpl loop. Frames past the loop end are never played when looping.
+    m_LoopStartFrame = layout.hasLoop ? layout.loopStartFrame : 0;
+    m_LoopEndFrame = (layout.hasLoop && loop) ? layout.loopEndFrame : layout.frameCount;
+    NN_ABORT_UNLESS(m_LoopEndFrame > m_LoopStartFrame);
+    NN_ABORT_UNLESS(BufferSize >= static_cast<std::size_t>(m_FrameSize));
+    m_ReadFrame = 0;
+    m_IsEndOfStreamRead = false;
+    m_IsEndOfStreamQueued = false;
+
+    // As with a fully loaded file, a multichannel stream uses one voice per channel.
+    nn::audio::AcquireVoiceSlot(pConfig, &m_Voice, m_SampleRate, m_ChannelCount, nn::audio::SampleFormat_PcmInt16, nn::audio::VoiceType::PriorityHighest, nullptr, 0);
+
+    m_FreeQueue.Initialize(m_FreeQueueSlots, sizeof(m_FreeQueueSlots), FreeQueueCapacity);
+    m_FilledQueue.Initialize(m_FilledQueueSlots, sizeof(m_FilledQueueSlots), FilledQueueCapacity);
+    nn::os::InitializeEvent(&m_FreeEvent, false, nn::os::EventClearMode_AutoClear);
+
+    result = nn::os::CreateThread(&m_Thread, ThreadFunction, this, threadStack, threadStackSize, nn::os::DefaultThreadPriority);
+    NN_ABORT_UNLESS_RESULT_SUCCESS(result);
+    nn::os::SetThreadNamePointer(&m_Thread, "AudioStreamReader");
+}
+
+void AudioStreamPlayer::Finalize() NN_NOEXCEPT
+{
+    if (m_IsThreadStarted)
+    {
+        NN_ABORT_UNLESS(m_FreeQueue.TryPush(QuitMessage));
+        nn::os::SignalEvent(&m_FreeEvent);
+        nn::os::WaitThread(&m_Thread);
+        m_IsThreadStarted = false;
+    }
+    nn::os::DestroyThread(&m_Thread);
+    nn::os::FinalizeEvent(&m_FreeEvent);
+
+    nn::fs::CloseFile(m_FileHandle);
+
+    nn::audio::SetVoicePlayState(&m_Voice, nn::audio::VoiceType::PlayState_Stop);
+    nn::audio::ReleaseVoiceSlot(m_pConfig, &m_Voice);
+    m_pConfig = nullptr;
+    m_pBuffer = nullptr;
+}
+
+void AudioStreamPlayer::Start() NN_NOEXCEPT
+{
+    NN_ABORT_UNLESS(!m_IsThreadStarted);
+
+    // Prime the whole ring before playback so the voice never starts empty.
+    for (int i = 0; i < BufferCount && !m_IsEndOfStreamRead; ++i)
+    {
+        FillBuffer(i);
+        nn::audio::AppendWaveBuffer(&m_Voice, &m_WaveBuffers[i]);
+        m_IsEndOfStreamQueued = m_WaveBuffers[i].isEndOfStream;
+    }
+
+    nn::os::StartThread(&m_Thread);
+    m_IsThreadStarted = true;
+
+    nn::audio::SetVoicePlayState(&m_Voice, nn::audio::VoiceType::PlayState_Play);
+}
+
+void AudioStreamPlayer::Update() NN_NOEXCEPT
+{
+    while (const nn::audio::WaveBuffer* pWaveBuffer = nn::audio::GetReleasedWaveBuffer(&m_Voice))
+    {
+        const ptrdiff_t index = pWaveBuffer - m_WaveBuffers;
+        NN_ABORT_UNLESS(index >= 0 && index < BufferCount);
+        NN_ABORT_UNLESS(m_FreeQueue.TryPush(static_cast<int>(index)));
+        nn::os::SignalEvent(&m_FreeEvent);
+    }
+
+    int index;
+    while (m_FilledQueue.TryPop(&index))
+    {
+        nn::audio::AppendWaveBuffer(&m_Voice, &m_WaveBuffers[index]);
+        if (m_WaveBuffers[index].isEndOfStream)
+        {
+            m_IsEndOfStreamQueued = true;
+        }
+    }
+}
+
+void AudioStreamPlayer::ThreadFunction(void* arg) NN_NOEXCEPT
+{
+    static_cast<AudioStreamPlayer*>(arg)->ThreadMain();
+}
+
+void AudioStreamPlayer::ThreadMain() NN_NOEXCEPT
+{
+    for (;;)
+    {
+        // The event is signaled after every push, so an index pushed after the queue was found empty still wakes the wait.
+        int index;
+        if (!m_FreeQueue.TryPop(&index))
+        {
+            nn::os::WaitEvent(&m_FreeEvent);
+            continue;
+        }
+        if (index == QuitMessage)
+        {
+            break;
+        }
+
+        // Once the end of a non-looping stream has been read, released buffers are simply retired.
+        if (m_IsEndOfStreamRead)
+        {
+            continue;
+        }
+
+        FillBuffer(index);
+        NN_ABORT_UNLESS(m_FilledQueue.TryPush(index));
+    }
+}
+
+void AudioStreamPlayer::FillBuffer(int index) NN_NOEXCEPT
+{
+    char* p = m_pBuffer + index * BufferSize;
+    const int64_t chunkFrameCount = static_cast<int64_t>(BufferSize / m_FrameSize);
+    int64_t filledFrameCount = 0;
+    bool isEndOfStream = false;
+
+    // Wrap at the loop end inside the chunk so the seam is sample-accurate.
+    while (filledFrameCount < chunkFrameCount)
+    {
+        const int64_t frameCount = std::min(chunkFrameCount - filledFrameCount, m_LoopEndFrame - m_ReadFrame);
+        nn::Result result = nn::fs::ReadFile(m_FileHandle, m_DataOffset + m_ReadFrame * m_FrameSize, p + filledFrameCount * m_FrameSize, static_cast<std::size_t>(frameCount * m_FrameSize));
+        NN_ABORT_UNLESS_RESULT_SUCCESS(result);
+        filledFrameCount += frameCount;
+        m_ReadFrame += frameCount;
+
+        if (m_ReadFrame == m_LoopEndFrame)
+        {
+            if (!m_Loop)
+            {
+                isEndOfStream = true;
+                break;
+            }
+            m_ReadFrame = m_LoopStartFrame;
+        }
+    }
+
+    nn::audio::WaveBuffer& waveBuffer = m_WaveBuffers[index];
+    waveBuffer.buffer = p;
+    waveBuffer.size = static_cast<std::size_t>(filledFrameCount * m_FrameSize);
+    waveBuffer.startSampleOffset = 0;
+    waveBuffer.endSampleOffset = static_cast<int32_t>(filledFrameCount);
+    waveBuffer.loop = false;
+    waveBuffer.isEndOfStream = isEndOfStream;
+    waveBuffer.pContext = nullptr;
+    waveBuffer.contextSize = 0;
+
+    m_IsEndOfStreamRead = isEndOfStream;
+}
@@ -0,0 +1,99 @@
+#pragma once
+
+/**
+* @brief
+*  Streams a 16-bit PCM WAV file through a single voice.
+*
+*  A reader thread fills a ring of <tt>BufferCount</tt> wave buffers of <tt>BufferSize</tt> bytes each,
+*  so the memory needed per stream does not depend on the length of the track.
+*  All voice calls stay on the thread that calls <tt>Update()</tt>; the reader only touches the file and the sample memory.
+*  Buffer indices pass between the two through lock-free queues, so <tt>Update()</tt> never waits for the reader; it only
+*  signals an event when it hands the reader a buffer to fill.
+*/
+
+#include <nn/nn_Common.h>
+#include <nn/nn_Macro.h>
+#include <nn/audio.h>
+#include <nn/fs.h>
+#include <nn/os.h>
+
+#include "AudioDspMpscQueue.h"
+
+class AudioStreamPlayer
+{
+    NN_DISALLOW_COPY(AudioStreamPlayer);
+    NN_DISALLOW_MOVE(AudioStreamPlayer);
+
+public:
+    static const int BufferCount = 4;                       //!<  Number of wave buffers a voice can hold at once.
+    static const std::size_t BufferSize = 8 * 1024;         //!<  Bytes per wave buffer (62.5 ms of 32 kHz stereo).
+    static const std::size_t ThreadStackSize = 16 * 1024;   //!<  Stack size the reader thread needs.
+
+    AudioStreamPlayer() NN_NOEXCEPT;
+
+    //!<  Size of the sample memory to pass to <tt>Initialize()</tt>. It must be in an attached memory pool.
+    static std::size_t GetRequiredBufferSize() NN_NOEXCEPT;
+
+    /**
+    * @brief  Opens the file and acquires a voice matching its format.
+    *
+    *  Set the voice destination, mix volumes, and filters through <tt>GetVoice()</tt> before calling <tt>Start()</tt>.
+    *  If the file has a <tt>smpl</tt> chunk, its first loop is used as the loop range; otherwise the whole track loops.
+    *  <tt>buffer</tt> must be aligned to <tt>nn::audio::BufferAlignSize</tt> and <tt>threadStack</tt> to <tt>nn::os::ThreadStackAlignment</tt>.
+    */
+    void Initialize(nn::audio::AudioRendererConfig* pConfig, const char* filename, bool loop,
+                    void* buffer, std::size_t bufferSize, void* threadStack, std::size_t threadStackSize) NN_NOEXCEPT;
+
+    //!<  Stops the reader thread, closes the file, and releases the voice.
+    void Finalize() NN_NOEXCEPT;
+
+    //!<  Fills every buffer, queues them, starts the reader thread, and starts playback.
+    void Start() NN_NOEXCEPT;
+
+    //!<  Hands released buffers to the reader and queues the ones it has refilled. Call once per update.
+    void Update() NN_NOEXCEPT;
+
+    nn::audio::VoiceType* GetVoice() NN_NOEXCEPT { return &m_Voice; }
+    int GetSampleRate() const NN_NOEXCEPT { return m_SampleRate; }
+    int GetChannelCount() const NN_NOEXCEPT { return m_ChannelCount; }
+
+    //!<  True after the last buffer of a non-looping stream has been queued.
+    bool IsEndOfStreamQueued() const NN_NOEXCEPT { return m_IsEndOfStreamQueued; }
+
+private:
+    static void ThreadFunction(void* arg) NN_NOEXCEPT;
+
+    void ThreadMain() NN_NOEXCEPT;
+
+    //!<  Reads the next chunk into the given buffer, wrapping at the loop end.
+    void FillBuffer(int index) NN_NOEXCEPT;
+
+    nn::audio::AudioRendererConfig* m_pConfig;
+    nn::audio::VoiceType m_Voice;
+    nn::audio::WaveBuffer m_WaveBuffers[BufferCount];
+    char* m_pBuffer;
+
+    nn::fs::FileHandle m_FileHandle;
+    int64_t m_DataOffset;           //!<  Byte offset of the first sample frame in the file.
+    int m_SampleRate;
+    int m_ChannelCount;
+    int m_FrameSize;                //!<  Bytes per sample frame (all channels).
+    int64_t m_LoopStartFrame;
+    int64_t m_LoopEndFrame;
+    int64_t m_ReadFrame;            //!<  Next frame the reader will read. Owned by the reader thread after Start().
+    bool m_Loop;
+    bool m_IsEndOfStreamRead;       //!<  Owned by the reader thread after Start().
+    bool m_IsEndOfStreamQueued;
+
+    // Each buffer index is in at most one queue at a time; the free queue also has room for the quit message.
+    static const int FreeQueueCapacity = 8;
+    static const int FilledQueueCapacity = BufferCount;
+
+    nn::os::ThreadType m_Thread;
+    nn::os::EventType m_FreeEvent;                  //!<  Signaled after pushing to m_FreeQueue; the reader waits on it.
+    AudioDsp::MpscQueue<int> m_FreeQueue;           //!<  Buffer indices waiting to be filled (main thread to reader).
+    AudioDsp::MpscQueue<int> m_FilledQueue;         //!<  Buffer indices ready to be queued (reader to main thread).
+    AudioDsp::MpscQueue<int>::Slot m_FreeQueueSlots[FreeQueueCapacity];
+    AudioDsp::MpscQueue<int>::Slot m_FilledQueueSlots[FilledQueueCapacity];
+    bool m_IsThreadStarted;
+};
@@ -0,0 +1,84 @@
+#include <nn/nn_Abort.h>
+
+#include "AudioUpdateThread.h"
+
+AudioUpdateThread::AudioUpdateThread() NN_NOEXCEPT
+    : m_pConfig(nullptr)
+    , m_pSystemEvent(nullptr)
+    , m_UpdateFunction(nullptr)
+    , m_pUserData(nullptr)
+    , m_IsQuitRequested(false)
+    , m_IsThreadStarted(false)
+{
+}
+
+void AudioUpdateThread::Initialize(nn::audio::AudioRendererHandle handle, nn::audio::AudioRendererConfig* pConfig, nn::os::SystemEvent* pSystemEvent,
+                                   UpdateFunction updateFunction, void* pUserData, void* threadStack, std::size_t threadStackSize, int priority) NN_NOEXCEPT
+{
+    NN_ABORT_UNLESS_NOT_NULL(pConfig);
+    NN_ABORT_UNLESS_NOT_NULL(pSystemEvent);
+    NN_ABORT_UNLESS_NOT_NULL(updateFunction);
+    NN_ABORT_UNLESS_NOT_NULL(threadStack);
+    NN_ABORT_UNLESS(threadStackSize >= ThreadStackSize);
+
+    m_Handle = handle;
+    m_pConfig = pConfig;
+    m_pSystemEvent = pSystemEvent;
+    m_UpdateFunction = updateFunction;
+    m_pUserData = pUserData;
+    m_IsQuitRequested.store(false, std::memory_order_relaxed);
+
+    nn::Result result = nn::os::CreateThread(&m_Thread, ThreadFunction, this, threadStack, threadStackSize, priority);
+    NN_ABORT_UNLESS_RESULT_SUCCESS(result);
+    nn::os::SetThreadNamePointer(&m_Thread, "AudioUpdate");
+}
+
+void AudioUpdateThread::Finalize() NN_NOEXCEPT
+{
+    if (m_IsThreadStarted)
+    {
+        // The signal wakes the thread without waiting for the next audio frame. Commands it has not run are left in the
+        // engine's queue for the caller to run.
+        m_IsQuitRequested.store(true, std::memory_order_release);
+        m_pSystemEvent->Signal();
+        nn::os::WaitThread(&m_Thread);
+        m_IsThreadStarted = false;
+    }
+    nn::os::DestroyThread(&m_Thread);
+
+    m_pConfig = nullptr;
+    m_pSystemEvent = nullptr;
+    m_UpdateFunction = nullptr;
+    m_pUserData = nullptr;
+}
+
+void AudioUpdateThread::Start() NN_NOEXCEPT
+{
+    NN_ABORT_UNLESS(!m_IsThreadStarted);
+
+    nn::os::StartThread(&m_Thread);
+    m_IsThreadStarted = true;
+}
+
+void AudioUpdateThread::ThreadFunction(void* arg) NN_NOEXCEPT
+{
+    static_cast<AudioUpdateThread*>(arg)->ThreadMain();
+}
+
+void AudioUpdateThread::ThreadMain() NN_NOEXCEPT
+{
+    for (;;)
+    {
+        // Signaled once per audio frame. If the thread falls behind, the event stays signaled and the next wait returns at once.
+        m_pSystemEvent->Wait();
+        if (m_IsQuitRequested.load(std::memory_order_acquire))
+        {
+            break;
+        }
+
+        m_UpdateFunction(m_pUserData);
+
+        nn::Result result = nn::audio::RequestUpdateAudioRenderer(m_Handle, m_pConfig);
+        NN_ABORT_UNLESS_RESULT_SUCCESS(result);
+    }
+}
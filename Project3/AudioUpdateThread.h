@@ -0,0 +1,66 @@
+#pragma once
+
+/**
+* @brief
+*  Runs the audio update on its own thread, paced by the renderer instead of the video frame.
+*
+*  The thread wakes on the renderer's <tt>SystemEvent</tt>, which is signaled once per audio frame (every
+*  <tt>RenderCount</tt> samples). Each wake it calls the update function for commands, streaming refills, and voice
+*  bookkeeping, and then calls <tt>nn::audio::RequestUpdateAudioRenderer()</tt>. A slow video frame therefore no longer
+*  delays parameter changes or sound effect triggers.
+*
+*  Once <tt>Start()</tt> has been called, the renderer config and every object the update function touches belong
+*  to the audio thread. Other threads reach them only through the lock-free command queue of <tt>AudioEngine</tt>, which
+*  the update function drains, so there is one path for commands and one order among them.
+*/
+
+#include <atomic>
+
+#include <nn/nn_Common.h>
+#include <nn/nn_Macro.h>
+#include <nn/audio.h>
+#include <nn/os.h>
+
+class AudioUpdateThread
+{
+    NN_DISALLOW_COPY(AudioUpdateThread);
+    NN_DISALLOW_MOVE(AudioUpdateThread);
+
+public:
+    typedef void (*UpdateFunction)(void* pUserData);
+    typedef void (*CommandFunction)(void* pUserData, uintptr_t argument);
+
+    static const std::size_t ThreadStackSize = 16 * 1024;   //!<  Stack size the audio thread needs, plus whatever the update function uses.
+
+    AudioUpdateThread() NN_NOEXCEPT;
+
+    /**
+    * @brief  Creates the thread without starting it.
+    *
+    *  updateFunction is called with pUserData on the audio thread once per audio frame.
+    *  <tt>threadStack</tt> must be aligned to <tt>nn::os::ThreadStackAlignment</tt>. Give the thread a higher priority
+    *  than the render thread so audio updates preempt it.
+    */
+    void Initialize(nn::audio::AudioRendererHandle handle, nn::audio::AudioRendererConfig* pConfig, nn::os::SystemEvent* pSystemEvent,
+                    UpdateFunction updateFunction, void* pUserData, void* threadStack, std::size_t threadStackSize, int priority) NN_NOEXCEPT;
+
+    //!<  Stops the thread after the update in progress, if any, and destroys it. Call it before stopping the renderer, from any thread but the audio thread.
+    void Finalize() NN_NOEXCEPT;
+
+    void Start() NN_NOEXCEPT;
+
+private:
+    static void ThreadFunction(void* arg) NN_NOEXCEPT;
+
+    void ThreadMain() NN_NOEXCEPT;
+
+    nn::audio::AudioRendererHandle m_Handle;
+    nn::audio::AudioRendererConfig* m_pConfig;
+    nn::os::SystemEvent* m_pSystemEvent;
+    UpdateFunction m_UpdateFunction;
+    void* m_pUserData;
+
+    nn::os::ThreadType m_Thread;
+    std::atomic<bool> m_IsQuitRequested;    //!<  Set by Finalize(); checked by the audio thread after each wake.
+    bool m_IsThreadStarted;
+};
@@ -0,0 +1,270 @@
+#include <new>
+
+#include <nn/nn_Abort.h>
+
+#include "AudioVoiceManager.h"
+
+namespace {
+
+const int IndexBitCount = 16;
+const uint32_t IndexMask = (1u << IndexBitCount) - 1;
+
+AudioVoiceManager::Handle MakeHandle(int index, uint16_t generation)
+{
+    return (static_cast<uint32_t>(generation) << IndexBitCount) | static_cast<uint32_t>(index);
+}
+
+uintptr_t AlignUp(uintptr_t value, std::size_t alignment)
+{
+    return (value + alignment - 1) & ~static_cast<uintptr_t>(alignment - 1);
+}
+
+}
+
+void InitializeAudioVoiceRequest(AudioVoiceRequest* pOutRequest) NN_NOEXCEPT
+{
+    pOutRequest->sampleRate = 32000;
+    pOutRequest->channelCount = 1;
+    pOutRequest->sampleFormat = nn::audio::SampleFormat_PcmInt16;
+    pOutRequest->priority = nn::audio::VoiceType::PriorityLowest;
+    pOutRequest->pParameter = nullptr;
+    pOutRequest->parameterSize = 0;
+    pOutRequest->pWaveBuffer = nullptr;
+    pOutRequest->pLeadInWaveBuffer = nullptr;
+    pOutRequest->volume = 1.0f;
+}
+
+AudioVoiceManager::AudioVoiceManager() NN_NOEXCEPT
+    : m_pConfig(nullptr)
+    , m_pEntries(nullptr)
+    , m_pFree(nullptr)
+    , m_pActive(nullptr)
+    , m_VoiceCount(0)
+    , m_FreeCount(0)
+    , m_ActiveCount(0)
+    , m_PeakActiveCount(0)
+    , m_Sequence(0)
+    , m_StolenCount(0)
+    , m_RejectedCount(0)
+{
+}
+
+std::size_t AudioVoiceManager::GetRequiredWorkBufferSize(int voiceCount) NN_NOEXCEPT
+{
+    return NN_ALIGNOF(Entry) - 1 + sizeof(Entry) * voiceCount + 2 * sizeof(int) * voiceCount;
+}
+
+void AudioVoiceManager::Initialize(nn::audio::AudioRendererConfig* pConfig, int voiceCount, void* workBuffer, std::size_t workBufferSize) NN_NOEXCEPT
+{
+    NN_ABORT_UNLESS_NOT_NULL(pConfig);
+    NN_ABORT_UNLESS(voiceCount > 0 && voiceCount <= VoiceCountMax);
+    NN_ABORT_UNLESS_NOT_NULL(workBuffer);
+    NN_ABORT_UNLESS(workBufferSize >= GetRequiredWorkBufferSize(voiceCount));
+
+    m_pConfig = pConfig;
+    m_VoiceCount = voiceCount;
+
+    uintptr_t cursor = AlignUp(reinterpret_cast<uintptr_t>(workBuffer), NN_ALIGNOF(Entry));
+    m_pEntries = reinterpret_cast<Entry*>(cursor);
+    cursor += sizeof(Entry) * voiceCount;
+    m_pFree = reinterpret_cast<int*>(cursor);
+    cursor += sizeof(int) * voiceCount;
+    m_pActive = reinterpret_cast<int*>(cursor);
+
+    for (int i = 0; i < voiceCount; ++i)
+    {
+        Entry* pEntry = new (&m_pEntries[i]) Entry();
+        pEntry->sequence = 0;
+        pEntry->generation = 1;
+        pEntry->queuedBufferCount = 0;
+        pEntry->activeIndex = -1;
+        pEntry->priority = nn::audio::VoiceType::PriorityLowest;
+        // Pop low indices first.
+        m_pFree[i] = voiceCount - 1 - i;
+    }
+    m_FreeCount = voiceCount;
+    m_ActiveCount = 0;
+    m_PeakActiveCount = 0;
+    m_Sequence = 0;
+    m_StolenCount = 0;
+    m_RejectedCount = 0;
+}
+
+void AudioVoiceManager::Finalize() NN_NOEXCEPT
+{
+    while (m_ActiveCount > 0)
+    {
+        Release(m_pActive[m_ActiveCount - 1]);
+    }
+    for (int i = 0; i < m_VoiceCount; ++i)
+    {
+        m_pEntries[i].~Entry();
+    }
+    m_pConfig = nullptr;
+    m_pEntries = nullptr;
+    m_pFree = nullptr;
+    m_pActive = nullptr;
+    m_VoiceCount = 0;
+    m_FreeCount = 0;
+}
+
+AudioVoiceManager::Handle AudioVoiceManager::Play(const AudioVoiceRequest& request) NN_NOEXCEPT
+{
+    NN_ABORT_UNLESS_NOT_NULL(request.pWaveBuffer);
+
+    if (m_FreeCount == 0)
+    {
+        const int victim = FindVictim(request.priority);
+        if (victim < 0)
+        {
+            ++m_RejectedCount;
+            return InvalidHandle;
+        }
+        Release(victim);
+        ++m_StolenCount;
+    }
+
+    const int index = m_pFree[--m_FreeCount];
+    Entry& entry = m_pEntries[index];
+    if (!nn::audio::AcquireVoiceSlot(m_pConfig, &entry.voice, request.sampleRate, request.channelCount, request.sampleFormat,
+                                     request.priority, request.pParameter, request.parameterSize))
+    {
+        // The renderer ran out of voices that were acquired outside the manager.
+        m_pFree[m_FreeCount++] = index;
+        ++m_RejectedCount;
+        return InvalidHandle;
+    }
+
+    entry.sequence = m_Sequence++;
+    entry.priority = request.priority;
+    entry.queuedBufferCount = request.pLeadInWaveBuffer != nullptr ? 2 : 1;
+    entry.activeIndex = m_ActiveCount;
+    m_pActive[m_ActiveCount++] = index;
+    m_PeakActiveCount = m_ActiveCount > m_PeakActiveCount ? m_ActiveCount : m_PeakActiveCount;
+
+    nn::audio::SetVoiceVolume(&entry.voice, request.volume);
+    if (request.pLeadInWaveBuffer != nullptr)
+    {
+        nn::audio::AppendWaveBuffer(&entry.voice, request.pLeadInWaveBuffer);
+    }
+    nn::audio::AppendWaveBuffer(&entry.voice, request.pWaveBuffer);
+    nn::audio::SetVoicePlayState(&entry.voice, nn::audio::VoiceType::PlayState_Play);
+    return MakeHandle(index, entry.generation);
+}
+
+void AudioVoiceManager::Stop(Handle handle) NN_NOEXCEPT
+{
+    if (Entry* pEntry = Find(handle))
+    {
+        Release(static_cast<int>(pEntry - m_pEntries));
+    }
+}
+
+bool AudioVoiceManager::AppendWaveBuffer(Handle handle, const nn::audio::WaveBuffer* pWaveBuffer) NN_NOEXCEPT
+{
+    Entry* pEntry = Find(handle);
+    if (pEntry == nullptr || !nn::audio::AppendWaveBuffer(&pEntry->voice, pWaveBuffer))
+    {
+        return false;
+    }
+    ++pEntry->queuedBufferCount;
+    return true;
+}
+
+nn::audio::VoiceType* AudioVoiceManager::GetVoice(Handle handle) NN_NOEXCEPT
+{
+    Entry* pEntry = Find(handle);
+    return pEntry != nullptr ? &pEntry->voice : nullptr;
+}
+
+bool AudioVoiceManager::IsPlaying(Handle handle) const NN_NOEXCEPT
+{
+    return Find(handle) != nullptr;
+}
+
+void AudioVoiceManager::Update() NN_NOEXCEPT
+{
+    // Walk backwards so releasing a voice, which moves the last active entry into its place, skips nothing.
+    for (int i = m_ActiveCount - 1; i >= 0; --i)
+    {
+        const int index = m_pActive[i];
+        Entry& entry = m_pEntries[index];
+        while (nn::audio::GetReleasedWaveBuffer(&entry.voice) != nullptr)
+        {
+            --entry.queuedBufferCount;
+        }
+        if (entry.queuedBufferCount <= 0 || nn::audio::GetVoicePlayState(&entry.voice) == nn::audio::VoiceType::PlayState_Stop)
+        {
+            Release(index);
+        }
+    }
+}
+
+AudioVoiceManager::Entry* AudioVoiceManager::Find(Handle handle) const NN_NOEXCEPT
+{
+    const uint32_t index = handle & IndexMask;
+    if (handle == InvalidHandle || index >= static_cast<uint32_t>(m_VoiceCount))
+    {
+        return nullptr;
+    }
+    Entry& entry = m_pEntries[index];
+    return (entry.activeIndex >= 0 && entry.generation == (handle >> IndexBitCount)) ? &entry : nullptr;
+}
+
+int AudioVoiceManager::FindVictim(int priority) const NN_NOEXCEPT
+{
+    int victim = -1;
+    float victimVolume = 0.0f;
+    for (int i = 0; i < m_ActiveCount; ++i)
+    {
+        const int index = m_pActive[i];
+        const Entry& entry = m_pEntries[index];
+        // A larger number is a lower priority.
+        if (entry.priority < priority)
+        {
+            continue;
+        }
+        const float volume = nn::audio::GetVoiceVolume(&entry.voice);
+        if (victim >= 0)
+        {
+            const Entry& current = m_pEntries[victim];
+            if (entry.priority != current.priority)
+            {
+                if (entry.priority < current.priority)
+                {
+                    continue;
+                }
+            }
+            else if (volume != victimVolume)
+            {
+                if (volume > victimVolume)
+                {
+                    continue;
+                }
+            }
+            else if (static_cast<int32_t>(entry.sequence - current.sequence) > 0)
+            {
+                // Same priority and volume: keep the older one.
+                continue;
+            }
+        }
+        victim = index;
+        victimVolume = volume;
+    }
+    return victim;
+}
+
+void AudioVoiceManager::Release(int index) NN_NOEXCEPT
+{
+    Entry& entry = m_pEntries[index];
+    nn::audio::SetVoicePlayState(&entry.voice, nn::audio::VoiceType::PlayState_Stop);
+    nn::audio::ReleaseVoiceSlot(m_pConfig, &entry.voice);
+
+    const int last = m_pActive[--m_ActiveCount];
+    m_pActive[entry.activeIndex] = last;
+    m_pEntries[last].activeIndex = entry.activeIndex;
+    entry.activeIndex = -1;
+    entry.queuedBufferCount = 0;
+    entry.generation = static_cast<uint16_t>(entry.generation == 0xffff ? 1 : entry.generation + 1);
+    m_pFree[m_FreeCount++] = index;
+}
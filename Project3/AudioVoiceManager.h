@@ -0,0 +1,126 @@
+#pragma once
+
+/**
+* @brief
+*  Owns a pool of renderer voices and hands them out per play request.
+*
+*  Free voices come from a stack, so starting a sound is O(1) while the pool has room.
+*  When it is full, the request steals the least important playing voice: the lowest priority first,
+*  then the quietest, then the oldest. A request never steals a voice more important than itself;
+*  it fails with <tt>InvalidHandle</tt> instead of aborting.
+*
+*  Voices are identified by handles that carry a generation count, so a handle to a voice that has
+*  finished or been stolen simply stops working instead of controlling whatever plays in its slot next.
+*  All calls must come from the thread that calls <tt>Update()</tt>.
+*/
+
+#include <nn/nn_Common.h>
+#include <nn/nn_Macro.h>
+#include <nn/audio.h>
+
+struct AudioVoiceRequest
+{
+    int sampleRate;
+    int channelCount;
+    nn::audio::SampleFormat sampleFormat;
+    int priority;                               //!<  Same scale as nn::audio: VoiceType::PriorityHighest (0) is the most important.
+    const void* pParameter;                     //!<  Format parameter passed to AcquireVoiceSlot(), e.g. nn::audio::AdpcmParameter.
+    std::size_t parameterSize;
+    const nn::audio::WaveBuffer* pWaveBuffer;   //!<  First buffer to play. It must stay valid while the voice is in use.
+    const nn::audio::WaveBuffer* pLeadInWaveBuffer; //!<  Played before pWaveBuffer, e.g. silence that delays the start; null for none.
+    float volume;
+};
+
+//!<  Sets a request to mono PCM16 at VoiceType::PriorityLowest with volume 1 and no buffer.
+void InitializeAudioVoiceRequest(AudioVoiceRequest* pOutRequest) NN_NOEXCEPT;
+
+class AudioVoiceManager
+{
+    NN_DISALLOW_COPY(AudioVoiceManager);
+    NN_DISALLOW_MOVE(AudioVoiceManager);
+
+public:
+    typedef uint32_t Handle;
+    static const Handle InvalidHandle = 0;
+    static const int VoiceCountMax = 0xffff;    //!<  Largest pool a manager can hold.
+
+    AudioVoiceManager() NN_NOEXCEPT;
+
+    //!<  Size of the work buffer to pass to <tt>Initialize()</tt>.
+    static std::size_t GetRequiredWorkBufferSize(int voiceCount) NN_NOEXCEPT;
+
+    /**
+    * @brief  Prepares a pool of voiceCount voices.
+    *
+    *  The renderer's <tt>voiceCount</tt> must leave room for voiceCount voices of the largest channel count requested,
+    *  on top of the voices acquired outside the manager.
+    */
+    void Initialize(nn::audio::AudioRendererConfig* pConfig, int voiceCount, void* workBuffer, std::size_t workBufferSize) NN_NOEXCEPT;
+
+    //!<  Stops and releases every voice.
+    void Finalize() NN_NOEXCEPT;
+
+    /**
+    * @brief  Acquires a voice, queues the request's wave buffer, and starts playback.
+    *
+    *  Set the destination and mix volumes through <tt>GetVoice()</tt> before the next <tt>RequestUpdateAudioRenderer()</tt>.
+    *
+    * @return  The handle of the new voice, or InvalidHandle if every voice is more important than the request.
+    */
+    Handle Play(const AudioVoiceRequest& request) NN_NOEXCEPT;
+
+    //!<  Stops the voice and returns it to the pool. Does nothing for a stale handle.
+    void Stop(Handle handle) NN_NOEXCEPT;
+
+    //!<  Queues another buffer on the voice. Use this instead of nn::audio::AppendWaveBuffer() so the manager can tell when the voice is done.
+    bool AppendWaveBuffer(Handle handle, const nn::audio::WaveBuffer* pWaveBuffer) NN_NOEXCEPT;
+
+    //!<  The voice behind a handle, or nullptr once it has finished or been stolen.
+    nn::audio::VoiceType* GetVoice(Handle handle) NN_NOEXCEPT;
+
+    bool IsPlaying(Handle handle) const NN_NOEXCEPT;
+
+    /**
+    * @brief  Returns voices whose buffers have all been played to the pool. Call once per update.
+    *
+    *  The manager consumes nn::audio::GetReleasedWaveBuffer() for its voices, so callers must not call it on them.
+    */
+    void Update() NN_NOEXCEPT;
+
+    int GetVoiceCount() const NN_NOEXCEPT { return m_VoiceCount; }
+    int GetActiveCount() const NN_NOEXCEPT { return m_ActiveCount; }
+    int GetPeakActiveCount() const NN_NOEXCEPT { return m_PeakActiveCount; }  //!<  Most voices active at once since Initialize().
+    int GetStolenCount() const NN_NOEXCEPT { return m_StolenCount; }       //!<  Voices stolen since Initialize().
+    int GetRejectedCount() const NN_NOEXCEPT { return m_RejectedCount; }   //!<  Requests refused since Initialize().
+
+private:
+    struct Entry
+    {
+        nn::audio::VoiceType voice;
+        uint32_t sequence;          //!<  Play order, for picking the oldest voice.
+        uint16_t generation;        //!<  Never 0, so no handle is ever InvalidHandle.
+        int queuedBufferCount;      //!<  Buffers appended and not yet released.
+        int activeIndex;            //!<  Position in m_pActive, or -1 while free.
+        int priority;
+    };
+
+    Entry* Find(Handle handle) const NN_NOEXCEPT;
+
+    //!<  Index of the voice a request of the given priority may steal, or -1.
+    int FindVictim(int priority) const NN_NOEXCEPT;
+
+    //!<  Stops and releases the voice, invalidates its handles, and puts it back on the free stack.
+    void Release(int index) NN_NOEXCEPT;
+
+    nn::audio::AudioRendererConfig* m_pConfig;
+    Entry* m_pEntries;
+    int* m_pFree;               //!<  Stack of free entry indices.
+    int* m_pActive;             //!<  Dense list of entry indices in use.
+    int m_VoiceCount;
+    int m_FreeCount;
+    int m_ActiveCount;
+    int m_PeakActiveCount;
+    uint32_t m_Sequence;
+    int m_StolenCount;
+    int m_RejectedCount;
+};
@@ -0,0 +1,23 @@
+#include <nn/nn_Abort.h>
+
+#include "AudioWavFile.h"
+
+namespace {
+
+bool ReadFileHandle(void* pUserData, int64_t offset, void* buffer, std::size_t size)
+{
+    const nn::fs::FileHandle* pHandle = static_cast<const nn::fs::FileHandle*>(pUserData);
+    return nn::fs::ReadFile(*pHandle, offset, buffer, size).IsSuccess();
+}
+
+}
+
+void ReadWavLayout(AudioDsp::WavLayout* pOutLayout, nn::fs::FileHandle handle) NN_NOEXCEPT
+{
+    int64_t fileSize;
+    nn::Result result = nn::fs::GetFileSize(&fileSize, handle);
+    NN_ABORT_UNLESS_RESULT_SUCCESS(result);
+
+    AudioDsp::WavResult wavResult = AudioDsp::ParseWavLayout(pOutLayout, ReadFileHandle, &handle, fileSize);
+    NN_ABORT_UNLESS(wavResult == AudioDsp::WavResult_Success, "Failed to parse WAV file (%s)", AudioDsp::GetWavResultString(wavResult));
+}
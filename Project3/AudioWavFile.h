@@ -0,0 +1,17 @@
+#pragma once
+
+/**
+* @brief
+*  WAV file reading on top of the AudioDspWav chunk parser.
+*
+*  Only the layout is read here. Sample data is never loaded whole: streams read the data chunk in blocks from the
+*  offset the layout gives, and sound effects play from banks the wave pool holds.
+*/
+
+#include <nn/nn_Common.h>
+#include <nn/fs.h>
+
+#include "AudioDspWav.h"
+
+//!<  Walks the chunks of an open WAV file with small header reads. Aborts if the file is not integer PCM.
+void ReadWavLayout(AudioDsp::WavLayout* pOutLayout, nn::fs::FileHandle handle) NN_NOEXCEPT;
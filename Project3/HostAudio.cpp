@@ -0,0 +1,1629 @@
+#include "HostAudio.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+#include "AudioDspBiquad.h"
+#include "AudioDspConvolver.h"
+#include "AudioDspResampler.h"
+#include "HostAudioKernels.h"
+
+namespace HostAudio {
+
+// Polyphase filters for SrcQuality_High, with cutoffs in steps of 1/8 of the input Nyquist frequency.
+const int SrcFilterCount = 8;
+
+// Input samples an output sample depends on, which bounds the carry between frames.
+const int SrcCarryCountMax = AudioDsp::ResamplerTapCount;
+
+// A convolution reverb stages its dry and wet signals in the source and voice scratch, which are free once the voices are mixed.
+static_assert(ConvolutionReverbChannelCountMax <= VoiceChannelCountMax, "The scratch buffers hold one channel per reverb channel");
+
+// Marks a written performance frame; the header after the last frame is cleared.
+const uint32_t PerformanceFrameMagic = 0x46524550;    // "PERF"
+
+// One performance frame: this header, the entries, and then the detail entries at detailOffset.
+struct PerformanceFrameHeader
+{
+    uint32_t magic;
+    uint32_t frameSize;                 //!<  Bytes to the next frame.
+    uint32_t detailOffset;              //!<  From the start of the frame.
+    int32_t  entryCount;
+    int32_t  detailCount;
+    float    totalProcessingTime;
+    bool     isRenderingTimeLimitExceeded;
+};
+
+struct FinalMixInfo
+{
+    bool  isUsed;
+    int   bufferCount;
+    int   bufferOffset;                 //!<  First mix buffer owned by this mix.
+    float volume;
+    float previousVolume;
+};
+
+struct SubMixInfo
+{
+    bool          isUsed;
+    int           bufferCount;
+    int           bufferOffset;
+    float         volume;
+    float         previousVolume;
+    FinalMixInfo* pDestinationFinalMix;
+    SubMixInfo*   pDestinationSubMix;
+    float*        pMixVolume;           //!<  [bufferCount][MixBufferCountMax]
+    float*        pPreviousMixVolume;
+};
+
+enum EffectType
+{
+    EffectType_BufferMixer,
+    EffectType_ConvolutionReverb,
+};
+
+struct BufferMixerInfo
+{
+    int           channelCount;
+    int8_t        input[BufferMixerChannelCountMax];
+    int8_t        output[BufferMixerChannelCountMax];
+    float         volume[BufferMixerChannelCountMax];
+};
+
+struct ConvolutionReverbInfo
+{
+    int           channelCountMax;
+    int           channelCount;
+    int8_t        input[ConvolutionReverbChannelCountMax];
+    int8_t        output[ConvolutionReverbChannelCountMax];
+    float         dryGain;
+    float         previousDryGain;
+    float         wetGain;
+    float         previousWetGain;
+    bool          isEnabled;
+    bool          isCleared;            //!<  The convolvers were reset since the reverb was disabled.
+    AudioDsp::PartitionedConvolver* pConvolvers;  //!<  [channelCountMax], in the buffer passed to AddConvolutionReverb().
+};
+
+//!<  One of the effectCount slots. Slots are taken in order and never freed, so the slot order is the order of processing.
+struct EffectInfo
+{
+    bool          isUsed;
+    EffectType    type;
+    FinalMixInfo* pFinalMix;
+    BufferMixerInfo bufferMixer;
+    ConvolutionReverbInfo convolutionReverb;
+};
+
+struct DeviceSinkInfo
+{
+    bool          isUsed;
+    FinalMixInfo* pFinalMix;
+    int           channelCount;
+    int8_t        input[DeviceSinkChannelCountMax];
+    char          name[32];
+    ISinkBackend* pBackend;
+};
+
+struct QueuedWaveBuffer
+{
+    WaveBuffer        waveBuffer;       //!<  Copy taken at append time.
+    const WaveBuffer* pUserWaveBuffer;  //!<  Returned by GetReleasedWaveBuffer().
+};
+
+struct VoiceInfo
+{
+    bool                 isUsed;
+    int                  sampleRate;
+    int                  channelCount;
+    SampleFormat         sampleFormat;
+    AdpcmParameter       adpcmParameter;
+    int                  priority;
+    VoiceType::PlayState playState;
+    float                volume;
+    float                previousVolume;
+    float                pitch;
+    BiquadFilterParameter biquad[VoiceBiquadFilterCountMax];
+    AudioDsp::BiquadBlockSection biquadSection[VoiceBiquadFilterCountMax];  //!<  biquad prepared for block processing.
+    float                biquadState[VoiceBiquadFilterCountMax][VoiceChannelCountMax][4];
+
+    FinalMixInfo*        pDestinationFinalMix;
+    SubMixInfo*          pDestinationSubMix;
+    float                mixVolume[VoiceChannelCountMax][MixBufferCountMax];
+    float                previousMixVolume[VoiceChannelCountMax][MixBufferCountMax];
+
+    QueuedWaveBuffer     queue[VoiceWaveBufferCountMax];
+    int                  queueHead;
+    int                  queueCount;
+    int32_t              currentOffset; //!<  Absolute sample offset in the head wave buffer.
+    bool                 isHeadStarted;
+    const WaveBuffer*    released[VoiceWaveBufferCountMax];
+    int                  releasedHead;
+    int                  releasedCount;
+
+    AdpcmContext         adpcmContext;
+
+    NodeId               nodeId;
+    SrcQuality           srcQuality;
+    uint32_t             fraction;      //!<  Q16 sub-sample position.
+    float                carry[VoiceChannelCountMax][SrcCarryCountMax];
+    int                  carryCount;
+    int64_t              playedSampleCount;
+};
+
+struct ConfigInfo
+{
+    AudioRendererParameter parameter;
+    FinalMixInfo    finalMix;
+    SubMixInfo*     pSubMixes;
+    VoiceInfo*      pVoices;
+    EffectInfo*     pEffects;
+    DeviceSinkInfo* pDeviceSinks;
+    int             usedMixBufferCount;
+    uint8_t*        pPerformanceBuffer;
+    std::size_t     performanceBufferSize;
+    std::size_t     performanceFrameOffset; //!<  Of the next frame to write.
+    const FinalMixInfo* pPerformanceDetailTarget;
+};
+
+struct RendererInfo
+{
+    AudioRendererParameter parameter;
+    ConfigInfo* pConfig;
+    bool        isStarted;
+    int64_t     elapsedFrameCount;
+    float*      pMixBuffers;            //!<  [mixBufferCount][sampleCount]
+    float*      pSourceScratch;         //!<  [VoiceChannelCountMax][sourceScratchCount]
+    int         sourceScratchCount;
+    float*      pVoiceScratch;          //!<  [VoiceChannelCountMax][sampleCount]
+    int16_t*    pPcmScratch;            //!<  Interleaved decode and sink staging.
+    int         pcmScratchCount;
+    AudioDsp::PolyphaseFilter* pSrcFilters;  //!<  [SrcFilterCount]
+    SubMixInfo** pSubMixOrder;
+};
+
+namespace {
+
+/**
+* @brief  Bump allocator over a caller-supplied work buffer.
+*
+*  With a null base it only measures, which lets the Get*WorkBufferSize() functions share
+*  the carving code with initialization.
+*/
+class WorkBufferCarver
+{
+public:
+    WorkBufferCarver(void* base, std::size_t size)
+        : m_Base(static_cast<char*>(base))
+        , m_Size(size)
+        , m_Offset(0)
+    {
+    }
+
+    template <typename T>
+    T* Carve(std::size_t count, std::size_t alignment = 16)
+    {
+        std::size_t start = (m_Offset + alignment - 1) & ~(alignment - 1);
+        if (m_Base != nullptr)
+        {
+            // Align the real address, not just the offset.
+            const uintptr_t address = reinterpret_cast<uintptr_t>(m_Base) + m_Offset;
+            start = m_Offset + (((address + alignment - 1) & ~(alignment - 1)) - address);
+        }
+        m_Offset = start + sizeof(T) * count;
+        if (m_Base == nullptr || m_Offset > m_Size)
+        {
+            return nullptr;
+        }
+        return reinterpret_cast<T*>(m_Base + start);
+    }
+
+    std::size_t GetUsedSize() const
+    {
+        // Leave room for aligning an arbitrary base address.
+        return m_Offset + 64;
+    }
+
+    bool IsOverflowed() const
+    {
+        return m_Base != nullptr && m_Offset > m_Size;
+    }
+
+private:
+    char*       m_Base;
+    std::size_t m_Size;
+    std::size_t m_Offset;
+};
+
+NodeId MakeNodeId(PerformanceEntryType type, int index)
+{
+    return static_cast<NodeId>(type) << 28 | static_cast<NodeId>(index);
+}
+
+int GetPerformanceEntryCountMax(const AudioRendererParameter& parameter)
+{
+    return parameter.voiceCount + parameter.subMixCount + 1 + parameter.sinkCount;
+}
+
+std::size_t GetPerformanceDetailOffset(const AudioRendererParameter& parameter)
+{
+    return sizeof(PerformanceFrameHeader) + sizeof(PerformanceEntry) * GetPerformanceEntryCountMax(parameter);
+}
+
+std::size_t GetPerformanceFrameSize(const AudioRendererParameter& parameter)
+{
+    const std::size_t size = GetPerformanceDetailOffset(parameter) + sizeof(PerformanceDetailEntry) * parameter.effectCount;
+    return (size + 7) & ~static_cast<std::size_t>(7);
+}
+
+/**
+* @brief  Times the nodes of one audio frame into the performance buffer of the config.
+*
+*  Without a performance buffer, or once it is full, it neither reads the clock nor writes anything.
+*/
+class PerformanceRecorder
+{
+public:
+    PerformanceRecorder(ConfigInfo* pConfig, const AudioRendererParameter& parameter)
+        : m_pConfig(pConfig)
+        , m_pHeader(nullptr)
+        , m_pEntries(nullptr)
+        , m_pDetails(nullptr)
+        , m_FrameSize(GetPerformanceFrameSize(parameter))
+        , m_Budget(1.0e6f * parameter.sampleCount / parameter.sampleRate)
+    {
+        if (pConfig->pPerformanceBuffer == nullptr || pConfig->performanceFrameOffset + m_FrameSize > pConfig->performanceBufferSize)
+        {
+            return;
+        }
+        uint8_t* pFrame = pConfig->pPerformanceBuffer + pConfig->performanceFrameOffset;
+        m_pHeader = reinterpret_cast<PerformanceFrameHeader*>(pFrame);
+        m_pHeader->magic = PerformanceFrameMagic;
+        m_pHeader->frameSize = static_cast<uint32_t>(m_FrameSize);
+        m_pHeader->detailOffset = static_cast<uint32_t>(GetPerformanceDetailOffset(parameter));
+        m_pHeader->entryCount = 0;
+        m_pHeader->detailCount = 0;
+        m_pEntries = reinterpret_cast<PerformanceEntry*>(pFrame + sizeof(PerformanceFrameHeader));
+        m_pDetails = reinterpret_cast<PerformanceDetailEntry*>(pFrame + m_pHeader->detailOffset);
+        m_Start = std::chrono::steady_clock::now();
+    }
+
+    //!<  Microseconds since the start of the frame.
+    float GetTime() const
+    {
+        return m_pHeader != nullptr ? std::chrono::duration<float, std::micro>(std::chrono::steady_clock::now() - m_Start).count() : 0.0f;
+    }
+
+    bool IsDetailTarget(const FinalMixInfo* pFinalMix) const
+    {
+        return m_pHeader != nullptr && m_pConfig->pPerformanceDetailTarget == pFinalMix;
+    }
+
+    //!<  Adds an entry for a node that started processing at startTime and ends now.
+    void AddEntry(NodeId nodeId, PerformanceEntryType type, float startTime)
+    {
+        if (m_pHeader != nullptr)
+        {
+            PerformanceEntry& entry = m_pEntries[m_pHeader->entryCount++];
+            entry.nodeId = nodeId;
+            entry.startTime = startTime;
+            entry.processingTime = GetTime() - startTime;
+            entry.entryType = static_cast<int8_t>(type);
+        }
+    }
+
+    void AddDetailEntry(NodeId nodeId, PerformanceDetailType type, PerformanceEntryType parentType, float startTime)
+    {
+        if (m_pHeader != nullptr)
+        {
+            PerformanceDetailEntry& entry = m_pDetails[m_pHeader->detailCount++];
+            entry.nodeId = nodeId;
+            entry.startTime = startTime;
+            entry.processingTime = GetTime() - startTime;
+            entry.detailType = static_cast<int8_t>(type);
+            entry.parentEntryType = static_cast<int8_t>(parentType);
+        }
+    }
+
+    void EndFrame()
+    {
+        if (m_pHeader == nullptr)
+        {
+            return;
+        }
+        m_pHeader->totalProcessingTime = GetTime();
+        m_pHeader->isRenderingTimeLimitExceeded = m_pHeader->totalProcessingTime > m_Budget;
+
+        // Terminate the frames written so far.
+        m_pConfig->performanceFrameOffset += m_FrameSize;
+        if (m_pConfig->performanceFrameOffset + sizeof(PerformanceFrameHeader) <= m_pConfig->performanceBufferSize)
+        {
+            reinterpret_cast<PerformanceFrameHeader*>(m_pConfig->pPerformanceBuffer + m_pConfig->performanceFrameOffset)->magic = 0;
+        }
+    }
+
+private:
+    ConfigInfo* m_pConfig;
+    PerformanceFrameHeader* m_pHeader;
+    PerformanceEntry* m_pEntries;
+    PerformanceDetailEntry* m_pDetails;
+    std::size_t m_FrameSize;
+    float m_Budget;
+    std::chrono::steady_clock::time_point m_Start;
+};
+
+int GetSourceScratchCount(const AudioRendererParameter& parameter)
+{
+    // Worst case: highest voice rate at the highest pitch, plus the polyphase filter carry.
+    const double ratio = static_cast<double>(VoiceType::GetPitchMax()) * VoiceSampleRateMax / parameter.sampleRate;
+    return static_cast<int>(parameter.sampleCount * ratio) + SrcCarryCountMax + 8;
+}
+
+// Rounding the cutoff down to a band keeps aliasing out at the cost of a little treble.
+int GetSrcFilterIndex(double ratio)
+{
+    const int index = ratio > 1.0 ? static_cast<int>(std::ceil((1.0 - 1.0 / ratio) * SrcFilterCount)) : 0;
+    return index < SrcFilterCount - 1 ? index : SrcFilterCount - 1;
+}
+
+// Input samples the resampler reads before the interpolation position.
+int GetSrcDelay(SrcQuality quality)
+{
+    return quality == SrcQuality_High ? AudioDsp::ResamplerDelay : 0;
+}
+
+int GetSrcTapCount(SrcQuality quality)
+{
+    return quality == SrcQuality_High ? AudioDsp::ResamplerTapCount : 2;
+}
+
+// A voice starts from silence, one sample behind the first sample it plays, as linear interpolation always has.
+void ResetVoiceSrc(VoiceInfo* pVoice)
+{
+    pVoice->fraction = 0;
+    pVoice->carryCount = GetSrcDelay(pVoice->srcQuality) + 1;
+    std::memset(pVoice->carry, 0, sizeof(pVoice->carry));
+}
+
+void CarveRenderer(WorkBufferCarver* pCarver, RendererInfo** ppRenderer, const AudioRendererParameter& parameter)
+{
+    RendererInfo* pRenderer = pCarver->Carve<RendererInfo>(1);
+    const int sourceScratchCount = GetSourceScratchCount(parameter);
+    const int pcmScratchCount = sourceScratchCount * VoiceChannelCountMax;
+    float* pMixBuffers = pCarver->Carve<float>(static_cast<std::size_t>(parameter.mixBufferCount) * parameter.sampleCount, 64);
+    float* pSourceScratch = pCarver->Carve<float>(static_cast<std::size_t>(VoiceChannelCountMax) * sourceScratchCount, 64);
+    float* pVoiceScratch = pCarver->Carve<float>(static_cast<std::size_t>(VoiceChannelCountMax) * parameter.sampleCount, 64);
+    int16_t* pPcmScratch = pCarver->Carve<int16_t>(pcmScratchCount, 64);
+    SubMixInfo** pSubMixOrder = pCarver->Carve<SubMixInfo*>(parameter.subMixCount > 0 ? parameter.subMixCount : 1);
+    AudioDsp::PolyphaseFilter* pSrcFilters = pCarver->Carve<AudioDsp::PolyphaseFilter>(SrcFilterCount, 64);
+
+    if (pRenderer != nullptr)
+    {
+        new (pRenderer) RendererInfo();
+        pRenderer->parameter = parameter;
+        pRenderer->pMixBuffers = pMixBuffers;
+        pRenderer->pSourceScratch = pSourceScratch;
+        pRenderer->sourceScratchCount = sourceScratchCount;
+        pRenderer->pVoiceScratch = pVoiceScratch;
+        pRenderer->pPcmScratch = pPcmScratch;
+        pRenderer->pcmScratchCount = pcmScratchCount;
+        pRenderer->pSubMixOrder = pSubMixOrder;
+        pRenderer->pSrcFilters = pSrcFilters;
+        for (int i = 0; i < SrcFilterCount; ++i)
+        {
+            AudioDsp::DesignPolyphaseFilter(&pSrcFilters[i], AudioDsp::GetResamplerCutoff(static_cast<double>(SrcFilterCount) / (SrcFilterCount - i)));
+        }
+    }
+    *ppRenderer = pRenderer;
+}
+
+void CarveConfig(WorkBufferCarver* pCarver, ConfigInfo** ppConfig, const AudioRendererParameter& parameter)
+{
+    ConfigInfo* pConfig = pCarver->Carve<ConfigInfo>(1);
+    SubMixInfo* pSubMixes = pCarver->Carve<SubMixInfo>(parameter.subMixCount);
+    float* pSubMixVolumes = pCarver->Carve<float>(static_cast<std::size_t>(parameter.mixBufferCount) * MixBufferCountMax * 2);
+    VoiceInfo* pVoices = pCarver->Carve<VoiceInfo>(parameter.voiceCount);
+    EffectInfo* pEffects = pCarver->Carve<EffectInfo>(parameter.effectCount);
+    DeviceSinkInfo* pDeviceSinks = pCarver->Carve<DeviceSinkInfo>(parameter.sinkCount);
+
+    if (pConfig != nullptr)
+    {
+        new (pConfig) ConfigInfo();
+        pConfig->parameter = parameter;
+        pConfig->pSubMixes = pSubMixes;
+        pConfig->pVoices = pVoices;
+        pConfig->pEffects = pEffects;
+        pConfig->pDeviceSinks = pDeviceSinks;
+        std::memset(pSubMixes, 0, sizeof(SubMixInfo) * parameter.subMixCount);
+        std::memset(pVoices, 0, sizeof(VoiceInfo) * parameter.voiceCount);
+        std::memset(pEffects, 0, sizeof(EffectInfo) * parameter.effectCount);
+        std::memset(pDeviceSinks, 0, sizeof(DeviceSinkInfo) * parameter.sinkCount);
+        std::memset(pSubMixVolumes, 0, sizeof(float) * parameter.mixBufferCount * MixBufferCountMax * 2);
+
+        // Each sub mix gets room for its volume matrices up front; rows are handed out by AcquireSubMix().
+        for (int i = 0; i < parameter.subMixCount; ++i)
+        {
+            pSubMixes[i].pMixVolume = pSubMixVolumes;
+            pSubMixes[i].pPreviousMixVolume = pSubMixVolumes + parameter.mixBufferCount * MixBufferCountMax;
+        }
+    }
+    *ppConfig = pConfig;
+}
+
+float* GetMixBuffer(RendererInfo* pRenderer, int index)
+{
+    return pRenderer->pMixBuffers + static_cast<std::size_t>(index) * pRenderer->parameter.sampleCount;
+}
+
+int GetDestinationBufferOffset(const VoiceInfo* pVoice)
+{
+    if (pVoice->pDestinationFinalMix != nullptr)
+    {
+        return pVoice->pDestinationFinalMix->bufferOffset;
+    }
+    if (pVoice->pDestinationSubMix != nullptr)
+    {
+        return pVoice->pDestinationSubMix->bufferOffset;
+    }
+    return -1;
+}
+
+int GetDestinationBufferCount(const VoiceInfo* pVoice)
+{
+    if (pVoice->pDestinationFinalMix != nullptr)
+    {
+        return pVoice->pDestinationFinalMix->bufferCount;
+    }
+    if (pVoice->pDestinationSubMix != nullptr)
+    {
+        return pVoice->pDestinationSubMix->bufferCount;
+    }
+    return 0;
+}
+
+void ResetVoiceDecoder(VoiceInfo* pVoice, const WaveBuffer& waveBuffer)
+{
+    pVoice->currentOffset = waveBuffer.startSampleOffset;
+    if (pVoice->sampleFormat == SampleFormat_Adpcm)
+    {
+        if (waveBuffer.pContext != nullptr && waveBuffer.contextSize >= sizeof(AdpcmContext))
+        {
+            pVoice->adpcmContext = *static_cast<const AdpcmContext*>(waveBuffer.pContext);
+        }
+        else
+        {
+            std::memset(&pVoice->adpcmContext, 0, sizeof(pVoice->adpcmContext));
+        }
+    }
+}
+
+void ReleaseHeadWaveBuffer(VoiceInfo* pVoice)
+{
+    QueuedWaveBuffer& head = pVoice->queue[pVoice->queueHead];
+    const bool isEndOfStream = head.waveBuffer.isEndOfStream;
+    pVoice->released[(pVoice->releasedHead + pVoice->releasedCount) % VoiceWaveBufferCountMax] = head.pUserWaveBuffer;
+    ++pVoice->releasedCount;
+    pVoice->queueHead = (pVoice->queueHead + 1) % VoiceWaveBufferCountMax;
+    --pVoice->queueCount;
+    pVoice->isHeadStarted = false;
+    if (isEndOfStream)
+    {
+        pVoice->playState = VoiceType::PlayState_Stop;
+    }
+}
+
+/**
+* @brief  Pulls count source samples per channel out of the wave buffer queue.
+*
+*  Handles looping, releasing consumed buffers and end of stream. Missing samples are zero-filled.
+*/
+void ReadSourceSamples(RendererInfo* pRenderer, VoiceInfo* pVoice, float* const* pOut, int count)
+{
+    int written = 0;
+    while (written < count)
+    {
+        if (pVoice->queueCount == 0 || pVoice->playState != VoiceType::PlayState_Play)
+        {
+            for (int ch = 0; ch < pVoice->channelCount; ++ch)
+            {
+                ClearSamples(pOut[ch] + written, count - written);
+            }
+            return;
+        }
+
+        QueuedWaveBuffer& head = pVoice->queue[pVoice->queueHead];
+        const WaveBuffer& waveBuffer = head.waveBuffer;
+        if (!pVoice->isHeadStarted)
+        {
+            ResetVoiceDecoder(pVoice, waveBuffer);
+            pVoice->isHeadStarted = true;
+        }
+
+        const int32_t remaining = waveBuffer.endSampleOffset - pVoice->currentOffset;
+        if (remaining <= 0)
+        {
+            if (waveBuffer.loop)
+            {
+                ResetVoiceDecoder(pVoice, waveBuffer);
+                if (waveBuffer.endSampleOffset <= waveBuffer.startSampleOffset)
+                {
+                    // An empty looping buffer would spin forever.
+                    ReleaseHeadWaveBuffer(pVoice);
+                }
+                continue;
+            }
+            ReleaseHeadWaveBuffer(pVoice);
+            continue;
+        }
+
+        const int chunk = static_cast<int>(remaining < count - written ? remaining : count - written);
+        const int pcmChunkMax = pRenderer->pcmScratchCount / pVoice->channelCount;
+        const int step = chunk < pcmChunkMax ? chunk : pcmChunkMax;
+        float* pChannels[VoiceChannelCountMax];
+        for (int ch = 0; ch < pVoice->channelCount; ++ch)
+        {
+            pChannels[ch] = pOut[ch] + written;
+        }
+
+        if (pVoice->sampleFormat == SampleFormat_PcmInt16)
+        {
+            const int16_t* pSamples = static_cast<const int16_t*>(waveBuffer.buffer) + static_cast<std::size_t>(pVoice->currentOffset) * pVoice->channelCount;
+            DeinterleaveInt16ToFloat(pChannels, pSamples, pVoice->channelCount, step);
+        }
+        else
+        {
+            AudioDsp::DecodeAdpcm(pRenderer->pPcmScratch, waveBuffer.buffer, waveBuffer.size, pVoice->currentOffset, step, pVoice->adpcmParameter, &pVoice->adpcmContext);
+            ConvertInt16ToFloat(pChannels[0], pRenderer->pPcmScratch, step);
+        }
+
+        pVoice->currentOffset += step;
+        pVoice->playedSampleCount += step;
+        written += step;
+    }
+}
+
+void RenderVoice(RendererInfo* pRenderer, VoiceInfo* pVoice)
+{
+    const int sampleCount = pRenderer->parameter.sampleCount;
+    const int destinationOffset = GetDestinationBufferOffset(pVoice);
+    const int destinationCount = GetDestinationBufferCount(pVoice);
+    if (destinationOffset < 0)
+    {
+        return;
+    }
+
+    // Position bookkeeping: source[0 .. carryCount) are samples decoded in earlier frames.
+    const double ratio = static_cast<double>(pVoice->pitch) * pVoice->sampleRate / pRenderer->parameter.sampleRate;
+    uint32_t step = static_cast<uint32_t>(ratio * 65536.0 + 0.5);
+    step = step == 0 ? 1 : step;
+    const uint64_t lastPosition = pVoice->fraction + static_cast<uint64_t>(step) * (sampleCount - 1);
+    const uint64_t endPosition = pVoice->fraction + static_cast<uint64_t>(step) * sampleCount;
+    const int consumed = static_cast<int>(endPosition >> 16);
+    const int tapCount = GetSrcTapCount(pVoice->srcQuality);
+    int needed = static_cast<int>(lastPosition >> 16) + tapCount;
+    needed = needed > consumed + tapCount - 1 ? needed : consumed + tapCount - 1;
+    if (needed > pRenderer->sourceScratchCount)
+    {
+        needed = pRenderer->sourceScratchCount;
+    }
+
+    float* pSource[VoiceChannelCountMax];
+    float* pVoiceOut[VoiceChannelCountMax];
+    for (int ch = 0; ch < pVoice->channelCount; ++ch)
+    {
+        pSource[ch] = pRenderer->pSourceScratch + static_cast<std::size_t>(ch) * pRenderer->sourceScratchCount;
+        pVoiceOut[ch] = pRenderer->pVoiceScratch + static_cast<std::size_t>(ch) * sampleCount;
+        for (int i = 0; i < pVoice->carryCount; ++i)
+        {
+            pSource[ch][i] = pVoice->carry[ch][i];
+        }
+    }
+
+    float* pDecodeTarget[VoiceChannelCountMax];
+    for (int ch = 0; ch < pVoice->channelCount; ++ch)
+    {
+        pDecodeTarget[ch] = pSource[ch] + pVoice->carryCount;
+    }
+    ReadSourceSamples(pRenderer, pVoice, pDecodeTarget, needed - pVoice->carryCount);
+
+    // At the renderer rate and pitch 1.0 the linear path is a plain copy, which also spares the polyphase filter's cost and its roll-off.
+    const bool isPolyphase = pVoice->srcQuality == SrcQuality_High && !(step == 0x10000 && pVoice->fraction == 0);
+    const AudioDsp::PolyphaseFilter& srcFilter = pRenderer->pSrcFilters[GetSrcFilterIndex(ratio)];
+    const int srcDelay = GetSrcDelay(pVoice->srcQuality);
+    for (int ch = 0; ch < pVoice->channelCount; ++ch)
+    {
+        if (isPolyphase)
+        {
+            AudioDsp::ResamplePolyphase(pVoiceOut[ch], sampleCount, pSource[ch], static_cast<uint64_t>(pVoice->fraction) << 16, static_cast<uint64_t>(step) << 16, srcFilter);
+        }
+        else
+        {
+            ResampleLinear(pVoiceOut[ch], sampleCount, pSource[ch] + srcDelay, pVoice->fraction, step);
+        }
+
+        for (int f = 0; f < VoiceBiquadFilterCountMax; ++f)
+        {
+            if (pVoice->biquad[f].enable)
+            {
+                AudioDsp::ProcessBiquadBlock(pVoiceOut[ch], sampleCount, pVoice->biquadSection[f], pVoice->biquadState[f][ch]);
+            }
+        }
+
+        // Keep what the next frame starts from.
+        const int carryCount = needed - consumed;
+        for (int i = 0; i < carryCount; ++i)
+        {
+            pVoice->carry[ch][i] = pSource[ch][consumed + i];
+        }
+    }
+    pVoice->carryCount = needed - consumed;
+    pVoice->fraction = static_cast<uint32_t>(endPosition & 0xffff);
+
+    for (int ch = 0; ch < pVoice->channelCount; ++ch)
+    {
+        for (int d = 0; d < destinationCount; ++d)
+        {
+            const float start = pVoice->previousVolume * pVoice->previousMixVolume[ch][d];
+            const float end = pVoice->volume * pVoice->mixVolume[ch][d];
+            if (start != 0.0f || end != 0.0f)
+            {
+                MixRamp(GetMixBuffer(pRenderer, destinationOffset + d), pVoiceOut[ch], start, end, sampleCount);
+            }
+            pVoice->previousMixVolume[ch][d] = pVoice->mixVolume[ch][d];
+        }
+    }
+    pVoice->previousVolume = pVoice->volume;
+}
+
+int GetSubMixDepth(const SubMixInfo* pSubMix, int limit)
+{
+    int depth = 0;
+    while (pSubMix != nullptr && depth <= limit)
+    {
+        pSubMix = pSubMix->pDestinationSubMix;
+        ++depth;
+    }
+    return depth;
+}
+
+void RenderSubMixes(RendererInfo* pRenderer, ConfigInfo* pConfig, PerformanceRecorder* pRecorder)
+{
+    const int sampleCount = pRenderer->parameter.sampleCount;
+    const int subMixCount = pConfig->parameter.subMixCount;
+
+    // Sub mixes further from the final mix render first so their output is complete when their destination renders.
+    int orderCount = 0;
+    for (int i = 0; i < subMixCount; ++i)
+    {
+        if (!pConfig->pSubMixes[i].isUsed)
+        {
+            continue;
+        }
+        SubMixInfo* pSubMix = &pConfig->pSubMixes[i];
+        const int depth = GetSubMixDepth(pSubMix, subMixCount);
+        int position = orderCount;
+        while (position > 0 && GetSubMixDepth(pRenderer->pSubMixOrder[position - 1], subMixCount) < depth)
+        {
+            pRenderer->pSubMixOrder[position] = pRenderer->pSubMixOrder[position - 1];
+            --position;
+        }
+        pRenderer->pSubMixOrder[position] = pSubMix;
+        ++orderCount;
+    }
+
+    for (int i = 0; i < orderCount; ++i)
+    {
+        SubMixInfo* pSubMix = pRenderer->pSubMixOrder[i];
+        int destinationOffset = -1;
+        int destinationCount = 0;
+        if (pSubMix->pDestinationFinalMix != nullptr)
+        {
+            destinationOffset = pSubMix->pDestinationFinalMix->bufferOffset;
+            destinationCount = pSubMix->pDestinationFinalMix->bufferCount;
+        }
+        else if (pSubMix->pDestinationSubMix != nullptr)
+        {
+            destinationOffset = pSubMix->pDestinationSubMix->bufferOffset;
+            destinationCount = pSubMix->pDestinationSubMix->bufferCount;
+        }
+        if (destinationOffset < 0)
+        {
+            continue;
+        }
+
+        const float startTime = pRecorder->GetTime();
+        for (int s = 0; s < pSubMix->bufferCount; ++s)
+        {
+            const float* pSource = GetMixBuffer(pRenderer, pSubMix->bufferOffset + s);
+            for (int d = 0; d < destinationCount; ++d)
+            {
+                float& mixVolume = pSubMix->pMixVolume[s * MixBufferCountMax + d];
+                float& previousMixVolume = pSubMix->pPreviousMixVolume[s * MixBufferCountMax + d];
+                const float start = pSubMix->previousVolume * previousMixVolume;
+                const float end = pSubMix->volume * mixVolume;
+                if (start != 0.0f || end != 0.0f)
+                {
+                    MixRamp(GetMixBuffer(pRenderer, destinationOffset + d), pSource, start, end, sampleCount);
+                }
+                previousMixVolume = mixVolume;
+            }
+        }
+        pSubMix->previousVolume = pSubMix->volume;
+        pRecorder->AddEntry(MakeNodeId(PerformanceEntryType_SubMix, static_cast<int>(pSubMix - pConfig->pSubMixes)), PerformanceEntryType_SubMix, startTime);
+    }
+}
+
+void RenderBufferMixer(RendererInfo* pRenderer, const FinalMixInfo* pFinalMix, const BufferMixerInfo& mixer)
+{
+    for (int ch = 0; ch < mixer.channelCount; ++ch)
+    {
+        Mix(GetMixBuffer(pRenderer, pFinalMix->bufferOffset + mixer.output[ch]),
+            GetMixBuffer(pRenderer, pFinalMix->bufferOffset + mixer.input[ch]),
+            mixer.volume[ch], pRenderer->parameter.sampleCount);
+    }
+}
+
+void RenderConvolutionReverb(RendererInfo* pRenderer, const FinalMixInfo* pFinalMix, ConvolutionReverbInfo* pReverb)
+{
+    const int sampleCount = pRenderer->parameter.sampleCount;
+    if (!pReverb->isEnabled)
+    {
+        for (int ch = 0; ch < pReverb->channelCount; ++ch)
+        {
+            const float* pInput = GetMixBuffer(pRenderer, pFinalMix->bufferOffset + pReverb->input[ch]);
+            float* pOutput = GetMixBuffer(pRenderer, pFinalMix->bufferOffset + pReverb->output[ch]);
+            if (pOutput != pInput)
+            {
+                std::memcpy(pOutput, pInput, sizeof(float) * sampleCount);
+            }
+        }
+        if (!pReverb->isCleared)
+        {
+            for (int ch = 0; ch < pReverb->channelCountMax; ++ch)
+            {
+                pReverb->pConvolvers[ch].Reset();
+            }
+            pReverb->isCleared = true;
+        }
+        return;
+    }
+
+    // Stage the dry and wet signal of every channel before writing any output, in case an output is another channel's input.
+    float* pDry = pRenderer->pSourceScratch;
+    float* pWet = pRenderer->pVoiceScratch;
+    for (int ch = 0; ch < pReverb->channelCount; ++ch)
+    {
+        const float* pInput = GetMixBuffer(pRenderer, pFinalMix->bufferOffset + pReverb->input[ch]);
+        std::memcpy(pDry + ch * sampleCount, pInput, sizeof(float) * sampleCount);
+        pReverb->pConvolvers[ch].Process(pWet + ch * sampleCount, pInput);
+    }
+    for (int ch = 0; ch < pReverb->channelCount; ++ch)
+    {
+        float* pOutput = GetMixBuffer(pRenderer, pFinalMix->bufferOffset + pReverb->output[ch]);
+        std::memcpy(pOutput, pDry + ch * sampleCount, sizeof(float) * sampleCount);
+        ApplyGainRamp(pOutput, pReverb->previousDryGain, pReverb->dryGain, sampleCount);
+        MixRamp(pOutput, pWet + ch * sampleCount, pReverb->previousWetGain, pReverb->wetGain, sampleCount);
+    }
+    pReverb->isCleared = false;
+    pReverb->previousDryGain = pReverb->dryGain;
+    pReverb->previousWetGain = pReverb->wetGain;
+}
+
+void RenderFinalMix(RendererInfo* pRenderer, ConfigInfo* pConfig, PerformanceRecorder* pRecorder)
+{
+    const int sampleCount = pRenderer->parameter.sampleCount;
+    FinalMixInfo* pFinalMix = &pConfig->finalMix;
+    if (!pFinalMix->isUsed)
+    {
+        return;
+    }
+
+    const NodeId nodeId = MakeNodeId(PerformanceEntryType_FinalMix, 0);
+    const bool isDetailTarget = pRecorder->IsDetailTarget(pFinalMix);
+    const float startTime = pRecorder->GetTime();
+
+    if (pFinalMix->volume != 1.0f || pFinalMix->previousVolume != 1.0f)
+    {
+        for (int i = 0; i < pFinalMix->bufferCount; ++i)
+        {
+            ApplyGainRamp(GetMixBuffer(pRenderer, pFinalMix->bufferOffset + i), pFinalMix->previousVolume, pFinalMix->volume, sampleCount);
+        }
+    }
+    pFinalMix->previousVolume = pFinalMix->volume;
+
+    for (int i = 0; i < pConfig->parameter.effectCount; ++i)
+    {
+        EffectInfo& effect = pConfig->pEffects[i];
+        if (!effect.isUsed)
+        {
+            continue;
+        }
+        const float effectStartTime = isDetailTarget ? pRecorder->GetTime() : 0.0f;
+        PerformanceDetailType detailType = PerformanceDetailType_Unknown;
+        switch (effect.type)
+        {
+        case EffectType_BufferMixer:
+            RenderBufferMixer(pRenderer, pFinalMix, effect.bufferMixer);
+            detailType = PerformanceDetailType_BufferMixer;
+            break;
+        case EffectType_ConvolutionReverb:
+            RenderConvolutionReverb(pRenderer, pFinalMix, &effect.convolutionReverb);
+            detailType = PerformanceDetailType_ConvolutionReverb;
+            break;
+        default:
+            break;
+        }
+        if (isDetailTarget)
+        {
+            pRecorder->AddDetailEntry(nodeId, detailType, PerformanceEntryType_FinalMix, effectStartTime);
+        }
+    }
+    pRecorder->AddEntry(nodeId, PerformanceEntryType_FinalMix, startTime);
+}
+
+// The time of a sink covers the conversion to 16 bits but not the backend, which has no counterpart on the console.
+void RenderSinks(RendererInfo* pRenderer, const ConfigInfo* pConfig, PerformanceRecorder* pRecorder)
+{
+    const int sampleCount = pRenderer->parameter.sampleCount;
+    for (int i = 0; i < pConfig->parameter.sinkCount; ++i)
+    {
+        const DeviceSinkInfo& sink = pConfig->pDeviceSinks[i];
+        if (!sink.isUsed || sink.pBackend == nullptr)
+        {
+            continue;
+        }
+        const float startTime = pRecorder->GetTime();
+        const float* pChannels[DeviceSinkChannelCountMax];
+        for (int ch = 0; ch < sink.channelCount; ++ch)
+        {
+            pChannels[ch] = GetMixBuffer(pRenderer, sink.pFinalMix->bufferOffset + sink.input[ch]);
+        }
+        InterleaveFloatToInt16(pRenderer->pPcmScratch, pChannels, sink.channelCount, sampleCount);
+        pRecorder->AddEntry(MakeNodeId(PerformanceEntryType_Sink, i), PerformanceEntryType_Sink, startTime);
+        sink.pBackend->Write(pRenderer->pPcmScratch, sampleCount, sink.channelCount);
+    }
+}
+
+bool AcquireMixBuffers(ConfigInfo* pConfig, int bufferCount, int* pOutOffset)
+{
+    if (bufferCount <= 0 || pConfig->usedMixBufferCount + bufferCount > pConfig->parameter.mixBufferCount)
+    {
+        return false;
+    }
+    *pOutOffset = pConfig->usedMixBufferCount;
+    pConfig->usedMixBufferCount += bufferCount;
+    return true;
+}
+
+// Takes the first free effect slot, so effects run in the order they were added.
+EffectInfo* AcquireEffect(ConfigInfo* pConfig, EffectType type, FinalMixType* pFinalMix)
+{
+    for (int i = 0; i < pConfig->parameter.effectCount; ++i)
+    {
+        EffectInfo* pEffect = &pConfig->pEffects[i];
+        if (!pEffect->isUsed)
+        {
+            std::memset(pEffect, 0, sizeof(*pEffect));
+            pEffect->isUsed = true;
+            pEffect->type = type;
+            pEffect->pFinalMix = pFinalMix->_pMixInfo;
+            return pEffect;
+        }
+    }
+    return nullptr;
+}
+
+// Lays out the convolvers of a reverb and their work buffers. With a null base it only measures.
+AudioDsp::PartitionedConvolver* CarveConvolvers(WorkBufferCarver* pCarver, int sampleCount, int channelCountMax, int impulseSampleCountMax)
+{
+    AudioDsp::PartitionedConvolver* pConvolvers = pCarver->Carve<AudioDsp::PartitionedConvolver>(channelCountMax);
+    const std::size_t workBufferSize = AudioDsp::PartitionedConvolver::GetRequiredWorkBufferSize(sampleCount, impulseSampleCountMax);
+    for (int ch = 0; ch < channelCountMax; ++ch)
+    {
+        void* workBuffer = pCarver->Carve<char>(workBufferSize);
+        if (pConvolvers != nullptr && workBuffer != nullptr)
+        {
+            new (&pConvolvers[ch]) AudioDsp::PartitionedConvolver();
+            pConvolvers[ch].Initialize(workBuffer, workBufferSize, sampleCount, impulseSampleCountMax);
+        }
+    }
+    return pConvolvers;
+}
+
+}  // namespace
+
+void InitializeAudioRendererParameter(AudioRendererParameter* pOutParameter)
+{
+    pOutParameter->sampleRate = 48000;
+    pOutParameter->sampleCount = 240;
+    pOutParameter->mixBufferCount = 1;
+    pOutParameter->voiceCount = 1;
+    pOutParameter->subMixCount = 0;
+    pOutParameter->sinkCount = 1;
+    pOutParameter->effectCount = 0;
+    pOutParameter->performanceFrameCount = 0;
+}
+
+bool IsValidAudioRendererParameter(const AudioRendererParameter& parameter)
+{
+    return (parameter.sampleRate == 32000 || parameter.sampleRate == 48000)
+        && parameter.sampleCount == parameter.sampleRate / 200
+        && parameter.mixBufferCount > 0 && parameter.mixBufferCount <= MixBufferCountMax
+        && parameter.voiceCount > 0
+        && parameter.subMixCount >= 0
+        && parameter.sinkCount > 0
+        && parameter.effectCount >= 0
+        && parameter.performanceFrameCount >= 0;
+}
+
+std::size_t GetAudioRendererWorkBufferSize(const AudioRendererParameter& parameter)
+{
+    WorkBufferCarver carver(nullptr, 0);
+    RendererInfo* pRenderer;
+    CarveRenderer(&carver, &pRenderer, parameter);
+    return carver.GetUsedSize();
+}
+
+bool OpenAudioRenderer(AudioRendererHandle* pOutHandle, const AudioRendererParameter& parameter, void* workBuffer, std::size_t workBufferSize)
+{
+    if (!IsValidAudioRendererParameter(parameter) || workBuffer == nullptr)
+    {
+        return false;
+    }
+    WorkBufferCarver carver(workBuffer, workBufferSize);
+    RendererInfo* pRenderer;
+    CarveRenderer(&carver, &pRenderer, parameter);
+    if (pRenderer == nullptr || carver.IsOverflowed())
+    {
+        return false;
+    }
+    pOutHandle->_pRenderer = pRenderer;
+    return true;
+}
+
+void CloseAudioRenderer(AudioRendererHandle handle)
+{
+    handle._pRenderer->~RendererInfo();
+}
+
+void StartAudioRenderer(AudioRendererHandle handle)
+{
+    handle._pRenderer->isStarted = true;
+}
+
+void StopAudioRenderer(AudioRendererHandle handle)
+{
+    handle._pRenderer->isStarted = false;
+}
+
+bool RequestUpdateAudioRenderer(AudioRendererHandle handle, const AudioRendererConfig* pConfig)
+{
+    const AudioRendererParameter& a = handle._pRenderer->parameter;
+    const AudioRendererParameter& b = pConfig->_pConfig->parameter;
+    if (a.voiceCount != b.voiceCount || a.subMixCount != b.subMixCount || a.mixBufferCount != b.mixBufferCount
+        || a.effectCount != b.effectCount || a.sinkCount != b.sinkCount)
+    {
+        return false;
+    }
+    handle._pRenderer->pConfig = pConfig->_pConfig;
+    return true;
+}
+
+void ProcessAudioRenderer(AudioRendererHandle handle)
+{
+    RendererInfo* pRenderer = handle._pRenderer;
+    ConfigInfo* pConfig = pRenderer->pConfig;
+    if (!pRenderer->isStarted || pConfig == nullptr)
+    {
+        return;
+    }
+
+    PerformanceRecorder recorder(pConfig, pRenderer->parameter);
+    const int sampleCount = pRenderer->parameter.sampleCount;
+    ClearSamples(pRenderer->pMixBuffers, pRenderer->parameter.mixBufferCount * sampleCount);
+
+    for (int i = 0; i < pConfig->parameter.voiceCount; ++i)
+    {
+        VoiceInfo* pVoice = &pConfig->pVoices[i];
+        if (pVoice->isUsed && pVoice->playState == VoiceType::PlayState_Play)
+        {
+            const float startTime = recorder.GetTime();
+            RenderVoice(pRenderer, pVoice);
+            recorder.AddEntry(pVoice->nodeId, PerformanceEntryType_Voice, startTime);
+        }
+    }
+
+    RenderSubMixes(pRenderer, pConfig, &recorder);
+    RenderFinalMix(pRenderer, pConfig, &recorder);
+    RenderSinks(pRenderer, pConfig, &recorder);
+    recorder.EndFrame();
+    ++pRenderer->elapsedFrameCount;
+}
+
+int64_t GetAudioRendererElapsedFrameCount(AudioRendererHandle handle)
+{
+    return handle._pRenderer->elapsedFrameCount;
+}
+
+PerformanceInfo::PerformanceInfo()
+    : m_pBuffer(nullptr)
+    , m_BufferSize(0)
+    , m_Offset(0)
+{
+}
+
+bool PerformanceInfo::SetBuffer(const void* buffer, std::size_t bufferSize)
+{
+    m_pBuffer = static_cast<const uint8_t*>(buffer);
+    m_BufferSize = bufferSize;
+    m_Offset = 0;
+    return m_pBuffer != nullptr && bufferSize >= sizeof(PerformanceFrameHeader)
+        && reinterpret_cast<const PerformanceFrameHeader*>(m_pBuffer)->magic == PerformanceFrameMagic;
+}
+
+bool PerformanceInfo::MoveToNextFrame()
+{
+    const std::size_t next = m_Offset + reinterpret_cast<const PerformanceFrameHeader*>(m_pBuffer + m_Offset)->frameSize;
+    if (next + sizeof(PerformanceFrameHeader) > m_BufferSize || reinterpret_cast<const PerformanceFrameHeader*>(m_pBuffer + next)->magic != PerformanceFrameMagic)
+    {
+        return false;
+    }
+    m_Offset = next;
+    return true;
+}
+
+const PerformanceEntry* PerformanceInfo::GetEntries(int* pOutCount) const
+{
+    *pOutCount = reinterpret_cast<const PerformanceFrameHeader*>(m_pBuffer + m_Offset)->entryCount;
+    return reinterpret_cast<const PerformanceEntry*>(m_pBuffer + m_Offset + sizeof(PerformanceFrameHeader));
+}
+
+const PerformanceDetailEntry* PerformanceInfo::GetDetailEntries(int* pOutCount) const
+{
+    const PerformanceFrameHeader* pHeader = reinterpret_cast<const PerformanceFrameHeader*>(m_pBuffer + m_Offset);
+    *pOutCount = pHeader->detailCount;
+    return reinterpret_cast<const PerformanceDetailEntry*>(m_pBuffer + m_Offset + pHeader->detailOffset);
+}
+
+float PerformanceInfo::GetTotalProcessingTime() const
+{
+    return reinterpret_cast<const PerformanceFrameHeader*>(m_pBuffer + m_Offset)->totalProcessingTime;
+}
+
+bool PerformanceInfo::IsRenderingTimeLimitExceeded() const
+{
+    return reinterpret_cast<const PerformanceFrameHeader*>(m_pBuffer + m_Offset)->isRenderingTimeLimitExceeded;
+}
+
+std::size_t GetRequiredBufferSizeForPerformanceFrames(const AudioRendererParameter& parameter)
+{
+    return GetPerformanceFrameSize(parameter) * parameter.performanceFrameCount;
+}
+
+void* SetPerformanceFrameBuffer(AudioRendererConfig* pConfig, void* buffer, std::size_t bufferSize)
+{
+    ConfigInfo* pInfo = pConfig->_pConfig;
+    void* pPrevious = pInfo->pPerformanceBuffer;
+    pInfo->pPerformanceBuffer = static_cast<uint8_t*>(buffer);
+    pInfo->performanceBufferSize = buffer != nullptr ? bufferSize : 0;
+    pInfo->performanceFrameOffset = 0;
+    if (pInfo->performanceBufferSize >= sizeof(PerformanceFrameHeader))
+    {
+        reinterpret_cast<PerformanceFrameHeader*>(buffer)->magic = 0;
+    }
+    return pPrevious;
+}
+
+void SetPerformanceDetailTarget(AudioRendererConfig* pConfig, const FinalMixType* pFinalMix)
+{
+    pConfig->_pConfig->pPerformanceDetailTarget = pFinalMix != nullptr ? pFinalMix->_pMixInfo : nullptr;
+}
+
+std::size_t GetAudioRendererConfigWorkBufferSize(const AudioRendererParameter& parameter)
+{
+    WorkBufferCarver carver(nullptr, 0);
+    ConfigInfo* pConfig;
+    CarveConfig(&carver, &pConfig, parameter);
+    return carver.GetUsedSize();
+}
+
+void InitializeAudioRendererConfig(AudioRendererConfig* pOutConfig, const AudioRendererParameter& parameter, void* buffer, std::size_t bufferSize)
+{
+    WorkBufferCarver carver(buffer, bufferSize);
+    CarveConfig(&carver, &pOutConfig->_pConfig, parameter);
+    if (pOutConfig->_pConfig == nullptr || carver.IsOverflowed())
+    {
+        std::abort();
+    }
+}
+
+bool AcquireFinalMix(AudioRendererConfig* pConfig, FinalMixType* pFinalMix, int bufferCount)
+{
+    ConfigInfo* pInfo = pConfig->_pConfig;
+    FinalMixInfo* pMix = &pInfo->finalMix;
+    if (pMix->isUsed || !AcquireMixBuffers(pInfo, bufferCount, &pMix->bufferOffset))
+    {
+        return false;
+    }
+    pMix->isUsed = true;
+    pMix->bufferCount = bufferCount;
+    pMix->volume = 1.0f;
+    pMix->previousVolume = 1.0f;
+    pFinalMix->_pMixInfo = pMix;
+    return true;
+}
+
+void SetFinalMixVolume(FinalMixType* pFinalMix, float volume)
+{
+    pFinalMix->_pMixInfo->volume = volume;
+}
+
+bool AcquireSubMix(AudioRendererConfig* pConfig, SubMixType* pSubMix, int sampleRate, int bufferCount)
+{
+    ConfigInfo* pInfo = pConfig->_pConfig;
+    if (sampleRate != pInfo->parameter.sampleRate)
+    {
+        return false;
+    }
+    for (int i = 0; i < pInfo->parameter.subMixCount; ++i)
+    {
+        SubMixInfo* pMix = &pInfo->pSubMixes[i];
+        if (pMix->isUsed)
+        {
+            continue;
+        }
+        if (!AcquireMixBuffers(pInfo, bufferCount, &pMix->bufferOffset))
+        {
+            return false;
+        }
+        // The shared volume matrices were carved per mix buffer; index them by this mix's first buffer.
+        pMix->pMixVolume += pMix->bufferOffset * MixBufferCountMax;
+        pMix->pPreviousMixVolume += pMix->bufferOffset * MixBufferCountMax;
+        pMix->isUsed = true;
+        pMix->bufferCount = bufferCount;
+        pMix->volume = 1.0f;
+        pMix->previousVolume = 1.0f;
+        pMix->pDestinationFinalMix = nullptr;
+        pMix->pDestinationSubMix = nullptr;
+        pSubMix->_pMixInfo = pMix;
+        return true;
+    }
+    return false;
+}
+
+void SetSubMixDestination(AudioRendererConfig* pConfig, SubMixType* pSource, FinalMixType* pDestination)
+{
+    static_cast<void>(pConfig);
+    pSource->_pMixInfo->pDestinationFinalMix = pDestination->_pMixInfo;
+    pSource->_pMixInfo->pDestinationSubMix = nullptr;
+}
+
+void SetSubMixDestination(AudioRendererConfig* pConfig, SubMixType* pSource, SubMixType* pDestination)
+{
+    static_cast<void>(pConfig);
+    pSource->_pMixInfo->pDestinationFinalMix = nullptr;
+    pSource->_pMixInfo->pDestinationSubMix = pDestination->_pMixInfo;
+}
+
+void SetSubMixMixVolume(SubMixType* pSource, FinalMixType* pDestination, float volume, int sourceIndex, int destinationIndex)
+{
+    SubMixInfo* pMix = pSource->_pMixInfo;
+    if (pMix->pDestinationFinalMix != pDestination->_pMixInfo || sourceIndex >= pMix->bufferCount || destinationIndex >= pDestination->_pMixInfo->bufferCount)
+    {
+        return;
+    }
+    pMix->pMixVolume[sourceIndex * MixBufferCountMax + destinationIndex] = volume;
+}
+
+void SetSubMixMixVolume(SubMixType* pSource, SubMixType* pDestination, float volume, int sourceIndex, int destinationIndex)
+{
+    SubMixInfo* pMix = pSource->_pMixInfo;
+    if (pMix->pDestinationSubMix != pDestination->_pMixInfo || sourceIndex >= pMix->bufferCount || destinationIndex >= pDestination->_pMixInfo->bufferCount)
+    {
+        return;
+    }
+    pMix->pMixVolume[sourceIndex * MixBufferCountMax + destinationIndex] = volume;
+}
+
+void SetSubMixVolume(SubMixType* pSubMix, float volume)
+{
+    pSubMix->_pMixInfo->volume = volume;
+}
+
+bool AddBufferMixer(AudioRendererConfig* pConfig, BufferMixerType* pMixer, FinalMixType* pFinalMix)
+{
+    EffectInfo* pEffect = AcquireEffect(pConfig->_pConfig, EffectType_BufferMixer, pFinalMix);
+    if (pEffect == nullptr)
+    {
+        return false;
+    }
+    pMixer->_pMixerInfo = &pEffect->bufferMixer;
+    return true;
+}
+
+void SetBufferMixerInputOutput(BufferMixerType* pMixer, const int8_t* input, const int8_t* output, int count)
+{
+    BufferMixerInfo* pEffect = pMixer->_pMixerInfo;
+    pEffect->channelCount = count < BufferMixerChannelCountMax ? count : BufferMixerChannelCountMax;
+    for (int i = 0; i < pEffect->channelCount; ++i)
+    {
+        pEffect->input[i] = input[i];
+        pEffect->output[i] = output[i];
+    }
+}
+
+void SetBufferMixerVolume(BufferMixerType* pMixer, int index, float volume)
+{
+    if (index >= 0 && index < BufferMixerChannelCountMax)
+    {
+        pMixer->_pMixerInfo->volume[index] = volume;
+    }
+}
+
+std::size_t GetRequiredBufferSizeForConvolutionReverb(int sampleRate, int channelCountMax, int impulseSampleCountMax)
+{
+    WorkBufferCarver carver(nullptr, 0);
+    CarveConvolvers(&carver, sampleRate / 200, channelCountMax, impulseSampleCountMax);
+    return carver.GetUsedSize();
+}
+
+bool AddConvolutionReverb(AudioRendererConfig* pConfig, ConvolutionReverbType* pReverb, void* buffer, std::size_t bufferSize, FinalMixType* pFinalMix, int channelCountMax, int impulseSampleCountMax)
+{
+    ConfigInfo* pInfo = pConfig->_pConfig;
+    if (buffer == nullptr || channelCountMax <= 0 || channelCountMax > ConvolutionReverbChannelCountMax || impulseSampleCountMax <= 0
+        || bufferSize < GetRequiredBufferSizeForConvolutionReverb(pInfo->parameter.sampleRate, channelCountMax, impulseSampleCountMax))
+    {
+        return false;
+    }
+    EffectInfo* pEffect = AcquireEffect(pInfo, EffectType_ConvolutionReverb, pFinalMix);
+    if (pEffect == nullptr)
+    {
+        return false;
+    }
+
+    WorkBufferCarver carver(buffer, bufferSize);
+    ConvolutionReverbInfo* pReverbInfo = &pEffect->convolutionReverb;
+    pReverbInfo->channelCountMax = channelCountMax;
+    pReverbInfo->dryGain = 1.0f;
+    pReverbInfo->previousDryGain = 1.0f;
+    pReverbInfo->wetGain = 1.0f;
+    pReverbInfo->previousWetGain = 1.0f;
+    pReverbInfo->isEnabled = true;
+    pReverbInfo->pConvolvers = CarveConvolvers(&carver, pInfo->parameter.sampleCount, channelCountMax, impulseSampleCountMax);
+    pReverb->_pReverbInfo = pReverbInfo;
+    return true;
+}
+
+void SetConvolutionReverbInputOutput(ConvolutionReverbType* pReverb, const int8_t* input, const int8_t* output, int count)
+{
+    ConvolutionReverbInfo* pInfo = pReverb->_pReverbInfo;
+    pInfo->channelCount = count < pInfo->channelCountMax ? count : pInfo->channelCountMax;
+    for (int i = 0; i < pInfo->channelCount; ++i)
+    {
+        pInfo->input[i] = input[i];
+        pInfo->output[i] = output[i];
+    }
+}
+
+void SetConvolutionReverbImpulse(ConvolutionReverbType* pReverb, const int16_t* samples, int sampleCount, int channelCount)
+{
+    ConvolutionReverbInfo* pInfo = pReverb->_pReverbInfo;
+    if (samples == nullptr || channelCount <= 0)
+    {
+        return;
+    }
+    for (int ch = 0; ch < pInfo->channelCountMax; ++ch)
+    {
+        pInfo->pConvolvers[ch].SetImpulse(samples + ch % channelCount, sampleCount, channelCount, 1.0f / 32768.0f);
+    }
+}
+
+void SetConvolutionReverbDryGain(ConvolutionReverbType* pReverb, float gain)
+{
+    pReverb->_pReverbInfo->dryGain = gain;
+}
+
+void SetConvolutionReverbWetGain(ConvolutionReverbType* pReverb, float gain)
+{
+    pReverb->_pReverbInfo->wetGain = gain;
+}
+
+void SetConvolutionReverbEnabled(ConvolutionReverbType* pReverb, bool isEnabled)
+{
+    pReverb->_pReverbInfo->isEnabled = isEnabled;
+}
+
+bool IsConvolutionReverbEnabled(const ConvolutionReverbType* pReverb)
+{
+    return pReverb->_pReverbInfo->isEnabled;
+}
+
+bool AddDeviceSink(AudioRendererConfig* pConfig, DeviceSinkType* pSink, FinalMixType* pFinalMix, const int8_t* input, int inputCount, const char* name)
+{
+    ConfigInfo* pInfo = pConfig->_pConfig;
+    if (inputCount <= 0 || inputCount > DeviceSinkChannelCountMax)
+    {
+        return false;
+    }
+    for (int i = 0; i < pInfo->parameter.sinkCount; ++i)
+    {
+        DeviceSinkInfo* pInfoSink = &pInfo->pDeviceSinks[i];
+        if (pInfoSink->isUsed)
+        {
+            continue;
+        }
+        std::memset(pInfoSink, 0, sizeof(*pInfoSink));
+        pInfoSink->isUsed = true;
+        pInfoSink->pFinalMix = pFinalMix->_pMixInfo;
+        pInfoSink->channelCount = inputCount;
+        for (int ch = 0; ch < inputCount; ++ch)
+        {
+            pInfoSink->input[ch] = input[ch];
+        }
+        std::strncpy(pInfoSink->name, name, sizeof(pInfoSink->name) - 1);
+        pSink->_pSinkInfo = pInfoSink;
+        return true;
+    }
+    return false;
+}
+
+void SetDeviceSinkBackend(DeviceSinkType* pSink, ISinkBackend* pBackend)
+{
+    pSink->_pSinkInfo->pBackend = pBackend;
+}
+
+bool AcquireVoiceSlot(AudioRendererConfig* pConfig, VoiceType* pVoice, int sampleRate, int channelCount, SampleFormat sampleFormat, int priority, const void* pParameter, std::size_t parameterSize)
+{
+    ConfigInfo* pInfo = pConfig->_pConfig;
+    if (sampleRate <= 0 || sampleRate > VoiceSampleRateMax || channelCount <= 0 || channelCount > VoiceChannelCountMax)
+    {
+        return false;
+    }
+    if (sampleFormat == SampleFormat_Adpcm && (channelCount != 1 || pParameter == nullptr || parameterSize < sizeof(AdpcmParameter)))
+    {
+        return false;
+    }
+
+    for (int i = 0; i < pInfo->parameter.voiceCount; ++i)
+    {
+        VoiceInfo* pInfoVoice = &pInfo->pVoices[i];
+        if (pInfoVoice->isUsed)
+        {
+            continue;
+        }
+        std::memset(pInfoVoice, 0, sizeof(*pInfoVoice));
+        pInfoVoice->isUsed = true;
+        pInfoVoice->sampleRate = sampleRate;
+        pInfoVoice->channelCount = channelCount;
+        pInfoVoice->sampleFormat = sampleFormat;
+        if (sampleFormat == SampleFormat_Adpcm)
+        {
+            std::memcpy(&pInfoVoice->adpcmParameter, pParameter, sizeof(AdpcmParameter));
+        }
+        pInfoVoice->priority = priority;
+        pInfoVoice->playState = VoiceType::PlayState_Stop;
+        pInfoVoice->volume = 1.0f;
+        pInfoVoice->previousVolume = 1.0f;
+        pInfoVoice->pitch = 1.0f;
+        pInfoVoice->nodeId = MakeNodeId(PerformanceEntryType_Voice, i);
+        ResetVoiceSrc(pInfoVoice);
+        pVoice->_pVoiceInfo = pInfoVoice;
+        return true;
+    }
+    return false;
+}
+
+void ReleaseVoiceSlot(AudioRendererConfig* pConfig, VoiceType* pVoice)
+{
+    static_cast<void>(pConfig);
+    pVoice->_pVoiceInfo->isUsed = false;
+    pVoice->_pVoiceInfo = nullptr;
+}
+
+void SetVoiceDestination(AudioRendererConfig* pConfig, VoiceType* pVoice, FinalMixType* pDestination)
+{
+    static_cast<void>(pConfig);
+    pVoice->_pVoiceInfo->pDestinationFinalMix = pDestination->_pMixInfo;
+    pVoice->_pVoiceInfo->pDestinationSubMix = nullptr;
+}
+
+void SetVoiceDestination(AudioRendererConfig* pConfig, VoiceType* pVoice, SubMixType* pDestination)
+{
+    static_cast<void>(pConfig);
+    pVoice->_pVoiceInfo->pDestinationFinalMix = nullptr;
+    pVoice->_pVoiceInfo->pDestinationSubMix = pDestination->_pMixInfo;
+}
+
+bool AppendWaveBuffer(VoiceType* pVoice, const WaveBuffer* pWaveBuffer)
+{
+    VoiceInfo* pInfo = pVoice->_pVoiceInfo;
+    // Buffers count against the limit until the caller has collected them with GetReleasedWaveBuffer().
+    if (pInfo->queueCount + pInfo->releasedCount >= VoiceWaveBufferCountMax)
+    {
+        return false;
+    }
+    if (pWaveBuffer->buffer == nullptr || pWaveBuffer->endSampleOffset < pWaveBuffer->startSampleOffset)
+    {
+        return false;
+    }
+    QueuedWaveBuffer& entry = pInfo->queue[(pInfo->queueHead + pInfo->queueCount) % VoiceWaveBufferCountMax];
+    entry.waveBuffer = *pWaveBuffer;
+    entry.pUserWaveBuffer = pWaveBuffer;
+    ++pInfo->queueCount;
+    return true;
+}
+
+const WaveBuffer* GetReleasedWaveBuffer(VoiceType* pVoice)
+{
+    VoiceInfo* pInfo = pVoice->_pVoiceInfo;
+    if (pInfo->releasedCount == 0)
+    {
+        return nullptr;
+    }
+    const WaveBuffer* pWaveBuffer = pInfo->released[pInfo->releasedHead];
+    pInfo->releasedHead = (pInfo->releasedHead + 1) % VoiceWaveBufferCountMax;
+    --pInfo->releasedCount;
+    return pWaveBuffer;
+}
+
+void SetVoicePlayState(VoiceType* pVoice, VoiceType::PlayState playState)
+{
+    VoiceInfo* pInfo = pVoice->_pVoiceInfo;
+    if (playState == VoiceType::PlayState_Stop && pInfo->playState != VoiceType::PlayState_Stop)
+    {
+        // Stopping drops everything still queued, as on the console.
+        while (pInfo->queueCount > 0)
+        {
+            ReleaseHeadWaveBuffer(pInfo);
+        }
+        ResetVoiceSrc(pInfo);
+        std::memset(pInfo->biquadState, 0, sizeof(pInfo->biquadState));
+    }
+    pInfo->playState = playState;
+}
+
+VoiceType::PlayState GetVoicePlayState(const VoiceType* pVoice)
+{
+    return pVoice->_pVoiceInfo->playState;
+}
+
+void SetVoiceVolume(VoiceType* pVoice, float volume)
+{
+    pVoice->_pVoiceInfo->volume = volume;
+}
+
+float GetVoiceVolume(const VoiceType* pVoice)
+{
+    return pVoice->_pVoiceInfo->volume;
+}
+
+void SetVoicePitch(VoiceType* pVoice, float pitch)
+{
+    const float pitchMin = VoiceType::GetPitchMin();
+    const float pitchMax = VoiceType::GetPitchMax();
+    pVoice->_pVoiceInfo->pitch = pitch < pitchMin ? pitchMin : (pitch > pitchMax ? pitchMax : pitch);
+}
+
+float GetVoicePitch(const VoiceType* pVoice)
+{
+    return pVoice->_pVoiceInfo->pitch;
+}
+
+void SetVoicePriority(VoiceType* pVoice, int priority)
+{
+    pVoice->_pVoiceInfo->priority = priority;
+}
+
+void SetVoiceMixVolume(VoiceType* pVoice, FinalMixType* pDestination, float volume, int sourceIndex, int destinationIndex)
+{
+    VoiceInfo* pInfo = pVoice->_pVoiceInfo;
+    if (pInfo->pDestinationFinalMix != pDestination->_pMixInfo || sourceIndex >= pInfo->channelCount || destinationIndex >= pDestination->_pMixInfo->bufferCount)
+    {
+        return;
+    }
+    pInfo->mixVolume[sourceIndex][destinationIndex] = volume;
+}
+
+void SetVoiceMixVolume(VoiceType* pVoice, SubMixType* pDestination, float volume, int sourceIndex, int destinationIndex)
+{
+    VoiceInfo* pInfo = pVoice->_pVoiceInfo;
+    if (pInfo->pDestinationSubMix != pDestination->_pMixInfo || sourceIndex >= pInfo->channelCount || destinationIndex >= pDestination->_pMixInfo->bufferCount)
+    {
+        return;
+    }
+    pInfo->mixVolume[sourceIndex][destinationIndex] = volume;
+}
+
+float GetVoiceMixVolume(const VoiceType* pVoice, const FinalMixType* pDestination, int sourceIndex, int destinationIndex)
+{
+    const VoiceInfo* pInfo = pVoice->_pVoiceInfo;
+    if (pInfo->pDestinationFinalMix != pDestination->_pMixInfo || sourceIndex >= pInfo->channelCount)
+    {
+        return 0.0f;
+    }
+    return pInfo->mixVolume[sourceIndex][destinationIndex];
+}
+
+float GetVoiceMixVolume(const VoiceType* pVoice, const SubMixType* pDestination, int sourceIndex, int destinationIndex)
+{
+    const VoiceInfo* pInfo = pVoice->_pVoiceInfo;
+    if (pInfo->pDestinationSubMix != pDestination->_pMixInfo || sourceIndex >= pInfo->channelCount)
+    {
+        return 0.0f;
+    }
+    return pInfo->mixVolume[sourceIndex][destinationIndex];
+}
+
+void SetVoiceBiquadFilterParameter(VoiceType* pVoice, int index, const BiquadFilterParameter& parameter)
+{
+    if (index < 0 || index >= VoiceBiquadFilterCountMax)
+    {
+        return;
+    }
+    VoiceInfo* pInfo = pVoice->_pVoiceInfo;
+    if (parameter.enable && !pInfo->biquad[index].enable)
+    {
+        std::memset(pInfo->biquadState[index], 0, sizeof(pInfo->biquadState[index]));
+    }
+    pInfo->biquad[index] = parameter;
+    AudioDsp::PrepareBiquadBlockSection(&pInfo->biquadSection[index], AudioDsp::FromBiquadQ14(parameter.numerator, parameter.denominator));
+}
+
+BiquadFilterParameter GetVoiceBiquadFilterParameter(const VoiceType* pVoice, int index)
+{
+    return pVoice->_pVoiceInfo->biquad[index];
+}
+
+void SetVoiceSrcQuality(VoiceType* pVoice, SrcQuality quality)
+{
+    VoiceInfo* pInfo = pVoice->_pVoiceInfo;
+    const int delayChange = GetSrcDelay(quality) - GetSrcDelay(pInfo->srcQuality);
+    pInfo->srcQuality = quality;
+    if (delayChange == 0)
+    {
+        return;
+    }
+
+    // Keep the stream position: the polyphase filter reads ResamplerDelay more samples of history than linear interpolation.
+    // History gained this way is silence, so switching while the voice plays is smooth but not exact.
+    const int carryCount = pInfo->carryCount + delayChange;
+    for (int ch = 0; ch < VoiceChannelCountMax; ++ch)
+    {
+        float* pCarry = pInfo->carry[ch];
+        if (delayChange > 0)
+        {
+            std::memmove(pCarry + delayChange, pCarry, sizeof(float) * pInfo->carryCount);
+            std::memset(pCarry, 0, sizeof(float) * delayChange);
+        }
+        else
+        {
+            std::memmove(pCarry, pCarry - delayChange, sizeof(float) * carryCount);
+        }
+    }
+    pInfo->carryCount = carryCount;
+}
+
+SrcQuality GetVoiceSrcQuality(const VoiceType* pVoice)
+{
+    return pVoice->_pVoiceInfo->srcQuality;
+}
+
+int64_t GetVoicePlayedSampleCount(const VoiceType* pVoice)
+{
+    return pVoice->_pVoiceInfo->playedSampleCount;
+}
+
+NodeId GetVoiceNodeId(const VoiceType* pVoice)
+{
+    return pVoice->_pVoiceInfo->nodeId;
+}
+
+bool IsVoiceValid(const VoiceType* pVoice)
+{
+    return pVoice->_pVoiceInfo != nullptr && pVoice->_pVoiceInfo->isUsed;
+}
+
+}  // namespace HostAudio
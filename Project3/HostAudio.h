@@ -0,0 +1,335 @@
+#pragma once
+
+/**
+* @brief
+*  Host-side software implementation of the audio renderer graph.
+*
+*  The functions in this namespace mirror the subset of <tt>nn::audio</tt> used by
+*  <tt>nnMain_Sound</tt> (<tt>AudioRenderer.cpp</tt>) so the same FinalMix / SubMix / BufferMixer /
+*  DeviceSink graph can be built and rendered on Linux or Windows without the console renderer.
+*
+*  Differences from the console renderer:
+*  - Rendering is driven by the caller. Each call to <tt>ProcessAudioRenderer()</tt> renders one audio
+*    frame of <tt>AudioRendererParameter::sampleCount</tt> samples, which is what the DSP does every
+*    time it signals the renderer <tt>SystemEvent</tt> on the console.
+*  - Mix buffers are 32-bit float in 16-bit sample units instead of int32.
+*  - The DeviceSink writes to an <tt>ISinkBackend</tt> (a WAV file, a null sink, or a capture in front of either, see HostAudioSink.h).
+*  - Performance frames time the nodes with the host clock, in fractional microseconds. A performance buffer is
+*    filled until it is full; the frames after that are lost until <tt>SetPerformanceFrameBuffer()</tt> hands out the next one.
+*  - The final mix can run a convolution reverb (<tt>AddConvolutionReverb()</tt>), which has no console counterpart. Like
+*    every effect, it takes one of the <tt>effectCount</tt> slots, and effects run in the order they were added.
+*
+*  All memory is carved from the work buffers passed to <tt>OpenAudioRenderer()</tt> and
+*  <tt>InitializeAudioRendererConfig()</tt>; nothing is allocated while rendering.
+*/
+
+#include <cstddef>
+#include <cstdint>
+
+#include "AudioDspAdpcm.h"
+
+namespace HostAudio {
+
+const int MixBufferCountMax = 24;
+const int VoiceChannelCountMax = 6;
+const int VoiceBiquadFilterCountMax = 2;
+const int VoiceWaveBufferCountMax = 4;
+const int VoiceSampleRateMax = 48000;
+const int BufferMixerChannelCountMax = 6;
+const int DeviceSinkChannelCountMax = 6;
+const int ConvolutionReverbChannelCountMax = 6;
+const std::size_t BufferAlignSize = 64;
+using AudioDsp::AdpcmHeaderSize;
+
+enum ChannelMapping
+{
+    ChannelMapping_FrontLeft = 0,
+    ChannelMapping_FrontRight = 1,
+};
+
+enum SampleFormat
+{
+    SampleFormat_PcmInt16,
+    SampleFormat_Adpcm,
+};
+
+//!<  Sample rate conversion of a voice to the renderer rate. Voices at the renderer rate and pitch 1.0 skip it either way.
+enum SrcQuality
+{
+    SrcQuality_Default,                 //!<  Linear interpolation.
+    SrcQuality_High,                    //!<  32-tap polyphase filter (AudioDspResampler.h), several times the cost.
+};
+
+// DSP-ADPCM types and header parsing are shared with the offline tools.
+using AudioDsp::AdpcmParameter;
+using AudioDsp::AdpcmContext;
+using AudioDsp::AdpcmHeaderInfo;
+using AudioDsp::ParseAdpcmHeader;
+
+typedef uint32_t NodeId;
+
+enum PerformanceEntryType
+{
+    PerformanceEntryType_Unknown,
+    PerformanceEntryType_Voice,
+    PerformanceEntryType_SubMix,
+    PerformanceEntryType_FinalMix,
+    PerformanceEntryType_Sink,
+};
+
+enum PerformanceDetailType
+{
+    PerformanceDetailType_Unknown,
+    PerformanceDetailType_BufferMixer,
+    PerformanceDetailType_ConvolutionReverb,
+};
+
+//!<  Times are in microseconds from the start of the audio frame, as on the console, but fractional: a host voice takes well under one.
+struct PerformanceEntry
+{
+    NodeId  nodeId;
+    float   startTime;
+    float   processingTime;
+    int8_t  entryType;                  //!<  PerformanceEntryType.
+};
+
+struct PerformanceDetailEntry
+{
+    NodeId  nodeId;
+    float   startTime;
+    float   processingTime;
+    int8_t  detailType;                 //!<  PerformanceDetailType.
+    int8_t  parentEntryType;            //!<  PerformanceEntryType of the node the detail belongs to.
+};
+
+struct BiquadFilterParameter
+{
+    bool    enable;
+    int16_t numerator[3];               //!<  b0, b1, b2 in Q14.
+    int16_t denominator[2];             //!<  -a1, -a2 in Q14 (added to the output, as on the console).
+};
+
+struct WaveBuffer
+{
+    const void* buffer;
+    std::size_t size;
+    int32_t     startSampleOffset;
+    int32_t     endSampleOffset;
+    bool        loop;
+    bool        isEndOfStream;
+    const void* pContext;               //!<  <tt>AdpcmContext</tt> at startSampleOffset (ADPCM only).
+    std::size_t contextSize;
+};
+
+struct AudioRendererParameter
+{
+    int sampleRate;
+    int sampleCount;
+    int mixBufferCount;
+    int voiceCount;
+    int subMixCount;
+    int sinkCount;
+    int effectCount;
+    int performanceFrameCount;
+};
+
+struct RendererInfo;
+struct ConfigInfo;
+struct VoiceInfo;
+struct SubMixInfo;
+struct FinalMixInfo;
+struct BufferMixerInfo;
+struct ConvolutionReverbInfo;
+struct DeviceSinkInfo;
+
+struct AudioRendererHandle
+{
+    RendererInfo* _pRenderer;
+};
+
+struct AudioRendererConfig
+{
+    ConfigInfo* _pConfig;
+};
+
+struct FinalMixType
+{
+    FinalMixInfo* _pMixInfo;
+};
+
+struct SubMixType
+{
+    SubMixInfo* _pMixInfo;
+};
+
+struct BufferMixerType
+{
+    BufferMixerInfo* _pMixerInfo;
+};
+
+struct ConvolutionReverbType
+{
+    ConvolutionReverbInfo* _pReverbInfo;
+};
+
+struct DeviceSinkType
+{
+    DeviceSinkInfo* _pSinkInfo;
+};
+
+struct VoiceType
+{
+    enum PlayState
+    {
+        PlayState_Play,
+        PlayState_Stop,
+        PlayState_Pause,
+    };
+
+    static const int PriorityHighest = 0;
+    static const int PriorityLowest = 255;
+
+    static float GetVolumeMin() { return 0.0f; }
+    static float GetVolumeMax() { return 128.0f; }
+    static float GetPitchMin()  { return 0.001f; }
+    static float GetPitchMax()  { return 4.0f; }
+
+    VoiceInfo* _pVoiceInfo;
+};
+
+/**
+* @brief  Destination for the samples a DeviceSink produces each audio frame.
+*/
+class ISinkBackend
+{
+public:
+    virtual ~ISinkBackend() {}
+
+    //!<  Receives one audio frame of interleaved, saturated 16-bit samples.
+    virtual void Write(const int16_t* interleaved, int sampleCount, int channelCount) = 0;
+};
+
+/**
+* @brief  Reads the frames of a performance buffer returned by <tt>SetPerformanceFrameBuffer()</tt>.
+*/
+class PerformanceInfo
+{
+public:
+    PerformanceInfo();
+
+    //!<  Selects the first frame. Returns false if the buffer holds no frame.
+    bool SetBuffer(const void* buffer, std::size_t bufferSize);
+
+    //!<  Returns false at the last frame.
+    bool MoveToNextFrame();
+
+    const PerformanceEntry* GetEntries(int* pOutCount) const;
+    const PerformanceDetailEntry* GetDetailEntries(int* pOutCount) const;
+    float GetTotalProcessingTime() const;
+
+    //!<  The frame took longer to render than it lasts.
+    bool IsRenderingTimeLimitExceeded() const;
+
+private:
+    const uint8_t* m_pBuffer;
+    std::size_t    m_BufferSize;
+    std::size_t    m_Offset;            //!<  Of the current frame.
+};
+
+// Renderer.
+void InitializeAudioRendererParameter(AudioRendererParameter* pOutParameter);
+bool IsValidAudioRendererParameter(const AudioRendererParameter& parameter);
+std::size_t GetAudioRendererWorkBufferSize(const AudioRendererParameter& parameter);
+bool OpenAudioRenderer(AudioRendererHandle* pOutHandle, const AudioRendererParameter& parameter, void* workBuffer, std::size_t workBufferSize);
+void CloseAudioRenderer(AudioRendererHandle handle);
+void StartAudioRenderer(AudioRendererHandle handle);
+void StopAudioRenderer(AudioRendererHandle handle);
+bool RequestUpdateAudioRenderer(AudioRendererHandle handle, const AudioRendererConfig* pConfig);
+void ProcessAudioRenderer(AudioRendererHandle handle);
+int64_t GetAudioRendererElapsedFrameCount(AudioRendererHandle handle);
+
+// Performance.
+std::size_t GetRequiredBufferSizeForPerformanceFrames(const AudioRendererParameter& parameter);
+void* SetPerformanceFrameBuffer(AudioRendererConfig* pConfig, void* buffer, std::size_t bufferSize);
+void SetPerformanceDetailTarget(AudioRendererConfig* pConfig, const FinalMixType* pFinalMix);
+
+// Config.
+std::size_t GetAudioRendererConfigWorkBufferSize(const AudioRendererParameter& parameter);
+void InitializeAudioRendererConfig(AudioRendererConfig* pOutConfig, const AudioRendererParameter& parameter, void* buffer, std::size_t bufferSize);
+
+// Mixes.
+bool AcquireFinalMix(AudioRendererConfig* pConfig, FinalMixType* pFinalMix, int bufferCount);
+void SetFinalMixVolume(FinalMixType* pFinalMix, float volume);
+bool AcquireSubMix(AudioRendererConfig* pConfig, SubMixType* pSubMix, int sampleRate, int bufferCount);
+void SetSubMixDestination(AudioRendererConfig* pConfig, SubMixType* pSource, FinalMixType* pDestination);
+void SetSubMixDestination(AudioRendererConfig* pConfig, SubMixType* pSource, SubMixType* pDestination);
+void SetSubMixMixVolume(SubMixType* pSource, FinalMixType* pDestination, float volume, int sourceIndex, int destinationIndex);
+void SetSubMixMixVolume(SubMixType* pSource, SubMixType* pDestination, float volume, int sourceIndex, int destinationIndex);
+void SetSubMixVolume(SubMixType* pSubMix, float volume);
+
+// Effects.
+bool AddBufferMixer(AudioRendererConfig* pConfig, BufferMixerType* pMixer, FinalMixType* pFinalMix);
+void SetBufferMixerInputOutput(BufferMixerType* pMixer, const int8_t* input, const int8_t* output, int count);
+void SetBufferMixerVolume(BufferMixerType* pMixer, int index, float volume);
+
+/**
+* @brief  Size of the buffer for a convolution reverb with impulse responses of up to impulseSampleCountMax samples.
+*
+*  The reverb convolves each of its channels in partitions of one audio frame (AudioDspConvolver.h), so the buffer
+*  and the time per frame both grow linearly with impulseSampleCountMax.
+*/
+std::size_t GetRequiredBufferSizeForConvolutionReverb(int sampleRate, int channelCountMax, int impulseSampleCountMax);
+
+//!<  The buffer holds the state of the reverb and must stay valid while the reverb is in use. The reverb starts enabled, silent until it has an impulse.
+bool AddConvolutionReverb(AudioRendererConfig* pConfig, ConvolutionReverbType* pReverb, void* buffer, std::size_t bufferSize, FinalMixType* pFinalMix, int channelCountMax, int impulseSampleCountMax);
+
+//!<  Each output buffer receives dry gain times its input plus wet gain times the reverb of that input. Input and output may be the same buffer.
+void SetConvolutionReverbInputOutput(ConvolutionReverbType* pReverb, const int8_t* input, const int8_t* output, int count);
+
+/**
+* @brief  Sets the impulse response from interleaved 16-bit samples, where full scale is a gain of 1.
+*
+*  Reverb channel i uses impulse channel i % channelCount, so a mono impulse serves every channel. This costs one FFT per
+*  audio frame of impulse, so a long impulse is best set before rendering starts.
+*/
+void SetConvolutionReverbImpulse(ConvolutionReverbType* pReverb, const int16_t* samples, int sampleCount, int channelCount);
+
+//!<  Gains are ramped over one audio frame. The defaults are 1.
+void SetConvolutionReverbDryGain(ConvolutionReverbType* pReverb, float gain);
+void SetConvolutionReverbWetGain(ConvolutionReverbType* pReverb, float gain);
+
+//!<  A disabled reverb copies its inputs to its outputs and drops its tail.
+void SetConvolutionReverbEnabled(ConvolutionReverbType* pReverb, bool isEnabled);
+bool IsConvolutionReverbEnabled(const ConvolutionReverbType* pReverb);
+
+// Sinks.
+bool AddDeviceSink(AudioRendererConfig* pConfig, DeviceSinkType* pSink, FinalMixType* pFinalMix, const int8_t* input, int inputCount, const char* name);
+void SetDeviceSinkBackend(DeviceSinkType* pSink, ISinkBackend* pBackend);
+
+// Voices.
+bool AcquireVoiceSlot(AudioRendererConfig* pConfig, VoiceType* pVoice, int sampleRate, int channelCount, SampleFormat sampleFormat, int priority, const void* pParameter, std::size_t parameterSize);
+void ReleaseVoiceSlot(AudioRendererConfig* pConfig, VoiceType* pVoice);
+void SetVoiceDestination(AudioRendererConfig* pConfig, VoiceType* pVoice, FinalMixType* pDestination);
+void SetVoiceDestination(AudioRendererConfig* pConfig, VoiceType* pVoice, SubMixType* pDestination);
+bool AppendWaveBuffer(VoiceType* pVoice, const WaveBuffer* pWaveBuffer);
+const WaveBuffer* GetReleasedWaveBuffer(VoiceType* pVoice);
+void SetVoicePlayState(VoiceType* pVoice, VoiceType::PlayState playState);
+VoiceType::PlayState GetVoicePlayState(const VoiceType* pVoice);
+void SetVoiceVolume(VoiceType* pVoice, float volume);
+float GetVoiceVolume(const VoiceType* pVoice);
+void SetVoicePitch(VoiceType* pVoice, float pitch);
+float GetVoicePitch(const VoiceType* pVoice);
+void SetVoicePriority(VoiceType* pVoice, int priority);
+void SetVoiceMixVolume(VoiceType* pVoice, FinalMixType* pDestination, float volume, int sourceIndex, int destinationIndex);
+void SetVoiceMixVolume(VoiceType* pVoice, SubMixType* pDestination, float volume, int sourceIndex, int destinationIndex);
+float GetVoiceMixVolume(const VoiceType* pVoice, const FinalMixType* pDestination, int sourceIndex, int destinationIndex);
+float GetVoiceMixVolume(const VoiceType* pVoice, const SubMixType* pDestination, int sourceIndex, int destinationIndex);
+void SetVoiceBiquadFilterParameter(VoiceType* pVoice, int index, const BiquadFilterParameter& parameter);
+BiquadFilterParameter GetVoiceBiquadFilterParameter(const VoiceType* pVoice, int index);
+void SetVoiceSrcQuality(VoiceType* pVoice, SrcQuality quality);
+SrcQuality GetVoiceSrcQuality(const VoiceType* pVoice);
+int64_t GetVoicePlayedSampleCount(const VoiceType* pVoice);
+NodeId GetVoiceNodeId(const VoiceType* pVoice);
+bool IsVoiceValid(const VoiceType* pVoice);
+
+}  // namespace HostAudio
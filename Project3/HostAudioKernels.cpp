@@ -0,0 +1,205 @@
+#include "HostAudioKernels.h"
+
+#include "AudioDspSimd.h"
+
+using namespace AudioDsp;
+
+namespace HostAudio {
+
+void ConvertInt16ToFloat(float* pDst, const int16_t* pSrc, int count)
+{
+    int i = 0;
+    for (; i + SimdWidth <= count; i += SimdWidth)
+    {
+        Store4(pDst + i, LoadInt16x4(pSrc + i));
+    }
+    for (; i < count; ++i)
+    {
+        pDst[i] = pSrc[i];
+    }
+}
+
+void DeinterleaveInt16ToFloat(float* const* pDst, const int16_t* pSrc, int channelCount, int count)
+{
+    if (channelCount == 1)
+    {
+        ConvertInt16ToFloat(pDst[0], pSrc, count);
+        return;
+    }
+
+    if (channelCount == 2)
+    {
+        // Four stereo frames are eight int16; convert both halves and swizzle the lanes.
+        float* pLeft = pDst[0];
+        float* pRight = pDst[1];
+        int i = 0;
+        for (; i + SimdWidth <= count; i += SimdWidth)
+        {
+            float lo[SimdWidth];
+            float hi[SimdWidth];
+            Store4(lo, LoadInt16x4(pSrc + i * 2));
+            Store4(hi, LoadInt16x4(pSrc + i * 2 + SimdWidth));
+            Store4(pLeft + i, Set4(lo[0], lo[2], hi[0], hi[2]));
+            Store4(pRight + i, Set4(lo[1], lo[3], hi[1], hi[3]));
+        }
+        for (; i < count; ++i)
+        {
+            pLeft[i] = pSrc[i * 2];
+            pRight[i] = pSrc[i * 2 + 1];
+        }
+        return;
+    }
+
+    for (int i = 0; i < count; ++i)
+    {
+        for (int ch = 0; ch < channelCount; ++ch)
+        {
+            pDst[ch][i] = pSrc[i * channelCount + ch];
+        }
+    }
+}
+
+void InterleaveFloatToInt16(int16_t* pDst, const float* const* pSrc, int channelCount, int count)
+{
+    int16_t lanes[SimdWidth];
+    for (int ch = 0; ch < channelCount; ++ch)
+    {
+        const float* pChannel = pSrc[ch];
+        int i = 0;
+        for (; i + SimdWidth <= count; i += SimdWidth)
+        {
+            StoreInt16x4(lanes, Load4(pChannel + i));
+            for (int k = 0; k < SimdWidth; ++k)
+            {
+                pDst[(i + k) * channelCount + ch] = lanes[k];
+            }
+        }
+        for (; i < count; ++i)
+        {
+            float padded[SimdWidth] = { pChannel[i], 0.0f, 0.0f, 0.0f };
+            StoreInt16x4(lanes, Load4(padded));
+            pDst[i * channelCount + ch] = lanes[0];
+        }
+    }
+}
+
+void ClearSamples(float* pData, int count)
+{
+    const Float4 zero = Set4(0.0f);
+    int i = 0;
+    for (; i + SimdWidth <= count; i += SimdWidth)
+    {
+        Store4(pData + i, zero);
+    }
+    for (; i < count; ++i)
+    {
+        pData[i] = 0.0f;
+    }
+}
+
+void ApplyGainRamp(float* pData, float startGain, float endGain, int count)
+{
+    if (count <= 0)
+    {
+        return;
+    }
+    const float delta = (endGain - startGain) / count;
+    Float4 gain = Set4(startGain, startGain + delta, startGain + delta * 2, startGain + delta * 3);
+    const Float4 gainStep = Set4(delta * SimdWidth);
+    int i = 0;
+    for (; i + SimdWidth <= count; i += SimdWidth)
+    {
+        Store4(pData + i, Mul4(Load4(pData + i), gain));
+        gain = Add4(gain, gainStep);
+    }
+    for (; i < count; ++i)
+    {
+        pData[i] *= startGain + delta * i;
+    }
+}
+
+void MixRamp(float* pDst, const float* pSrc, float startGain, float endGain, int count)
+{
+    if (startGain == endGain)
+    {
+        Mix(pDst, pSrc, endGain, count);
+        return;
+    }
+    if (count <= 0)
+    {
+        return;
+    }
+    const float delta = (endGain - startGain) / count;
+    Float4 gain = Set4(startGain, startGain + delta, startGain + delta * 2, startGain + delta * 3);
+    const Float4 gainStep = Set4(delta * SimdWidth);
+    int i = 0;
+    for (; i + SimdWidth <= count; i += SimdWidth)
+    {
+        Store4(pDst + i, MulAdd4(Load4(pDst + i), Load4(pSrc + i), gain));
+        gain = Add4(gain, gainStep);
+    }
+    for (; i < count; ++i)
+    {
+        pDst[i] += pSrc[i] * (startGain + delta * i);
+    }
+}
+
+void Mix(float* pDst, const float* pSrc, float gain, int count)
+{
+    if (gain == 0.0f)
+    {
+        return;
+    }
+    const Float4 g = Set4(gain);
+    int i = 0;
+    for (; i + SimdWidth <= count; i += SimdWidth)
+    {
+        Store4(pDst + i, MulAdd4(Load4(pDst + i), Load4(pSrc + i), g));
+    }
+    for (; i < count; ++i)
+    {
+        pDst[i] += pSrc[i] * gain;
+    }
+}
+
+void ResampleLinear(float* pDst, int dstCount, const float* pSrc, uint32_t fraction, uint32_t step)
+{
+    if (step == 0x10000 && fraction == 0)
+    {
+        for (int i = 0; i < dstCount; ++i)
+        {
+            pDst[i] = pSrc[i];
+        }
+        return;
+    }
+
+    // The loads are a gather, so they stay scalar; the interpolation itself is vectorized.
+    const float scale = 1.0f / 65536.0f;
+    uint64_t position = fraction;
+    int i = 0;
+    for (; i + SimdWidth <= dstCount; i += SimdWidth)
+    {
+        float a[SimdWidth];
+        float b[SimdWidth];
+        float f[SimdWidth];
+        for (int k = 0; k < SimdWidth; ++k)
+        {
+            const uint64_t index = position >> 16;
+            a[k] = pSrc[index];
+            b[k] = pSrc[index + 1];
+            f[k] = static_cast<float>(position & 0xffff) * scale;
+            position += step;
+        }
+        const Float4 va = Load4(a);
+        Store4(pDst + i, MulAdd4(va, Sub4(Load4(b), va), Load4(f)));
+    }
+    for (; i < dstCount; ++i)
+    {
+        const uint64_t index = position >> 16;
+        const float f = static_cast<float>(position & 0xffff) * scale;
+        pDst[i] = pSrc[index] + (pSrc[index + 1] - pSrc[index]) * f;
+        position += step;
+    }
+}
+
+}  // namespace HostAudio
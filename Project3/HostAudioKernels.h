@@ -0,0 +1,49 @@
+#pragma once
+
+/**
+* @brief
+*  Vectorized sample kernels used by the host software renderer.
+*
+*  All kernels operate on float buffers in 16-bit sample units and process
+*  <tt>AudioDsp::SimdWidth</tt> samples per step with a scalar tail, so any
+*  <tt>count</tt> is accepted.
+*/
+
+#include <cstdint>
+
+namespace HostAudio {
+
+//!<  Converts mono int16 samples to float.
+void ConvertInt16ToFloat(float* pDst, const int16_t* pSrc, int count);
+
+//!<  Splits interleaved int16 samples into one float buffer per channel.
+void DeinterleaveInt16ToFloat(float* const* pDst, const int16_t* pSrc, int channelCount, int count);
+
+//!<  Rounds and saturates one float buffer per channel into interleaved int16.
+void InterleaveFloatToInt16(int16_t* pDst, const float* const* pSrc, int channelCount, int count);
+
+//!<  Sets count samples to zero.
+void ClearSamples(float* pData, int count);
+
+//!<  Multiplies pData by a gain that moves linearly from startGain to endGain over the block.
+void ApplyGainRamp(float* pData, float startGain, float endGain, int count);
+
+//!<  pDst += pSrc * gain, where gain moves linearly from startGain to endGain over the block.
+void MixRamp(float* pDst, const float* pSrc, float startGain, float endGain, int count);
+
+//!<  pDst += pSrc * gain.
+void Mix(float* pDst, const float* pSrc, float gain, int count);
+
+/**
+* @brief  Linearly interpolating sample-rate conversion with a Q16 step.
+*
+* @param[out] pDst      dstCount output samples.
+* @param[in]  pSrc      Source samples; pSrc[0] is the sample at the integer part of the current position.
+* @param[in]  fraction  Q16 fractional part of the current position.
+* @param[in]  step      Q16 source samples advanced per output sample.
+*
+*  pSrc must hold ((fraction + step * (dstCount - 1)) >> 16) + 2 samples.
+*/
+void ResampleLinear(float* pDst, int dstCount, const float* pSrc, uint32_t fraction, uint32_t step);
+
+}  // namespace HostAudio
@@ -0,0 +1,165 @@
+#include "HostAudioSink.h"
+
+#include <chrono>
+
+#include "AudioDspWav.h"
+
+namespace HostAudio {
+
+void WriteWavHeader(std::FILE* pFile, int sampleRate, int channelCount, uint32_t dataSize)
+{
+    uint8_t header[AudioDsp::WavHeaderSize];
+    AudioDsp::MakeWavHeader(header, sampleRate, channelCount, dataSize);
+    std::fwrite(header, 1, sizeof(header), pFile);
+}
+
+WavFileSink::WavFileSink()
+    : m_pFile(nullptr)
+    , m_SampleRate(0)
+    , m_ChannelCount(0)
+    , m_WrittenSampleCount(0)
+{
+}
+
+WavFileSink::~WavFileSink()
+{
+    Close();
+}
+
+bool WavFileSink::Open(const char* path, int sampleRate, int channelCount)
+{
+    Close();
+    m_pFile = std::fopen(path, "wb");
+    if (m_pFile == nullptr)
+    {
+        return false;
+    }
+    m_SampleRate = sampleRate;
+    m_ChannelCount = channelCount;
+    m_WrittenSampleCount = 0;
+    WriteWavHeader(m_pFile, sampleRate, channelCount, 0);
+    return true;
+}
+
+void WavFileSink::Close()
+{
+    if (m_pFile == nullptr)
+    {
+        return;
+    }
+    const uint32_t dataSize = static_cast<uint32_t>(m_WrittenSampleCount * m_ChannelCount * 2);
+    std::fseek(m_pFile, 0, SEEK_SET);
+    WriteWavHeader(m_pFile, m_SampleRate, m_ChannelCount, dataSize);
+    std::fclose(m_pFile);
+    m_pFile = nullptr;
+}
+
+void WavFileSink::Write(const int16_t* interleaved, int sampleCount, int channelCount)
+{
+    if (m_pFile == nullptr || channelCount != m_ChannelCount)
+    {
+        return;
+    }
+    // WAV is little-endian, as are all the hosts this runs on.
+    std::fwrite(interleaved, sizeof(int16_t) * channelCount, sampleCount, m_pFile);
+    m_WrittenSampleCount += sampleCount;
+}
+
+void NullSink::Write(const int16_t* interleaved, int sampleCount, int channelCount)
+{
+    const int count = sampleCount * channelCount;
+    uint32_t sum = m_Checksum;
+    for (int i = 0; i < count; ++i)
+    {
+        sum = sum * 31 + static_cast<uint16_t>(interleaved[i]);
+    }
+    m_Checksum = sum;
+    m_WrittenSampleCount += sampleCount;
+}
+
+CaptureSink::CaptureSink(ISinkBackend* pNext)
+    : m_pNext(pNext)
+    , m_pFile(nullptr)
+    , m_SampleRate(0)
+    , m_ChannelCount(0)
+    , m_IsQuitRequested(false)
+    , m_WrittenFrameCount(0)
+{
+}
+
+CaptureSink::~CaptureSink()
+{
+    Close();
+}
+
+bool CaptureSink::Open(const char* path, int sampleRate, int channelCount, int frameSampleCount, int frameCount)
+{
+    Close();
+    m_pFile = std::fopen(path, "wb");
+    if (m_pFile == nullptr)
+    {
+        return false;
+    }
+    m_SampleRate = sampleRate;
+    m_ChannelCount = channelCount;
+    m_RingBuffer.resize(AudioDsp::CaptureRing::GetRequiredWorkBufferSize(frameSampleCount, channelCount, frameCount));
+    m_Ring.Initialize(m_RingBuffer.data(), m_RingBuffer.size(), frameSampleCount, channelCount, frameCount);
+    m_WrittenFrameCount.store(0, std::memory_order_relaxed);
+    m_IsQuitRequested.store(false, std::memory_order_relaxed);
+    WriteWavHeader(m_pFile, sampleRate, channelCount, 0);
+    m_Thread = std::thread(&CaptureSink::WriterMain, this);
+    return true;
+}
+
+void CaptureSink::Close()
+{
+    if (m_pFile == nullptr)
+    {
+        return;
+    }
+    m_IsQuitRequested.store(true, std::memory_order_release);
+    m_Thread.join();
+
+    const uint32_t dataSize = static_cast<uint32_t>(m_WrittenFrameCount.load(std::memory_order_relaxed) * m_Ring.GetFrameSize());
+    std::fseek(m_pFile, 0, SEEK_SET);
+    WriteWavHeader(m_pFile, m_SampleRate, m_ChannelCount, dataSize);
+    std::fclose(m_pFile);
+    m_pFile = nullptr;
+}
+
+void CaptureSink::Write(const int16_t* interleaved, int sampleCount, int channelCount)
+{
+    if (m_pNext != nullptr)
+    {
+        m_pNext->Write(interleaved, sampleCount, channelCount);
+    }
+    if (m_pFile != nullptr && channelCount == m_ChannelCount)
+    {
+        m_Ring.PushInterleaved(interleaved, sampleCount);
+    }
+}
+
+void CaptureSink::WriterMain()
+{
+    for (;;)
+    {
+        // The quit request is read before the ring, so the frames pushed before it are all written.
+        const bool isQuitRequested = m_IsQuitRequested.load(std::memory_order_acquire);
+        const int16_t* pFrames;
+        int frameCount;
+        while ((frameCount = m_Ring.Peek(&pFrames)) > 0)
+        {
+            std::fwrite(pFrames, m_Ring.GetFrameSize(), frameCount, m_pFile);
+            m_Ring.Pop(frameCount);
+            m_WrittenFrameCount.fetch_add(frameCount, std::memory_order_relaxed);
+        }
+        if (isQuitRequested)
+        {
+            break;
+        }
+        // Nothing on the render side waits for the writer, so it polls instead of being woken.
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+}
+
+}  // namespace HostAudio
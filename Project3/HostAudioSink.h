@@ -0,0 +1,112 @@
+#pragma once
+
+/**
+* @brief
+*  DeviceSink backends for the host software renderer.
+*/
+
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+#include "AudioDspCaptureRing.h"
+#include "HostAudio.h"
+
+namespace HostAudio {
+
+/**
+* @brief  Writes everything the sink receives to a 16-bit PCM WAV file.
+*
+*  The RIFF and data chunk sizes are patched in by <tt>Close()</tt>.
+*/
+class WavFileSink : public ISinkBackend
+{
+public:
+    WavFileSink();
+    virtual ~WavFileSink();
+
+    bool Open(const char* path, int sampleRate, int channelCount);
+    void Close();
+
+    virtual void Write(const int16_t* interleaved, int sampleCount, int channelCount);
+
+    int64_t GetWrittenSampleCount() const { return m_WrittenSampleCount; }
+
+private:
+    WavFileSink(const WavFileSink&);
+    WavFileSink& operator=(const WavFileSink&);
+
+    std::FILE* m_pFile;
+    int        m_SampleRate;
+    int        m_ChannelCount;
+    int64_t    m_WrittenSampleCount;
+};
+
+/**
+* @brief  Discards the output; used for profiling the renderer without I/O.
+*/
+class NullSink : public ISinkBackend
+{
+public:
+    NullSink() : m_WrittenSampleCount(0), m_Checksum(0) {}
+
+    virtual void Write(const int16_t* interleaved, int sampleCount, int channelCount);
+
+    int64_t GetWrittenSampleCount() const { return m_WrittenSampleCount; }
+    uint32_t GetChecksum() const { return m_Checksum; }
+
+private:
+    int64_t  m_WrittenSampleCount;
+    uint32_t m_Checksum;            //!<  Cheap running sum so the optimizer cannot drop the render.
+};
+
+/**
+* @brief  Passes everything on to another backend and captures a copy to a WAV file without waiting for the disk.
+*
+*  <tt>Write()</tt> copies the frame into an <tt>AudioDsp::CaptureRing</tt>, and a writer thread appends what the ring
+*  holds to the file. If the writer falls behind, frames are dropped from the capture, never from the output, and
+*  counted. Every write must be one frame of the sample count given to <tt>Open()</tt>.
+*/
+class CaptureSink : public ISinkBackend
+{
+public:
+    //!<  pNext receives every write first; null captures only.
+    explicit CaptureSink(ISinkBackend* pNext);
+    virtual ~CaptureSink();
+
+    //!<  Creates the file and starts the writer with a ring of frameCount frames, a power of two.
+    bool Open(const char* path, int sampleRate, int channelCount, int frameSampleCount, int frameCount);
+
+    //!<  Lets the writer drain the ring, stops it, and patches the RIFF and data chunk sizes.
+    void Close();
+
+    virtual void Write(const int16_t* interleaved, int sampleCount, int channelCount);
+
+    //!<  Frames in the file; final after <tt>Close()</tt>.
+    int64_t GetWrittenFrameCount() const { return m_WrittenFrameCount.load(std::memory_order_relaxed); }
+    uint32_t GetDroppedFrameCount() const { return m_Ring.GetDroppedFrameCount(); }
+    int GetPeakFrameCount() const { return m_Ring.GetPeakFrameCount(); }
+
+private:
+    CaptureSink(const CaptureSink&);
+    CaptureSink& operator=(const CaptureSink&);
+
+    void WriterMain();
+
+    ISinkBackend*         m_pNext;
+    std::FILE*            m_pFile;
+    int                   m_SampleRate;
+    int                   m_ChannelCount;
+    std::vector<char>     m_RingBuffer;
+    AudioDsp::CaptureRing m_Ring;
+    std::thread           m_Thread;
+    std::atomic<bool>     m_IsQuitRequested;
+    std::atomic<int64_t>  m_WrittenFrameCount;
+};
+
+//!<  Writes a canonical 44-byte PCM WAV header.
+void WriteWavHeader(std::FILE* pFile, int sampleRate, int channelCount, uint32_t dataSize);
+
+}  // namespace HostAudio
@@ -0,0 +1,3398 @@
+/**
+* @brief
+*  Host driver for the software audio renderer.
+*
+*  Builds the same graph as <tt>nnMain_Sound</tt> in <tt>AudioRenderer.cpp</tt> and renders it offline.
+*
+*  Build on the host (Linux, gcc or clang):
+*  <tt>c++ -O2 -std=c++11 -pthread -o HostAudioTool HostAudioTool.cpp HostAudio.cpp HostAudioKernels.cpp HostAudioSink.cpp AudioDspAdpcm.cpp AudioDspAdpcmEncoder.cpp AudioDspBank.cpp AudioDspBiquad.cpp AudioDspBudget.cpp AudioDspCaptureRing.cpp AudioDspConvolver.cpp AudioDspFft.cpp AudioDspMeter.cpp AudioDspMetrics.cpp AudioDspOscillator.cpp AudioDspResampler.cpp AudioDspSpatializer.cpp AudioDspWav.cpp AudioDspWavePool.cpp</tt>
+*
+*  Commands:
+*  - <tt>render &lt;out.wav&gt; [--seconds N] [--bgm file.wav] [--se file.adpcm]... [--bank file.bank] [--metrics out.jsonl|-] [--reverb impulse.wav] [--capture out.wav]</tt>
+*    Renders the sample scenario to a WAV file (or to the null sink if the path is "-"). The ADPCM sounds of a bank are
+*    played as further sound effects. With <tt>--metrics</tt>, the renderer's performance frames are aggregated as on the
+*    console, and a metrics line in the <tt>AudioDspMetrics.h</tt> schema is written every second of audio. With
+*    <tt>--reverb</tt>, a convolution reverb with the impulse (at <tt>RenderRate</tt>) runs on auxBusA, where the sound effects play.
+*    With <tt>--capture</tt>, the final mix is also copied to a WAV file through a lock-free ring and a writer thread, as
+*    the console engine captures it, and the frames the writer could not keep up with are reported.
+*  - <tt>capacity [--se file.adpcm]</tt>
+*    Reports how many voices fit in one <tt>RenderCount</tt> frame (5 ms) on this machine.
+*  - <tt>wav-info &lt;file.wav&gt;...</tt>
+*    Prints the format, data offset, loop points, and chunk layout of WAV files.
+*  - <tt>adpcm-decode &lt;in.adpcm&gt; &lt;out.wav&gt; [--seconds N] [--verify reference.wav]</tt>
+*    Decodes a DSP-ADPCM file (following its loop) and optionally compares the result bit for bit with a reference.
+*  - <tt>adpcm-bench &lt;in.adpcm&gt;...</tt>
+*    Measures decoder throughput against a per-sample reference decoder and checks that both agree.
+*  - <tt>adpcm-encode &lt;out-dir&gt; &lt;in.wav&gt;... [--jobs N]</tt>
+*    Encodes 16-bit PCM WAV files to DSP-ADPCM, 3.5 times smaller, with predictors designed for each file and the loop
+*    of its <tt>smpl</tt> chunk. Each channel becomes a mono file (<tt>name.adpcm</tt>, or <tt>name_0.adpcm</tt> and so on),
+*    encoded on N threads (every core by default). Every file is decoded again to report its signal to noise ratio and
+*    to check that its loop context continues the loop seamlessly. The output goes into a bank with <tt>bank-build</tt>.
+*  - <tt>oscillator-bench [--count N]</tt>
+*    Measures the oscillator bank per waveform against a per-sample <tt>sinf()</tt> mix and checks the sine accuracy.
+*  - <tt>biquad-bench [--sections N]</tt>
+*    Measures a swept biquad cascade in block form against a per-sample cascade and checks that both agree.
+*  - <tt>convert &lt;in.wav|in.adpcm&gt; &lt;out.wav&gt; [--rate N]</tt>
+*    Resamples an asset to N Hz (<tt>RenderRate</tt> by default) with the polyphase filter, so its voice plays at pitch 1.0
+*    without sample rate conversion, and reports the renderer time this saves per voice. ADPCM input is written as PCM.
+*  - <tt>bank-build &lt;out.bank&gt; &lt;in.adpcm|in.wav&gt;...</tt>
+*    Packs DSP-ADPCM and 16-bit PCM WAV files into one bank for <tt>AudioBank</tt>; each sound is named after its file.
+*  - <tt>bank-info &lt;file.bank&gt;...</tt>
+*    Validates banks and lists their sounds.
+*  - <tt>budget &lt;file.bank&gt;... [--polyphony N] [--voices N]</tt>
+*    Computes the bank memory and voices the sounds of the banks need at polyphony N (3) each, capped at N voices if
+*    given, from the bank headers and entry tables as <tt>ApplyAudioEngineManifest()</tt> does on the console. The renderer
+*    buffers this takes are <tt>nn::audio</tt> sizes, logged on the console by <tt>AudioEngine::DumpBudget()</tt>.
+*  - <tt>pool-bench [--hours N]</tt>
+*    Runs N hours (4) of stream chunk and bank traffic through <tt>AudioDsp::WavePool</tt> over a 14 MB pool, checking
+*    alignment, overlap, and that unloading every bank leaves the long-lived region whole, then reports the occupancy
+*    of each slab, the cost per operation against the system allocator, and the largest bank that still fits.
+*  - <tt>ir-make &lt;out.wav&gt; [--seconds N] [--rate N]</tt>
+*    Synthesizes a stereo room impulse response of N seconds (decaying to -60 dB) with unit energy per channel, for
+*    <tt>render --reverb</tt>. <tt>SampleRoom.wav</tt> next to this tool was made with the defaults.
+*  - <tt>reverb-bench [--ir impulse.wav]</tt>
+*    Measures the partitioned convolution per frame for impulses of 0.25 to 4 seconds (or the given one), reports the
+*    cost per second of impulse, and checks the output against direct convolution.
+*  - <tt>spatializer-bench [--emitters N] [--channels N]</tt>
+*    Measures the gain matrix update of N emitters (64) over the default layout of N channels (2) for a turning and a
+*    still listener, counts the emitters whose gains changed, and checks the gains against a per-emitter angle computation.
+*  - <tt>meter-bench [--channels N]</tt>
+*    Checks the bus meter against a sine of known level and the BS.1770 coefficients, and its clip count on a burst past
+*    full scale, then measures its cost per audio frame for N channels (2).
+*  - <tt>scenario [--frames N] [--repeat N] [--bank file.bank] [--golden file.txt] [--update] [--wav out.wav] [--reference ref.wav]</tt>
+*    Renders N frames (2000, ten seconds) of a scripted run of the sample: a synthesized BGM with filter toggles, pauses,
+*    and a pan sweep, the ADPCM sounds of the bank (SampleSe.bank) triggered in turn, and sine volume and pitch sweeps.
+*    Reports the fastest of the runs in voice frames per millisecond and as a realtime factor, then compares a hash of
+*    each second of output with the golden file (<tt>HostAudioScenario.golden</tt>), or rewrites it with <tt>--update</tt>.
+*    A DSP change that is meant to keep the output should match bit for bit. One that only changes rounding can be
+*    judged with <tt>--reference</tt>, a <tt>--wav</tt> render from before the change. The golden file was made on
+*    x86-64, where the SSE kernels run; the NEON and scalar kernels round differently.
+*/
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "AudioDspAdpcm.h"
+#include "AudioDspAdpcmEncoder.h"
+#include "AudioDspBank.h"
+#include "AudioDspBiquad.h"
+#include "AudioDspBudget.h"
+#include "AudioDspConvolver.h"
+#include "AudioDspMeter.h"
+#include "AudioDspMetrics.h"
+#include "AudioDspOscillator.h"
+#include "AudioDspResampler.h"
+#include "AudioDspSpatializer.h"
+#include "AudioDspWav.h"
+#include "AudioDspWavePool.h"
+#include "HostAudio.h"
+#include "HostAudioSink.h"
+
+namespace {
+
+// Same rates as the console sample.
+const int RenderRate = 32000;
+const int RenderCount = (RenderRate / 200);
+
+const int SeCountMax = 4;
+
+// Voices the render and scenario graphs play at most: the sine, the BGM, and one per sound effect.
+const int RenderVoiceCount = 1 + 1 + SeCountMax;
+
+// Labels of the voices in the metrics.
+const char* const SeLabels[SeCountMax] = { "se0", "se1", "se2", "se3" };
+
+// BGM filters, designed for RenderRate at compile time.
+constexpr AudioDsp::BiquadQ14 BgmLowPassFilter = AudioDsp::ToBiquadQ14(AudioDsp::DesignBiquadConstant(AudioDsp::BiquadType_LowPass, RenderRate, 2048.0, 0.7071));
+constexpr AudioDsp::BiquadQ14 BgmHighPassFilter = AudioDsp::ToBiquadQ14(AudioDsp::DesignBiquadConstant(AudioDsp::BiquadType_HighPass, RenderRate, 1024.0, 0.7071));
+
+// Level of the reverb on auxBusA. Impulses from ir-make have unit energy, so this is the wet to dry power ratio.
+const float ReverbWetGain = 0.5f;
+
+// Samples per generated sine buffer; the four-buffer ring holds 40 ms.
+const int OscillatorStreamSampleCount = 320;
+
+// Audio frames the capture ring holds (1.28 s at RenderCount), so the writer may stall that long without a gap.
+const int CaptureFrameCount = 256;
+
+std::vector<char> g_WorkBuffer;
+std::vector<char> g_ConfigBuffer;
+
+void FreeWaveBuffer(void* p)
+{
+#if defined(_WIN32)
+    _aligned_free(p);
+#else
+    std::free(p);
+#endif
+}
+
+// Every wave buffer not yet freed, oldest first. What a WaveBufferScope leaves is freed at exit, std::exit() included.
+struct WaveBufferList
+{
+    std::vector<void*> buffers;
+
+    ~WaveBufferList()
+    {
+        for (std::size_t i = 0; i < buffers.size(); ++i)
+        {
+            FreeWaveBuffer(buffers[i]);
+        }
+    }
+};
+
+WaveBufferList g_WaveBuffers;
+
+// Frees the wave buffers allocated while it lives, for commands that load one input after another.
+class WaveBufferScope
+{
+public:
+    WaveBufferScope() : m_Mark(g_WaveBuffers.buffers.size()) {}
+
+    ~WaveBufferScope()
+    {
+        while (g_WaveBuffers.buffers.size() > m_Mark)
+        {
+            FreeWaveBuffer(g_WaveBuffers.buffers.back());
+            g_WaveBuffers.buffers.pop_back();
+        }
+    }
+
+private:
+    WaveBufferScope(const WaveBufferScope&);
+    WaveBufferScope& operator=(const WaveBufferScope&);
+
+    std::size_t m_Mark;
+};
+
+void* AllocateWaveBuffer(std::size_t size)
+{
+    // Stand-in for g_WaveBufferAllocator. The buffer lives until the enclosing WaveBufferScope ends, or until exit.
+    void* p = nullptr;
+    const std::size_t alignedSize = (size + HostAudio::BufferAlignSize - 1) & ~(HostAudio::BufferAlignSize - 1);
+#if defined(_WIN32)
+    p = _aligned_malloc(alignedSize, HostAudio::BufferAlignSize);
+#else
+    if (posix_memalign(&p, HostAudio::BufferAlignSize, alignedSize) != 0)
+    {
+        p = nullptr;
+    }
+#endif
+    if (p == nullptr)
+    {
+        std::fprintf(stderr, "Out of memory (%zu bytes)\n", size);
+        std::exit(1);
+    }
+    g_WaveBuffers.buffers.push_back(p);
+    return p;
+}
+
+bool ReadWholeFile(std::vector<uint8_t>* pOut, const char* path)
+{
+    std::FILE* pFile = std::fopen(path, "rb");
+    if (pFile == nullptr)
+    {
+        return false;
+    }
+    std::fseek(pFile, 0, SEEK_END);
+    const long size = std::ftell(pFile);
+    std::fseek(pFile, 0, SEEK_SET);
+    pOut->resize(size > 0 ? static_cast<std::size_t>(size) : 0);
+    const bool ok = size > 0 && std::fread(pOut->data(), 1, pOut->size(), pFile) == pOut->size();
+    std::fclose(pFile);
+    return ok;
+}
+
+struct PcmData
+{
+    void* data;
+    std::size_t size;
+    int sampleRate;
+    int channelCount;
+};
+
+struct AdpcmData
+{
+    HostAudio::AdpcmHeaderInfo header;
+    void* data;
+    std::size_t size;
+};
+
+bool ReadStdioFile(void* pUserData, int64_t offset, void* buffer, std::size_t size)
+{
+    std::FILE* pFile = static_cast<std::FILE*>(pUserData);
+    return std::fseek(pFile, static_cast<long>(offset), SEEK_SET) == 0 && std::fread(buffer, 1, size, pFile) == size;
+}
+
+bool ReadWavLayout(AudioDsp::WavLayout* pOutLayout, std::FILE* pFile, const char* path)
+{
+    std::fseek(pFile, 0, SEEK_END);
+    const long fileSize = std::ftell(pFile);
+    const AudioDsp::WavResult result = AudioDsp::ParseWavLayout(pOutLayout, ReadStdioFile, pFile, fileSize);
+    if (result != AudioDsp::WavResult_Success)
+    {
+        std::fprintf(stderr, "%s: %s\n", path, AudioDsp::GetWavResultString(result));
+        return false;
+    }
+    return true;
+}
+
+bool ReadWavFile(PcmData* pOut, const char* path)
+{
+    std::FILE* pFile = std::fopen(path, "rb");
+    if (pFile == nullptr)
+    {
+        return false;
+    }
+    AudioDsp::WavLayout layout;
+    bool ok = ReadWavLayout(&layout, pFile, path) && layout.bitsPerSample == 16;
+    if (ok)
+    {
+        // Exactly dataSize bytes, filled by one read at the data chunk offset.
+        pOut->size = static_cast<std::size_t>(layout.dataSize);
+        pOut->data = AllocateWaveBuffer(pOut->size);
+        pOut->sampleRate = layout.sampleRate;
+        pOut->channelCount = layout.channelCount;
+        ok = ReadStdioFile(pFile, layout.dataOffset, pOut->data, pOut->size);
+    }
+    std::fclose(pFile);
+    return ok;
+}
+
+bool ReadAdpcmFile(AdpcmData* pOut, const char* path)
+{
+    std::vector<uint8_t> file;
+    if (!ReadWholeFile(&file, path) || file.size() < HostAudio::AdpcmHeaderSize)
+    {
+        return false;
+    }
+    if (!HostAudio::ParseAdpcmHeader(&pOut->header, file.data(), HostAudio::AdpcmHeaderSize))
+    {
+        return false;
+    }
+    pOut->size = file.size() - HostAudio::AdpcmHeaderSize;
+    pOut->data = AllocateWaveBuffer(pOut->size);
+    std::memcpy(pOut->data, file.data() + HostAudio::AdpcmHeaderSize, pOut->size);
+    return true;
+}
+
+void GenerateSineWave(PcmData* pOut, int sampleRate, int frequency, int sampleCount)
+{
+    int16_t* p = static_cast<int16_t*>(AllocateWaveBuffer(sampleCount * sizeof(int16_t)));
+    const float Pi = 3.1415926535897932384626433f;
+    for (int i = 0; i < sampleCount; ++i)
+    {
+        p[i] = static_cast<int16_t>(std::numeric_limits<int16_t>::max() * sinf(2 * Pi * frequency * i / sampleRate));
+    }
+    pOut->data = p;
+    pOut->size = sampleCount * sizeof(int16_t);
+    pOut->sampleRate = sampleRate;
+    pOut->channelCount = 1;
+}
+
+void OpenRenderer(HostAudio::AudioRendererHandle* pHandle, HostAudio::AudioRendererConfig* pConfig, const HostAudio::AudioRendererParameter& parameter)
+{
+    if (!HostAudio::IsValidAudioRendererParameter(parameter))
+    {
+        std::fprintf(stderr, "Invalid AudioRendererParameter specified.\n");
+        std::exit(1);
+    }
+    g_WorkBuffer.resize(HostAudio::GetAudioRendererWorkBufferSize(parameter));
+    if (!HostAudio::OpenAudioRenderer(pHandle, parameter, g_WorkBuffer.data(), g_WorkBuffer.size()))
+    {
+        std::fprintf(stderr, "Failed to open AudioRenderer\n");
+        std::exit(1);
+    }
+    g_ConfigBuffer.resize(HostAudio::GetAudioRendererConfigWorkBufferSize(parameter));
+    HostAudio::InitializeAudioRendererConfig(pConfig, parameter, g_ConfigBuffer.data(), g_ConfigBuffer.size());
+}
+
+// Reads a bank in one piece, as AudioBank::Load() does on the console. Freed at exit.
+const void* ReadBankFile(const char* path)
+{
+    std::FILE* pFile = std::fopen(path, "rb");
+    if (pFile == nullptr)
+    {
+        std::fprintf(stderr, "Cannot open %s\n", path);
+        return nullptr;
+    }
+    std::fseek(pFile, 0, SEEK_END);
+    const long size = std::ftell(pFile);
+    std::fseek(pFile, 0, SEEK_SET);
+    void* bank = size > 0 ? AllocateWaveBuffer(static_cast<std::size_t>(size)) : nullptr;
+    const bool ok = bank != nullptr && std::fread(bank, 1, static_cast<std::size_t>(size), pFile) == static_cast<std::size_t>(size);
+    std::fclose(pFile);
+    if (!ok)
+    {
+        std::fprintf(stderr, "Cannot read %s\n", path);
+        return nullptr;
+    }
+    const AudioDsp::BankResult result = AudioDsp::ValidateBank(bank, static_cast<std::size_t>(size));
+    if (result != AudioDsp::BankResult_Success)
+    {
+        std::fprintf(stderr, "%s: %s\n", path, AudioDsp::GetBankResultString(result));
+        return nullptr;
+    }
+    return bank;
+}
+
+// Feeds the frames of a performance buffer to the metrics, as AudioPerformanceMetrics does on the console.
+void AddPerformanceFrames(AudioDsp::RenderMetrics* pMetrics, const void* buffer, std::size_t bufferSize)
+{
+    HostAudio::PerformanceInfo info;
+    if (!info.SetBuffer(buffer, bufferSize))
+    {
+        return;
+    }
+    do
+    {
+        pMetrics->BeginFrame();
+        int entryCount;
+        const HostAudio::PerformanceEntry* pEntries = info.GetEntries(&entryCount);
+        for (int i = 0; i < entryCount; ++i)
+        {
+            switch (pEntries[i].entryType)
+            {
+            case HostAudio::PerformanceEntryType_Voice:
+                pMetrics->AddEntry(AudioDsp::MetricsNodeType_Voice, pEntries[i].nodeId, pEntries[i].processingTime);
+                break;
+            case HostAudio::PerformanceEntryType_SubMix:
+                pMetrics->AddEntry(AudioDsp::MetricsNodeType_SubMix, pEntries[i].nodeId, pEntries[i].processingTime);
+                break;
+            case HostAudio::PerformanceEntryType_FinalMix:
+                pMetrics->AddEntry(AudioDsp::MetricsNodeType_FinalMix, pEntries[i].nodeId, pEntries[i].processingTime);
+                break;
+            case HostAudio::PerformanceEntryType_Sink:
+                pMetrics->AddEntry(AudioDsp::MetricsNodeType_Sink, pEntries[i].nodeId, pEntries[i].processingTime);
+                break;
+            default:
+                break;
+            }
+        }
+        int detailCount;
+        const HostAudio::PerformanceDetailEntry* pDetails = info.GetDetailEntries(&detailCount);
+        for (int i = 0; i < detailCount; ++i)
+        {
+            if (pDetails[i].parentEntryType == HostAudio::PerformanceEntryType_FinalMix)
+            {
+                pMetrics->AddEntry(AudioDsp::MetricsNodeType_Effect, pDetails[i].nodeId, pDetails[i].processingTime);
+            }
+        }
+        pMetrics->EndFrame(info.GetTotalProcessingTime(), info.IsRenderingTimeLimitExceeded());
+    } while (info.MoveToNextFrame());
+}
+
+void WriteMetrics(std::FILE* pFile, const AudioDsp::RenderMetrics& metrics)
+{
+    std::vector<char> line(4096);
+    const int length = metrics.Dump(line.data(), line.size(), "host");
+    if (static_cast<std::size_t>(length) >= line.size())
+    {
+        line.resize(length + 1);
+        metrics.Dump(line.data(), line.size(), "host");
+    }
+    std::fputs(line.data(), pFile);
+}
+
+struct RenderOptions
+{
+    const char* outputPath;
+    double seconds;
+    const char* bgmPath;
+    const char* sePaths[SeCountMax];
+    int seCount;
+    const char* bankPath;
+    const char* metricsPath;
+    const char* reverbPath;
+    const char* capturePath;
+};
+
+int RunRender(const RenderOptions& options)
+{
+    HostAudio::AudioRendererParameter parameter;
+    HostAudio::InitializeAudioRendererParameter(&parameter);
+    parameter.sampleRate = RenderRate;
+    parameter.sampleCount = RenderCount;
+    parameter.mixBufferCount = 6 + 2; // FinalMix(6) + SubMix(2)
+    parameter.voiceCount = RenderVoiceCount;
+    parameter.subMixCount = 2;
+    parameter.sinkCount = 1;
+    parameter.effectCount = options.reverbPath != nullptr ? 2 : 1; // BufferMixer, and the reverb if any
+    // The update runs every audio frame, so each performance buffer holds one frame.
+    parameter.performanceFrameCount = options.metricsPath != nullptr ? 1 : 0;
+
+    int channelCount = 2;
+    int8_t mainBus[2];
+    mainBus[HostAudio::ChannelMapping_FrontLeft] = 4;
+    mainBus[HostAudio::ChannelMapping_FrontRight] = 5;
+    int8_t auxBusA[2];
+    auxBusA[HostAudio::ChannelMapping_FrontLeft] = 0;
+    auxBusA[HostAudio::ChannelMapping_FrontRight] = 1;
+
+    HostAudio::AudioRendererHandle handle;
+    HostAudio::AudioRendererConfig config;
+    OpenRenderer(&handle, &config, parameter);
+
+    HostAudio::FinalMixType finalMix;
+    HostAudio::AcquireFinalMix(&config, &finalMix, 6);
+    HostAudio::SubMixType subMix0;
+    HostAudio::AcquireSubMix(&config, &subMix0, parameter.sampleRate, 1);
+    HostAudio::SubMixType subMix1;
+    HostAudio::AcquireSubMix(&config, &subMix1, parameter.sampleRate, 1);
+
+    HostAudio::DeviceSinkType deviceSink;
+    HostAudio::AddDeviceSink(&config, &deviceSink, &finalMix, mainBus, channelCount, "MainAudioOut");
+
+    HostAudio::WavFileSink wavSink;
+    HostAudio::NullSink nullSink;
+    HostAudio::ISinkBackend* pOutput = &nullSink;
+    if (std::strcmp(options.outputPath, "-") != 0)
+    {
+        if (!wavSink.Open(options.outputPath, RenderRate, channelCount))
+        {
+            std::fprintf(stderr, "Cannot open %s\n", options.outputPath);
+            return 1;
+        }
+        pOutput = &wavSink;
+    }
+
+    // The capture sits in front of the output and copies the final mix to its own file on a writer thread.
+    HostAudio::CaptureSink captureSink(pOutput);
+    if (options.capturePath != nullptr)
+    {
+        if (!captureSink.Open(options.capturePath, RenderRate, channelCount, RenderCount, CaptureFrameCount))
+        {
+            std::fprintf(stderr, "Cannot open %s\n", options.capturePath);
+            return 1;
+        }
+        pOutput = &captureSink;
+    }
+    HostAudio::SetDeviceSinkBackend(&deviceSink, pOutput);
+
+    HostAudio::SetSubMixDestination(&config, &subMix0, &finalMix);
+    HostAudio::SetSubMixMixVolume(&subMix0, &finalMix, 0.5f, 0, mainBus[0]);
+    HostAudio::SetSubMixMixVolume(&subMix0, &finalMix, 0.5f, 0, mainBus[1]);
+    HostAudio::SetSubMixDestination(&config, &subMix1, &subMix0);
+    HostAudio::SetSubMixMixVolume(&subMix1, &subMix0, 0.5f, 0, 0);
+
+    // Convolution reverb on auxBusA, added first so it runs before the mixer sends auxBusA to mainBus.
+    HostAudio::ConvolutionReverbType reverb;
+    std::vector<char> reverbBuffer;
+    if (options.reverbPath != nullptr)
+    {
+        PcmData impulse;
+        if (!ReadWavFile(&impulse, options.reverbPath))
+        {
+            std::fprintf(stderr, "Cannot read 16-bit PCM WAV %s\n", options.reverbPath);
+            return 1;
+        }
+        if (impulse.sampleRate != RenderRate)
+        {
+            std::fprintf(stderr, "%s is %d Hz; convert the impulse to %d Hz first\n", options.reverbPath, impulse.sampleRate, RenderRate);
+            return 1;
+        }
+        const int impulseSampleCount = static_cast<int>(impulse.size / sizeof(int16_t)) / impulse.channelCount;
+        reverbBuffer.resize(HostAudio::GetRequiredBufferSizeForConvolutionReverb(RenderRate, channelCount, impulseSampleCount));
+        HostAudio::AddConvolutionReverb(&config, &reverb, reverbBuffer.data(), reverbBuffer.size(), &finalMix, channelCount, impulseSampleCount);
+        HostAudio::SetConvolutionReverbInputOutput(&reverb, auxBusA, auxBusA, channelCount);
+        HostAudio::SetConvolutionReverbImpulse(&reverb, static_cast<const int16_t*>(impulse.data), impulseSampleCount, impulse.channelCount);
+        HostAudio::SetConvolutionReverbWetGain(&reverb, ReverbWetGain);
+    }
+
+    HostAudio::BufferMixerType mixer1;
+    HostAudio::AddBufferMixer(&config, &mixer1, &finalMix);
+    HostAudio::SetBufferMixerInputOutput(&mixer1, auxBusA, mainBus, channelCount);
+    HostAudio::SetBufferMixerVolume(&mixer1, 0, 1.0f);
+    HostAudio::SetBufferMixerVolume(&mixer1, 1, 1.0f);
+
+    HostAudio::RequestUpdateAudioRenderer(handle, &config);
+    HostAudio::StartAudioRenderer(handle);
+
+    // Sine wave, generated on demand into a small ring of wave buffers.
+    HostAudio::VoiceType voiceSine;
+    HostAudio::WaveBuffer waveBufferSine[HostAudio::VoiceWaveBufferCountMax];
+    int16_t* dataSine[HostAudio::VoiceWaveBufferCountMax];
+    AudioDsp::OscillatorBank sineBank;
+    std::vector<char> sineBankWorkBuffer(AudioDsp::OscillatorBank::GetRequiredWorkBufferSize(1));
+    {
+        const int sineSampleRate = 32000;
+        const float sineFrequency = 440.0f;
+        sineBank.Initialize(sineBankWorkBuffer.data(), sineBankWorkBuffer.size(), 1, sineSampleRate);
+        sineBank.Add(AudioDsp::Waveform_Sine, sineFrequency, 1.0f);
+
+        HostAudio::AcquireVoiceSlot(&config, &voiceSine, sineSampleRate, 1, HostAudio::SampleFormat_PcmInt16, HostAudio::VoiceType::PriorityHighest, nullptr, 0);
+        HostAudio::SetVoiceDestination(&config, &voiceSine, &subMix1);
+
+        for (int i = 0; i < HostAudio::VoiceWaveBufferCountMax; ++i)
+        {
+            dataSine[i] = static_cast<int16_t*>(AllocateWaveBuffer(OscillatorStreamSampleCount * sizeof(int16_t)));
+            sineBank.Process(dataSine[i], OscillatorStreamSampleCount);
+
+            HostAudio::WaveBuffer& waveBuffer = waveBufferSine[i];
+            waveBuffer.buffer = dataSine[i];
+            waveBuffer.size = OscillatorStreamSampleCount * sizeof(int16_t);
+            waveBuffer.startSampleOffset = 0;
+            waveBuffer.endSampleOffset = OscillatorStreamSampleCount;
+            waveBuffer.loop = false;
+            waveBuffer.isEndOfStream = false;
+            waveBuffer.pContext = nullptr;
+            waveBuffer.contextSize = 0;
+            HostAudio::AppendWaveBuffer(&voiceSine, &waveBuffer);
+        }
+        HostAudio::SetVoicePlayState(&voiceSine, HostAudio::VoiceType::PlayState_Play);
+        HostAudio::SetVoiceMixVolume(&voiceSine, &subMix1, 0.707f / 2, 0, 0);
+    }
+
+    // Background music.
+    HostAudio::VoiceType voiceBgm;
+    HostAudio::WaveBuffer waveBufferBgm;
+    bool hasBgm = false;
+    if (options.bgmPath != nullptr)
+    {
+        PcmData bgm;
+        if (!ReadWavFile(&bgm, options.bgmPath))
+        {
+            std::fprintf(stderr, "Cannot read 16-bit PCM WAV %s\n", options.bgmPath);
+            return 1;
+        }
+        HostAudio::AcquireVoiceSlot(&config, &voiceBgm, bgm.sampleRate, bgm.channelCount, HostAudio::SampleFormat_PcmInt16, HostAudio::VoiceType::PriorityHighest, nullptr, 0);
+        HostAudio::SetVoiceDestination(&config, &voiceBgm, &finalMix);
+
+        waveBufferBgm.buffer = bgm.data;
+        waveBufferBgm.size = bgm.size;
+        waveBufferBgm.startSampleOffset = 0;
+        waveBufferBgm.endSampleOffset = static_cast<int32_t>(bgm.size / sizeof(int16_t)) / bgm.channelCount;
+        waveBufferBgm.loop = true;
+        waveBufferBgm.isEndOfStream = false;
+        waveBufferBgm.pContext = nullptr;
+        waveBufferBgm.contextSize = 0;
+
+        HostAudio::AppendWaveBuffer(&voiceBgm, &waveBufferBgm);
+        HostAudio::SetVoicePlayState(&voiceBgm, HostAudio::VoiceType::PlayState_Play);
+        HostAudio::SetVoiceMixVolume(&voiceBgm, &finalMix, 0.5f, 0, mainBus[0]);
+        HostAudio::SetVoiceMixVolume(&voiceBgm, &finalMix, 0.5f, 1, mainBus[1]);
+
+        HostAudio::BiquadFilterParameter firstFilter = AudioDsp::ToBiquadFilterParameter<HostAudio::BiquadFilterParameter>(BgmLowPassFilter, true);
+        HostAudio::SetVoiceBiquadFilterParameter(&voiceBgm, 0, firstFilter);
+        HostAudio::BiquadFilterParameter secondFilter = AudioDsp::ToBiquadFilterParameter<HostAudio::BiquadFilterParameter>(BgmHighPassFilter, false);
+        HostAudio::SetVoiceBiquadFilterParameter(&voiceBgm, 1, secondFilter);
+        hasBgm = true;
+    }
+
+    // Sound effects, from their own files and then the ADPCM sounds of the bank.
+    HostAudio::VoiceType voiceSe[SeCountMax];
+    HostAudio::WaveBuffer waveBufferSe[SeCountMax];
+    AdpcmData se[SeCountMax];
+    int seCount = 0;
+    for (; seCount < options.seCount; ++seCount)
+    {
+        if (!ReadAdpcmFile(&se[seCount], options.sePaths[seCount]))
+        {
+            std::fprintf(stderr, "Cannot read ADPCM %s\n", options.sePaths[seCount]);
+            return 1;
+        }
+    }
+    if (options.bankPath != nullptr)
+    {
+        const void* bank = ReadBankFile(options.bankPath);
+        if (bank == nullptr)
+        {
+            return 1;
+        }
+        for (int i = 0; i < AudioDsp::GetBankEntryCount(bank) && seCount < SeCountMax; ++i)
+        {
+            const AudioDsp::BankEntry* pEntry = AudioDsp::GetBankEntry(bank, i);
+            if (pEntry->sampleFormat == AudioDsp::BankSampleFormat_Adpcm)
+            {
+                se[seCount].header = pEntry->info;
+                se[seCount].data = const_cast<void*>(AudioDsp::GetBankEntryData(bank, i));
+                se[seCount].size = pEntry->dataSize;
+                ++seCount;
+            }
+        }
+    }
+    for (int i = 0; i < seCount; ++i)
+    {
+        HostAudio::AcquireVoiceSlot(&config, &voiceSe[i], se[i].header.sampleRate, 1, HostAudio::SampleFormat_Adpcm, HostAudio::VoiceType::PriorityHighest, &se[i].header.parameter, sizeof(HostAudio::AdpcmParameter));
+        HostAudio::SetVoiceDestination(&config, &voiceSe[i], &finalMix);
+
+        waveBufferSe[i].buffer = se[i].data;
+        waveBufferSe[i].size = se[i].size;
+        waveBufferSe[i].startSampleOffset = 0;
+        waveBufferSe[i].endSampleOffset = se[i].header.sampleCount;
+        waveBufferSe[i].loop = false;
+        waveBufferSe[i].isEndOfStream = false;
+        waveBufferSe[i].pContext = &se[i].header.context;
+        waveBufferSe[i].contextSize = sizeof(HostAudio::AdpcmContext);
+
+        HostAudio::AppendWaveBuffer(&voiceSe[i], &waveBufferSe[i]);
+        HostAudio::SetVoicePlayState(&voiceSe[i], HostAudio::VoiceType::PlayState_Play);
+        HostAudio::SetVoiceMixVolume(&voiceSe[i], &finalMix, 0.707f / 2, 0, auxBusA[0]);
+        HostAudio::SetVoiceMixVolume(&voiceSe[i], &finalMix, 0.707f / 2, 0, auxBusA[1]);
+    }
+
+    // Performance metrics: the renderer fills one buffer while the other is parsed.
+    AudioDsp::RenderMetrics metrics;
+    std::vector<uint8_t> performanceBuffers[2];
+    std::FILE* pMetricsFile = nullptr;
+    if (options.metricsPath != nullptr)
+    {
+        pMetricsFile = std::strcmp(options.metricsPath, "-") == 0 ? stdout : std::fopen(options.metricsPath, "w");
+        if (pMetricsFile == nullptr)
+        {
+            std::fprintf(stderr, "Cannot open %s\n", options.metricsPath);
+            return 1;
+        }
+        metrics.Initialize(parameter.sampleCount, parameter.sampleRate);
+        metrics.SetLabel(HostAudio::GetVoiceNodeId(&voiceSine), "sine");
+        if (hasBgm)
+        {
+            metrics.SetLabel(HostAudio::GetVoiceNodeId(&voiceBgm), "bgm");
+        }
+        for (int i = 0; i < seCount; ++i)
+        {
+            metrics.SetLabel(HostAudio::GetVoiceNodeId(&voiceSe[i]), SeLabels[i]);
+        }
+        for (int i = 0; i < 2; ++i)
+        {
+            performanceBuffers[i].resize(HostAudio::GetRequiredBufferSizeForPerformanceFrames(parameter));
+        }
+        HostAudio::SetPerformanceFrameBuffer(&config, performanceBuffers[0].data(), performanceBuffers[0].size());
+        HostAudio::SetPerformanceDetailTarget(&config, &finalMix);
+    }
+
+    const int frameCount = static_cast<int>(options.seconds * RenderRate / RenderCount);
+    const auto start = std::chrono::steady_clock::now();
+    for (int frame = 0; frame < frameCount; ++frame)
+    {
+        if (pMetricsFile != nullptr)
+        {
+            std::vector<uint8_t>& next = performanceBuffers[(frame + 1) % 2];
+            const void* filled = HostAudio::SetPerformanceFrameBuffer(&config, next.data(), next.size());
+            AddPerformanceFrames(&metrics, filled, next.size());
+            if (frame > 0 && frame % AudioDsp::RenderMetrics::WindowFrameCount == 0)
+            {
+                WriteMetrics(pMetricsFile, metrics);
+            }
+        }
+
+        // Retrigger one SE per second, like pressing A/B/X/Y in turn.
+        const int framesPerSecond = RenderRate / RenderCount;
+        if (seCount > 0 && frame % framesPerSecond == 0)
+        {
+            const int i = (frame / framesPerSecond) % seCount;
+            if (HostAudio::GetReleasedWaveBuffer(&voiceSe[i]))
+            {
+                HostAudio::AppendWaveBuffer(&voiceSe[i], &waveBufferSe[i]);
+            }
+        }
+
+        // Refill the sine buffers that have finished playing.
+        while (const HostAudio::WaveBuffer* pWaveBuffer = HostAudio::GetReleasedWaveBuffer(&voiceSine))
+        {
+            const ptrdiff_t index = pWaveBuffer - waveBufferSine;
+            sineBank.Process(dataSine[index], OscillatorStreamSampleCount);
+            HostAudio::AppendWaveBuffer(&voiceSine, &waveBufferSine[index]);
+        }
+
+        HostAudio::RequestUpdateAudioRenderer(handle, &config);
+        HostAudio::ProcessAudioRenderer(handle);
+    }
+    const double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    if (pMetricsFile != nullptr)
+    {
+        const void* filled = HostAudio::SetPerformanceFrameBuffer(&config, nullptr, 0);
+        AddPerformanceFrames(&metrics, filled, performanceBuffers[0].size());
+        WriteMetrics(pMetricsFile, metrics);
+        if (pMetricsFile != stdout)
+        {
+            std::fclose(pMetricsFile);
+        }
+    }
+
+    wavSink.Close();
+    captureSink.Close();
+    HostAudio::StopAudioRenderer(handle);
+    HostAudio::CloseAudioRenderer(handle);
+
+    std::printf("Rendered %d frames (%.2f s of audio, %s) in %.3f s, %.1fx realtime\n",
+        frameCount, frameCount * double(RenderCount) / RenderRate, hasBgm ? "with BGM" : "no BGM",
+        elapsed, elapsed > 0.0 ? frameCount * double(RenderCount) / RenderRate / elapsed : 0.0);
+    if (options.capturePath != nullptr)
+    {
+        std::printf("Captured %lld frames to %s, %u dropped, at most %d of %d waiting\n",
+            static_cast<long long>(captureSink.GetWrittenFrameCount()), options.capturePath,
+            captureSink.GetDroppedFrameCount(), captureSink.GetPeakFrameCount(), CaptureFrameCount);
+    }
+    return 0;
+}
+
+// Average wall time for one audio frame with voiceCount active voices.
+double MeasureFrameTime(int voiceCount, const AdpcmData* pSe)
+{
+    HostAudio::AudioRendererParameter parameter;
+    HostAudio::InitializeAudioRendererParameter(&parameter);
+    parameter.sampleRate = RenderRate;
+    parameter.sampleCount = RenderCount;
+    parameter.mixBufferCount = 6;
+    parameter.voiceCount = voiceCount;
+    parameter.sinkCount = 1;
+
+    const int8_t mainBus[2] = { 4, 5 };
+    HostAudio::AudioRendererHandle handle;
+    HostAudio::AudioRendererConfig config;
+    OpenRenderer(&handle, &config, parameter);
+    HostAudio::FinalMixType finalMix;
+    HostAudio::AcquireFinalMix(&config, &finalMix, 6);
+    HostAudio::DeviceSinkType deviceSink;
+    HostAudio::AddDeviceSink(&config, &deviceSink, &finalMix, mainBus, 2, "MainAudioOut");
+    HostAudio::NullSink nullSink;
+    HostAudio::SetDeviceSinkBackend(&deviceSink, &nullSink);
+
+    static PcmData s_Sine;
+    if (s_Sine.data == nullptr)
+    {
+        GenerateSineWave(&s_Sine, 32000, 440, 32000);
+    }
+
+    std::vector<HostAudio::VoiceType> voices(voiceCount);
+    std::vector<HostAudio::WaveBuffer> waveBuffers(voiceCount);
+    const HostAudio::BiquadFilterParameter filter = AudioDsp::ToBiquadFilterParameter<HostAudio::BiquadFilterParameter>(BgmLowPassFilter, true);
+    for (int i = 0; i < voiceCount; ++i)
+    {
+        HostAudio::WaveBuffer& waveBuffer = waveBuffers[i];
+        std::memset(&waveBuffer, 0, sizeof(waveBuffer));
+        waveBuffer.loop = true;
+        // Alternate ADPCM and PCM voices when an SE is available; each one is resampled, filtered and panned.
+        if (pSe != nullptr && (i & 1))
+        {
+            HostAudio::AcquireVoiceSlot(&config, &voices[i], pSe->header.sampleRate, 1, HostAudio::SampleFormat_Adpcm, 0, &pSe->header.parameter, sizeof(HostAudio::AdpcmParameter));
+            waveBuffer.buffer = pSe->data;
+            waveBuffer.size = pSe->size;
+            waveBuffer.endSampleOffset = pSe->header.sampleCount;
+            waveBuffer.pContext = &pSe->header.context;
+            waveBuffer.contextSize = sizeof(HostAudio::AdpcmContext);
+        }
+        else
+        {
+            HostAudio::AcquireVoiceSlot(&config, &voices[i], s_Sine.sampleRate, 1, HostAudio::SampleFormat_PcmInt16, 0, nullptr, 0);
+            waveBuffer.buffer = s_Sine.data;
+            waveBuffer.size = s_Sine.size;
+            waveBuffer.endSampleOffset = static_cast<int32_t>(s_Sine.size / sizeof(int16_t));
+        }
+        HostAudio::SetVoiceDestination(&config, &voices[i], &finalMix);
+        HostAudio::AppendWaveBuffer(&voices[i], &waveBuffer);
+        HostAudio::SetVoicePitch(&voices[i], 1.0f + 0.001f * (i % 100));
+        HostAudio::SetVoiceBiquadFilterParameter(&voices[i], 0, filter);
+        HostAudio::SetVoiceMixVolume(&voices[i], &finalMix, 0.01f, 0, mainBus[0]);
+        HostAudio::SetVoiceMixVolume(&voices[i], &finalMix, 0.01f, 0, mainBus[1]);
+        HostAudio::SetVoicePlayState(&voices[i], HostAudio::VoiceType::PlayState_Play);
+    }
+
+    HostAudio::RequestUpdateAudioRenderer(handle, &config);
+    HostAudio::StartAudioRenderer(handle);
+    for (int i = 0; i < 20; ++i)
+    {
+        HostAudio::ProcessAudioRenderer(handle);
+    }
+    const int frameCount = 200;
+    const auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < frameCount; ++i)
+    {
+        HostAudio::ProcessAudioRenderer(handle);
+    }
+    const double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    HostAudio::CloseAudioRenderer(handle);
+    return elapsed / frameCount;
+}
+
+int RunCapacity(const char* sePath)
+{
+    AdpcmData se;
+    const AdpcmData* pSe = nullptr;
+    if (sePath != nullptr)
+    {
+        if (!ReadAdpcmFile(&se, sePath))
+        {
+            std::fprintf(stderr, "Cannot read ADPCM %s\n", sePath);
+            return 1;
+        }
+        pSe = &se;
+    }
+
+    const double budget = double(RenderCount) / RenderRate;
+    int low = 0;
+    double lowFrameTime = 0.0;
+    int high = 16;
+    for (double frameTime = MeasureFrameTime(high, pSe); frameTime < budget && high < (1 << 16); frameTime = MeasureFrameTime(high, pSe))
+    {
+        low = high;
+        lowFrameTime = frameTime;
+        high *= 2;
+    }
+    while (high - low > 1)
+    {
+        const int middle = (low + high) / 2;
+        const double frameTime = MeasureFrameTime(middle, pSe);
+        if (frameTime < budget)
+        {
+            low = middle;
+            lowFrameTime = frameTime;
+        }
+        else
+        {
+            high = middle;
+        }
+    }
+    const double frameTime = lowFrameTime;
+    std::printf("%d voices fit in a %d-sample frame (%.3f ms budget, %.3f ms used, %.2f us/voice)\n",
+        low, RenderCount, budget * 1000.0, frameTime * 1000.0, low > 0 ? frameTime * 1.0e6 / low : 0.0);
+    return 0;
+}
+
+int RunWavInfo(int fileCount, char** paths)
+{
+    int failedCount = 0;
+    for (int i = 0; i < fileCount; ++i)
+    {
+        std::FILE* pFile = std::fopen(paths[i], "rb");
+        AudioDsp::WavLayout layout;
+        if (pFile == nullptr || !ReadWavLayout(&layout, pFile, paths[i]))
+        {
+            if (pFile != nullptr)
+            {
+                std::fclose(pFile);
+            }
+            ++failedCount;
+            continue;
+        }
+        std::fclose(pFile);
+
+        std::printf("%s: %d Hz, %d ch, %d bit, data at %lld (%lld bytes, %lld frames)",
+            paths[i], layout.sampleRate, layout.channelCount, layout.bitsPerSample,
+            static_cast<long long>(layout.dataOffset), static_cast<long long>(layout.dataSize), static_cast<long long>(layout.frameCount));
+        if (layout.hasLoop)
+        {
+            std::printf(", loop %lld-%lld", static_cast<long long>(layout.loopStartFrame), static_cast<long long>(layout.loopEndFrame));
+        }
+        std::printf("\n");
+        for (int j = 0; j < layout.chunkCount; ++j)
+        {
+            const AudioDsp::WavChunk& chunk = layout.chunks[j];
+            std::printf("  %c%c%c%c  offset %-10lld size %u\n",
+                static_cast<char>(chunk.id), static_cast<char>(chunk.id >> 8), static_cast<char>(chunk.id >> 16), static_cast<char>(chunk.id >> 24),
+                static_cast<long long>(chunk.offset), chunk.size);
+        }
+    }
+    return failedCount == 0 ? 0 : 1;
+}
+
+// Straightforward per-sample decoder kept as the reference for the block decoder.
+void DecodeAdpcmReference(int16_t* pOut, const uint8_t* pData, int32_t startSampleOffset, int sampleCount, const AudioDsp::AdpcmParameter& parameter, AudioDsp::AdpcmContext* pContext)
+{
+    int32_t history0 = pContext->history[0];
+    int32_t history1 = pContext->history[1];
+    for (int i = 0; i < sampleCount; ++i)
+    {
+        const int32_t offset = startSampleOffset + i;
+        const uint8_t* pFrame = pData + offset / AudioDsp::AdpcmFrameSampleCount * AudioDsp::AdpcmFrameSize;
+        const int indexInFrame = offset % AudioDsp::AdpcmFrameSampleCount;
+        const uint8_t predScale = pFrame[0];
+        const uint8_t byte = pFrame[1 + indexInFrame / 2];
+        int32_t nibble = (indexInFrame & 1) ? (byte & 0xf) : (byte >> 4);
+        nibble = nibble >= 8 ? nibble - 16 : nibble;
+        const int predictor = (predScale >> 4) & 0x7;
+        const int32_t scale = 1 << (predScale & 0xf);
+        const int32_t coef0 = static_cast<int16_t>(parameter.coefficients[predictor * 2]);
+        const int32_t coef1 = static_cast<int16_t>(parameter.coefficients[predictor * 2 + 1]);
+        int32_t sample = (nibble * scale * 2048 + 1024 + coef0 * history0 + coef1 * history1) >> 11;
+        sample = sample < -32768 ? -32768 : (sample > 32767 ? 32767 : sample);
+        history1 = history0;
+        history0 = sample;
+        pOut[i] = static_cast<int16_t>(sample);
+        pContext->predScale = predScale;
+    }
+    pContext->history[0] = static_cast<int16_t>(history0);
+    pContext->history[1] = static_cast<int16_t>(history1);
+}
+
+int RunAdpcmDecode(const char* inputPath, const char* outputPath, double seconds, const char* referencePath)
+{
+    AdpcmData adpcm;
+    if (!ReadAdpcmFile(&adpcm, inputPath))
+    {
+        std::fprintf(stderr, "Cannot read ADPCM %s\n", inputPath);
+        return 1;
+    }
+    const AudioDsp::AdpcmHeaderInfo& info = adpcm.header;
+    const int sampleCount = seconds > 0.0 ? static_cast<int>(seconds * info.sampleRate) : info.sampleCount;
+    std::vector<int16_t> samples(sampleCount);
+    AudioDsp::AdpcmCursor cursor;
+    AudioDsp::ResetAdpcmCursor(&cursor, info);
+    AudioDsp::DecodeAdpcmWithLoop(samples.data(), sampleCount, adpcm.data, adpcm.size, info, &cursor);
+
+    HostAudio::WavFileSink sink;
+    if (!sink.Open(outputPath, info.sampleRate, 1))
+    {
+        std::fprintf(stderr, "Cannot open %s\n", outputPath);
+        return 1;
+    }
+    sink.Write(samples.data(), sampleCount, 1);
+    sink.Close();
+    std::printf("%s: %d samples at %d Hz%s -> %s\n", inputPath, sampleCount, info.sampleRate, info.loop ? " (looped)" : "", outputPath);
+
+    if (referencePath == nullptr)
+    {
+        return 0;
+    }
+    PcmData reference;
+    if (!ReadWavFile(&reference, referencePath) || reference.channelCount != 1)
+    {
+        std::fprintf(stderr, "Cannot read mono 16-bit reference %s\n", referencePath);
+        return 1;
+    }
+    const int16_t* pReference = static_cast<const int16_t*>(reference.data);
+    const int referenceCount = static_cast<int>(reference.size / sizeof(int16_t));
+    const int compareCount = referenceCount < sampleCount ? referenceCount : sampleCount;
+    for (int i = 0; i < compareCount; ++i)
+    {
+        if (samples[i] != pReference[i])
+        {
+            std::printf("MISMATCH at sample %d: decoded %d, reference %d\n", i, samples[i], pReference[i]);
+            return 1;
+        }
+    }
+    std::printf("Bit-exact with %s over %d samples%s\n", referencePath, compareCount, referenceCount != sampleCount ? " (lengths differ)" : "");
+    return referenceCount == sampleCount ? 0 : 1;
+}
+
+int RunAdpcmBench(int fileCount, char** paths)
+{
+    for (int i = 0; i < fileCount; ++i)
+    {
+        WaveBufferScope scope;
+        AdpcmData adpcm;
+        if (!ReadAdpcmFile(&adpcm, paths[i]))
+        {
+            std::fprintf(stderr, "Cannot read ADPCM %s\n", paths[i]);
+            return 1;
+        }
+        const AudioDsp::AdpcmHeaderInfo& info = adpcm.header;
+        // The reference decoder has no bounds handling, so it only covers whole frames.
+        const int sampleCount = static_cast<int>(adpcm.size / AudioDsp::AdpcmFrameSize) * AudioDsp::AdpcmFrameSampleCount;
+        const int sampleCountClamped = sampleCount < info.sampleCount ? sampleCount : info.sampleCount;
+        std::vector<int16_t> block(sampleCountClamped);
+        std::vector<int16_t> reference(sampleCountClamped);
+
+        // Decode in renderer-sized pieces so mid-frame starts are exercised too.
+        const int pieceSize = RenderCount;
+        double blockSeconds = 0.0;
+        double referenceSeconds = 0.0;
+        const int iterationCount = 200;
+        for (int iteration = 0; iteration < iterationCount; ++iteration)
+        {
+            AudioDsp::AdpcmContext context = info.context;
+            auto start = std::chrono::steady_clock::now();
+            for (int offset = 0; offset < sampleCountClamped; offset += pieceSize)
+            {
+                const int count = sampleCountClamped - offset < pieceSize ? sampleCountClamped - offset : pieceSize;
+                AudioDsp::DecodeAdpcm(block.data() + offset, adpcm.data, adpcm.size, offset, count, info.parameter, &context);
+            }
+            blockSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+            context = info.context;
+            start = std::chrono::steady_clock::now();
+            for (int offset = 0; offset < sampleCountClamped; offset += pieceSize)
+            {
+                const int count = sampleCountClamped - offset < pieceSize ? sampleCountClamped - offset : pieceSize;
+                DecodeAdpcmReference(reference.data() + offset, static_cast<const uint8_t*>(adpcm.data), offset, count, info.parameter, &context);
+            }
+            referenceSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        }
+
+        if (block != reference)
+        {
+            std::printf("%s: MISMATCH between block and reference decoders\n", paths[i]);
+            return 1;
+        }
+        const double decodedSamples = static_cast<double>(sampleCountClamped) * iterationCount;
+        std::printf("%s: %d samples, block %.1f Msamples/s, reference %.1f Msamples/s (%.2fx), bit-exact\n",
+            paths[i], sampleCountClamped, decodedSamples / blockSeconds * 1.0e-6, decodedSamples / referenceSeconds * 1.0e-6, referenceSeconds / blockSeconds);
+    }
+    return 0;
+}
+
+// Per-sample sinf() mix of count oscillators, the way GenerateSineWave() renders one.
+void MixSineReference(float* pOut, int sampleCount, const float* frequencies, float* phases, int count)
+{
+    const float Pi = 3.1415926535897932384626433f;
+    for (int i = 0; i < sampleCount; ++i)
+    {
+        float sum = 0.0f;
+        for (int j = 0; j < count; ++j)
+        {
+            sum += sinf(2 * Pi * phases[j]);
+            phases[j] += frequencies[j] / RenderRate;
+            phases[j] -= phases[j] >= 1.0f ? 1.0f : 0.0f;
+        }
+        pOut[i] = sum;
+    }
+}
+
+int RunOscillatorBench(int oscillatorCount)
+{
+    const char* const waveformNames[AudioDsp::Waveform_Count] = { "sine", "saw", "square", "wavetable" };
+    const int tableSize = 2048;
+    std::vector<float> table(tableSize + 1);
+    const float harmonics[] = { 1.0f, 0.5f, 0.33f, 0.25f, 0.2f, 0.0f, 0.14f, 0.0f, 0.11f };
+    AudioDsp::BuildWavetable(table.data(), tableSize, harmonics, sizeof(harmonics) / sizeof(harmonics[0]));
+
+    std::vector<float> frequencies(oscillatorCount);
+    for (int i = 0; i < oscillatorCount; ++i)
+    {
+        frequencies[i] = 110.0f * std::pow(2.0f, (i % 48) / 12.0f);
+    }
+
+    const double budget = double(RenderCount) / RenderRate;
+    const int frameCount = 2000;
+    std::vector<float> output(RenderCount);
+    std::vector<char> workBuffer(AudioDsp::OscillatorBank::GetRequiredWorkBufferSize(oscillatorCount));
+    for (int waveform = 0; waveform < AudioDsp::Waveform_Count; ++waveform)
+    {
+        AudioDsp::OscillatorBank bank;
+        bank.Initialize(workBuffer.data(), workBuffer.size(), oscillatorCount, RenderRate);
+        for (int i = 0; i < oscillatorCount; ++i)
+        {
+            bank.Add(static_cast<AudioDsp::Waveform>(waveform), frequencies[i], 1.0f / oscillatorCount, table.data(), tableSize);
+        }
+        const auto start = std::chrono::steady_clock::now();
+        for (int frame = 0; frame < frameCount; ++frame)
+        {
+            // Keep every oscillator ramping so the measurement includes frequency changes.
+            if (frame % 8 == 0)
+            {
+                for (int i = 0; i < oscillatorCount; ++i)
+                {
+                    bank.SetFrequency(i, frequencies[i] * (1.0f + 0.01f * ((frame / 8) & 1)));
+                }
+            }
+            bank.Process(output.data(), RenderCount);
+        }
+        const double frameTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() / frameCount;
+        std::printf("%-9s %d oscillators: %.3f ms per %d-sample frame (%.1f%% of budget, %.2f ns per oscillator-sample)\n",
+            waveformNames[waveform], oscillatorCount, frameTime * 1000.0, RenderCount, frameTime / budget * 100.0,
+            frameTime * 1.0e9 / (double(oscillatorCount) * RenderCount));
+    }
+
+    // Baseline: the same sine mix with one sinf() call per oscillator per sample.
+    {
+        std::vector<float> phases(oscillatorCount, 0.0f);
+        const int referenceFrameCount = 200;
+        const auto start = std::chrono::steady_clock::now();
+        for (int frame = 0; frame < referenceFrameCount; ++frame)
+        {
+            MixSineReference(output.data(), RenderCount, frequencies.data(), phases.data(), oscillatorCount);
+        }
+        const double frameTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() / referenceFrameCount;
+        std::printf("sinf      %d oscillators: %.3f ms per %d-sample frame (%.1f%% of budget)\n",
+            oscillatorCount, frameTime * 1000.0, RenderCount, frameTime / budget * 100.0);
+    }
+
+    // Accuracy of the polynomial sine against the library over one second.
+    // The reference follows the same float phase sequence, so only the waveform error is measured.
+    {
+        std::vector<char> accuracyWorkBuffer(AudioDsp::OscillatorBank::GetRequiredWorkBufferSize(1));
+        AudioDsp::OscillatorBank bank;
+        bank.Initialize(accuracyWorkBuffer.data(), accuracyWorkBuffer.size(), 1, RenderRate);
+        bank.Add(AudioDsp::Waveform_Sine, 440.0f, 1.0f);
+        std::vector<float> sine(RenderRate);
+        bank.Process(sine.data(), RenderRate);
+        const float increment = 440.0f / RenderRate;
+        float phase = 0.0f;
+        double errorMax = 0.0;
+        for (int i = 0; i < RenderRate; ++i)
+        {
+            // Skip the fade-in.
+            if (i >= AudioDsp::OscillatorBank::RampSampleCount)
+            {
+                const double error = std::fabs(sine[i] - std::sin(2.0 * 3.14159265358979323846 * phase));
+                errorMax = error > errorMax ? error : errorMax;
+            }
+            phase += increment;
+            phase -= static_cast<float>(static_cast<int>(phase));
+        }
+        std::printf("sine error against std::sin over 1 s: %.2e (%.1f dB)\n", errorMax, 20.0 * std::log10(errorMax));
+    }
+    return 0;
+}
+
+// Per-sample cascade in the form the renderer used before block processing. T is float for timing and double for accuracy.
+template <typename T>
+void ProcessBiquadReference(T* pData, int count, const AudioDsp::BiquadCoefficients* sections, T (*states)[4], int sectionCount)
+{
+    for (int s = 0; s < sectionCount; ++s)
+    {
+        const AudioDsp::BiquadCoefficients& c = sections[s];
+        T* pState = states[s];
+        for (int i = 0; i < count; ++i)
+        {
+            const T x = pData[i];
+            const T y = c.b0 * x + c.b1 * pState[0] + c.b2 * pState[1] - c.a1 * pState[2] - c.a2 * pState[3];
+            pState[1] = pState[0];
+            pState[0] = x;
+            pState[3] = pState[2];
+            pState[2] = y;
+            pData[i] = y;
+        }
+    }
+}
+
+int RunBiquadBench(int sectionCount)
+{
+    // A low-pass swept once per frame between 200 Hz and 8 kHz, followed by fixed peaking and shelving sections.
+    const AudioDsp::BiquadType types[AudioDsp::BiquadCascade::SectionCountMax] =
+        { AudioDsp::BiquadType_LowPass, AudioDsp::BiquadType_Peaking, AudioDsp::BiquadType_HighShelf, AudioDsp::BiquadType_HighPass };
+    const float frequencies[AudioDsp::BiquadCascade::SectionCountMax] = { 2000.0f, 1000.0f, 6000.0f, 40.0f };
+    AudioDsp::BiquadCoefficients sections[AudioDsp::BiquadCascade::SectionCountMax];
+    for (int s = 0; s < sectionCount; ++s)
+    {
+        sections[s] = AudioDsp::DesignBiquad(types[s], RenderRate, frequencies[s], 0.7071f, -6.0f);
+    }
+
+    const int frameCount = 20000;
+    const double budget = double(RenderCount) / RenderRate;
+    std::vector<float> input(static_cast<std::size_t>(frameCount) * RenderCount);
+    uint32_t seed = 1;
+    for (std::size_t i = 0; i < input.size(); ++i)
+    {
+        seed = seed * 1664525u + 1013904223u;
+        input[i] = static_cast<float>(static_cast<int32_t>(seed) >> 17);
+    }
+    std::vector<float> block(input);
+    std::vector<float> reference(input);
+    std::vector<double> exact(input.begin(), input.end());
+
+    AudioDsp::BiquadCascade cascade;
+    for (int s = 0; s < sectionCount; ++s)
+    {
+        cascade.SetSection(s, sections[s]);
+    }
+    float states[AudioDsp::BiquadCascade::SectionCountMax][4] = {};
+    double exactStates[AudioDsp::BiquadCascade::SectionCountMax][4] = {};
+
+    double blockSeconds = 0.0;
+    double referenceSeconds = 0.0;
+    for (int frame = 0; frame < frameCount; ++frame)
+    {
+        const float cutoff = 200.0f * std::pow(40.0f, 0.5f + 0.5f * std::sin(frame * 0.01f));
+        sections[0] = AudioDsp::DesignBiquad(types[0], RenderRate, cutoff, 0.7071f);
+
+        auto start = std::chrono::steady_clock::now();
+        cascade.SetSection(0, sections[0]);
+        cascade.Process(&block[static_cast<std::size_t>(frame) * RenderCount], RenderCount);
+        blockSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        start = std::chrono::steady_clock::now();
+        ProcessBiquadReference(&reference[static_cast<std::size_t>(frame) * RenderCount], RenderCount, sections, states, sectionCount);
+        referenceSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        ProcessBiquadReference(&exact[static_cast<std::size_t>(frame) * RenderCount], RenderCount, sections, exactStates, sectionCount);
+    }
+
+    // Both float versions are compared with the same cascade in double precision.
+    double blockErrorPower = 0.0;
+    double referenceErrorPower = 0.0;
+    double signalPower = 0.0;
+    for (std::size_t i = 0; i < block.size(); ++i)
+    {
+        blockErrorPower += (block[i] - exact[i]) * (block[i] - exact[i]);
+        referenceErrorPower += (reference[i] - exact[i]) * (reference[i] - exact[i]);
+        signalPower += exact[i] * exact[i];
+    }
+    const double blockErrorDb = 10.0 * std::log10((blockErrorPower + 1.0e-30) / (signalPower + 1.0e-30));
+    const double referenceErrorDb = 10.0 * std::log10((referenceErrorPower + 1.0e-30) / (signalPower + 1.0e-30));
+
+    std::printf("block     %d sections: %.2f us per %d-sample frame (%.3f%% of budget), including the redesign of the swept section\n",
+        sectionCount, blockSeconds / frameCount * 1.0e6, RenderCount, blockSeconds / frameCount / budget * 100.0);
+    std::printf("reference %d sections: %.2f us per %d-sample frame (%.2fx)\n",
+        sectionCount, referenceSeconds / frameCount * 1.0e6, RenderCount, referenceSeconds / blockSeconds);
+    std::printf("error against double precision: block %.1f dB, reference %.1f dB\n", blockErrorDb, referenceErrorDb);
+    // The block form sums eight products per output, so it carries some 10 dB more rounding noise than the per-sample form.
+    return blockErrorDb < referenceErrorDb + 20.0 ? 0 : 1;
+}
+
+// Average wall time for one audio frame with voiceCount voices playing an interleaved 16-bit asset at its own rate.
+double MeasureSrcFrameTime(int voiceCount, const PcmData& pcm, HostAudio::SrcQuality quality)
+{
+    HostAudio::AudioRendererParameter parameter;
+    HostAudio::InitializeAudioRendererParameter(&parameter);
+    parameter.sampleRate = RenderRate;
+    parameter.sampleCount = RenderCount;
+    parameter.mixBufferCount = 6;
+    parameter.voiceCount = voiceCount;
+    parameter.sinkCount = 1;
+
+    const int8_t mainBus[2] = { 4, 5 };
+    HostAudio::AudioRendererHandle handle;
+    HostAudio::AudioRendererConfig config;
+    OpenRenderer(&handle, &config, parameter);
+    HostAudio::FinalMixType finalMix;
+    HostAudio::AcquireFinalMix(&config, &finalMix, 6);
+    HostAudio::DeviceSinkType deviceSink;
+    HostAudio::AddDeviceSink(&config, &deviceSink, &finalMix, mainBus, 2, "MainAudioOut");
+    HostAudio::NullSink nullSink;
+    HostAudio::SetDeviceSinkBackend(&deviceSink, &nullSink);
+
+    HostAudio::WaveBuffer waveBuffer;
+    std::memset(&waveBuffer, 0, sizeof(waveBuffer));
+    waveBuffer.buffer = pcm.data;
+    waveBuffer.size = pcm.size;
+    waveBuffer.endSampleOffset = static_cast<int32_t>(pcm.size / sizeof(int16_t) / pcm.channelCount);
+    waveBuffer.loop = true;
+
+    std::vector<HostAudio::VoiceType> voices(voiceCount);
+    for (int i = 0; i < voiceCount; ++i)
+    {
+        HostAudio::AcquireVoiceSlot(&config, &voices[i], pcm.sampleRate, pcm.channelCount, HostAudio::SampleFormat_PcmInt16, 0, nullptr, 0);
+        HostAudio::SetVoiceSrcQuality(&voices[i], quality);
+        HostAudio::SetVoiceDestination(&config, &voices[i], &finalMix);
+        HostAudio::AppendWaveBuffer(&voices[i], &waveBuffer);
+        for (int ch = 0; ch < pcm.channelCount; ++ch)
+        {
+            HostAudio::SetVoiceMixVolume(&voices[i], &finalMix, 0.01f, ch, mainBus[ch & 1]);
+        }
+        HostAudio::SetVoicePlayState(&voices[i], HostAudio::VoiceType::PlayState_Play);
+    }
+
+    HostAudio::RequestUpdateAudioRenderer(handle, &config);
+    HostAudio::StartAudioRenderer(handle);
+    for (int i = 0; i < 20; ++i)
+    {
+        HostAudio::ProcessAudioRenderer(handle);
+    }
+    const int frameCount = 200;
+    const auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < frameCount; ++i)
+    {
+        HostAudio::ProcessAudioRenderer(handle);
+    }
+    const double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    HostAudio::CloseAudioRenderer(handle);
+    return elapsed / frameCount;
+}
+
+// Reads a 16-bit WAV, or decodes a DSP-ADPCM file once through without following its loop.
+bool ReadConvertInput(std::vector<int16_t>* pOutSamples, int* pOutSampleRate, int* pOutChannelCount, bool* pOutIsLooped, const char* path)
+{
+    std::vector<uint8_t> file;
+    if (!ReadWholeFile(&file, path))
+    {
+        return false;
+    }
+    if (file.size() >= 4 && std::memcmp(file.data(), "RIFF", 4) == 0)
+    {
+        PcmData pcm;
+        if (!ReadWavFile(&pcm, path))
+        {
+            return false;
+        }
+        const int16_t* pSamples = static_cast<const int16_t*>(pcm.data);
+        pOutSamples->assign(pSamples, pSamples + pcm.size / sizeof(int16_t));
+        *pOutSampleRate = pcm.sampleRate;
+        *pOutChannelCount = pcm.channelCount;
+        *pOutIsLooped = false;
+        return pcm.channelCount > 0 && pcm.channelCount <= HostAudio::VoiceChannelCountMax;
+    }
+
+    AdpcmData adpcm;
+    if (!ReadAdpcmFile(&adpcm, path))
+    {
+        return false;
+    }
+    AudioDsp::AdpcmHeaderInfo info = adpcm.header;
+    info.loop = false;
+    pOutSamples->resize(info.sampleCount);
+    AudioDsp::AdpcmCursor cursor;
+    AudioDsp::ResetAdpcmCursor(&cursor, info);
+    AudioDsp::DecodeAdpcmWithLoop(pOutSamples->data(), info.sampleCount, adpcm.data, adpcm.size, info, &cursor);
+    *pOutSampleRate = info.sampleRate;
+    *pOutChannelCount = 1;
+    *pOutIsLooped = adpcm.header.loop;
+    return true;
+}
+
+int RunConvert(const char* inputPath, const char* outputPath, int outputRate)
+{
+    std::vector<int16_t> input;
+    int inputRate = 0;
+    int channelCount = 0;
+    bool isLooped = false;
+    if (!ReadConvertInput(&input, &inputRate, &channelCount, &isLooped, inputPath) || inputRate <= 0)
+    {
+        std::fprintf(stderr, "Cannot read %s as a 16-bit WAV or DSP-ADPCM file\n", inputPath);
+        return 1;
+    }
+    if (outputRate <= 0 || outputRate > HostAudio::VoiceSampleRateMax)
+    {
+        std::fprintf(stderr, "Output rate must be between 1 and %d Hz\n", HostAudio::VoiceSampleRateMax);
+        return 1;
+    }
+
+    const int inputFrameCount = static_cast<int>(input.size() / channelCount);
+    const int outputFrameCount = static_cast<int>((static_cast<int64_t>(inputFrameCount) * outputRate + inputRate - 1) / inputRate);
+    std::vector<int16_t> output(static_cast<std::size_t>(outputFrameCount) * channelCount);
+
+    // Pad with the filter history in front and the filter length behind, so the first output lands on the first input.
+    const auto start = std::chrono::steady_clock::now();
+    const double ratio = static_cast<double>(inputRate) / outputRate;
+    const uint64_t step = (static_cast<uint64_t>(inputRate) << AudioDsp::ResamplerFractionBits) / outputRate;
+    std::unique_ptr<AudioDsp::PolyphaseFilter> filter(new AudioDsp::PolyphaseFilter);
+    AudioDsp::DesignPolyphaseFilter(filter.get(), AudioDsp::GetResamplerCutoff(ratio));
+    std::vector<float> source(AudioDsp::ResamplerDelay + inputFrameCount + AudioDsp::ResamplerTapCount, 0.0f);
+    std::vector<float> resampled(outputFrameCount);
+    int clippedCount = 0;
+    for (int ch = 0; ch < channelCount; ++ch)
+    {
+        for (int i = 0; i < inputFrameCount; ++i)
+        {
+            source[AudioDsp::ResamplerDelay + i] = input[static_cast<std::size_t>(i) * channelCount + ch];
+        }
+        if (inputRate == outputRate)
+        {
+            std::copy(source.begin() + AudioDsp::ResamplerDelay, source.begin() + AudioDsp::ResamplerDelay + outputFrameCount, resampled.begin());
+        }
+        else
+        {
+            AudioDsp::ResamplePolyphase(resampled.data(), outputFrameCount, source.data(), 0, step, *filter);
+        }
+        for (int i = 0; i < outputFrameCount; ++i)
+        {
+            const float sample = std::nearbyint(resampled[i]);
+            clippedCount += sample > 32767.0f || sample < -32768.0f ? 1 : 0;
+            output[static_cast<std::size_t>(i) * channelCount + ch] = static_cast<int16_t>(std::min(std::max(sample, -32768.0f), 32767.0f));
+        }
+    }
+    const double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    HostAudio::WavFileSink sink;
+    if (!sink.Open(outputPath, outputRate, channelCount))
+    {
+        std::fprintf(stderr, "Cannot open %s\n", outputPath);
+        return 1;
+    }
+    sink.Write(output.data(), outputFrameCount, channelCount);
+    sink.Close();
+    std::printf("%s: %d Hz, %d ch, %d frames -> %s: %d Hz, %d frames in %.1f ms\n",
+        inputPath, inputRate, channelCount, inputFrameCount, outputPath, outputRate, outputFrameCount, elapsed * 1000.0);
+    if (clippedCount > 0)
+    {
+        std::printf("%d samples clipped by filter overshoot; lower the level before converting\n", clippedCount);
+    }
+    if (isLooped)
+    {
+        std::printf("The input loops, but the output WAV has no loop points; resample them by %d/%d\n", outputRate, inputRate);
+    }
+    if (outputRate != RenderRate || inputRate == RenderRate)
+    {
+        return 0;
+    }
+
+    // The same asset before and after conversion, so the difference is the sample rate conversion alone.
+    const int voiceCount = 64;
+    PcmData before = { input.data(), input.size() * sizeof(int16_t), inputRate, channelCount };
+    PcmData after = { output.data(), output.size() * sizeof(int16_t), outputRate, channelCount };
+    const double linearTime = MeasureSrcFrameTime(voiceCount, before, HostAudio::SrcQuality_Default) / voiceCount;
+    const double polyphaseTime = MeasureSrcFrameTime(voiceCount, before, HostAudio::SrcQuality_High) / voiceCount;
+    const double convertedTime = MeasureSrcFrameTime(voiceCount, after, HostAudio::SrcQuality_High) / voiceCount;
+    const double budget = double(RenderCount) / RenderRate;
+    std::printf("per voice and %d-sample frame: %.3f us with linear SRC, %.3f us with polyphase SRC, %.3f us converted\n",
+        RenderCount, linearTime * 1.0e6, polyphaseTime * 1.0e6, convertedTime * 1.0e6);
+    std::printf("converting saves %.3f us per voice against linear SRC (%.3f%% of budget) and %.3f us against polyphase SRC (%.3f%% of budget)\n",
+        (linearTime - convertedTime) * 1.0e6, (linearTime - convertedTime) / budget * 100.0,
+        (polyphaseTime - convertedTime) * 1.0e6, (polyphaseTime - convertedTime) / budget * 100.0);
+    return 0;
+}
+
+// One input of bank-build. The name is the file name without its directory and extension.
+struct BankInput
+{
+    std::string name;
+    AudioDsp::BankSampleFormat sampleFormat;
+    int channelCount;
+    AudioDsp::AdpcmHeaderInfo info;
+    std::vector<uint8_t> data;
+};
+
+bool ReadBankInput(BankInput* pOut, const char* path)
+{
+    std::string name(path);
+    const std::size_t slash = name.find_last_of("/\\");
+    name = slash == std::string::npos ? name : name.substr(slash + 1);
+    const std::size_t dot = name.rfind('.');
+    pOut->name = dot == std::string::npos || dot == 0 ? name : name.substr(0, dot);
+    std::memset(&pOut->info, 0, sizeof(pOut->info));
+
+    std::vector<uint8_t> file;
+    if (!ReadWholeFile(&file, path))
+    {
+        std::fprintf(stderr, "Cannot read %s\n", path);
+        return false;
+    }
+    if (file.size() >= 4 && std::memcmp(file.data(), "RIFF", 4) == 0)
+    {
+        std::FILE* pFile = std::fopen(path, "rb");
+        AudioDsp::WavLayout layout;
+        const bool ok = pFile != nullptr && ReadWavLayout(&layout, pFile, path);
+        if (pFile != nullptr)
+        {
+            std::fclose(pFile);
+        }
+        if (!ok || layout.bitsPerSample != 16)
+        {
+            std::fprintf(stderr, "%s: only 16-bit PCM WAV files can go into a bank\n", path);
+            return false;
+        }
+        pOut->sampleFormat = AudioDsp::BankSampleFormat_PcmInt16;
+        pOut->channelCount = layout.channelCount;
+        pOut->info.sampleCount = static_cast<int>(layout.frameCount);
+        pOut->info.sampleRate = layout.sampleRate;
+        pOut->info.loop = layout.hasLoop;
+        pOut->info.loopStartSampleOffset = static_cast<int>(layout.loopStartFrame);
+        pOut->info.loopEndSampleOffset = static_cast<int>(layout.loopEndFrame);
+        pOut->data.assign(file.begin() + layout.dataOffset, file.begin() + layout.dataOffset + layout.dataSize);
+        return true;
+    }
+
+    if (file.size() < HostAudio::AdpcmHeaderSize || !HostAudio::ParseAdpcmHeader(&pOut->info, file.data(), HostAudio::AdpcmHeaderSize))
+    {
+        std::fprintf(stderr, "%s: not a 16-bit WAV or DSP-ADPCM file\n", path);
+        return false;
+    }
+    pOut->sampleFormat = AudioDsp::BankSampleFormat_Adpcm;
+    pOut->channelCount = 1;
+    pOut->data.assign(file.begin() + HostAudio::AdpcmHeaderSize, file.end());
+    return true;
+}
+
+void PrintBankEntries(const void* bank)
+{
+    for (int i = 0; i < AudioDsp::GetBankEntryCount(bank); ++i)
+    {
+        const AudioDsp::BankEntry* pEntry = AudioDsp::GetBankEntry(bank, i);
+        std::printf("  %-20s %-5s %5d Hz, %d ch, %7d samples", pEntry->name,
+            pEntry->sampleFormat == AudioDsp::BankSampleFormat_Adpcm ? "adpcm" : "pcm16", pEntry->info.sampleRate, pEntry->channelCount, pEntry->info.sampleCount);
+        if (pEntry->info.loop)
+        {
+            std::printf(", loop %d-%d", pEntry->info.loopStartSampleOffset, pEntry->info.loopEndSampleOffset);
+        }
+        std::printf(", data at %u (%u bytes)\n", pEntry->dataOffset, pEntry->dataSize);
+    }
+}
+
+int RunBankBuild(const char* outputPath, int inputCount, char** inputPaths)
+{
+    std::vector<BankInput> inputs(inputCount);
+    std::vector<AudioDsp::BankSource> sources(inputCount);
+    for (int i = 0; i < inputCount; ++i)
+    {
+        BankInput& input = inputs[i];
+        if (!ReadBankInput(&input, inputPaths[i]))
+        {
+            return 1;
+        }
+        for (int j = 0; j < i; ++j)
+        {
+            if (inputs[j].name == input.name)
+            {
+                std::fprintf(stderr, "%s: the name %s is already in the bank\n", inputPaths[i], input.name.c_str());
+                return 1;
+            }
+        }
+        if (input.name.size() > static_cast<std::size_t>(AudioDsp::BankNameLengthMax))
+        {
+            std::fprintf(stderr, "%s: the name is longer than %d characters\n", inputPaths[i], AudioDsp::BankNameLengthMax);
+            return 1;
+        }
+        AudioDsp::BankSource& source = sources[i];
+        source.name = input.name.c_str();
+        source.sampleFormat = input.sampleFormat;
+        source.channelCount = input.channelCount;
+        source.info = input.info;
+        source.data = input.data.data();
+        source.dataSize = input.data.size();
+    }
+
+    std::size_t size;
+    AudioDsp::BuildBank(nullptr, 0, &size, sources.data(), inputCount, HostAudio::BufferAlignSize);
+    std::vector<uint8_t> bank(size);
+    AudioDsp::BankResult result = AudioDsp::BuildBank(bank.data(), bank.size(), &size, sources.data(), inputCount, HostAudio::BufferAlignSize);
+    if (result == AudioDsp::BankResult_Success)
+    {
+        // Catch a builder bug here rather than on the console.
+        result = AudioDsp::ValidateBank(bank.data(), bank.size());
+    }
+    if (result != AudioDsp::BankResult_Success)
+    {
+        std::fprintf(stderr, "Cannot build the bank: %s\n", AudioDsp::GetBankResultString(result));
+        return 1;
+    }
+
+    std::FILE* pFile = std::fopen(outputPath, "wb");
+    const bool ok = pFile != nullptr && std::fwrite(bank.data(), 1, bank.size(), pFile) == bank.size();
+    if (pFile != nullptr)
+    {
+        std::fclose(pFile);
+    }
+    if (!ok)
+    {
+        std::fprintf(stderr, "Cannot write %s\n", outputPath);
+        return 1;
+    }
+
+    std::size_t payloadSize = 0;
+    for (int i = 0; i < inputCount; ++i)
+    {
+        payloadSize += sources[i].dataSize;
+    }
+    std::printf("%s: %d sounds, %zu bytes (%zu of sample data, %zu of header and alignment)\n",
+        outputPath, inputCount, bank.size(), payloadSize, bank.size() - payloadSize);
+    PrintBankEntries(bank.data());
+    return 0;
+}
+
+int RunBankInfo(int fileCount, char** paths)
+{
+    int failedCount = 0;
+    for (int i = 0; i < fileCount; ++i)
+    {
+        WaveBufferScope scope;
+        const void* bank = ReadBankFile(paths[i]);
+        if (bank == nullptr)
+        {
+            ++failedCount;
+            continue;
+        }
+        const AudioDsp::BankHeader* pHeader = AudioDsp::GetBankHeader(bank);
+        std::printf("%s: version %d, %d sounds, %u bytes, payloads aligned to %u\n",
+            paths[i], pHeader->version, pHeader->entryCount, pHeader->fileSize, pHeader->alignment);
+        PrintBankEntries(bank);
+    }
+    return failedCount > 0 ? 1 : 0;
+}
+
+// Reads the banks of budget through stdio, keeping the last one opened open, as the console engine reads them through nn::fs.
+struct BudgetFileReader
+{
+    char** paths;
+    int openBank;
+    std::FILE* pFile;
+
+    static bool Read(void* pUserData, int bank, int64_t offset, void* buffer, std::size_t size)
+    {
+        BudgetFileReader* pReader = static_cast<BudgetFileReader*>(pUserData);
+        if (bank != pReader->openBank)
+        {
+            pReader->Close();
+            pReader->pFile = std::fopen(pReader->paths[bank], "rb");
+            if (pReader->pFile == nullptr)
+            {
+                return false;
+            }
+            pReader->openBank = bank;
+        }
+        return std::fseek(pReader->pFile, static_cast<long>(offset), SEEK_SET) == 0
+            && std::fread(buffer, 1, size, pReader->pFile) == size;
+    }
+
+    void Close()
+    {
+        if (pFile != nullptr)
+        {
+            std::fclose(pFile);
+            pFile = nullptr;
+            openBank = -1;
+        }
+    }
+};
+
+/**
+* @brief  Prints the voices and bank memory the sounds of fileCount banks need at polyphonyMax instances each.
+*
+*  The budget is computed from the bank headers and entry tables alone, as <tt>ApplyAudioEngineManifest()</tt> does on
+*  the console. The renderer buffers it leads to are <tt>nn::audio</tt> sizes, which only the console can query; its
+*  <tt>AudioEngine::DumpBudget()</tt> logs them.
+*/
+int RunBudget(int fileCount, char** paths, int polyphonyMax, int voiceCountMax)
+{
+    // The names of the sounds come from the validated banks; the budget itself reads only the headers and entries.
+    std::vector<AudioDsp::BudgetSound> sounds;
+    for (int i = 0; i < fileCount; ++i)
+    {
+        const void* bank = ReadBankFile(paths[i]);
+        if (bank == nullptr)
+        {
+            return 1;
+        }
+        for (int j = 0; j < AudioDsp::GetBankEntryCount(bank); ++j)
+        {
+            AudioDsp::BudgetSound sound;
+            sound.bank = i;
+            sound.name = AudioDsp::GetBankEntry(bank, j)->name;
+            sound.polyphonyMax = polyphonyMax;
+            sounds.push_back(sound);
+        }
+    }
+
+    BudgetFileReader reader = { paths, -1, nullptr };
+    AudioDsp::Budget budget;
+    const AudioDsp::BankResult result = AudioDsp::ComputeBudget(&budget, fileCount, sounds.data(), static_cast<int>(sounds.size()),
+                                                                HostAudio::BufferAlignSize, BudgetFileReader::Read, &reader);
+    reader.Close();
+    if (result != AudioDsp::BankResult_Success)
+    {
+        std::fprintf(stderr, "Cannot compute the budget: %s\n", AudioDsp::GetBankResultString(result));
+        return 1;
+    }
+    if (budget.missingSound >= 0)
+    {
+        std::fprintf(stderr, "%s is not in %s\n", sounds[budget.missingSound].name, paths[sounds[budget.missingSound].bank]);
+        return 1;
+    }
+
+    const int voiceCount = voiceCountMax > 0 ? std::min(budget.voiceCount, voiceCountMax) : budget.voiceCount;
+    std::printf("%d banks, %zu sounds at polyphony %d\n", fileCount, sounds.size(), polyphonyMax);
+    std::printf("bank memory:      %zu bytes (aligned to %zu)\n", budget.bankPoolSize, HostAudio::BufferAlignSize);
+    std::printf("voices:           %d of %d instances, up to %d channels each\n", voiceCount, budget.voiceCount, budget.voiceChannelCountMax);
+    // As AudioEngine counts renderer voices: each pooled voice at the largest channel count.
+    std::printf("voice channels:   %d\n", voiceCount * budget.voiceChannelCountMax);
+    return 0;
+}
+
+// One channel of one input of adpcm-encode. Workers take tasks in turn, so a long file does not hold up the rest.
+struct AdpcmEncodeTask
+{
+    const BankInput* pInput;
+    int channel;
+    std::string outputPath;
+    std::size_t outputSize;
+    double signalPower;
+    double noisePower;
+    const char* error;
+};
+
+void RunAdpcmEncodeTask(AdpcmEncodeTask* pTask)
+{
+    const BankInput& input = *pTask->pInput;
+    const int16_t* pSamples = reinterpret_cast<const int16_t*>(input.data.data()) + pTask->channel;
+    const int sampleCount = input.info.sampleCount;
+    AudioDsp::AdpcmHeaderInfo info = input.info;
+    std::vector<uint8_t> file(AudioDsp::AdpcmHeaderSize + AudioDsp::GetAdpcmDataSize(sampleCount));
+    if (!AudioDsp::EncodeAdpcm(file.data() + AudioDsp::AdpcmHeaderSize, file.size() - AudioDsp::AdpcmHeaderSize, &info, pSamples, input.channelCount)
+        || !AudioDsp::WriteAdpcmHeader(file.data(), AudioDsp::AdpcmHeaderSize, info))
+    {
+        pTask->error = "the loop lies outside the sound";
+        return;
+    }
+
+    // Decode the file as a player reads it: the whole sound once, then across the loop end.
+    AudioDsp::AdpcmHeaderInfo parsed;
+    AudioDsp::ParseAdpcmHeader(&parsed, file.data(), AudioDsp::AdpcmHeaderSize);
+    const uint8_t* pData = file.data() + AudioDsp::AdpcmHeaderSize;
+    const std::size_t dataSize = file.size() - AudioDsp::AdpcmHeaderSize;
+    AudioDsp::AdpcmHeaderInfo once = parsed;
+    once.loop = false;
+    std::vector<int16_t> decoded(sampleCount);
+    AudioDsp::AdpcmCursor cursor;
+    AudioDsp::ResetAdpcmCursor(&cursor, once);
+    AudioDsp::DecodeAdpcmWithLoop(decoded.data(), sampleCount, pData, dataSize, once, &cursor);
+    pTask->signalPower = 0.0;
+    pTask->noisePower = 0.0;
+    for (int i = 0; i < sampleCount; ++i)
+    {
+        const double x = pSamples[static_cast<std::size_t>(i) * input.channelCount];
+        pTask->signalPower += x * x;
+        pTask->noisePower += (x - decoded[i]) * (x - decoded[i]);
+    }
+    if (parsed.loop)
+    {
+        // With the loop context, the samples after the jump are the ones decoded straight through from the loop start.
+        const int loopLength = parsed.loopEndSampleOffset - parsed.loopStartSampleOffset;
+        const int checkCount = loopLength < 4096 ? loopLength : 4096;
+        std::vector<int16_t> looped(parsed.loopEndSampleOffset + checkCount);
+        AudioDsp::ResetAdpcmCursor(&cursor, parsed);
+        AudioDsp::DecodeAdpcmWithLoop(looped.data(), static_cast<int>(looped.size()), pData, dataSize, parsed, &cursor);
+        if (!std::equal(looped.begin() + parsed.loopEndSampleOffset, looped.end(), decoded.begin() + parsed.loopStartSampleOffset))
+        {
+            pTask->error = "the loop context does not reproduce the loop start";
+            return;
+        }
+    }
+
+    std::FILE* pFile = std::fopen(pTask->outputPath.c_str(), "wb");
+    const bool ok = pFile != nullptr && std::fwrite(file.data(), 1, file.size(), pFile) == file.size();
+    if (pFile != nullptr)
+    {
+        std::fclose(pFile);
+    }
+    pTask->outputSize = file.size();
+    pTask->error = ok ? nullptr : "cannot write the output";
+}
+
+int RunAdpcmEncode(const char* outputDirectory, int inputCount, char** inputPaths, int jobCount)
+{
+    std::vector<BankInput> inputs(inputCount);
+    std::vector<AdpcmEncodeTask> tasks;
+    for (int i = 0; i < inputCount; ++i)
+    {
+        if (!ReadBankInput(&inputs[i], inputPaths[i]))
+        {
+            return 1;
+        }
+        if (inputs[i].sampleFormat != AudioDsp::BankSampleFormat_PcmInt16)
+        {
+            std::fprintf(stderr, "%s: already DSP-ADPCM\n", inputPaths[i]);
+            return 1;
+        }
+    }
+    for (int i = 0; i < inputCount; ++i)
+    {
+        // ADPCM voices are mono, so each channel of a multichannel file gets a file of its own.
+        for (int c = 0; c < inputs[i].channelCount; ++c)
+        {
+            AdpcmEncodeTask task = {};
+            task.pInput = &inputs[i];
+            task.channel = c;
+            task.outputPath = std::string(outputDirectory) + "/" + inputs[i].name;
+            if (inputs[i].channelCount > 1)
+            {
+                task.outputPath += "_" + std::to_string(c);
+            }
+            task.outputPath += ".adpcm";
+            tasks.push_back(task);
+        }
+    }
+
+    const int hardwareThreadCount = static_cast<int>(std::thread::hardware_concurrency());
+    int threadCount = jobCount > 0 ? jobCount : (hardwareThreadCount > 0 ? hardwareThreadCount : 1);
+    threadCount = std::min(threadCount, static_cast<int>(tasks.size()));
+    std::atomic<int> nextTask(0);
+    const auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> threads;
+    for (int t = 0; t < threadCount; ++t)
+    {
+        threads.push_back(std::thread([&tasks, &nextTask]()
+        {
+            for (int i = nextTask++; i < static_cast<int>(tasks.size()); i = nextTask++)
+            {
+                RunAdpcmEncodeTask(&tasks[i]);
+            }
+        }));
+    }
+    for (std::size_t t = 0; t < threads.size(); ++t)
+    {
+        threads[t].join();
+    }
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    int failureCount = 0;
+    std::size_t pcmSize = 0;
+    std::size_t adpcmSize = 0;
+    for (std::size_t i = 0; i < tasks.size(); ++i)
+    {
+        const AdpcmEncodeTask& task = tasks[i];
+        const AudioDsp::AdpcmHeaderInfo& info = task.pInput->info;
+        if (task.error != nullptr)
+        {
+            std::fprintf(stderr, "%s: %s\n", task.outputPath.c_str(), task.error);
+            ++failureCount;
+            continue;
+        }
+        const std::size_t channelPcmSize = sizeof(int16_t) * info.sampleCount;
+        pcmSize += channelPcmSize;
+        adpcmSize += task.outputSize;
+        std::printf("%s: %d samples at %d Hz", task.outputPath.c_str(), info.sampleCount, info.sampleRate);
+        if (info.loop)
+        {
+            std::printf(", loop %d-%d", info.loopStartSampleOffset, info.loopEndSampleOffset);
+        }
+        if (task.noisePower > 0.0)
+        {
+            std::printf(", %zu -> %zu bytes, SNR %.1f dB\n", channelPcmSize, task.outputSize, 10.0 * std::log10(task.signalPower / task.noisePower));
+        }
+        else
+        {
+            std::printf(", %zu -> %zu bytes, lossless\n", channelPcmSize, task.outputSize);
+        }
+    }
+    std::printf("%zu channels of %d files on %d threads in %.2f s: %zu -> %zu bytes (%.2fx smaller)\n",
+        tasks.size(), inputCount, threadCount, seconds, pcmSize, adpcmSize, adpcmSize > 0 ? static_cast<double>(pcmSize) / adpcmSize : 0.0);
+    return failureCount == 0 ? 0 : 1;
+}
+
+// Next value of a linear congruential generator, as an integer in [0, range).
+int NextRandom(uint32_t* pSeed, int range)
+{
+    *pSeed = *pSeed * 1664525u + 1013904223u;
+    return static_cast<int>((static_cast<uint64_t>(*pSeed >> 8) * range) >> 24);
+}
+
+// One operation of the pool-bench workload, replayed on the system allocator for comparison.
+struct PoolOperation
+{
+    bool isAllocation;
+    bool isLongLived;
+    int slot;
+    std::size_t size;
+};
+
+// Stamps the first and last word of an allocation with its slot, so overlapping allocations are caught when freed.
+void StampAllocation(void* p, std::size_t size, int slot)
+{
+    std::memcpy(p, &slot, sizeof(slot));
+    std::memcpy(static_cast<char*>(p) + size - sizeof(slot), &slot, sizeof(slot));
+}
+
+bool CheckStamp(const void* p, std::size_t size, int slot)
+{
+    int first;
+    int last;
+    std::memcpy(&first, p, sizeof(first));
+    std::memcpy(&last, static_cast<const char*>(p) + size - sizeof(last), sizeof(last));
+    return first == slot && last == slot;
+}
+
+int RunPoolBench(double hours)
+{
+    // The console sample's 14 MB pool: 8 KB stream chunks, 32 KB stream rings, and the rest for banks.
+    const std::size_t poolSize = 14 * 1024 * 1024;
+    const AudioDsp::WavePoolSlabConfig slabs[] = { { 8 * 1024, 256 }, { 32 * 1024, 64 } };
+    const int slabCount = static_cast<int>(sizeof(slabs) / sizeof(slabs[0]));
+    const int bankCountMax = 8;
+    const int blockSlotCount = 256 + 64;
+    void* buffer = AllocateWaveBuffer(poolSize);
+    AudioDsp::WavePool pool;
+    pool.Initialize(buffer, poolSize, HostAudio::BufferAlignSize, slabs, slabCount);
+    AudioDsp::WavePoolStatistics statistics;
+    pool.GetStatistics(&statistics);
+    const std::size_t longLivedSize = statistics.longLivedSize;
+
+    // Every audio frame, streams may open or close a chunk; every two minutes a level change unloads every bank in
+    // a random order and loads a new set. Slots 0 to blockSlotCount - 1 are blocks, the rest banks.
+    std::vector<PoolOperation> operations;
+    std::vector<void*> pointers(blockSlotCount + bankCountMax, nullptr);
+    std::vector<std::size_t> sizes(blockSlotCount + bankCountMax, 0);
+    const int64_t frameCount = static_cast<int64_t>(hours * 3600.0 * RenderRate / RenderCount);
+    const int64_t levelFrameCount = 120 * RenderRate / RenderCount;
+    uint32_t seed = 1;
+    int liveBlockCount = 0;
+    int64_t failureCount = 0;
+    bool ok = true;
+    const auto start = std::chrono::steady_clock::now();
+    for (int64_t frame = 0; frame < frameCount && ok; ++frame)
+    {
+        if (frame % levelFrameCount == 0)
+        {
+            for (int i = bankCountMax; i > 0; --i)
+            {
+                // Pick one of the remaining banks to unload next.
+                int pick = NextRandom(&seed, i);
+                int slot = blockSlotCount;
+                for (; slot < blockSlotCount + bankCountMax; ++slot)
+                {
+                    if (pointers[slot] != nullptr && pick-- == 0)
+                    {
+                        break;
+                    }
+                }
+                if (slot == blockSlotCount + bankCountMax)
+                {
+                    continue;
+                }
+                ok = ok && CheckStamp(pointers[slot], sizes[slot], slot);
+                pool.FreeLongLived(pointers[slot], sizes[slot]);
+                PoolOperation operation = { false, true, slot, sizes[slot] };
+                operations.push_back(operation);
+                pointers[slot] = nullptr;
+            }
+            pool.GetStatistics(&statistics);
+            // With every bank unloaded, the region must be whole again.
+            ok = ok && statistics.longLivedUsedSize == 0 && statistics.longLivedFreedSize == 0;
+
+            const int bankCount = 2 + NextRandom(&seed, bankCountMax - 1);
+            for (int i = 0; i < bankCount; ++i)
+            {
+                const int slot = blockSlotCount + i;
+                const std::size_t size = 64 * 1024 + static_cast<std::size_t>(NextRandom(&seed, 2 * 1024 * 1024)) + 1;
+                void* p = pool.AllocateLongLived(size);
+                if (p == nullptr)
+                {
+                    ++failureCount;
+                    continue;
+                }
+                ok = ok && reinterpret_cast<uintptr_t>(p) % HostAudio::BufferAlignSize == 0;
+                StampAllocation(p, size, slot);
+                pointers[slot] = p;
+                sizes[slot] = size;
+                PoolOperation operation = { true, true, slot, size };
+                operations.push_back(operation);
+            }
+        }
+
+        // Streams open chunks while fewer than half the slots are live and close them after.
+        if (NextRandom(&seed, 4) != 0)
+        {
+            continue;
+        }
+        const int slot = NextRandom(&seed, blockSlotCount);
+        if (pointers[slot] != nullptr)
+        {
+            ok = ok && CheckStamp(pointers[slot], sizes[slot], slot);
+            pool.FreeBlock(pointers[slot]);
+            PoolOperation operation = { false, false, slot, sizes[slot] };
+            operations.push_back(operation);
+            pointers[slot] = nullptr;
+            --liveBlockCount;
+        }
+        else if (liveBlockCount < blockSlotCount / 2)
+        {
+            const std::size_t size = NextRandom(&seed, 4) == 0 ? 32 * 1024 - NextRandom(&seed, 4096) : 8 * 1024 - NextRandom(&seed, 1024);
+            void* p = pool.AllocateBlock(size);
+            if (p == nullptr)
+            {
+                ++failureCount;
+                continue;
+            }
+            ok = ok && reinterpret_cast<uintptr_t>(p) % HostAudio::BufferAlignSize == 0;
+            StampAllocation(p, size, slot);
+            pointers[slot] = p;
+            sizes[slot] = size;
+            ++liveBlockCount;
+            PoolOperation operation = { true, false, slot, size };
+            operations.push_back(operation);
+        }
+    }
+    const double poolSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    if (!ok)
+    {
+        std::printf("FAILED: overlapping or misaligned allocations, or a long-lived region left with holes\n");
+        return 1;
+    }
+    pool.GetStatistics(&statistics);
+    for (int i = 0; i < statistics.slabCount; ++i)
+    {
+        const AudioDsp::WavePoolSlabStatistics& slab = statistics.slabs[i];
+        std::printf("slab %d: %6zu-byte blocks, %d of %d used, peak %d\n", i, slab.blockSize, slab.usedCount, slab.blockCount, slab.peakUsedCount);
+    }
+    std::printf("long-lived: %zu of %zu bytes used (%zu freed below the top), peak %zu\n",
+        statistics.longLivedUsedSize, statistics.longLivedSize, statistics.longLivedFreedSize, statistics.longLivedPeakSize);
+
+    // The same operations on the system allocator, at the same alignment.
+    std::vector<void*> systemPointers(pointers.size(), nullptr);
+    const auto systemStart = std::chrono::steady_clock::now();
+    for (std::size_t i = 0; i < operations.size(); ++i)
+    {
+        const PoolOperation& operation = operations[i];
+        if (operation.isAllocation)
+        {
+            if (posix_memalign(&systemPointers[operation.slot], HostAudio::BufferAlignSize, operation.size) != 0)
+            {
+                systemPointers[operation.slot] = nullptr;
+            }
+        }
+        else
+        {
+            std::free(systemPointers[operation.slot]);
+            systemPointers[operation.slot] = nullptr;
+        }
+    }
+    const double systemSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - systemStart).count();
+    for (std::size_t i = 0; i < systemPointers.size(); ++i)
+    {
+        std::free(systemPointers[i]);
+    }
+
+    // Fragmentation: after hours of churn, a bank as large as the whole region still fits once the banks are gone.
+    for (int slot = blockSlotCount; slot < blockSlotCount + bankCountMax; ++slot)
+    {
+        pool.FreeLongLived(pointers[slot], sizes[slot]);
+    }
+    void* pLargest = pool.AllocateLongLived(longLivedSize);
+    std::printf("%.1f hours of audio frames, %zu operations, %lld refused for lack of room: pool %.0f ns per operation (workload included), "
+                "system allocator %.0f ns; largest bank after the run %zu of %zu bytes\n",
+        hours, operations.size(), static_cast<long long>(failureCount), poolSeconds / operations.size() * 1.0e9,
+        systemSeconds / operations.size() * 1.0e9, pLargest != nullptr ? longLivedSize : 0, longLivedSize);
+    return pLargest != nullptr ? 0 : 1;
+}
+
+// Next value of a linear congruential generator, as a float in [-1, 1).
+float NextNoise(uint32_t* pSeed)
+{
+    *pSeed = *pSeed * 1664525u + 1013904223u;
+    return static_cast<float>(static_cast<int32_t>(*pSeed)) / 2147483648.0f;
+}
+
+// A stereo room: a few early reflections, then noise decaying by 60 dB over the length, darkening as it decays.
+void SynthesizeImpulse(std::vector<float>* pOut, int sampleRate, int sampleCount, int channelCount)
+{
+    const int earlyEnd = sampleRate * 80 / 1000;
+    const int lateStart = sampleRate * 20 / 1000;
+    const int reflectionCount = 12;
+    pOut->assign(static_cast<std::size_t>(sampleCount) * channelCount, 0.0f);
+    for (int ch = 0; ch < channelCount; ++ch)
+    {
+        uint32_t seed = 0x5eed0000u + ch;
+        float* pChannel = pOut->data() + ch;
+        for (int r = 0; r < reflectionCount; ++r)
+        {
+            const int position = sampleRate * 8 / 1000 + static_cast<int>((0.5f + 0.5f * NextNoise(&seed)) * (earlyEnd - sampleRate * 8 / 1000));
+            if (position < sampleCount)
+            {
+                pChannel[static_cast<std::size_t>(position) * channelCount] += NextNoise(&seed) * std::exp(-3.0f * position / earlyEnd);
+            }
+        }
+        float lowPass = 0.0f;
+        for (int i = lateStart; i < sampleCount; ++i)
+        {
+            // The one-pole cutoff falls from about 10 kHz to about 1 kHz over the length (at 32 kHz).
+            const float t = static_cast<float>(i) / sampleCount;
+            const float coefficient = 0.85f - 0.65f * t;
+            lowPass += coefficient * (NextNoise(&seed) - lowPass);
+            const float onset = std::min(1.0f, static_cast<float>(i - lateStart) / (earlyEnd - lateStart));
+            pChannel[static_cast<std::size_t>(i) * channelCount] += 0.3f * onset * lowPass * std::exp(-6.908f * t);
+        }
+
+        double energy = 0.0;
+        for (int i = 0; i < sampleCount; ++i)
+        {
+            energy += pChannel[static_cast<std::size_t>(i) * channelCount] * pChannel[static_cast<std::size_t>(i) * channelCount];
+        }
+        const float scale = static_cast<float>(1.0 / std::sqrt(energy));
+        for (int i = 0; i < sampleCount; ++i)
+        {
+            pChannel[static_cast<std::size_t>(i) * channelCount] *= scale;
+        }
+    }
+}
+
+int RunIrMake(const char* outputPath, double seconds, int sampleRate)
+{
+    if (seconds <= 0.0 || sampleRate <= 0 || sampleRate > HostAudio::VoiceSampleRateMax)
+    {
+        std::fprintf(stderr, "The length must be positive and the rate between 1 and %d Hz\n", HostAudio::VoiceSampleRateMax);
+        return 1;
+    }
+    const int channelCount = 2;
+    const int sampleCount = static_cast<int>(seconds * sampleRate);
+    std::vector<float> impulse;
+    SynthesizeImpulse(&impulse, sampleRate, sampleCount, channelCount);
+
+    // Full scale is a gain of 1, as SetConvolutionReverbImpulse() reads it.
+    std::vector<int16_t> samples(impulse.size());
+    float peak = 0.0f;
+    for (std::size_t i = 0; i < impulse.size(); ++i)
+    {
+        peak = std::max(peak, std::fabs(impulse[i]));
+        samples[i] = static_cast<int16_t>(std::min(std::max(std::nearbyint(impulse[i] * 32768.0f), -32768.0f), 32767.0f));
+    }
+
+    HostAudio::WavFileSink sink;
+    if (!sink.Open(outputPath, sampleRate, channelCount))
+    {
+        std::fprintf(stderr, "Cannot open %s\n", outputPath);
+        return 1;
+    }
+    sink.Write(samples.data(), sampleCount, channelCount);
+    sink.Close();
+    std::printf("%s: %d Hz, %d ch, %d frames (%.2f s), peak %.1f dBFS\n",
+        outputPath, sampleRate, channelCount, sampleCount, seconds, 20.0 * std::log10(peak));
+    return 0;
+}
+
+// Average wall time of one Process() call of a convolver holding the given impulse.
+double MeasureConvolverFrameTime(const float* pImpulse, int sampleCount, int stride, double* pOutSetupTime)
+{
+    AudioDsp::PartitionedConvolver convolver;
+    std::vector<char> workBuffer(AudioDsp::PartitionedConvolver::GetRequiredWorkBufferSize(RenderCount, sampleCount));
+    convolver.Initialize(workBuffer.data(), workBuffer.size(), RenderCount, sampleCount);
+    auto start = std::chrono::steady_clock::now();
+    convolver.SetImpulse(pImpulse, sampleCount, stride, 1.0f);
+    *pOutSetupTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::vector<float> block(RenderCount);
+    uint32_t seed = 1;
+    const int frameCount = 2000;
+    double elapsed = 0.0;
+    for (int frame = -20; frame < frameCount; ++frame)
+    {
+        for (int i = 0; i < RenderCount; ++i)
+        {
+            block[i] = 16384.0f * NextNoise(&seed);
+        }
+        start = std::chrono::steady_clock::now();
+        convolver.Process(block.data(), block.data());
+        if (frame >= 0)
+        {
+            elapsed += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        }
+    }
+    return elapsed / frameCount;
+}
+
+int RunReverbBench(const char* impulsePath)
+{
+    std::vector<float> impulse;
+    int channelCount = 1;
+    int sampleCount = 0;
+    if (impulsePath != nullptr)
+    {
+        PcmData pcm;
+        if (!ReadWavFile(&pcm, impulsePath))
+        {
+            std::fprintf(stderr, "Cannot read 16-bit PCM WAV %s\n", impulsePath);
+            return 1;
+        }
+        channelCount = pcm.channelCount;
+        sampleCount = static_cast<int>(pcm.size / sizeof(int16_t)) / channelCount;
+        impulse.resize(pcm.size / sizeof(int16_t));
+        for (std::size_t i = 0; i < impulse.size(); ++i)
+        {
+            impulse[i] = static_cast<const int16_t*>(pcm.data)[i] / 32768.0f;
+        }
+    }
+    else
+    {
+        sampleCount = 4 * RenderRate;
+        SynthesizeImpulse(&impulse, RenderRate, sampleCount, channelCount);
+    }
+
+    // Synthesized impulses are cut to each length; a file is measured as it is.
+    const double budget = double(RenderCount) / RenderRate;
+    const double lengths[] = { 0.25, 0.5, 1.0, 2.0, 4.0 };
+    std::printf("FFT size %d for %d-sample frames; costs are per channel\n", AudioDsp::PartitionedConvolver::GetFftSize(RenderCount), RenderCount);
+    for (double length : lengths)
+    {
+        const int count = impulsePath != nullptr ? sampleCount : static_cast<int>(length * RenderRate);
+        const double seconds = double(count) / RenderRate;
+        double setupTime;
+        const double frameTime = MeasureConvolverFrameTime(impulse.data(), count, channelCount, &setupTime);
+        std::printf("%5.2f s impulse, %4d partitions: %7.2f us per frame (%5.2f%% of budget), %6.2f us per frame per second of impulse, setup %.2f ms\n",
+            seconds, AudioDsp::PartitionedConvolver::GetPartitionCount(RenderCount, count), frameTime * 1.0e6, frameTime / budget * 100.0,
+            frameTime / seconds * 1.0e6, setupTime * 1.0e3);
+        if (impulsePath != nullptr)
+        {
+            break;
+        }
+    }
+
+    // Direct convolution in double precision over the first frames, with the first channel cut to 0.25 s.
+    const int checkImpulseCount = std::min(sampleCount, RenderRate / 4);
+    const int checkFrameCount = 100;
+    AudioDsp::PartitionedConvolver convolver;
+    std::vector<char> workBuffer(AudioDsp::PartitionedConvolver::GetRequiredWorkBufferSize(RenderCount, checkImpulseCount));
+    convolver.Initialize(workBuffer.data(), workBuffer.size(), RenderCount, checkImpulseCount);
+    convolver.SetImpulse(impulse.data(), checkImpulseCount, channelCount, 1.0f);
+    std::vector<float> input(static_cast<std::size_t>(checkFrameCount) * RenderCount);
+    std::vector<float> output(input.size());
+    uint32_t seed = 2;
+    for (std::size_t i = 0; i < input.size(); ++i)
+    {
+        input[i] = 16384.0f * NextNoise(&seed);
+    }
+    for (int frame = 0; frame < checkFrameCount; ++frame)
+    {
+        convolver.Process(&output[static_cast<std::size_t>(frame) * RenderCount], &input[static_cast<std::size_t>(frame) * RenderCount]);
+    }
+    double errorPower = 0.0;
+    double signalPower = 0.0;
+    for (std::size_t n = 0; n < output.size(); ++n)
+    {
+        double exact = 0.0;
+        for (std::size_t m = 0; m < static_cast<std::size_t>(checkImpulseCount) && m <= n; ++m)
+        {
+            exact += static_cast<double>(impulse[m * channelCount]) * input[n - m];
+        }
+        errorPower += (output[n] - exact) * (output[n] - exact);
+        signalPower += exact * exact;
+    }
+    const double errorDb = 10.0 * std::log10((errorPower + 1.0e-30) / (signalPower + 1.0e-30));
+    std::printf("error against direct convolution: %.1f dB\n", errorDb);
+    return errorDb < -100.0 ? 0 : 1;
+}
+
+// Gains of one source by direct angles, in double precision: the listener-space direction from the conjugate rotation,
+// its azimuth by atan2(), and the speaker pair around it found by comparing azimuths.
+void SpatializeReference(double* pOutGains, const float* pAzimuths, int channelCount, const double* orientation, const float* position)
+{
+    const double qx = -orientation[0];
+    const double qy = -orientation[1];
+    const double qz = -orientation[2];
+    const double qw = orientation[3];
+    const double px = position[0];
+    const double py = position[1];
+    const double pz = position[2];
+    // v' = q* v q, written as v + 2w(u x v) + 2u x (u x v) with u the vector part of the conjugate.
+    const double cx = qy * pz - qz * py;
+    const double cy = qz * px - qx * pz;
+    const double cz = qx * py - qy * px;
+    const double x = px + 2.0 * (qw * cx + qy * cz - qz * cy);
+    const double y = py + 2.0 * (qw * cy + qz * cx - qx * cz);
+    const double z = pz + 2.0 * (qw * cz + qx * cy - qy * cx);
+    const double distance = std::sqrt(x * x + y * y + z * z);
+    const double attenuation = 1.0 / std::max(distance, 1.0);
+    const double azimuth = std::atan2(x, -z) * 180.0 / 3.14159265358979;
+
+    std::vector<int> speakers;
+    for (int c = 0; c < channelCount; ++c)
+    {
+        pOutGains[c] = 0.0;
+        if (pAzimuths[c] != AudioDsp::Spatializer::NonDirectional)
+        {
+            speakers.push_back(c);
+        }
+    }
+    if (speakers.size() == 1)
+    {
+        pOutGains[speakers[0]] = attenuation;
+    }
+    else if (speakers.size() == 2)
+    {
+        const int left = pAzimuths[speakers[0]] < pAzimuths[speakers[1]] ? speakers[0] : speakers[1];
+        const int right = left == speakers[0] ? speakers[1] : speakers[0];
+        const double lateral = std::sin(azimuth * 3.14159265358979 / 180.0);
+        pOutGains[left] = attenuation * std::sqrt(0.5 - 0.5 * lateral);
+        pOutGains[right] = attenuation * std::sqrt(0.5 + 0.5 * lateral);
+    }
+    else if (speakers.size() > 2)
+    {
+        // The speaker at or just anticlockwise of the source, and the one at or just clockwise of it.
+        int first = -1;
+        int second = -1;
+        double firstDelta = 360.0;
+        double secondDelta = 360.0;
+        for (int c : speakers)
+        {
+            const double clockwise = std::fmod(pAzimuths[c] - azimuth + 720.0, 360.0);
+            const double anticlockwise = std::fmod(azimuth - pAzimuths[c] + 720.0, 360.0);
+            if (clockwise < secondDelta)
+            {
+                secondDelta = clockwise;
+                second = c;
+            }
+            if (anticlockwise < firstDelta)
+            {
+                firstDelta = anticlockwise;
+                first = c;
+            }
+        }
+        // gains * directions = source direction, by Cramer's rule; the sines of the arcs on either side.
+        const double gap = firstDelta + secondDelta;
+        const double radian = 3.14159265358979 / 180.0;
+        double firstGain = gap > 0.0 ? std::sin(secondDelta * radian) / std::sin(gap * radian) : 1.0;
+        double secondGain = gap > 0.0 ? std::sin(firstDelta * radian) / std::sin(gap * radian) : 0.0;
+        const double norm = std::sqrt(firstGain * firstGain + secondGain * secondGain);
+        pOutGains[first] += attenuation * firstGain / norm;
+        if (second != first)
+        {
+            pOutGains[second] += attenuation * secondGain / norm;
+        }
+    }
+}
+
+int RunSpatializerBench(int emitterCount, int channelCount)
+{
+    float azimuths[AudioDsp::Spatializer::ChannelCountMax];
+    AudioDsp::Spatializer::GetDefaultLayout(azimuths, channelCount);
+    AudioDsp::Spatializer spatializer;
+    std::vector<char> workBuffer(AudioDsp::Spatializer::GetRequiredWorkBufferSize(emitterCount));
+    spatializer.Initialize(workBuffer.data(), workBuffer.size(), emitterCount, azimuths, channelCount);
+
+    // Emitters between half a unit and ten units away, in every direction.
+    std::vector<float> positions(static_cast<std::size_t>(emitterCount) * 3);
+    uint32_t seed = 3;
+    for (int e = 0; e < emitterCount; ++e)
+    {
+        float* p = &positions[static_cast<std::size_t>(e) * 3];
+        p[0] = 10.0f * NextNoise(&seed);
+        p[1] = 2.0f * NextNoise(&seed);
+        p[2] = 10.0f * NextNoise(&seed);
+        spatializer.AddEmitter(p[0], p[1], p[2]);
+    }
+
+    // The head turns at 90 degrees per second, tilted and nodding, for the first half, then holds still.
+    const int frameCount = 20000;
+    const double budget = double(RenderCount) / RenderRate;
+    double turningSeconds = 0.0;
+    double stillSeconds = 0.0;
+    int64_t turningChanges = 0;
+    int64_t stillChanges = 0;
+    double errorMax = 0.0;
+    double orientation[4] = { 0.0, 0.0, 0.0, 1.0 };
+    for (int frame = 0; frame < frameCount; ++frame)
+    {
+        const bool isTurning = frame < frameCount / 2;
+        if (isTurning)
+        {
+            const double time = double(frame) * RenderCount / RenderRate;
+            const double yaw = 0.5 * 3.14159265358979 * time;
+            const double pitch = 0.3 * std::sin(time);
+            orientation[0] = std::sin(0.5 * pitch) * std::cos(0.5 * yaw);
+            orientation[1] = std::cos(0.5 * pitch) * std::sin(0.5 * yaw);
+            orientation[2] = -std::sin(0.5 * pitch) * std::sin(0.5 * yaw);
+            orientation[3] = std::cos(0.5 * pitch) * std::cos(0.5 * yaw);
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        spatializer.SetListenerOrientation(static_cast<float>(orientation[0]), static_cast<float>(orientation[1]),
+                                           static_cast<float>(orientation[2]), static_cast<float>(orientation[3]));
+        spatializer.Update();
+        const double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        int changes = 0;
+        for (int e = 0; e < emitterCount; ++e)
+        {
+            changes += spatializer.IsChanged(e) ? 1 : 0;
+        }
+        (isTurning ? turningSeconds : stillSeconds) += elapsed;
+        (isTurning ? turningChanges : stillChanges) += changes;
+
+        // Gains are held until they move by the threshold, so that is the error allowed.
+        if (frame % 97 == 0)
+        {
+            for (int e = 0; e < emitterCount; ++e)
+            {
+                double exact[AudioDsp::Spatializer::ChannelCountMax];
+                SpatializeReference(exact, azimuths, channelCount, orientation, &positions[static_cast<std::size_t>(e) * 3]);
+                for (int c = 0; c < channelCount; ++c)
+                {
+                    errorMax = std::max(errorMax, std::fabs(spatializer.GetGain(e, c) - exact[c]));
+                }
+            }
+        }
+    }
+
+    const int half = frameCount / 2;
+    std::printf("%d emitters over %d channels\n", emitterCount, channelCount);
+    std::printf("turning: %.2f us per frame (%.3f%% of budget), %.1f emitters changed per frame\n",
+        turningSeconds / half * 1.0e6, turningSeconds / half / budget * 100.0, double(turningChanges) / half);
+    std::printf("still:   %.2f us per frame (%.3f%% of budget), %.1f emitters changed per frame\n",
+        stillSeconds / half * 1.0e6, stillSeconds / half / budget * 100.0, double(stillChanges) / half);
+    std::printf("largest gain error against direct angles: %.6f (threshold %.6f)\n", errorMax, AudioDsp::Spatializer::ChangeThreshold);
+    return errorMax < AudioDsp::Spatializer::ChangeThreshold + 1.0e-4 ? 0 : 1;
+}
+
+// Loudness of planar blocks by the direct recursion of the BS.1770 48 kHz K-weighting coefficients, in double precision.
+double MeasureLoudnessReference(const std::vector<int32_t>& samples, int channelCount, int sampleCount)
+{
+    const double shelf[5] = { 1.53512485958697, -2.69169618940638, 1.19839281085285, -1.69065929318241, 0.73248077421585 };
+    const double highPass[5] = { 1.0, -2.0, 1.0, -1.99004745483398, 0.99007225036621 };
+    double weighted = 0.0;
+    for (int c = 0; c < channelCount; ++c)
+    {
+        double state[2][4] = {};
+        double power = 0.0;
+        for (int n = 0; n < sampleCount; ++n)
+        {
+            double x = samples[static_cast<std::size_t>(c) * sampleCount + n] / 32768.0;
+            for (int s = 0; s < 2; ++s)
+            {
+                const double* b = s == 0 ? shelf : highPass;
+                double* z = state[s];
+                const double y = b[0] * x + b[1] * z[0] + b[2] * z[1] - b[3] * z[2] - b[4] * z[3];
+                z[1] = z[0];
+                z[0] = x;
+                z[3] = z[2];
+                z[2] = y;
+                x = y;
+            }
+            power += x * x;
+        }
+        weighted += power / sampleCount;
+    }
+    return -0.691 + 10.0 * std::log10(weighted);
+}
+
+// Feeds planar samples to a meter one audio frame at a time, as the aux tap does.
+void ProcessMeterFrames(AudioDsp::Meter* pMeter, const std::vector<int32_t>& samples, int channelCount, int sampleCount, int frameSampleCount)
+{
+    std::vector<int32_t> frame(static_cast<std::size_t>(channelCount) * frameSampleCount);
+    for (int offset = 0; offset + frameSampleCount <= sampleCount; offset += frameSampleCount)
+    {
+        for (int c = 0; c < channelCount; ++c)
+        {
+            std::memcpy(&frame[static_cast<std::size_t>(c) * frameSampleCount], &samples[static_cast<std::size_t>(c) * sampleCount + offset],
+                        frameSampleCount * sizeof(int32_t));
+        }
+        pMeter->Process(frame.data(), frameSampleCount);
+    }
+}
+
+int RunMeterBench(int channelCount)
+{
+    int failedCount = 0;
+
+    // A 997 Hz sine at -20 dBFS on every channel reads -20 LUFS in stereo. With six, the LFE is left out and the rear pair weighted.
+    {
+        const int sampleRate = 48000;
+        const int sampleCount = 3 * sampleRate;
+        std::vector<int32_t> samples(static_cast<std::size_t>(channelCount) * sampleCount);
+        for (int c = 0; c < channelCount; ++c)
+        {
+            for (int n = 0; n < sampleCount; ++n)
+            {
+                samples[static_cast<std::size_t>(c) * sampleCount + n] = static_cast<int32_t>(std::lround(3276.8 * std::sin(2.0 * 3.14159265358979 * 997.0 * n / sampleRate)));
+            }
+        }
+        AudioDsp::Meter meter;
+        meter.Initialize(channelCount, sampleRate);
+        ProcessMeterFrames(&meter, samples, channelCount, sampleCount, 240);
+        AudioDsp::MeterReading reading;
+        meter.Read(&reading);
+        const double expected = MeasureLoudnessReference(samples, channelCount, sampleCount)
+            + (channelCount == 6 ? 10.0 * std::log10((3.0 + 2.0 * 1.41) / 6.0) : 0.0);
+        std::printf("997 Hz at -20 dBFS: peak %.2f dBFS, RMS %.2f dBFS, momentary %.2f LUFS, short-term %.2f LUFS (reference %.2f)\n",
+            reading.peakDb[0], reading.rmsDb[0], reading.momentaryLufs, reading.shortTermLufs, expected);
+        if (std::fabs(reading.peakDb[0] + 20.0f) > 0.01f || std::fabs(reading.rmsDb[0] + 23.01f) > 0.02f
+            || std::fabs(reading.shortTermLufs - expected) > 0.05 || reading.blockCount != 30 || reading.clipCount != 0)
+        {
+            ++failedCount;
+        }
+    }
+
+    // Noise with one burst past full scale: the clips are counted and the peak reads above 0 dBFS.
+    {
+        const int sampleRate = RenderRate;
+        const int sampleCount = sampleRate;
+        std::vector<int32_t> samples(static_cast<std::size_t>(channelCount) * sampleCount);
+        uint32_t seed = 5;
+        for (std::size_t n = 0; n < samples.size(); ++n)
+        {
+            samples[n] = static_cast<int32_t>(8192.0f * NextNoise(&seed));
+        }
+        for (int n = 1000; n < 1100; ++n)
+        {
+            samples[n] = n % 2 == 0 ? 40000 : -40000;
+        }
+        AudioDsp::Meter meter;
+        meter.Initialize(channelCount, sampleRate);
+        ProcessMeterFrames(&meter, samples, channelCount, sampleCount, RenderCount);
+        AudioDsp::MeterReading reading;
+        meter.Read(&reading);
+        std::printf("noise with a burst: largest peak %.2f dBFS, %u clips\n", reading.peakMaxDb, reading.clipCount);
+        if (reading.clipCount != 100 || std::fabs(reading.peakMaxDb - 20.0f * std::log10(40000.0f / 32768.0f)) > 0.01f)
+        {
+            ++failedCount;
+        }
+    }
+
+    // Cost per audio frame of RenderCount samples.
+    {
+        const int frameCount = 200000;
+        std::vector<int32_t> frame(static_cast<std::size_t>(channelCount) * RenderCount);
+        uint32_t seed = 7;
+        for (std::size_t n = 0; n < frame.size(); ++n)
+        {
+            frame[n] = static_cast<int32_t>(16384.0f * NextNoise(&seed));
+        }
+        AudioDsp::Meter meter;
+        meter.Initialize(channelCount, RenderRate);
+        const auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < frameCount; ++i)
+        {
+            meter.Process(frame.data(), RenderCount);
+        }
+        const double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        AudioDsp::MeterReading reading;
+        meter.Read(&reading);
+        const double budget = double(RenderCount) / RenderRate;
+        std::printf("%d channels: %.3f us per %d-sample frame (%.3f%% of budget), short-term %.2f LUFS\n",
+            channelCount, elapsed / frameCount * 1.0e6, RenderCount, elapsed / frameCount / budget * 100.0, reading.shortTermLufs);
+    }
+    return failedCount == 0 ? 0 : 1;
+}
+
+// Sounds of the scripted scenario, loaded or synthesized once and shared by every run.
+struct ScenarioAssets
+{
+    PcmData bgm;
+    AdpcmData se[SeCountMax];
+    int seCount;
+    int16_t* sineData[HostAudio::VoiceWaveBufferCountMax];
+};
+
+// Digest of one second of the scenario output.
+struct ScenarioSegment
+{
+    uint64_t hash;                      //!<  FNV-1a of the interleaved samples, little-endian.
+    double rms;                         //!<  dB of full scale, over every channel.
+    int peak;
+};
+
+/**
+* @brief  Hashes the output one segment at a time and optionally writes it to a WAV file and compares it with a reference.
+*/
+class ScenarioSink : public HostAudio::ISinkBackend
+{
+public:
+    ScenarioSink(int segmentSampleCount, HostAudio::WavFileSink* pWavSink, const PcmData* pReference)
+        : m_SegmentSampleCount(segmentSampleCount)
+        , m_pWavSink(pWavSink)
+        , m_pReference(pReference)
+        , m_SampleCount(0)
+        , m_ErrorMax(0)
+        , m_ErrorPower(0.0)
+        , m_SignalPower(0.0)
+    {
+        BeginSegment();
+    }
+
+    virtual void Write(const int16_t* interleaved, int sampleCount, int channelCount)
+    {
+        if (m_pWavSink != nullptr)
+        {
+            m_pWavSink->Write(interleaved, sampleCount, channelCount);
+        }
+        const int16_t* pReference = m_pReference != nullptr ? static_cast<const int16_t*>(m_pReference->data) : nullptr;
+        const int64_t referenceCount = m_pReference != nullptr ? static_cast<int64_t>(m_pReference->size / sizeof(int16_t)) : 0;
+        for (int n = 0; n < sampleCount * channelCount; ++n)
+        {
+            const int sample = interleaved[n];
+            const uint16_t bits = static_cast<uint16_t>(sample);
+            m_Segment.hash = (m_Segment.hash ^ (bits & 0xff)) * 1099511628211ull;
+            m_Segment.hash = (m_Segment.hash ^ (bits >> 8)) * 1099511628211ull;
+            m_Segment.peak = std::max(m_Segment.peak, std::abs(sample));
+            m_SegmentPower += double(sample) * sample;
+            const int64_t index = m_SampleCount * channelCount + n;
+            if (index < referenceCount)
+            {
+                const int error = sample - pReference[index];
+                m_ErrorMax = std::max(m_ErrorMax, std::abs(error));
+                m_ErrorPower += double(error) * error;
+                m_SignalPower += double(pReference[index]) * pReference[index];
+            }
+        }
+        m_SegmentSampleCountDone += sampleCount;
+        m_SampleCount += sampleCount;
+        if (m_SegmentSampleCountDone >= m_SegmentSampleCount)
+        {
+            EndSegment(channelCount);
+        }
+    }
+
+    //!<  Closes a partial last segment. Call once after the last frame.
+    void Flush(int channelCount)
+    {
+        if (m_SegmentSampleCountDone > 0)
+        {
+            EndSegment(channelCount);
+        }
+    }
+
+    const std::vector<ScenarioSegment>& GetSegments() const { return m_Segments; }
+    int GetErrorMax() const { return m_ErrorMax; }
+
+    //!<  Power of the difference from the reference relative to the reference, in dB.
+    double GetErrorDb() const { return 10.0 * std::log10((m_ErrorPower + 1.0e-30) / (m_SignalPower + 1.0e-30)); }
+
+private:
+    void BeginSegment()
+    {
+        m_Segment.hash = 14695981039346656037ull;
+        m_Segment.rms = 0.0;
+        m_Segment.peak = 0;
+        m_SegmentPower = 0.0;
+        m_SegmentSampleCountDone = 0;
+    }
+
+    void EndSegment(int channelCount)
+    {
+        const double meanPower = m_SegmentPower / (double(m_SegmentSampleCountDone) * channelCount);
+        m_Segment.rms = 10.0 * std::log10(meanPower / (32768.0 * 32768.0) + 1.0e-30);
+        m_Segments.push_back(m_Segment);
+        BeginSegment();
+    }
+
+    int m_SegmentSampleCount;
+    HostAudio::WavFileSink* m_pWavSink;
+    const PcmData* m_pReference;
+    int64_t m_SampleCount;
+    int m_SegmentSampleCountDone;
+    double m_SegmentPower;
+    ScenarioSegment m_Segment;
+    std::vector<ScenarioSegment> m_Segments;
+    int m_ErrorMax;
+    double m_ErrorPower;
+    double m_SignalPower;
+};
+
+// Position in a triangle wave of the given period, from 0 up to 1 and back.
+double Triangle(int frame, int periodFrameCount)
+{
+    const double phase = double(frame % periodFrameCount) / periodFrameCount;
+    return phase < 0.5 ? 2.0 * phase : 2.0 - 2.0 * phase;
+}
+
+/**
+* @brief  Renders frameCount frames of the scripted scenario into pSink.
+*
+*  The graph is the one of <tt>RunRender()</tt>. The script stands in for the buttons of <tt>nnMain_Sound</tt>: one sound
+*  effect is triggered every quarter second in turn, the sine volume sweeps from -12 dB to +5 dB and back in equal dB
+*  steps every four seconds, its pitch sweeps an octave either way every six seconds, the BGM high-pass filter toggles
+*  every three seconds, the BGM pans from side to side every eight seconds, and it pauses for half a second at five
+*  seconds. Returns the time spent in the frame loop; pVoiceFrameCount receives the voices playing summed over frames.
+*/
+double RenderScenario(const ScenarioAssets& assets, int frameCount, HostAudio::ISinkBackend* pSink, int64_t* pVoiceFrameCount)
+{
+    HostAudio::AudioRendererParameter parameter;
+    HostAudio::InitializeAudioRendererParameter(&parameter);
+    parameter.sampleRate = RenderRate;
+    parameter.sampleCount = RenderCount;
+    parameter.mixBufferCount = 6 + 2; // FinalMix(6) + SubMix(2)
+    parameter.voiceCount = RenderVoiceCount;
+    parameter.subMixCount = 2;
+    parameter.sinkCount = 1;
+    parameter.effectCount = 1;
+
+    const int channelCount = 2;
+    int8_t mainBus[2];
+    mainBus[HostAudio::ChannelMapping_FrontLeft] = 4;
+    mainBus[HostAudio::ChannelMapping_FrontRight] = 5;
+    int8_t auxBusA[2];
+    auxBusA[HostAudio::ChannelMapping_FrontLeft] = 0;
+    auxBusA[HostAudio::ChannelMapping_FrontRight] = 1;
+
+    HostAudio::AudioRendererHandle handle;
+    HostAudio::AudioRendererConfig config;
+    OpenRenderer(&handle, &config, parameter);
+
+    HostAudio::FinalMixType finalMix;
+    HostAudio::AcquireFinalMix(&config, &finalMix, 6);
+    HostAudio::SubMixType subMix0;
+    HostAudio::AcquireSubMix(&config, &subMix0, parameter.sampleRate, 1);
+    HostAudio::SubMixType subMix1;
+    HostAudio::AcquireSubMix(&config, &subMix1, parameter.sampleRate, 1);
+
+    HostAudio::DeviceSinkType deviceSink;
+    HostAudio::AddDeviceSink(&config, &deviceSink, &finalMix, mainBus, channelCount, "MainAudioOut");
+    HostAudio::SetDeviceSinkBackend(&deviceSink, pSink);
+
+    HostAudio::SetSubMixDestination(&config, &subMix0, &finalMix);
+    HostAudio::SetSubMixMixVolume(&subMix0, &finalMix, 0.5f, 0, mainBus[0]);
+    HostAudio::SetSubMixMixVolume(&subMix0, &finalMix, 0.5f, 0, mainBus[1]);
+    HostAudio::SetSubMixDestination(&config, &subMix1, &subMix0);
+    HostAudio::SetSubMixMixVolume(&subMix1, &subMix0, 0.5f, 0, 0);
+
+    HostAudio::BufferMixerType mixer1;
+    HostAudio::AddBufferMixer(&config, &mixer1, &finalMix);
+    HostAudio::SetBufferMixerInputOutput(&mixer1, auxBusA, mainBus, channelCount);
+    HostAudio::SetBufferMixerVolume(&mixer1, 0, 1.0f);
+    HostAudio::SetBufferMixerVolume(&mixer1, 1, 1.0f);
+
+    HostAudio::RequestUpdateAudioRenderer(handle, &config);
+    HostAudio::StartAudioRenderer(handle);
+
+    // Sine wave, generated on demand into a small ring of wave buffers.
+    const float sineFrequency = 440.0f;
+    HostAudio::VoiceType voiceSine;
+    HostAudio::WaveBuffer waveBufferSine[HostAudio::VoiceWaveBufferCountMax];
+    AudioDsp::OscillatorBank sineBank;
+    std::vector<char> sineBankWorkBuffer(AudioDsp::OscillatorBank::GetRequiredWorkBufferSize(1));
+    sineBank.Initialize(sineBankWorkBuffer.data(), sineBankWorkBuffer.size(), 1, RenderRate);
+    const int sineOscillator = sineBank.Add(AudioDsp::Waveform_Sine, sineFrequency, 1.0f);
+    HostAudio::AcquireVoiceSlot(&config, &voiceSine, RenderRate, 1, HostAudio::SampleFormat_PcmInt16, HostAudio::VoiceType::PriorityHighest, nullptr, 0);
+    HostAudio::SetVoiceDestination(&config, &voiceSine, &subMix1);
+    for (int i = 0; i < HostAudio::VoiceWaveBufferCountMax; ++i)
+    {
+        sineBank.Process(assets.sineData[i], OscillatorStreamSampleCount);
+        HostAudio::WaveBuffer& waveBuffer = waveBufferSine[i];
+        waveBuffer.buffer = assets.sineData[i];
+        waveBuffer.size = OscillatorStreamSampleCount * sizeof(int16_t);
+        waveBuffer.startSampleOffset = 0;
+        waveBuffer.endSampleOffset = OscillatorStreamSampleCount;
+        waveBuffer.loop = false;
+        waveBuffer.isEndOfStream = false;
+        waveBuffer.pContext = nullptr;
+        waveBuffer.contextSize = 0;
+        HostAudio::AppendWaveBuffer(&voiceSine, &waveBuffer);
+    }
+    HostAudio::SetVoicePlayState(&voiceSine, HostAudio::VoiceType::PlayState_Play);
+    HostAudio::SetVoiceMixVolume(&voiceSine, &subMix1, 0.707f / 2, 0, 0);
+
+    // Background music, through both filters with the high-pass one disabled.
+    HostAudio::VoiceType voiceBgm;
+    HostAudio::WaveBuffer waveBufferBgm;
+    HostAudio::AcquireVoiceSlot(&config, &voiceBgm, assets.bgm.sampleRate, assets.bgm.channelCount, HostAudio::SampleFormat_PcmInt16, HostAudio::VoiceType::PriorityHighest, nullptr, 0);
+    HostAudio::SetVoiceDestination(&config, &voiceBgm, &finalMix);
+    waveBufferBgm.buffer = assets.bgm.data;
+    waveBufferBgm.size = assets.bgm.size;
+    waveBufferBgm.startSampleOffset = 0;
+    waveBufferBgm.endSampleOffset = static_cast<int32_t>(assets.bgm.size / sizeof(int16_t)) / assets.bgm.channelCount;
+    waveBufferBgm.loop = true;
+    waveBufferBgm.isEndOfStream = false;
+    waveBufferBgm.pContext = nullptr;
+    waveBufferBgm.contextSize = 0;
+    HostAudio::AppendWaveBuffer(&voiceBgm, &waveBufferBgm);
+    HostAudio::SetVoicePlayState(&voiceBgm, HostAudio::VoiceType::PlayState_Play);
+    HostAudio::SetVoiceBiquadFilterParameter(&voiceBgm, 0, AudioDsp::ToBiquadFilterParameter<HostAudio::BiquadFilterParameter>(BgmLowPassFilter, true));
+    HostAudio::SetVoiceBiquadFilterParameter(&voiceBgm, 1, AudioDsp::ToBiquadFilterParameter<HostAudio::BiquadFilterParameter>(BgmHighPassFilter, false));
+
+    // Sound effects on auxBusA, each played once at the start as in the sample.
+    HostAudio::VoiceType voiceSe[SeCountMax];
+    HostAudio::WaveBuffer waveBufferSe[SeCountMax];
+    bool isSePlaying[SeCountMax];
+    for (int i = 0; i < assets.seCount; ++i)
+    {
+        const AdpcmData& se = assets.se[i];
+        HostAudio::AcquireVoiceSlot(&config, &voiceSe[i], se.header.sampleRate, 1, HostAudio::SampleFormat_Adpcm, HostAudio::VoiceType::PriorityHighest, &se.header.parameter, sizeof(HostAudio::AdpcmParameter));
+        HostAudio::SetVoiceDestination(&config, &voiceSe[i], &finalMix);
+        waveBufferSe[i].buffer = se.data;
+        waveBufferSe[i].size = se.size;
+        waveBufferSe[i].startSampleOffset = 0;
+        waveBufferSe[i].endSampleOffset = se.header.sampleCount;
+        waveBufferSe[i].loop = false;
+        waveBufferSe[i].isEndOfStream = false;
+        waveBufferSe[i].pContext = &se.header.context;
+        waveBufferSe[i].contextSize = sizeof(HostAudio::AdpcmContext);
+        HostAudio::AppendWaveBuffer(&voiceSe[i], &waveBufferSe[i]);
+        HostAudio::SetVoicePlayState(&voiceSe[i], HostAudio::VoiceType::PlayState_Play);
+        HostAudio::SetVoiceMixVolume(&voiceSe[i], &finalMix, 0.707f / 2, 0, auxBusA[0]);
+        HostAudio::SetVoiceMixVolume(&voiceSe[i], &finalMix, 0.707f / 2, 0, auxBusA[1]);
+        isSePlaying[i] = true;
+    }
+
+    const int framesPerSecond = RenderRate / RenderCount;
+    const double pi = 3.14159265358979;
+    bool isBgmPaused = false;
+    int64_t voiceFrameCount = 0;
+    const auto start = std::chrono::steady_clock::now();
+    for (int frame = 0; frame < frameCount; ++frame)
+    {
+        // A quarter of a second apart, like pressing A, B, X, and Y in turn. A sound effect still playing is not cut off.
+        for (int i = 0; i < assets.seCount; ++i)
+        {
+            if (isSePlaying[i] && HostAudio::GetReleasedWaveBuffer(&voiceSe[i]) != nullptr)
+            {
+                isSePlaying[i] = false;
+            }
+        }
+        if (assets.seCount > 0 && frame % (framesPerSecond / 4) == 0)
+        {
+            const int i = (frame / (framesPerSecond / 4)) % assets.seCount;
+            if (!isSePlaying[i])
+            {
+                HostAudio::AppendWaveBuffer(&voiceSe[i], &waveBufferSe[i]);
+                isSePlaying[i] = true;
+            }
+        }
+
+        // Sine volume and pitch, as if the stick were held one way and then the other.
+        HostAudio::SetVoiceVolume(&voiceSine, static_cast<float>(0.25 * std::pow(7.0, Triangle(frame, 4 * framesPerSecond))));
+        sineBank.SetFrequency(sineOscillator, static_cast<float>(sineFrequency * std::pow(2.0, 2.0 * Triangle(frame, 6 * framesPerSecond) - 1.0)));
+
+        // L toggles the BGM high-pass filter, and R pauses the BGM.
+        if (frame % (3 * framesPerSecond) == 3 * framesPerSecond / 2)
+        {
+            HostAudio::BiquadFilterParameter filter = HostAudio::GetVoiceBiquadFilterParameter(&voiceBgm, 1);
+            filter.enable = !filter.enable;
+            HostAudio::SetVoiceBiquadFilterParameter(&voiceBgm, 1, filter);
+        }
+        if (frame == 5 * framesPerSecond || frame == 5 * framesPerSecond + framesPerSecond / 2)
+        {
+            isBgmPaused = !isBgmPaused;
+            HostAudio::SetVoicePlayState(&voiceBgm, isBgmPaused ? HostAudio::VoiceType::PlayState_Pause : HostAudio::VoiceType::PlayState_Play);
+        }
+
+        // Equal-power pan of the BGM; centered, both channels get the 0.5f of the sample.
+        const double pan = 0.5 * pi * Triangle(frame + 2 * framesPerSecond, 8 * framesPerSecond);
+        HostAudio::SetVoiceMixVolume(&voiceBgm, &finalMix, static_cast<float>(0.707 * std::cos(pan)), 0, mainBus[0]);
+        HostAudio::SetVoiceMixVolume(&voiceBgm, &finalMix, static_cast<float>(0.707 * std::sin(pan)), 1, mainBus[1]);
+
+        // Refill the sine buffers that have finished playing.
+        while (const HostAudio::WaveBuffer* pWaveBuffer = HostAudio::GetReleasedWaveBuffer(&voiceSine))
+        {
+            const ptrdiff_t index = pWaveBuffer - waveBufferSine;
+            sineBank.Process(assets.sineData[index], OscillatorStreamSampleCount);
+            HostAudio::AppendWaveBuffer(&voiceSine, &waveBufferSine[index]);
+        }
+
+        voiceFrameCount += 1 + (isBgmPaused ? 0 : 1);
+        for (int i = 0; i < assets.seCount; ++i)
+        {
+            voiceFrameCount += isSePlaying[i] ? 1 : 0;
+        }
+
+        HostAudio::RequestUpdateAudioRenderer(handle, &config);
+        HostAudio::ProcessAudioRenderer(handle);
+    }
+    const double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    HostAudio::StopAudioRenderer(handle);
+    HostAudio::CloseAudioRenderer(handle);
+    *pVoiceFrameCount = voiceFrameCount;
+    return elapsed;
+}
+
+// Reads a golden file written by WriteScenarioGolden(). Lines starting with '#' are comments.
+bool ReadScenarioGolden(int* pOutFrameCount, std::vector<ScenarioSegment>* pOutSegments, const char* path)
+{
+    std::FILE* pFile = std::fopen(path, "r");
+    if (pFile == nullptr)
+    {
+        std::fprintf(stderr, "Cannot open %s\n", path);
+        return false;
+    }
+    bool ok = true;
+    *pOutFrameCount = -1;
+    char line[256];
+    while (ok && std::fgets(line, sizeof(line), pFile) != nullptr)
+    {
+        int index;
+        unsigned long long hash;
+        ScenarioSegment segment;
+        if (line[0] == '#' || line[0] == '\n')
+        {
+            continue;
+        }
+        if (std::sscanf(line, "frames %d", pOutFrameCount) == 1)
+        {
+            continue;
+        }
+        ok = std::sscanf(line, "segment %d %llx %lf %d", &index, &hash, &segment.rms, &segment.peak) == 4
+            && index == static_cast<int>(pOutSegments->size());
+        segment.hash = hash;
+        pOutSegments->push_back(segment);
+    }
+    std::fclose(pFile);
+    if (!ok || *pOutFrameCount <= 0)
+    {
+        std::fprintf(stderr, "%s: not a scenario golden file\n", path);
+        return false;
+    }
+    return true;
+}
+
+bool WriteScenarioGolden(const char* path, int frameCount, const std::vector<ScenarioSegment>& segments)
+{
+    std::FILE* pFile = std::fopen(path, "w");
+    if (pFile == nullptr)
+    {
+        std::fprintf(stderr, "Cannot open %s\n", path);
+        return false;
+    }
+    std::fprintf(pFile, "# Output of HostAudioTool scenario, one second per segment: FNV-1a hash, RMS in dBFS, peak.\n");
+    std::fprintf(pFile, "# Rewrite only for an intended change of the output: scenario --golden <this file> --update\n");
+    std::fprintf(pFile, "frames %d\n", frameCount);
+    for (std::size_t i = 0; i < segments.size(); ++i)
+    {
+        std::fprintf(pFile, "segment %d %016llx %.2f %d\n", static_cast<int>(i),
+            static_cast<unsigned long long>(segments[i].hash), segments[i].rms, segments[i].peak);
+    }
+    return std::fclose(pFile) == 0;
+}
+
+struct ScenarioOptions
+{
+    int frameCount;
+    int repeatCount;
+    const char* bankPath;
+    const char* goldenPath;
+    bool isUpdate;
+    const char* wavPath;
+    const char* referencePath;
+};
+
+int RunScenario(const ScenarioOptions& options)
+{
+    // The BGM is synthesized at 48 kHz, so its voice resamples, and loops every two seconds.
+    ScenarioAssets assets;
+    {
+        const int bgmSampleRate = 48000;
+        const int bgmSampleCount = 2 * bgmSampleRate;
+        const AudioDsp::Waveform waveforms[2][2] = { { AudioDsp::Waveform_Saw, AudioDsp::Waveform_Sine }, { AudioDsp::Waveform_Square, AudioDsp::Waveform_Sine } };
+        const float frequencies[2][2] = { { 110.0f, 330.0f }, { 165.0f, 440.0f } };
+        std::vector<int16_t> channel(bgmSampleCount);
+        int16_t* pBgm = static_cast<int16_t*>(AllocateWaveBuffer(bgmSampleCount * 2 * sizeof(int16_t)));
+        for (int c = 0; c < 2; ++c)
+        {
+            AudioDsp::OscillatorBank bank;
+            std::vector<char> workBuffer(AudioDsp::OscillatorBank::GetRequiredWorkBufferSize(2));
+            bank.Initialize(workBuffer.data(), workBuffer.size(), 2, bgmSampleRate);
+            bank.Add(waveforms[c][0], frequencies[c][0], 0.3f);
+            bank.Add(waveforms[c][1], frequencies[c][1], 0.2f);
+            bank.Process(channel.data(), bgmSampleCount);
+            for (int n = 0; n < bgmSampleCount; ++n)
+            {
+                pBgm[2 * n + c] = channel[n];
+            }
+        }
+        assets.bgm.data = pBgm;
+        assets.bgm.size = bgmSampleCount * 2 * sizeof(int16_t);
+        assets.bgm.sampleRate = bgmSampleRate;
+        assets.bgm.channelCount = 2;
+    }
+    const void* bank = ReadBankFile(options.bankPath);
+    if (bank == nullptr)
+    {
+        return 1;
+    }
+    assets.seCount = 0;
+    for (int i = 0; i < AudioDsp::GetBankEntryCount(bank) && assets.seCount < SeCountMax; ++i)
+    {
+        const AudioDsp::BankEntry* pEntry = AudioDsp::GetBankEntry(bank, i);
+        if (pEntry->sampleFormat == AudioDsp::BankSampleFormat_Adpcm)
+        {
+            AdpcmData& se = assets.se[assets.seCount++];
+            se.header = pEntry->info;
+            se.data = const_cast<void*>(AudioDsp::GetBankEntryData(bank, i));
+            se.size = pEntry->dataSize;
+        }
+    }
+    for (int i = 0; i < HostAudio::VoiceWaveBufferCountMax; ++i)
+    {
+        assets.sineData[i] = static_cast<int16_t*>(AllocateWaveBuffer(OscillatorStreamSampleCount * sizeof(int16_t)));
+    }
+
+    PcmData reference = {};
+    if (options.referencePath != nullptr && !ReadWavFile(&reference, options.referencePath))
+    {
+        std::fprintf(stderr, "Cannot read 16-bit PCM WAV %s\n", options.referencePath);
+        return 1;
+    }
+
+    // Every run must produce the same output; the fastest one is reported.
+    const int channelCount = 2;
+    const int framesPerSecond = RenderRate / RenderCount;
+    std::vector<ScenarioSegment> segments;
+    double elapsedMin = 0.0;
+    int64_t voiceFrameCount = 0;
+    int errorMax = 0;
+    double errorDb = 0.0;
+    for (int run = 0; run < options.repeatCount; ++run)
+    {
+        // Only the first run writes the WAV file and is compared with the reference.
+        HostAudio::WavFileSink wavSink;
+        const bool isFirst = run == 0;
+        if (isFirst && options.wavPath != nullptr && !wavSink.Open(options.wavPath, RenderRate, channelCount))
+        {
+            std::fprintf(stderr, "Cannot open %s\n", options.wavPath);
+            return 1;
+        }
+        ScenarioSink sink(framesPerSecond * RenderCount, isFirst && options.wavPath != nullptr ? &wavSink : nullptr,
+                          isFirst && options.referencePath != nullptr ? &reference : nullptr);
+        const double elapsed = RenderScenario(assets, options.frameCount, &sink, &voiceFrameCount);
+        sink.Flush(channelCount);
+        wavSink.Close();
+        if (isFirst)
+        {
+            segments = sink.GetSegments();
+            elapsedMin = elapsed;
+            errorMax = sink.GetErrorMax();
+            errorDb = sink.GetErrorDb();
+        }
+        else
+        {
+            elapsedMin = std::min(elapsedMin, elapsed);
+            for (std::size_t i = 0; i < segments.size(); ++i)
+            {
+                if (sink.GetSegments()[i].hash != segments[i].hash)
+                {
+                    std::printf("run %d differs from run 0 in segment %d: the render is not deterministic\n", run, static_cast<int>(i));
+                    return 1;
+                }
+            }
+        }
+    }
+
+    const double audioSeconds = options.frameCount * double(RenderCount) / RenderRate;
+    std::printf("%d frames (%.2f s of audio), %.2f voices on average, fastest of %d runs:\n",
+        options.frameCount, audioSeconds, double(voiceFrameCount) / options.frameCount, options.repeatCount);
+    std::printf("  %.2f us per frame, %.1f voice frames per ms, %.1fx realtime\n",
+        elapsedMin / options.frameCount * 1.0e6, voiceFrameCount / (elapsedMin * 1000.0), audioSeconds / elapsedMin);
+    if (options.referencePath != nullptr)
+    {
+        if (errorMax == 0)
+        {
+            std::printf("against %s: identical\n", options.referencePath);
+        }
+        else
+        {
+            std::printf("against %s: largest sample difference %d, difference power %.1f dB\n", options.referencePath, errorMax, errorDb);
+        }
+    }
+
+    if (options.isUpdate)
+    {
+        if (!WriteScenarioGolden(options.goldenPath, options.frameCount, segments))
+        {
+            return 1;
+        }
+        std::printf("wrote %d segments to %s\n", static_cast<int>(segments.size()), options.goldenPath);
+        return 0;
+    }
+
+    int goldenFrameCount;
+    std::vector<ScenarioSegment> golden;
+    if (!ReadScenarioGolden(&goldenFrameCount, &golden, options.goldenPath))
+    {
+        return 1;
+    }
+    if (goldenFrameCount != options.frameCount || golden.size() != segments.size())
+    {
+        std::printf("%s holds %d frames; run with --frames %d to compare\n", options.goldenPath, goldenFrameCount, goldenFrameCount);
+        return 1;
+    }
+    int mismatchCount = 0;
+    for (std::size_t i = 0; i < segments.size(); ++i)
+    {
+        if (segments[i].hash != golden[i].hash)
+        {
+            std::printf("segment %d (%d s): hash differs, RMS %.2f -> %.2f dBFS, peak %d -> %d\n", static_cast<int>(i), static_cast<int>(i),
+                golden[i].rms, segments[i].rms, golden[i].peak, segments[i].peak);
+            ++mismatchCount;
+        }
+    }
+    std::printf("%s: %d of %d segments match\n", options.goldenPath, static_cast<int>(segments.size()) - mismatchCount, static_cast<int>(segments.size()));
+    return mismatchCount == 0 ? 0 : 1;
+}
+
+void PrintUsage()
+{
+    std::printf("--------------------------------------------------------\n");
+    std::printf("HostAudioTool\n");
+    std::printf("--------------------------------------------------------\n");
+    std::printf("render <out.wav|-> [--seconds N] [--bgm file.wav] [--se file.adpcm]... [--bank file.bank] [--metrics out.jsonl|-] [--reverb impulse.wav] [--capture out.wav]\n");
+    std::printf("capacity [--se file.adpcm]\n");
+    std::printf("wav-info <file.wav>...\n");
+    std::printf("adpcm-decode <in.adpcm> <out.wav> [--seconds N] [--verify reference.wav]\n");
+    std::printf("adpcm-bench <in.adpcm>...\n");
+    std::printf("adpcm-encode <out-dir> <in.wav>... [--jobs N]\n");
+    std::printf("oscillator-bench [--count N]\n");
+    std::printf("biquad-bench [--sections N]\n");
+    std::printf("convert <in.wav|in.adpcm> <out.wav> [--rate N]\n");
+    std::printf("bank-build <out.bank> <in.adpcm|in.wav>...\n");
+    std::printf("bank-info <file.bank>...\n");
+    std::printf("budget <file.bank>... [--polyphony N] [--voices N]\n");
+    std::printf("pool-bench [--hours N]\n");
+    std::printf("ir-make <out.wav> [--seconds N] [--rate N]\n");
+    std::printf("reverb-bench [--ir impulse.wav]\n");
+    std::printf("spatializer-bench [--emitters N] [--channels N]\n");
+    std::printf("meter-bench [--channels N]\n");
+    std::printf("scenario [--frames N] [--repeat N] [--bank file.bank] [--golden file.txt] [--update] [--wav out.wav] [--reference ref.wav]\n");
+    std::printf("--------------------------------------------------------\n");
+}
+
+}  // namespace
+
+int main(int argc, char** argv)
+{
+    if (argc < 2)
+    {
+        PrintUsage();
+        return 1;
+    }
+
+    if (std::strcmp(argv[1], "render") == 0 && argc >= 3)
+    {
+        RenderOptions options = {};
+        options.outputPath = argv[2];
+        options.seconds = 10.0;
+        for (int i = 3; i < argc; ++i)
+        {
+            if (std::strcmp(argv[i], "--seconds") == 0 && i + 1 < argc)
+            {
+                options.seconds = std::atof(argv[++i]);
+            }
+            else if (std::strcmp(argv[i], "--bgm") == 0 && i + 1 < argc)
+            {
+                options.bgmPath = argv[++i];
+            }
+            else if (std::strcmp(argv[i], "--se") == 0 && i + 1 < argc && options.seCount < SeCountMax)
+            {
+                options.sePaths[options.seCount++] = argv[++i];
+            }
+            else if (std::strcmp(argv[i], "--bank") == 0 && i + 1 < argc)
+            {
+                options.bankPath = argv[++i];
+            }
+            else if (std::strcmp(argv[i], "--metrics") == 0 && i + 1 < argc)
+            {
+                options.metricsPath = argv[++i];
+            }
+            else if (std::strcmp(argv[i], "--reverb") == 0 && i + 1 < argc)
+            {
+                options.reverbPath = argv[++i];
+            }
+            else if (std::strcmp(argv[i], "--capture") == 0 && i + 1 < argc)
+            {
+                options.capturePath = argv[++i];
+            }
+        }
+        return RunRender(options);
+    }
+
+    if (std::strcmp(argv[1], "capacity") == 0)
+    {
+        const char* sePath = nullptr;
+        for (int i = 2; i < argc; ++i)
+        {
+            if (std::strcmp(argv[i], "--se") == 0 && i + 1 < argc)
+            {
+                sePath = argv[++i];
+            }
+        }
+        return RunCapacity(sePath);
+    }
+
+    if (std::strcmp(argv[1], "wav-info") == 0 && argc >= 3)
+    {
+        return RunWavInfo(argc - 2, argv + 2);
+    }
+
+    if (std::strcmp(argv[1], "adpcm-decode") == 0 && argc >= 4)
+    {
+        double seconds = 0.0;
+        const char* referencePath = nullptr;
+        for (int i = 4; i < argc; ++i)
+        {
+            if (std::strcmp(argv[i], "--seconds") == 0 && i + 1 < argc)
+            {
+                seconds = std::atof(argv[++i]);
+            }
+            else if (std::strcmp(argv[i], "--verify") == 0 && i + 1 < argc)
+            {
+                referencePath = argv[++i];
+            }
+        }
+        return RunAdpcmDecode(argv[2], argv[3], seconds, referencePath);
+    }
+
+    if (std::strcmp(argv[1], "adpcm-bench") == 0 && argc >= 3)
+    {
+        return RunAdpcmBench(argc - 2, argv + 2);
+    }
+
+    if (std::strcmp(argv[1], "adpcm-encode") == 0 && argc >= 4)
+    {
+        // Options may follow the inputs.
+        int jobCount = 0;
+        std::vector<char*> inputPaths;
+        for (int i = 3; i < argc; ++i)
+        {
+            if (std::strcmp(argv[i], "--jobs") == 0 && i + 1 < argc)
+            {
+                jobCount = std::atoi(argv[++i]);
+            }
+            else
+            {
+                inputPaths.push_back(argv[i]);
+            }
+        }
+        return RunAdpcmEncode(argv[2], static_cast<int>(inputPaths.size()), inputPaths.data(), jobCount);
+    }
+
+    if (std::strcmp(argv[1], "oscillator-bench") == 0)
+    {
+        int oscillatorCount = 256;
+        for (int i = 2; i < argc; ++i)
+        {
+            if (std::strcmp(argv[i], "--count") == 0 && i + 1 < argc)
+            {
+                oscillatorCount = std::atoi(argv[++i]);
+            }
+        }
+        return RunOscillatorBench(oscillatorCount > 0 ? oscillatorCount : 1);
+    }
+
+    if (std::strcmp(argv[1], "biquad-bench") == 0)
+    {
+        int sectionCount = AudioDsp::BiquadCascade::SectionCountMax;
+        for (int i = 2; i < argc; ++i)
+        {
+            if (std::strcmp(argv[i], "--sections") == 0 && i + 1 < argc)
+            {
+                sectionCount = std::atoi(argv[++i]);
+            }
+        }
+        // std::min() binds a reference, which would need an out-of-line definition of SectionCountMax.
+        const int sectionCountMax = AudioDsp::BiquadCascade::SectionCountMax;
+        return RunBiquadBench(std::min(std::max(sectionCount, 1), sectionCountMax));
+    }
+
+    if (std::strcmp(argv[1], "convert") == 0 && argc >= 4)
+    {
+        int outputRate = RenderRate;
+        for (int i = 4; i < argc; ++i)
+        {
+            if (std::strcmp(argv[i], "--rate") == 0 && i + 1 < argc)
+            {
+                outputRate = std::atoi(argv[++i]);
+            }
+        }
+        return RunConvert(argv[2], argv[3], outputRate);
+    }
+
+    if (std::strcmp(argv[1], "bank-build") == 0 && argc >= 4)
+    {
+        return RunBankBuild(argv[2], argc - 3, argv + 3);
+    }
+
+    if (std::strcmp(argv[1], "bank-info") == 0 && argc >= 3)
+    {
+        return RunBankInfo(argc - 2, argv + 2);
+    }
+
+    if (std::strcmp(argv[1], "budget") == 0 && argc >= 3)
+    {
+        // Options may follow the banks.
+        int polyphonyMax = 3;
+        int voiceCountMax = 0;
+        std::vector<char*> bankPaths;
+        for (int i = 2; i < argc; ++i)
+        {
+            if (std::strcmp(argv[i], "--polyphony") == 0 && i + 1 < argc)
+            {
+                polyphonyMax = std::atoi(argv[++i]);
+            }
+            else if (std::strcmp(argv[i], "--voices") == 0 && i + 1 < argc)
+            {
+                voiceCountMax = std::atoi(argv[++i]);
+            }
+            else
+            {
+                bankPaths.push_back(argv[i]);
+            }
+        }
+        return RunBudget(static_cast<int>(bankPaths.size()), bankPaths.data(), polyphonyMax, voiceCountMax);
+    }
+
+    if (std::strcmp(argv[1], "pool-bench") == 0)
+    {
+        double hours = 4.0;
+        for (int i = 2; i < argc; ++i)
+        {
+            if (std::strcmp(argv[i], "--hours") == 0 && i + 1 < argc)
+            {
+                hours = std::atof(argv[++i]);
+            }
+        }
+        return RunPoolBench(hours);
+    }
+
+    if (std::strcmp(argv[1], "ir-make") == 0 && argc >= 3)
+    {
+        double seconds = 1.0;
+        int sampleRate = RenderRate;
+        for (int i = 3; i < argc; ++i)
+        {
+            if (std::strcmp(argv[i], "--seconds") == 0 && i + 1 < argc)
+            {
+                seconds = std::atof(argv[++i]);
+            }
+            else if (std::strcmp(argv[i], "--rate") == 0 && i + 1 < argc)
+            {
+                sampleRate = std::atoi(argv[++i]);
+            }
+        }
+        return RunIrMake(argv[2], seconds, sampleRate);
+    }
+
+    if (std::strcmp(argv[1], "reverb-bench") == 0)
+    {
+        const char* impulsePath = nullptr;
+        for (int i = 2; i < argc; ++i)
+        {
+            if (std::strcmp(argv[i], "--ir") == 0 && i + 1 < argc)
+            {
+                impulsePath = argv[++i];
+            }
+        }
+        return RunReverbBench(impulsePath);
+    }
+
+    if (std::strcmp(argv[1], "spatializer-bench") == 0)
+    {
+        int emitterCount = 64;
+        int channelCount = 2;
+        for (int i = 2; i < argc; ++i)
+        {
+            if (std::strcmp(argv[i], "--emitters") == 0 && i + 1 < argc)
+            {
+                emitterCount = std::atoi(argv[++i]);
+            }
+            else if (std::strcmp(argv[i], "--channels") == 0 && i + 1 < argc)
+            {
+                channelCount = std::atoi(argv[++i]);
+            }
+        }
+        const int channelCountMax = AudioDsp::Spatializer::ChannelCountMax;
+        return RunSpatializerBench(std::max(emitterCount, 1), std::min(std::max(channelCount, 1), channelCountMax));
+    }
+
+    if (std::strcmp(argv[1], "meter-bench") == 0)
+    {
+        int channelCount = 2;
+        for (int i = 2; i < argc; ++i)
+        {
+            if (std::strcmp(argv[i], "--channels") == 0 && i + 1 < argc)
+            {
+                channelCount = std::atoi(argv[++i]);
+            }
+        }
+        return RunMeterBench(std::min(std::max(channelCount, 1), AudioDsp::MeterChannelCountMax));
+    }
+
+    if (std::strcmp(argv[1], "scenario") == 0)
+    {
+        ScenarioOptions options = {};
+        options.frameCount = 2000;
+        options.repeatCount = 3;
+        options.bankPath = "Binaries/NX64/Contents/NX/AudioCommon/SampleSe.bank";
+        options.goldenPath = "HostAudioScenario.golden";
+        for (int i = 2; i < argc; ++i)
+        {
+            if (std::strcmp(argv[i], "--frames") == 0 && i + 1 < argc)
+            {
+                options.frameCount = std::atoi(argv[++i]);
+            }
+            else if (std::strcmp(argv[i], "--repeat") == 0 && i + 1 < argc)
+            {
+                options.repeatCount = std::atoi(argv[++i]);
+            }
+            else if (std::strcmp(argv[i], "--bank") == 0 && i + 1 < argc)
+            {
+                options.bankPath = argv[++i];
+            }
+            else if (std::strcmp(argv[i], "--golden") == 0 && i + 1 < argc)
+            {
+                options.goldenPath = argv[++i];
+            }
+            else if (std::strcmp(argv[i], "--update") == 0)
+            {
+                options.isUpdate = true;
+            }
+            else if (std::strcmp(argv[i], "--wav") == 0 && i + 1 < argc)
+            {
+                options.wavPath = argv[++i];
+            }
+            else if (std::strcmp(argv[i], "--reference") == 0 && i + 1 < argc)
+            {
+                options.referencePath = argv[++i];
+            }
+        }
+        options.frameCount = std::max(options.frameCount, 1);
+        options.repeatCount = std::max(options.repeatCount, 1);
+        return RunScenario(options);
+    }
+
+    PrintUsage();
+    return 1;
+}
@@ -113,7 +113,6 @@
 #include <nn/nn_TimeSpan.h>
 #include <nn/audio.h>
 #include <nns/audio/audio_HidUtilities.h>
-#include <nns/audio/audio_WavFormat.h>
 #include <nn/hid.h>
 #include <nn/hid/hid_KeyboardKey.h>
 #include <nn/hid/hid_Npad.h>
@@ -137,6 +136,8 @@
 #include <nv/nv_MemoryManagement.h>
 #endif
 #include"SixAxis.h"
+#include "AudioDspBiquad.h"
+#include "AudioEngine.h"
 
 using namespace SixAxis;
 namespace {
@@ -2157,6 +2158,21 @@ const int RenderCount = (RenderRate / 200);
 // Select the number of files to play.
 const int BgmCount = 1;
 const int SeCount = 4;
+// Most voices the sound effects share; the manifest gives them fewer if fewer instances can play at once.
+const int SeVoiceCount = 8;
+// Sound effects are retriggered every few frames, so each plays one instance at a time and triggers while it plays are dropped.
+const int SePolyphonyMax = 1;
+// Sound effects are triggered on a grid of the audio clock, SeBeatsPerSecond a second, exact to the sample whatever the video frame timing.
+const int SeBeatsPerSecond = 60;
+// How far ahead of the audio clock the beats are scheduled. Covers a late video frame without queuing more than a few.
+const int SeScheduleAheadSampleCount = RenderRate / 10;
+// The BGM voice is budgeted for stereo files.
+const int BgmChannelCountMax = 2;
+// BGM filters, designed for RenderRate at compile time so they keep their cutoff at either rate.
+constexpr AudioDsp::BiquadQ14 BgmLowPassFilter = AudioDsp::ToBiquadQ14(AudioDsp::DesignBiquadConstant(AudioDsp::BiquadType_LowPass, RenderRate, 2048.0, 0.7071));
+constexpr AudioDsp::BiquadQ14 BgmHighPassFilter = AudioDsp::ToBiquadQ14(AudioDsp::DesignBiquadConstant(AudioDsp::BiquadType_HighPass, RenderRate, 1024.0, 0.7071));
+// Audio frames a performance buffer holds. The audio thread updates once per audio frame; the rest is slack for a late update.
+const int PerformanceFrameCount = 8;
 
 // - Add or remove these files from the files lists.
 const char* g_BgmFileNames[BgmCount] =
@@ -2164,19 +2180,31 @@ const char* g_BgmFileNames[BgmCount] =
 	"Contents:/AudioRenderer/SampleBgm0-2ch.wav",
 };
 
-const char* g_SeFileNames[SeCount] =
+// The sound effects are packed into one bank; rebuild it with HostAudioTool bank-build after changing the list.
+const char g_SeBankFileName[] = "Contents:/AudioCommon/SampleSe.bank";
+
+const char* g_SeNames[SeCount] =
+{
+	"SampleSe0",
+	"SampleSe1",
+	"SampleSe2",
+	"SampleSe3",
+};
+
+// Where the sounds are, relative to the player holding the controller: x to the right, y up, and -z into the screen, in meters.
+// The BGM plays from the screen and the sound effects from either side, so turning the controller turns them the other way.
+const float g_BgmPosition[3] = { 0.0f, 0.0f, -1.0f };
+const float g_SePositions[SeCount][3] =
 {
-	"Contents:/AudioCommon/SampleSe0.adpcm",
-	"Contents:/AudioCommon/SampleSe1.adpcm",
-	"Contents:/AudioCommon/SampleSe2.adpcm",
-	"Contents:/AudioCommon/SampleSe3.adpcm",
+	{ -1.0f, 0.0f, 0.0f },
+	{ 1.0f, 0.0f, 0.0f },
+	{ -0.7f, 0.0f, -0.7f },
+	{ 0.7f, 0.0f, -0.7f },
 };
 
 NN_ALIGNAS(4096) char g_WorkBuffer[8 * 1024 * 1024];
-NN_AUDIO_ALIGNAS_MEMORY_POOL_ALIGN char g_WaveBufferPoolMemory[14 * 1024 * 1024];
 
 nn::mem::StandardAllocator g_Allocator;
-nn::mem::StandardAllocator g_WaveBufferAllocator;
 
 char* g_MountRomCacheBuffer = NULL;
 
@@ -2201,76 +2229,17 @@ void FinalizeFileSystem()
 	g_MountRomCacheBuffer = NULL;
 }
 
-std::size_t GenerateSineWave(void** data, int sampleRate, int frequency, int sampleCount)
-{
-	// The entire memory region managed with g_WaveBufferAllocator is added to the memory pool, waveBufferMemoryPool.
-	int16_t* p = static_cast<int16_t*>(g_WaveBufferAllocator.Allocate(sampleCount * sizeof(int16_t), nn::audio::BufferAlignSize));
-	NN_ABORT_UNLESS_NOT_NULL(p);
-	const float Pi = 3.1415926535897932384626433f;
-	for (auto i = 0; i < sampleCount; ++i)
-	{
-		p[i] = static_cast<int16_t>(std::numeric_limits<int16_t>::max() * sinf(2 * Pi * frequency * i / sampleRate));
-	}
-	*data = p;
-	return sampleCount * sizeof(int16_t);
-}
-
-
-std::size_t ReadWavFile(nns::audio::WavFormat* format, void** data, const char* filename)
+// Audio thread command: fades out oscillator argument of the engine.
+void RemoveOscillatorCommand(void* pUserData, uintptr_t argument)
 {
-	nn::fs::FileHandle handle;
-	nn::Result result = nn::fs::OpenFile(&handle, filename, nn::fs::OpenMode_Read);
-	NN_ABORT_UNLESS_RESULT_SUCCESS(result);
-
-	int64_t size;
-
-	result = nn::fs::GetFileSize(&size, handle);
-	NN_ABORT_UNLESS_RESULT_SUCCESS(result);
-
-	*data = g_WaveBufferAllocator.Allocate(static_cast<std::size_t>(size), nn::audio::BufferAlignSize);
-	NN_ABORT_UNLESS_NOT_NULL(*data);
-
-	// The DATA chunk must be read, but this sample assumes that it is found to be 1024 bits or less.
-	const std::size_t WavHeaderDataSize = 1024;
-
-	result = nn::fs::ReadFile(handle, 0, *data, WavHeaderDataSize);
-	NN_ABORT_UNLESS_RESULT_SUCCESS(result);
-
-	nns::audio::WavResult wavResult = nns::audio::ParseWavFormat(format, *data, WavHeaderDataSize);
-	NN_ABORT_UNLESS_EQUAL(wavResult, nns::audio::WavResult_Success);
-	NN_ABORT_UNLESS_EQUAL(format->bitsPerSample, 16);  // This sample assumes 16-bit PCM.
-
-	result = nn::fs::ReadFile(handle, static_cast<std::size_t>(format->dataOffset), *data, static_cast<std::size_t>(format->dataSize));
-	NN_ABORT_UNLESS_RESULT_SUCCESS(result);
-	nn::fs::CloseFile(handle);
-
-	return static_cast<std::size_t>(format->dataSize);
+	static_cast<AudioEngine*>(pUserData)->GetOscillatorBank()->Remove(static_cast<int>(argument));
 }
 
-std::size_t ReadAdpcmFile(nn::audio::AdpcmHeaderInfo* header, void** adpcmData, const char* filename)
+// Audio thread command: logs the renderer times collected so far.
+void DumpMetricsCommand(void* pUserData, uintptr_t argument)
 {
-	nn::fs::FileHandle handle;
-	nn::Result result = nn::fs::OpenFile(&handle, filename, nn::fs::OpenMode_Read);
-	NN_ABORT_UNLESS_RESULT_SUCCESS(result);
-
-	int64_t size;
-	uint8_t adpcmheader[nn::audio::AdpcmHeaderSize];
-
-	result = nn::fs::GetFileSize(&size, handle);
-	NN_ABORT_UNLESS_RESULT_SUCCESS(result);
-
-	*adpcmData = g_WaveBufferAllocator.Allocate(static_cast<std::size_t>(size) - sizeof(adpcmheader), nn::audio::BufferAlignSize);
-	NN_ABORT_UNLESS_NOT_NULL(*adpcmData);
-
-	result = nn::fs::ReadFile(handle, 0, adpcmheader, sizeof(adpcmheader));
-	NN_ABORT_UNLESS_RESULT_SUCCESS(result);
-	result = nn::fs::ReadFile(handle, sizeof(adpcmheader), *adpcmData, static_cast<size_t>(size) - sizeof(adpcmheader));
-	NN_ABORT_UNLESS_RESULT_SUCCESS(result);
-	nn::fs::CloseFile(handle);
-
-	nn::audio::ParseAdpcmHeader(header, adpcmheader, sizeof(adpcmheader));
-
-	return static_cast<std::size_t>(size) - sizeof(adpcmheader);
+	NN_UNUSED(argument);
+	static_cast<AudioEngine*>(pUserData)->GetPerformanceMetrics()->Dump();
 }
 
 ///-----------------------------------------------------------------------------
@@ -2304,7 +2273,6 @@ extern "C" void nninitStartup()
 extern "C" void nnMain()
 {
 	g_Allocator.Initialize(g_WorkBuffer, sizeof(g_WorkBuffer));
-	g_WaveBufferAllocator.Initialize(g_WaveBufferPoolMemory, sizeof(g_WaveBufferPoolMemory));
 
     InitializeFileSystem();
 
@@ -2391,222 +2359,159 @@ extern "C" void nnMain()
 
 	//Set the style of operation to use.
 	nn::hid::SetSupportedNpadStyleSet(nn::hid::NpadStyleFullKey::Mask);
-	// Specify a renderer parameter.
-	nn::audio::AudioRendererParameter parameter;
-	nn::audio::InitializeAudioRendererParameter(&parameter);
-	parameter.sampleRate = RenderRate;
-	parameter.sampleCount = RenderCount;
-	parameter.mixBufferCount = 6 + 2; // FinalMix(6) + SubMix(2)
-	parameter.voiceCount = 24;
-	parameter.subMixCount = 2;
-	parameter.sinkCount = 1;
-	parameter.effectCount = 2;
-	parameter.performanceFrameCount = 0;
+	// Describe the mix graph. The engine derives the renderer parameter and the size of its arenas from it.
+	AudioEngineGraph graph;
+	InitializeAudioEngineGraph(&graph);
+	graph.sampleRate = RenderRate;
+	graph.sampleCount = RenderCount;
 
 	// Define the relationship between the mix buffer and audio bus.
-	int channelCount = 2;
-	int8_t mainBus[2];
-	mainBus[nn::audio::ChannelMapping_FrontLeft] = 4;
-	mainBus[nn::audio::ChannelMapping_FrontRight] = 5;
-	int8_t auxBusA[2];
-	auxBusA[nn::audio::ChannelMapping_FrontLeft] = 0;
-	auxBusA[nn::audio::ChannelMapping_FrontRight] = 1;
-
-	// Check whether the parameter is supported by the system.
-	NN_ABORT_UNLESS(
-		nn::audio::IsValidAudioRendererParameter(parameter),
-		"Invalid AudioRendererParameter specified."
-	);
-
-	// Prepare a renderer work buffer.
-	size_t workBufferSize = nn::audio::GetAudioRendererWorkBufferSize(parameter);
-	void* workBuffer = g_Allocator.Allocate(workBufferSize, nn::os::MemoryPageSize);
-	NN_ABORT_UNLESS_NOT_NULL(workBuffer);
-
-	nn::os::SystemEvent systemEvent;
-
-	// Initialize the renderer.
-	nn::audio::AudioRendererHandle handle;
-	NN_ABORT_UNLESS(
-		nn::audio::OpenAudioRenderer(&handle, &systemEvent, parameter, workBuffer, workBufferSize).IsSuccess(),
-		"Failed to open AudioRenderer"
-	);
-
-	// Initialize AudioRendererConfig.
-	size_t configBufferSize = nn::audio::GetAudioRendererConfigWorkBufferSize(parameter);
-	void* configBuffer = g_Allocator.Allocate(configBufferSize, nn::os::MemoryPageSize);
-	NN_ABORT_UNLESS_NOT_NULL(configBuffer);
-	nn::audio::AudioRendererConfig config;
-	nn::audio::InitializeAudioRendererConfig(&config, parameter, configBuffer, configBufferSize);
-
-	nn::audio::FinalMixType finalMix;
-	nn::audio::AcquireFinalMix(&config, &finalMix, 6);
-
-	nn::audio::SubMixType subMix0;
-	nn::audio::AcquireSubMix(&config, &subMix0, parameter.sampleRate, 1);
-	nn::audio::SubMixType subMix1;
-	nn::audio::AcquireSubMix(&config, &subMix1, parameter.sampleRate, 1);
-
-	// Specify the renderer output destination.
-	nn::audio::DeviceSinkType deviceSink;
-	// Configure the input for the audio output device.
-	// The output channel is set in conjunction with the mix buffer index specified for mainBus.
-	// mainBus[nn::audio::ChannelMapping_FrontLeft] is output to the left channel and
-	// mainBus[nn::audio::ChannelMapping_FrontRight] is output to the right channel.
-	nn::Result result = nn::audio::AddDeviceSink(&config, &deviceSink, &finalMix, mainBus, channelCount, "MainAudioOut");
-	NN_ABORT_UNLESS_RESULT_SUCCESS(result);
-
-	// Connect SubMix(0) to FinalMix.
-	nn::audio::SetSubMixDestination(&config, &subMix0, &finalMix);
-
-	// Configure so that you send the 0th buffer of SubMix(0) to mainBus[0]
-	// and mainBus[1] of FinalMix, using a volume of 0.5f for the mix.
-	nn::audio::SetSubMixMixVolume(&subMix0, &finalMix, 0.5f, 0, mainBus[0]);
-	nn::audio::SetSubMixMixVolume(&subMix0, &finalMix, 0.5f, 0, mainBus[1]);
-
-	// Connect SubMix(1) to SubMix(0).
-	nn::audio::SetSubMixDestination(&config, &subMix1, &subMix0);
-
-	// Configure so that you send the 0th buffer of SubMix(1) to the 0th buffer of SubMix(0)
-	// and mainBus[1] of FinalMix, using a volume of 0.5f for the mix.
-	nn::audio::SetSubMixMixVolume(&subMix1, &subMix0, 0.5f, 0, 0);
-
-	// Prepare and register BufferMixer.
-	nn::audio::BufferMixerType mixer1;
-	result = nn::audio::AddBufferMixer(&config, &mixer1, &finalMix);
-	NN_ABORT_UNLESS_RESULT_SUCCESS(result);
-	nn::audio::SetBufferMixerInputOutput(&mixer1, auxBusA, mainBus, channelCount);
-
-	// Set buffer mixer parameters.
-	nn::audio::SetBufferMixerVolume(&mixer1, 0, 1.0f);
-	nn::audio::SetBufferMixerVolume(&mixer1, 1, 1.0f);
-
-	// The specified parameters are applied in the renderer.
-	result = nn::audio::RequestUpdateAudioRenderer(handle, &config);
-	NN_ABORT_UNLESS_RESULT_SUCCESS(result);
-
-	// Start rendering.
-	result = nn::audio::StartAudioRenderer(handle);
-	NN_ABORT_UNLESS_RESULT_SUCCESS(result);
-
-	// Prepare Voice.
-	nn::audio::VoiceType voiceSine;
-	nn::audio::WaveBuffer waveBufferSine;
-	void* dataSine;
-
-	// Prepare a memory pool to maintain the sample data added to WaveBuffer.
-	nn::audio::MemoryPoolType waveBufferMemoryPool;
-	auto ret = AcquireMemoryPool(&config, &waveBufferMemoryPool, g_WaveBufferPoolMemory, sizeof(g_WaveBufferPoolMemory));
-	NN_ABORT_UNLESS(ret);
-	ret = RequestAttachMemoryPool(&waveBufferMemoryPool);
-	NN_ABORT_UNLESS(ret);
-
-	// Prepare the waveform to play with Voice.
+	// mainBus is output to the audio output device: mainBus[nn::audio::ChannelMapping_FrontLeft] to the left channel and
+	// mainBus[nn::audio::ChannelMapping_FrontRight] to the right channel. A BufferMixer adds auxBus to mainBus.
+	graph.finalMixBufferCount = 6;
+	graph.channelCount = 2;
+	graph.mainBus[nn::audio::ChannelMapping_FrontLeft] = 4;
+	graph.mainBus[nn::audio::ChannelMapping_FrontRight] = 5;
+	graph.isAuxBusEnabled = true;
+	graph.auxBus[nn::audio::ChannelMapping_FrontLeft] = 0;
+	graph.auxBus[nn::audio::ChannelMapping_FrontRight] = 1;
+
+	// SubMix(0) sends its buffer to both channels of mainBus, and SubMix(1) sends its buffer to SubMix(0), each with a volume of 0.5f.
+	graph.subMixCount = 2;
+	graph.subMixes[0].bufferCount = 1;
+	graph.subMixes[0].destination = AudioEngine::Destination_MainBus;
+	graph.subMixes[0].volume = 0.5f;
+	graph.subMixes[1].bufferCount = 1;
+	graph.subMixes[1].destination = 0;
+	graph.subMixes[1].volume = 0.5f;
+
+	// BGM streams, the sine wave oscillator on SubMix(1), and the voice pool and bank of the sound effects.
+	graph.streamCountMax = BgmCount;
+	graph.streamChannelCountMax = BgmChannelCountMax;
+	graph.oscillatorCountMax = 1;
+	graph.oscillatorDestination = 1;
+	graph.oscillatorVolume = 0.707f / 2;
+	// The bank memory, sound effects, and voice pool are sized from the bank and the polyphony of each sound effect.
+	const char* seBankFileNames[] = { g_SeBankFileName };
+	AudioDsp::BudgetSound seBudgetSounds[SeCount];
+	for (int i = 0; i < SeCount; ++i)
 	{
-		const int sineSampleRate = 32000;
-		const int sineFrequency = 440;
-		const int sineSampleCount = 32000;
-		std::size_t size = GenerateSineWave(&dataSine, sineSampleRate, sineFrequency, sineSampleCount);
-
-		nn::audio::AcquireVoiceSlot(&config, &voiceSine, sineSampleRate, 1, nn::audio::SampleFormat_PcmInt16, nn::audio::VoiceType::PriorityHighest, nullptr, 0);
-		nn::audio::SetVoiceDestination(&config, &voiceSine, &subMix1);
-
-		waveBufferSine.buffer = dataSine;
-		waveBufferSine.size = size;
-		waveBufferSine.startSampleOffset = 0;
-		waveBufferSine.endSampleOffset = sineSampleCount;
-		waveBufferSine.loop = 0;
-		waveBufferSine.isEndOfStream = false;
-
-		// Add the waveform to Voice.
-		nn::audio::AppendWaveBuffer(&voiceSine, &waveBufferSine);
-		nn::audio::AppendWaveBuffer(&voiceSine, &waveBufferSine);
-		nn::audio::AppendWaveBuffer(&voiceSine, &waveBufferSine);
-		nn::audio::AppendWaveBuffer(&voiceSine, &waveBufferSine);
-		nn::audio::SetVoicePlayState(&voiceSine, nn::audio::VoiceType::PlayState_Play);
-		nn::audio::SetVoiceMixVolume(&voiceSine, &subMix1, 0.707f / 2, 0, 0);
+		seBudgetSounds[i].bank = 0;
+		seBudgetSounds[i].name = g_SeNames[i];
+		seBudgetSounds[i].polyphonyMax = SePolyphonyMax;
 	}
+	AudioEngineManifest manifest;
+	manifest.bankFileNames = seBankFileNames;
+	manifest.bankCount = 1;
+	manifest.soundEffects = seBudgetSounds;
+	manifest.soundEffectCount = SeCount;
+	manifest.voiceCountMax = SeVoiceCount;
+	ApplyAudioEngineManifest(&graph, manifest);
+	graph.emitterCountMax = BgmCount + SeCount;
+	// The voices go to the loudest sound effects each update; the others keep their place and resume when they are heard again.
+	graph.isVirtualVoiceEnabled = true;
+	graph.performanceFrameCount = PerformanceFrameCount;
+	// Buffers 2 and 3 take the return of the mainBus and auxBus meters; nothing else uses them.
+	graph.isMeteringEnabled = true;
+	graph.meterBus[nn::audio::ChannelMapping_FrontLeft] = 2;
+	graph.meterBus[nn::audio::ChannelMapping_FrontRight] = 3;
+
+	// From Start() on, the audio objects are updated once per audio frame on their own thread, however long a video frame takes.
+	// The render loop only posts commands to it.
+	graph.isUpdateThreadEnabled = true;
+	graph.updateThreadPriority = nn::os::DefaultThreadPriority - 1;
+
+	// Allocate both arenas of the engine once. Nothing is allocated for audio after this.
+	size_t audioWorkBufferSize = AudioEngine::GetRequiredWorkBufferSize(graph);
+	void* audioWorkBuffer = g_Allocator.Allocate(audioWorkBufferSize, nn::os::MemoryPageSize);
+	NN_ABORT_UNLESS_NOT_NULL(audioWorkBuffer);
+	size_t audioPoolBufferSize = AudioEngine::GetRequiredPoolBufferSize(graph);
+	void* audioPoolBuffer = g_Allocator.Allocate(audioPoolBufferSize, nn::audio::MemoryPoolType::AddressAlignment);
+	NN_ABORT_UNLESS_NOT_NULL(audioPoolBuffer);
+
+	// Open the renderer, build the graph, start rendering, and attach the pool buffer as a memory pool.
+	AudioEngine engine;
+	engine.Initialize(graph, audioWorkBuffer, audioWorkBufferSize, audioPoolBuffer, audioPoolBufferSize);
+
+	// Sine wave
+	// The tone is generated on demand by an oscillator bank, so only AudioOscillatorPlayer::GetRequiredBufferSize() bytes are used.
+	const float sineFrequency = 440.0f;
+	engine.GetPerformanceMetrics()->SetLabel(engine.GetOscillatorVoice(), "sine");
+	const int sineOscillator = engine.GetOscillatorBank()->Add(AudioDsp::Waveform_Sine, sineFrequency, 1.0f);
+	NN_ABORT_UNLESS(sineOscillator != AudioDsp::OscillatorBank::InvalidHandle);
 
 	// Background music
-	nn::audio::VoiceType voiceBgm[BgmCount];
-	nn::audio::WaveBuffer waveBufferBgm;
-	void* dataBgm[BgmCount];
-
+	// The BGM is streamed, so only AudioStreamPlayer::GetRequiredBufferSize() bytes of each track are resident at a time.
 	for (int i = 0; i < BgmCount; ++i)
 	{
-		nns::audio::WavFormat format;
-		std::size_t dataSize = ReadWavFile(&format, &dataBgm[i], g_BgmFileNames[i]);
-
-		// Specify the number of channels and get the voices for the loaded WAV file.
-		// Note that if multiple channels of data are loaded, a number of voices commensurate with the number of channels is used.
-		nn::audio::AcquireVoiceSlot(&config, &voiceBgm[i], format.sampleRate, format.channelCount, nn::audio::SampleFormat_PcmInt16, nn::audio::VoiceType::PriorityHighest, nullptr, 0);
-		nn::audio::SetVoiceDestination(&config, &voiceBgm[i], &finalMix);
-
-		waveBufferBgm.buffer = dataBgm[i];
-		waveBufferBgm.size = dataSize;
-		waveBufferBgm.startSampleOffset = 0;
-		waveBufferBgm.endSampleOffset = static_cast<int32_t>(dataSize / sizeof(int16_t)) / format.channelCount;
-		waveBufferBgm.loop = true;
-		waveBufferBgm.isEndOfStream = false;
-		waveBufferBgm.pContext = nullptr;
-		waveBufferBgm.contextSize = 0;
-
-		nn::audio::AppendWaveBuffer(&voiceBgm[i], &waveBufferBgm);
-		nn::audio::SetVoicePlayState(&voiceBgm[i], nn::audio::VoiceType::PlayState_Play);
-		// Set the mix volume, sending the voice's channel 0 to mainBus[0] and channel 1 to mainBus[1].
-		nn::audio::SetVoiceMixVolume(&voiceBgm[i], &finalMix, 0.5f, 0, mainBus[0]);
-		nn::audio::SetVoiceMixVolume(&voiceBgm[i], &finalMix, 0.5f, 1, mainBus[1]);
+		// The channel count and sample rate come from the file header.
+		// Channel 0 of the voice is sent to mainBus[0] and channel 1 to mainBus[1], with a volume of 0.5f.
+		const int bgm = engine.AddStream(g_BgmFileNames[i], true, AudioEngine::Destination_MainBus, 0.5f);
+		// From the first update on, both channels are panned together from the BGM position instead.
+		engine.AddStreamEmitter(bgm, g_BgmPosition[0], g_BgmPosition[1], g_BgmPosition[2]);
+		nn::audio::VoiceType* pVoiceBgm = engine.GetStreamVoice(bgm);
+		engine.GetPerformanceMetrics()->SetLabel(pVoiceBgm, "bgm");
 
 		// Set a 2048 Hz cutoff low-pass filter.
-		nn::audio::BiquadFilterParameter firstFilter = { true, {720, 1439, 720}, {22684, -9350} };
-		nn::audio::SetVoiceBiquadFilterParameter(&voiceBgm[i], 0, firstFilter);
+		nn::audio::BiquadFilterParameter firstFilter = AudioDsp::ToBiquadFilterParameter<nn::audio::BiquadFilterParameter>(BgmLowPassFilter, true);
+		nn::audio::SetVoiceBiquadFilterParameter(pVoiceBgm, 0, firstFilter);
 		// Set a high-pass filter with a cutoff frequency of 1024 Hz, but leave it disabled for now.
-		nn::audio::BiquadFilterParameter secondFilter = { false, {14041, -28083, 14041}, {29547, -13563} };
-		nn::audio::SetVoiceBiquadFilterParameter(&voiceBgm[i], 1, secondFilter);
+		nn::audio::BiquadFilterParameter secondFilter = AudioDsp::ToBiquadFilterParameter<nn::audio::BiquadFilterParameter>(BgmHighPassFilter, false);
+		nn::audio::SetVoiceBiquadFilterParameter(pVoiceBgm, 1, secondFilter);
 	}
 
 	// Sound effects
-	nn::audio::VoiceType voiceSe[SeCount];
-	nn::audio::WaveBuffer waveBufferSe[SeCount];
-	nn::audio::AdpcmHeaderInfo* header[SeCount];
-	void* dataSe[SeCount];
-
+	// Voices come from the engine's pool, so a sound effect only holds a voice while it plays.
+	// Every instance of a sound effect shares its ADPCM data and header. The data is played from the bank in place.
+	AudioSoundEffectConfig seConfig;
+	InitializeAudioSoundEffectConfig(&seConfig);
+	seConfig.polyphonyMax = SePolyphonyMax;
+	seConfig.retriggerPolicy = AudioRetriggerPolicy_Ignore;
+	seConfig.isVirtualizable = true;
+
+	const int seBank = engine.LoadBank(g_SeBankFileName);
 	for (int i = 0; i < SeCount; ++i)
 	{
-		header[i] = reinterpret_cast<nn::audio::AdpcmHeaderInfo*>(g_WaveBufferAllocator.Allocate(sizeof(nn::audio::AdpcmHeaderInfo), NN_ALIGNOF(nn::audio::AdpcmHeaderInfo)));
-		std::size_t dataSeSize = ReadAdpcmFile(header[i], &dataSe[i], g_SeFileNames[i]);
-		nn::audio::AcquireVoiceSlot(&config, &voiceSe[i], header[i]->sampleRate, 1, nn::audio::SampleFormat_Adpcm, nn::audio::VoiceType::PriorityHighest, &header[i]->parameter, sizeof(nn::audio::AdpcmParameter));
-		nn::audio::SetVoiceDestination(&config, &voiceSe[i], &finalMix);
-
-		waveBufferSe[i].buffer = dataSe[i];
-		waveBufferSe[i].size = dataSeSize;
-		waveBufferSe[i].startSampleOffset = 0;
-		waveBufferSe[i].endSampleOffset = header[i]->sampleCount;
-		waveBufferSe[i].loop = false;
-		waveBufferSe[i].isEndOfStream = false;
-		waveBufferSe[i].pContext = &header[i]->loopContext;
-		waveBufferSe[i].contextSize = sizeof(nn::audio::AdpcmContext);
-
-		nn::audio::AppendWaveBuffer(&voiceSe[i], &waveBufferSe[i]);
-		nn::audio::SetVoicePlayState(&voiceSe[i], nn::audio::VoiceType::PlayState_Play);
-		nn::audio::SetVoiceMixVolume(&voiceSe[i], &finalMix, 0.707f / 2, 0, auxBusA[0]);
-		nn::audio::SetVoiceMixVolume(&voiceSe[i], &finalMix, 0.707f / 2, 0, auxBusA[1]);
+		// The sound effects are added in order, so sound effect i has index i.
+		engine.AddSoundEffect(seBank, g_SeNames[i], seConfig, AudioEngine::Destination_AuxBus, 0.707f / 2);
+		engine.AddSoundEffectEmitter(i, g_SePositions[i][0], g_SePositions[i][1], g_SePositions[i][2]);
+		engine.PlaySoundEffect(i);
 	}
 
+	// Start the sine wave, the BGM, and the audio thread.
+	engine.Start();
+	const int64_t seBeatOrigin = engine.GetSampleTime() + SeScheduleAheadSampleCount;
+	int seBeat = 0;
+
     // Draw each frame.
     for( int frame = 0; frame < 60 * 12; ++frame )
     {
-		//Play sound effects. (The same SE is not overlaid.)
-		for (int i = 0; i < SeCount; ++i)
+		//Play sound effects. (The same SE is not overlaid; see SePolyphonyMax.)
+		// SE numbers {0, 1, 2, 3, 4, 5} correspond to buttons {A, B, X, Y, L, R}, and take turns on the beats.
+		// Every beat within SeScheduleAheadSampleCount of the audio clock is scheduled; a full queue leaves the rest for the next frame.
+		for (;;)
 		{
-			// SE numbers {0, 1, 2, 3, 4, 5} correspond to buttons {A, B, X, Y, L, R}.
-			if (frame % SeCount == i)
+			const int64_t beatTime = seBeatOrigin + static_cast<int64_t>(seBeat) * RenderRate / SeBeatsPerSecond;
+			if (beatTime >= engine.GetSampleTime() + SeScheduleAheadSampleCount || !engine.SchedulePlaySoundEffect(seBeat % SeCount, beatTime))
 			{
-				if (nn::audio::GetReleasedWaveBuffer(&voiceSe[i]))
-				{
-					nn::audio::AppendWaveBuffer(&voiceSe[i], &waveBufferSe[i]);
-				}
+				break;
 			}
+			++seBeat;
+		}
+
+		// The tone plays for the first four seconds, as long as the pre-rendered buffers used to last, then fades out.
+		if (frame == 60 * 4)
+		{
+			while (!engine.Post(RemoveOscillatorCommand, &engine, static_cast<uintptr_t>(sineOscillator)))
+			{
+				nn::os::YieldThread();
+			}
+		}
+
+		// The meters are written on the audio thread and read here without a lock, every five seconds.
+		if (frame % (60 * 5) == 60 * 5 - 1)
+		{
+			engine.DumpMeters();
 		}
 
 
@@ -2646,6 +2551,8 @@ extern "C" void nnMain()
 
 			angle = (*it)->GetRotation();
 		}
+		// The orientation that turns the Mii's head also turns the listener. The audio thread takes the latest one each audio frame.
+		engine.SetListenerOrientation(angle.GetX(), angle.GetY(), angle.GetZ(), angle.GetW());
         ///  Set the various constant buffers for drawing.
         SetupMiiConstantBuffers(HeadwearCreateModelTypeList[headwearType], angle);
         SetupHeadwearConstantBuffers(headwearType,angle);
@@ -2792,14 +2699,22 @@ extern "C" void nnMain()
         const nn::gfx::SyncResult syncResult = g_GpuDoneFence.Sync(nn::TimeSpan::FromSeconds(1));
         NN_ASSERT(syncResult == nn::gfx::SyncResult_Success);
 
-		result = nn::audio::RequestUpdateAudioRenderer(handle, &config);
-		NN_ABORT_UNLESS_RESULT_SUCCESS(result);
-
 #ifdef WIN32
         nn::hws::ProcessMessage();
 #endif
     }
 
+	// Log the renderer times of the last second of the run. The audio thread runs the commands still queued before it stops.
+	while (!engine.Post(DumpMetricsCommand, &engine, 0))
+	{
+		nn::os::YieldThread();
+	}
+
+	// Stop the audio thread, the BGM reader threads, and every voice before the file system is unmounted.
+	engine.Finalize();
+	g_Allocator.Free(audioPoolBuffer);
+	g_Allocator.Free(audioWorkBuffer);
+
     FinalizeHeadwearModel();
     FinalizeMii();
     FinalizeResources();